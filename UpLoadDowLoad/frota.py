@@ -0,0 +1,182 @@
+"""Configuração da frota de placas de alarme pelo endpoint /config/bundle.
+
+Substitui os scripts upload_*/baixar_* (um arquivo, uma placa, senha na URL).
+
+Uso:
+  python frota.py baixar  <dispositivos.txt> <pasta_saida>
+  python frota.py diff    <dispositivos.txt> <pasta_config>
+  python frota.py enviar  <dispositivos.txt> <pasta_config> [--versao N] [--forcar] [--recarregar]
+
+<dispositivos.txt>: uma placa por linha, "nome host[:porta]" (# comenta).
+<pasta_config>: sensores.json, usuarios.json e/ou horarios.json; só as seções
+presentes são enviadas. Todas as placas são atendidas em paralelo.
+
+A senha de admin vem de ESP_PASS (ou é pedida) e vai no cabeçalho
+X-Senha-Admin. O corpo leva CRC-32 em X-Bundle-CRC32; a placa só troca os
+arquivos se todas as seções forem válidas.
+"""
+
+import argparse
+import concurrent.futures
+import getpass
+import json
+import os
+import sys
+import time
+import zlib
+
+import requests
+
+SECOES = ("sensores", "usuarios", "horarios")
+TIMEOUT = 5
+LOCAIS_DA_PLACA = {"ultimoDiaReinicio"}  # estado local, fora do diff
+
+
+def ler_dispositivos(caminho):
+    dispositivos = []
+    with open(caminho, encoding="utf-8") as f:
+        for linha in f:
+            linha = linha.strip()
+            if not linha or linha.startswith("#"):
+                continue
+            nome, host = linha.split()[:2]
+            dispositivos.append((nome, f"http://{host}"))
+    return dispositivos
+
+
+def ler_config(pasta):
+    config = {}
+    for secao in SECOES:
+        caminho = os.path.join(pasta, f"{secao}.json")
+        if os.path.exists(caminho):
+            with open(caminho, encoding="utf-8") as f:
+                config[secao] = json.load(f)
+    if not config:
+        sys.exit(f"[ERRO] Nenhum de {', '.join(s + '.json' for s in SECOES)} em {pasta}")
+    return config
+
+
+# ------------------------------------------------------------------ diff
+def diff_sensores(atual, novo):
+    chave = lambda s: (s.get("nome"), s.get("zona"))
+    a = {chave(s): s for s in atual}
+    n = {chave(s): s for s in novo}
+    linhas = [f"+ sensor {k[0]} ({k[1]})" for k in n if k not in a]
+    linhas += [f"- sensor {k[0]} ({k[1]})" for k in a if k not in n]
+    for k in n:
+        if k in a and a[k] != n[k]:
+            mudancas = ", ".join(f"{c}: {a[k].get(c)} -> {n[k].get(c)}"
+                                 for c in sorted(set(a[k]) | set(n[k])) if a[k].get(c) != n[k].get(c))
+            linhas.append(f"~ sensor {k[0]} ({k[1]}): {mudancas}")
+    return linhas
+
+
+def diff_usuarios(atual, novo):
+    a = {u.get("usuario"): u for u in atual}
+    n = {u.get("usuario"): u for u in novo}
+    linhas = [f"+ usuário {u}" for u in n if u not in a]
+    linhas += [f"- usuário {u}" for u in a if u not in n]
+    linhas += [f"~ usuário {u}: senha alterada" for u in n if u in a and a[u] != n[u]]
+    return linhas
+
+
+def diff_horarios(atual, novo):
+    chaves = (set(atual) | set(novo)) - LOCAIS_DA_PLACA
+    return [f"~ {c}: {atual.get(c)} -> {novo.get(c)}"
+            for c in sorted(chaves) if c in novo and atual.get(c) != novo.get(c)]
+
+
+DIFFS = {"sensores": diff_sensores, "usuarios": diff_usuarios, "horarios": diff_horarios}
+
+
+def diff_bundle(atual, config):
+    linhas = []
+    for secao, novo in config.items():
+        linhas += DIFFS[secao](atual.get(secao) or ([] if secao != "horarios" else {}), novo)
+    return linhas
+
+
+# -------------------------------------------------------------- operações
+def baixar_bundle(sessao, url):
+    r = sessao.get(f"{url}/config/bundle", timeout=TIMEOUT)
+    r.raise_for_status()
+    return r.json()
+
+
+def processar(dispositivo, args, senha, config):
+    nome, url = dispositivo
+    sessao = requests.Session()
+    sessao.headers["X-Senha-Admin"] = senha
+    inicio = time.monotonic()
+
+    try:
+        atual = baixar_bundle(sessao, url)
+
+        if args.comando == "baixar":
+            pasta = os.path.join(args.pasta, nome)
+            os.makedirs(pasta, exist_ok=True)
+            for secao in SECOES:
+                with open(os.path.join(pasta, f"{secao}.json"), "w", encoding="utf-8") as f:
+                    json.dump(atual.get(secao), f, ensure_ascii=False, indent=2)
+            return nome, True, f"versão {atual.get('versao')} salva em {pasta}", []
+
+        diff = diff_bundle(atual, config)
+        if args.comando == "diff" or not diff:
+            return nome, True, "sem mudanças" if not diff else f"{len(diff)} mudança(s)", diff
+
+        bundle = {"formato": 1, "versao": args.versao, **config}
+        corpo = json.dumps(bundle, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+        cabecalhos = {"Content-Type": "application/json",
+                      "X-Bundle-CRC32": f"{zlib.crc32(corpo):08x}"}
+        r = sessao.post(f"{url}/config/bundle", data=corpo, headers=cabecalhos,
+                        params={"forcar": "1"} if args.forcar else None, timeout=TIMEOUT)
+        resposta = r.json() if r.headers.get("Content-Type", "").startswith("application/json") else {}
+        if not r.ok:
+            erros = [e.get("msg") for e in resposta.get("erros", [])]
+            return nome, False, f"HTTP {r.status_code}: {resposta.get('msg') or '; '.join(erros) or r.text}", diff
+
+        msg = resposta.get("msg", "ok")
+        if resposta.get("recarregar") and args.recarregar:
+            sessao.post(f"{url}/recarregar_dados", timeout=TIMEOUT).raise_for_status()
+            msg += ", sensores recarregados"
+        elif resposta.get("recarregar"):
+            msg += " (sensores valem após /recarregar_dados)"
+        return nome, True, f"{msg} em {time.monotonic() - inicio:.1f}s", diff
+
+    except (requests.RequestException, ValueError) as e:
+        return nome, False, f"falha: {e}", []
+
+
+def main():
+    p = argparse.ArgumentParser(description="Configuração em lote das placas de alarme")
+    p.add_argument("comando", choices=("baixar", "diff", "enviar"))
+    p.add_argument("dispositivos")
+    p.add_argument("pasta")
+    p.add_argument("--versao", type=int, default=int(time.time()),
+                   help="versão do bundle (padrão: horário atual, sempre crescente)")
+    p.add_argument("--forcar", action="store_true", help="aceita versão menor/igual à instalada")
+    p.add_argument("--recarregar", action="store_true",
+                   help="chama /recarregar_dados se os sensores mudarem (rearma o alarme)")
+    p.add_argument("--paralelo", type=int, default=32)
+    args = p.parse_args()
+
+    senha = os.environ.get("ESP_PASS") or getpass.getpass("Senha de admin: ")
+    dispositivos = ler_dispositivos(args.dispositivos)
+    config = ler_config(args.pasta) if args.comando != "baixar" else None
+
+    falhas = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.paralelo) as executor:
+        tarefas = [executor.submit(processar, d, args, senha, config) for d in dispositivos]
+        for tarefa in concurrent.futures.as_completed(tarefas):
+            nome, ok, msg, diff = tarefa.result()
+            falhas += not ok
+            print(f"[{'OK' if ok else 'ERRO'}] {nome}: {msg}")
+            for linha in diff:
+                print(f"    {linha}")
+
+    print(f"\n{len(dispositivos) - falhas}/{len(dispositivos)} placas ok")
+    sys.exit(1 if falhas else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,6 +11,24 @@
 #define MAX_TENTATIVAS_LOGIN 3
 #define TEMPO_BLOQUEIO_LOGIN 300000  // 5 minutos em ms
 
+// Limite de requisições (por IP e global, token bucket; ver limitador.h)
+#define WEB_TABELA_IPS              16  // IPs acompanhados (o mais antigo sai)
+#define WEB_BALDE_IP_CAPACIDADE     20  // rajada por IP (carregar a página inteira)
+#define WEB_BALDE_IP_TAXA           5   // requisições/s sustentadas por IP
+#define WEB_BALDE_GLOBAL_CAPACIDADE 40
+#define WEB_BALDE_GLOBAL_TAXA       20  // requisições/s somando todos os IPs
+#define WEB_CUSTO_LOGIN             5   // /login e /verifica_login gastam mais fichas
+#define WEB_BALDE_LOGIN_CAPACIDADE  15  // fichas de login somando todos os IPs (3 tentativas)
+#define WEB_BALDE_LOGIN_TAXA        1   // fichas/s: uma tentativa a cada WEB_CUSTO_LOGIN s
+
+// Ajustes de operação por sensor (sobre /sensores.json, sem recarregar)
+#define AJUSTES_SENSORES_PATH "/ajustes_sensores.json"
+#define AJUSTES_MAX_BYTES     1024
+#define ZONA_BYPASS_MAX_S     86400   // bypass de zona: no máximo 24 h
+
+// /status.json em MessagePack (ver status_compacto.h); não coube = responde JSON
+#define STATUS_COMPACTO_MAX 768
+
 
 // ======================== PINOS DO HARDWARE ========================
 // PIRs
@@ -27,6 +45,11 @@
 #define BTN_ARM_PIN   D3  // Botão físico de armar/desarmar
 #define BUZZER_PIN    D5  // Sirene/Buzzer sonoro
 
+// Sirene: ciclos de toque/pausa enquanto o sensor seguir violado
+#define SIRENE_TEMPO_ALTO_MS  5000
+#define SIRENE_TEMPO_BAIXO_MS 5000
+#define SIRENE_CICLOS         4
+
 /* // ======================== NOMES DAS ZONAS ==========================
 #define ZONA_1_NAME   "RECICLO"
 #define ZONA_2_NAME   "TRIAGEM"
@@ -39,7 +62,8 @@ extern int  DISARM_HOUR_WEEKDAY;
 extern int  ARM_HOUR_WEEKEND ;
 extern int  DISARM_HOUR_WEEKEND ; 
 // ======================== ARQUIVOS NO SISTEMA ======================
-#define HISTORICO_PATH      "/historico.json"
+#define HISTORICO_PATH      "/historico.log"   // uma linha JSON por evento
+#define HISTORICO_ANTIGO_PATH "/historico.json" // formato antigo (array), migrado no boot
 #define HTML_INDEX_PATH     "/index.html"
 #define HTML_ADMIN_PATH     "/admin.html"
 #define USUARIOS_PATH       "/usuarios.json"
@@ -47,5 +71,118 @@ extern int  DISARM_HOUR_WEEKEND ;
 
 // ======================== PARÂMETROS DO HISTÓRICO =================
 #define HISTORICO_MAX_REGISTROS  100
+#define HISTORICO_COMPACTAR_ESPERA_MS     60000UL   // primeira espera após uma compactação falhar
+#define HISTORICO_COMPACTAR_ESPERA_MAX_MS 3600000UL // teto da espera (dobra a cada falha)
+// Eventos repetidos da mesma origem (registrarEventoAgrupado)
+#define EVENTOS_JANELA_AGRUPAR_MS  60000UL   // repetição dentro disso é só contada
+#define EVENTOS_AGRUPAR_MAX_MS     600000UL  // resumo ao menos a cada 10 min numa tempestade
+#define EVENTOS_AGRUPAMENTOS       6         // origens acompanhadas ao mesmo tempo
+// Arquivo compactado: o que a compactação do histórico descarta vai, em
+// blocos LZSS, para segmentos em HISTORICO_ARQUIVO_DIR (mais antigo sai primeiro)
+#define HISTORICO_ARQUIVO_DIR            "/hist_arq"
+#define HISTORICO_ARQUIVO_MAX_BYTES      49152   // orçamento na flash (6 blocos de 8 KB)
+#define HISTORICO_ARQUIVO_SEGMENTO_BYTES 7168    // segmento fechado perto de 1 bloco
+#define HISTORICO_ARQUIVO_MAX_SEGMENTOS  16
+#define HISTORICO_ARQUIVO_RECENTES_BYTES 2048    // textos recentes (heap só durante a compactação/leitura)
+// Agregados por dia (/historico/resumo.json)
+#define RESUMO_PATH                "/resumo_historico.bin"
+#define RESUMO_DIAS                30
+#define RESUMO_MAX_SENSORES        32        // cheia: sai o sensor com menos alertas
+#define RESUMO_GRAVAR_MS           600000UL  // no máximo uma regravação a cada 10 min
+
+// ======================== VIGIA DO LOOP (TRAVAMENTOS) ==============
+#define VIGIA_LIMIAR_MS         500       // fase do loop mais lenta que isso = travamento
+#define VIGIA_CRASH_PATH        "/crash.json" // último reinício anormal
+#define VIGIA_RTC_OFFSET        32        // blocos de 4 B; 0..31 ficam para o eboot (OTA)
+
+// ======================== TESTE DE CAMINHADA =======================
+#define TESTE_CAMINHADA_DURACAO_S  1800      // padrão quando o POST não informa
+#define TESTE_CAMINHADA_MAX_S      14400     // o alarme volta ao estado anterior ao vencer
+
+// ======================== RASTRO DE GPIO (REPLAY NO HOST) ==========
+// Transições dos sensores e operações do alarme em dois segmentos que se
+// alternam (ver rastro_gpio.h); /diag/rastro.bin vai para tools/replay_rastro
+#define RASTRO_PATH_0              "/rastro_0.bin"
+#define RASTRO_PATH_1              "/rastro_1.bin"
+#define RASTRO_SEGMENTO_BYTES      8192      // cheio: troca com o alarme ocioso
+#define RASTRO_SEGMENTO_MAX_BYTES  12288     // troca mesmo com o alarme ocupado
+#define RASTRO_ATIVO_PADRAO        true      // POST /diag/rastro.json muda até o reboot
+
+// ======================== ARMAZENAMENTO (DESGASTE DA FLASH) ========
+#define ARMAZ_ESTATISTICAS_PATH "/armazenamento.json" // apagamentos acumulados
+#define ARMAZ_BUFFER_BYTES      512       // buffer de coalescência por arquivo anexado
+#define ARMAZ_MAX_BUFFERS       3         // histórico + outbox MQTT + rastro de GPIO
+#define ARMAZ_PRAZO_MS          30000UL   // dado anexado fica no máximo isso em RAM
+#define ARMAZ_PERSISTIR_MS      21600000UL // grava as estatísticas a cada 6 h
+#define ARMAZ_CICLOS_BLOCO      100000UL  // ciclos de apagamento garantidos por bloco
+
+// ======================== MQTT =====================================
+#define MQTT_CONFIG_PATH        "/mqtt.json"
+#define MQTT_OUTBOX_PATH        "/mqtt_outbox.log"
+#define MQTT_OUTBOX_MAX_BYTES   16384   // fila offline em flash (~100 eventos)
+#define MQTT_PORTA_PADRAO       1883
+#define MQTT_CONEXAO_TIMEOUT_MS 100     // TCP/DNS: única espera no loop, só com broker mudo
+#define MQTT_PRAZO_RESPOSTA_MS  5000UL  // CONNACK/PUBACK/PINGRESP (sem bloquear)
+#define MQTT_KEEPALIVE_S        30
+#define MQTT_RECONEXAO_MS       15000UL // dobra a cada falha até MQTT_RECONEXAO_MAX_MS
+#define MQTT_RECONEXAO_MAX_MS   120000UL
+
+// ======================== NOTIFICAÇÕES (WEBHOOK / SMTP) ============
+#define NOTIF_CONFIG_PATH          "/notificacoes.json"
+#define NOTIF_CONFIG_MAX_BYTES     1536
+#define NOTIF_MAX_DESTINOS         4
+#define NOTIF_MAX_FILTROS          4         // prefixos de evento por destino
+#define NOTIF_FILA                 8         // cheia: a notificação mais antiga sai
+#define NOTIF_MAX_TENTATIVAS       6         // por destino, antes de desistir
+#define NOTIF_ESPERA_INICIAL_MS    5000UL    // dobra a cada falha (+ até 25% de sorteio)
+#define NOTIF_ESPERA_MAX_MS        300000UL
+#define NOTIF_VALIDADE_MS          1800000UL // notificação velha demais é descartada
+#define NOTIF_DEDUP_MS             300000UL  // mesmo texto dentro disso não é reenviado
+#define NOTIF_DEDUP_ENTRADAS       8
+#define NOTIF_DISJUNTOR_FALHAS     4         // falhas seguidas que abrem o circuito
+#define NOTIF_DISJUNTOR_ABERTO_MS  120000UL  // destino em pausa; depois, uma tentativa
+#define NOTIF_CONEXAO_TIMEOUT_MS   300       // connect/DNS: limita o bloqueio do loop
+#define NOTIF_PRAZO_MS             10000UL   // conversa inteira com o servidor
+
+// ======================== ENERGIA (RITMO DO LOOP) ==================
+// Armado ou sirene tocando: tick rápido, sem pausas. Desarmado: tick lento
+// e o loop pausa entre ticks com o WiFi em light sleep automático.
+#define ENERGIA_TICK_RAPIDO_MS       100
+#define ENERGIA_TICK_LENTO_MS        1000
+#define ENERGIA_PAUSA_MAX_MS         300     // uma pausa segura no máximo isso (HTTP espera)
+#define ENERGIA_PAUSA_MIN_MS         5       // menos que isso: só yield()
+#define ENERGIA_ACORDADO_MS          3000    // sem pausas depois de uma requisição HTTP
+#define ENERGIA_LISTEN_INTERVAL      1       // acorda a cada DTIM: multicast do P2P chega
+// Estimativa de consumo a partir da fração do tempo em pausa (medir com
+// amperímetro na instalação e ajustar)
+#define ENERGIA_CORRENTE_ACORDADO_MA 70
+#define ENERGIA_CORRENTE_PAUSA_MA    3
+
+// ======================== BUNDLE DE CONFIGURAÇÃO (FROTA) ===========
+#define BUNDLE_VERSAO_PATH      "/config_versao.json" // versão/CRC do último bundle aplicado
+#define BUNDLE_JOURNAL_PATH     "/config_bundle.jnl"  // commit em andamento
+#define BUNDLE_SUFIXO_TMP       ".bdl"
+#define BUNDLE_MAX_BYTES        8192
+
+// ======================== OTA (AUTOTESTE / ROLLBACK) ===============
+#define OTA_ESTADO_PATH         "/ota_estado.json"
+#define OTA_ANTERIOR_PATH       "/ota_anterior.bin"  // última imagem confirmada
+#define OTA_ANTERIOR_TMP_PATH   "/ota_anterior.tmp"
+#define OTA_AUTOTESTE_MS        15000UL   // tempo saudável para confirmar a imagem nova
+#define OTA_PRAZO_CONFIRMACAO_MS 120000UL // sem confirmar até aqui: rollback
+#define OTA_MAX_TENTATIVAS      3         // boots sem confirmar antes do rollback
+#define OTA_COPIA_BLOCO         1024      // bytes copiados para o LittleFS por loop
+
+// ======================== P2P (UDP NA REDE LOCAL) ==================
+#define P2P_CONFIG_PATH         "/p2p.json"
+#define P2P_SEQ_PATH            "/p2p_seq.bin"
+#define P2P_PARES_PATH          "/p2p_pares.bin"  // último seq aceito de cada placa
+#define P2P_PORTA               4242
+#define P2P_GRUPO               239, 255, 42, 42   // multicast
+
+// ======================== COMANDOS VIA WEBSOCKET ====================
+#define WS_PORTA                81
+#define WS_CACHE_COMANDOS       8         // ids já executados lembrados (reenvio idempotente)
+#define WS_MAX_ID               24        // tamanho máximo do id do comando
 
 #endif
@@ -2,6 +2,10 @@
 #include "event_logger.h"
 #include "system_config.h"
 #include "web_server.h"
+#include "armazenamento.h"
+#include "resumo_historico.h"
+#include "teste_caminhada.h"
+#include "rastro_gpio.h"
 #include <time.h>
 
 extern std::vector<String> todasZonas;
@@ -15,55 +19,81 @@ int  ultimoDiaReinicio = -1;
 Alarme::Alarme()
 : estadoAtual(Estado::DESARMADO),
   modoAtual(Modo::MANUAL),
-  sirene(nullptr)
+  sirene(nullptr),
+  emTeste(false),
+  estadoAntesDoTeste(Estado::DESARMADO)
 {}
 
 void Alarme::definirSirene(Sirene *s) { sirene = s; }
-void Alarme::adicionarZona(Zona *zona) { zonas.push_back(zona); }
+void Alarme::definirZonas(Faixa<Zona> z) { zonas = z; }
 
 void Alarme::armar(const std::vector<String> &zonasSelecionadas)
 {
+    encerrarTesteCaminhada();
+    if (estadoAtual != Estado::ARMADO) resumoArmado();
     estadoAtual = Estado::ARMADO;
     zonasAtivas = zonasSelecionadas;
 
-    for (auto zona : zonas)
+    for (Zona &zona : zonas)
     {
-        if (zonaEstaAtiva(zona->getNome())) zona->armar();
-        else                               zona->desarmar();
+        if (zonaEstaAtiva(zona.getNome())) zona.armar();
+        else                              zona.desarmar();
     }
 
     if (sirene) sirene->desativar();
+    rastroArmado();
 }
 
 void Alarme::desarmar()
 {
+    encerrarTesteCaminhada();
+    if (estadoAtual != Estado::DESARMADO) resumoDesarmado();
     estadoAtual = Estado::DESARMADO;
-    for (auto zona : zonas) zona->desarmar();
+    for (Zona &zona : zonas) zona.desarmar();
     if (sirene) sirene->desativar();
+    rastroDesarmado();
 }
 
-void Alarme::atualizar()
+void Alarme::atualizar(uint32_t leitura)
 {
-    if (estadoAtual != Estado::ARMADO) return;
+    if (estadoAtual != Estado::ARMADO)
+    {
+        // a sirene pode ter sido acionada por outra placa (P2P)
+        if (sirene) sirene->atualizar();
+        return;
+    }
 
-    for (auto zona : zonas)
+    // todos os pinos num só acesso (leitura do tick); as zonas avaliam por máscara
+    for (Zona &zona : zonas)
     {
-        if (!zonaEstaAtiva(zona->getNome())) continue;
+        // armar() já deixa armadas só as zonas ativas: evita comparar nomes a cada tick
+        if (!zona.estaArmada()) continue;
 
-        zona->atualizar();
+        zona.atualizar(leitura);
 
-        if (zona->estaViolada())
+        if (zona.estaViolada())
         {
-            for (auto sensor : zona->getSensores())
+            for (Sensor &sensor : zona.getSensores())
             {
-                if (sensor->getEstado() == Sensor::Estado::VIOLADO &&
-                    sensor->getSituacao() == Sensor::Situacao::ATIVO &&
-                    !sensor->foiAlertaEmitido())
+                if (sensor.getEstado() == Sensor::Estado::VIOLADO &&
+                    sensor.getSituacao() == Sensor::Situacao::ATIVO &&
+                    !sensor.foiAlertaEmitido())
                 {
-                    String msg = "[ALERTA] Zona " + zona->getNome() + " violada (" + sensor->getNome() + ").";
-                    registrarEvento(msg);
-                    sensor->setAlertaEmitido(true);
-                    if (sirene) sirene->ativar(sensor);
+                    if (emTeste)
+                    {
+                        testeCaminhadaDetectado(zona, sensor);
+                        sensor.setAlertaEmitido(true);
+                        continue;
+                    }
+
+                    // PIR oscilando dispara de novo a cada volta ao repouso: agrupa por sensor
+                    char origem[80];
+                    snprintf(origem, sizeof(origem), "alerta/%s/%s", zona.getNome(), sensor.getNome());
+                    registrarEventoAgrupado(origem, "[ALERTA] Zona %s violada (%s).", zona.getNome(), sensor.getNome());
+                    resumoAlerta(sensor);
+                    rastroAlerta(sensor);
+                    sensor.setAlertaEmitido(true);
+                    if (sirene) sirene->ativar(&sensor);
                 }
             }
         }
@@ -72,7 +102,7 @@ void Alarme::atualizar()
     if (sirene) sirene->atualizar();
 }
 
-bool Alarme::zonaEstaAtiva(const String &nomeZona) const
+bool Alarme::zonaEstaAtiva(const char *nomeZona) const
 {
     for (const auto &z : zonasAtivas) if (z == nomeZona) return true;
     return false;
@@ -89,12 +119,12 @@ void Alarme::setModo(Modo m)
     if (modoAtual == Modo::AUTOMATICO)
     {
         zonasAtivas.clear();
-        for (auto zona : zonas) zonasAtivas.push_back(zona->getNome());
+        for (const Zona &zona : zonas) zonasAtivas.push_back(zona.getNome());
     }
 }
 
 const std::vector<String>& Alarme::getZonasAtivas() const { return zonasAtivas; }
-const std::vector<Zona*>&  Alarme::getZonas() const { return zonas; }
+Faixa<Zona>                Alarme::getZonas() const { return zonas; }
 
 void Alarme::imprimirDados() const
 {
@@ -109,10 +139,54 @@ void Alarme::imprimirDados() const
     Serial.println("------------------------\n");
 }
 
+// Só solta as referências: quem libera os objetos é o PoolModelo (resetar)
 void Alarme::limparZonas()
 {
-    for (auto zona : zonas) delete zona;
-    zonas.clear();
+    // o relatório aponta para os sensores do pool: não sobrevive à troca
+    encerrarTesteCaminhada();
+    testeCaminhadaDescartar();
+    rastroModeloDescartado();
+    if (sirene) sirene->desativar(); // sirene aponta para um sensor do pool
+    zonas = Faixa<Zona>();
+}
+
+void Alarme::iniciarTesteCaminhada()
+{
+    if (emTeste) return;
+    emTeste = true;
+    estadoAntesDoTeste = estadoAtual;
+    zonasAntesDoTeste = zonasAtivas;
+
+    // estado limpo: um sensor já acionado conta como disparo no início
+    estadoAtual = Estado::ARMADO;
+    for (Zona &zona : zonas)
+    {
+        zona.desarmar();
+        zona.armar();
+    }
+    if (sirene) sirene->silenciar(true);
+    rastroTesteCaminhada(true);
+}
+
+void Alarme::encerrarTesteCaminhada()
+{
+    if (!emTeste) return;
+    emTeste = false;
+    testeCaminhadaFim();
+
+    if (sirene) sirene->silenciar(false);
+    for (Zona &zona : zonas) zona.desarmar();
+
+    // sem resumoArmado/Desarmado: para o histórico o teste não mudou o estado
+    if (estadoAntesDoTeste == Estado::ARMADO)
+    {
+        zonasAtivas = zonasAntesDoTeste;
+        for (Zona &zona : zonas)
+            if (zonaEstaAtiva(zona.getNome())) zona.armar();
+    }
+    else estadoAtual = Estado::DESARMADO;
+    zonasAntesDoTeste.clear();
+    rastroTesteCaminhada(false);
 }
 
 // =================== AUTO SCHEDULE ===================
@@ -120,6 +194,7 @@ void Alarme::limparZonas()
 void checkAutoSchedule(Alarme &alarme)
 {
     if (alarme.getModo() != Alarme::Modo::AUTOMATICO) return;
+    if (alarme.emTesteCaminhada()) return; // o teste devolve o estado ao terminar
 
     struct tm timeinfo;
     const bool temHora = getLocalTime(&timeinfo);
@@ -187,6 +262,9 @@ void checkDailyRestart()
 
         ultimoDiaReinicio = diaId;
         salvarUltimoDiaReinicio(diaId);
+        eventosAgrupadosFecharTodos();
+        resumoGravar();
+        armazenamentoDescarregarTudo();
 
         delay(2000);
         ESP.restart();
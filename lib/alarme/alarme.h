@@ -5,6 +5,7 @@
 #include <vector>
 #include "zona.h"
 #include "sirene.h"
+#include "faixa.h"
 
 class Alarme
 {
@@ -16,27 +17,41 @@ public:
 
     void armar(const std::vector<String> &zonas);
     void desarmar();
-    void atualizar();
+    void atualizar(uint32_t leitura); // leitura = entradasLer() do tick
 
     void definirSirene(Sirene *s);
-    void adicionarZona(Zona *zona);
+    void definirZonas(Faixa<Zona> zonas); // zonas vivem no PoolModelo
 
     Estado getEstado() const;
     Modo getModo() const;
     void setModo(Modo m);
 
-    bool zonaEstaAtiva(const String &nomeZona) const;
+    bool zonaEstaAtiva(const char *nomeZona) const;
     const std::vector<String> &getZonasAtivas() const;
-    const std::vector<Zona*>& getZonas() const;
+    Faixa<Zona> getZonas() const;
     void imprimirDados() const;
     void limparZonas();
 
+    // Teste de caminhada: todas as zonas vigiando com a sirene muda; as
+    // detecções vão para o relatório (teste_caminhada.h) em vez de alertas.
+    // Encerrar (ou armar/desarmar) volta ao estado de antes do teste.
+    void iniciarTesteCaminhada();
+    void encerrarTesteCaminhada();
+    bool emTesteCaminhada() const { return emTeste; }
+    // Para onde o teste volta (rastro de GPIO: segmento começando no meio do teste)
+    Estado getEstadoAntesDoTeste() const { return estadoAntesDoTeste; }
+    const std::vector<String> &getZonasAntesDoTeste() const { return zonasAntesDoTeste; }
+
 private:
     Estado estadoAtual;
     Modo modoAtual;
-    std::vector<Zona *> zonas;
+    Faixa<Zona> zonas;
     std::vector<String> zonasAtivas;
     Sirene *sirene;
+
+    bool emTeste;
+    Estado estadoAntesDoTeste;
+    std::vector<String> zonasAntesDoTeste;
 };
 
 void checkAutoSchedule(Alarme &alarme);
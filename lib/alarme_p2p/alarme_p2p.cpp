@@ -0,0 +1,301 @@
+#include "alarme_p2p.h"
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <Crypto.h>
+
+#include "system_config.h"
+#include "alarme.h"
+#include "sirene.h"
+#include "pool_modelo.h"
+#include "config_sensores.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "rastro_gpio.h"
+#include "identidade.h"
+#include "pacote_p2p.h"
+
+extern std::vector<String> todasZonas;
+
+static const uint32_t P2P_SEQ_BLOCO = 1000; // grava o seq na flash a cada 1000 pacotes
+static const uint8_t P2P_MAX_REACOES = 8;
+static const uint8_t P2P_MAX_PENDENTES = 6;
+static const uint16_t P2P_REENVIOS_MS[] = {20, 60};
+static_assert(P2P_ZONA_BYTES == CONFIG_MAX_NOME + 1, "nome de zona do pacote P2P");
+
+struct Pendente
+{
+    PacoteP2P pacote;
+    uint32_t envioMs;
+    uint8_t reenvios;
+    bool ativo;
+};
+
+static WiFiUDP udp;
+static const IPAddress grupo(P2P_GRUPO);
+static bool habilitado = false;
+static bool escutando = false;
+
+static Alarme *alarmePtr = nullptr;
+static Sirene *sirenePtr = nullptr;
+static char origemLocal[P2P_ORIGEM_BYTES];
+static char chave[64];
+static char mestre[P2P_ORIGEM_BYTES];
+static char reagirZonas[P2P_MAX_REACOES][CONFIG_MAX_NOME + 1];
+static uint8_t totalReacoes = 0;
+
+static uint32_t seqAtual = 0;
+static uint32_t seqLimite = 0;
+static TabelaPares pares;
+static bool avisouTabelaCheia = false;
+static Pendente pendentes[P2P_MAX_PENDENTES];
+
+// estado local anunciado por último
+static int8_t estadoAnunciado = -1;
+static uint32_t geracaoAnunciada = 0;
+static bool zonaAnunciada[CONFIG_MAX_SENSORES];
+
+// Seq persistido em blocos: após reinício continua acima de qualquer valor já usado.
+// Sem o arquivo (flash apagada) parte da hora: as outras placas guardam o último
+// seq desta e recusariam uma contagem recomeçada do zero.
+static void reservarBlocoSeq()
+{
+    uint32_t base = 0;
+    File f = LittleFS.open(P2P_SEQ_PATH, "r");
+    if (f)
+    {
+        f.read((uint8_t *)&base, sizeof(base));
+        f.close();
+    }
+    else
+    {
+        const time_t agora = time(nullptr);
+        if (agora > 1700000000) base = (uint32_t)agora;
+    }
+    if (base < seqAtual) base = seqAtual;
+
+    seqLimite = base + P2P_SEQ_BLOCO;
+    armazenamentoGravar(P2P_SEQ_PATH, (const uint8_t *)&seqLimite, sizeof(seqLimite));
+    seqAtual = base;
+}
+
+static void enviar(const PacoteP2P &p)
+{
+    udp.beginPacketMulticast(grupo, P2P_PORTA, WiFi.localIP());
+    udp.write((const uint8_t *)&p, sizeof(p));
+    udp.endPacket();
+}
+
+static void anunciar(TipoP2P tipo, const char *zona)
+{
+    if (seqAtual + 1 >= seqLimite) reservarBlocoSeq();
+    seqAtual++;
+
+    PacoteP2P p;
+    p2pMontar(p, tipo, seqAtual, origemLocal, zona, chave);
+    enviar(p);
+
+    // UDP não garante entrega: agenda os reenvios (o receptor ignora duplicados)
+    for (Pendente &pend : pendentes)
+    {
+        if (pend.ativo) continue;
+        pend.pacote = p;
+        pend.envioMs = millis();
+        pend.reenvios = 0;
+        pend.ativo = true;
+        break;
+    }
+}
+
+static void processarReenvios()
+{
+    const uint32_t agora = millis();
+    for (Pendente &pend : pendentes)
+    {
+        if (!pend.ativo || agora - pend.envioMs < P2P_REENVIOS_MS[pend.reenvios]) continue;
+        enviar(pend.pacote);
+        if (++pend.reenvios >= sizeof(P2P_REENVIOS_MS) / sizeof(P2P_REENVIOS_MS[0])) pend.ativo = false;
+    }
+}
+
+// Detecta mudanças locais (após o tick do alarme) e anuncia
+static void anunciarMudancas()
+{
+    // teste de caminhada: o "armado" e as violações são do teste, não vão às outras placas
+    if (alarmePtr->emTesteCaminhada()) return;
+
+    const int8_t estado = alarmePtr->getEstado() == Alarme::Estado::ARMADO ? 1 : 0;
+    if (estado != estadoAnunciado)
+    {
+        if (estadoAnunciado >= 0) anunciar(estado ? P2P_ARMOU : P2P_DESARMOU, nullptr);
+        estadoAnunciado = estado;
+    }
+
+    if (geracaoAnunciada != poolModelo.getGeracao())
+    {
+        memset(zonaAnunciada, 0, sizeof(zonaAnunciada));
+        geracaoAnunciada = poolModelo.getGeracao();
+    }
+
+    uint8_t i = 0;
+    for (const Zona &zona : alarmePtr->getZonas())
+    {
+        const bool violada = zona.estaViolada();
+        if (violada && !zonaAnunciada[i]) anunciar(P2P_ZONA_VIOLADA, zona.getNome());
+        zonaAnunciada[i] = violada;
+        if (++i >= CONFIG_MAX_SENSORES) break;
+    }
+}
+
+// true se o pacote é novo para esta origem (descarta replays e duplicados).
+// O último seq vai para a flash antes de o pacote ter efeito.
+static bool aceitarSeq(const PacoteP2P &p)
+{
+    switch (pares.aceitar(p.origem, p.seq))
+    {
+    case TabelaPares::NOVO:
+        armazenamentoGravar(P2P_PARES_PATH, pares.dados(), TabelaPares::tamanho());
+        return true;
+
+    case TabelaPares::CHEIA:
+        contadores.p2pRejeitados++;
+        if (!avisouTabelaCheia)
+        {
+            avisouTabelaCheia = true;
+            registrarEventoF("[P2P] Mais de %u placas na rede: '%s' ignorada", P2P_MAX_PARES, p.origem);
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+static bool deveReagir(const char *zona)
+{
+    for (uint8_t i = 0; i < totalReacoes; i++)
+    {
+        if (strcmp(reagirZonas[i], "*") == 0 || strcmp(reagirZonas[i], zona) == 0) return true;
+    }
+    return false;
+}
+
+static void receber()
+{
+    // poucos pacotes por loop para não atrasar o tick
+    for (uint8_t n = 0; n < 4; n++)
+    {
+        if (udp.parsePacket() <= 0) return;
+
+        PacoteP2P p;
+        if (udp.read((uint8_t *)&p, sizeof(p)) != (int)sizeof(p) || !p2pValidar(p, chave))
+        {
+            contadores.p2pRejeitados++;
+            continue;
+        }
+        if (strcmp(p.origem, origemLocal) == 0) continue; // o próprio multicast
+        if (!aceitarSeq(p)) continue; // reenvio ou replay: idempotente
+        contadores.p2pRecebidos++;
+
+        switch (p.tipo)
+        {
+        case P2P_ARMOU:
+            if (mestre[0] && strcmp(p.origem, mestre) == 0 && alarmePtr->getEstado() != Alarme::Estado::ARMADO)
+            {
+                alarmePtr->armar(todasZonas);
+                registrarEventoF("[P2P] Alarme armado pela placa mestre %s", p.origem);
+            }
+            break;
+
+        case P2P_DESARMOU:
+            if (mestre[0] && strcmp(p.origem, mestre) == 0 && alarmePtr->getEstado() != Alarme::Estado::DESARMADO)
+            {
+                alarmePtr->desarmar();
+                registrarEventoF("[P2P] Alarme desarmado pela placa mestre %s", p.origem);
+            }
+            break;
+
+        case P2P_ZONA_VIOLADA:
+            if (deveReagir(p.zona) && sirenePtr && !sirenePtr->estaAtiva())
+            {
+                sirenePtr->ativar(nullptr);
+                rastroSireneRemota();
+                registrarEventoF("[P2P] Zona %s violada na placa %s: sirene acionada", p.zona, p.origem);
+            }
+            break;
+        }
+    }
+}
+
+// Último seq de cada placa, gravado por aceitarSeq
+static void carregarPares()
+{
+    pares.limpar();
+    File f = LittleFS.open(P2P_PARES_PATH, "r");
+    if (!f) return;
+    uint8_t imagem[TabelaPares::tamanho()];
+    const size_t n = f.read(imagem, sizeof(imagem));
+    const bool inteiro = n == sizeof(imagem) && !f.available();
+    f.close();
+    if (!inteiro || !pares.carregar(imagem, n)) Serial.println("[P2P] Tabela de pares inválida: recomeçando");
+}
+
+void p2p_setup(Alarme *alarme, Sirene *sirene)
+{
+    alarmePtr = alarme;
+    sirenePtr = sirene;
+
+    File f = LittleFS.open(P2P_CONFIG_PATH, "r");
+    if (!f)
+    {
+        Serial.println("[P2P] Sem /p2p.json: desativado");
+        return;
+    }
+
+    StaticJsonDocument<512> doc;
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+    if (err || !(doc["chave"] | "")[0])
+    {
+        Serial.println("[P2P] /p2p.json inválido ou sem chave: desativado");
+        return;
+    }
+
+    // "nome": como esta placa aparece para as outras; sem ele, o chip id
+    const char *nome = doc["nome"] | "";
+    strlcpy(origemLocal, nome[0] ? nome : identidadeDispositivo(), sizeof(origemLocal));
+    strlcpy(chave, doc["chave"] | "", sizeof(chave));
+    strlcpy(mestre, doc["mestre"] | "", sizeof(mestre));
+    for (JsonVariant z : doc["reagir_zonas"].as<JsonArray>())
+    {
+        if (totalReacoes >= P2P_MAX_REACOES) break;
+        strlcpy(reagirZonas[totalReacoes++], z | "", CONFIG_MAX_NOME + 1);
+    }
+
+    carregarPares();
+    habilitado = true;
+    Serial.printf("[P2P] Ativo como '%s' (mestre: %s, %u zonas remotas)\n",
+                  origemLocal, mestre[0] ? mestre : "-", totalReacoes);
+}
+
+void p2p_loop(bool wifiConectado)
+{
+    if (!habilitado) return;
+
+    if (!wifiConectado)
+    {
+        escutando = false;
+        return;
+    }
+    if (!escutando)
+    {
+        escutando = udp.beginMulticast(WiFi.localIP(), grupo, P2P_PORTA);
+        if (!escutando) return;
+    }
+
+    receber();
+    anunciarMudancas();
+    processarReenvios();
+}
@@ -0,0 +1,25 @@
+#ifndef ALARME_P2P_H
+#define ALARME_P2P_H
+
+#include <Arduino.h>
+
+class Alarme;
+class Sirene;
+
+// Propagação de eventos entre placas da mesma rede via UDP multicast.
+// Cada placa anuncia ARMOU/DESARMOU e zona VIOLADA; os pacotes levam a origem
+// (nome da placa), número de sequência (persistido em blocos, sobrevive a
+// reinícios) e HMAC-SHA256 truncado com a chave compartilhada de /p2p.json.
+// Cada pacote é enviado 3 vezes (0, 20 e 60 ms); o receptor descarta seq
+// repetido ou antigo, com o último seq de cada origem guardado na flash
+// (P2P_PARES_PATH): um pacote capturado não é aceito nem após reinício.
+//
+// /p2p.json:
+//   {"chave":"...",              obrigatório (sem chave o módulo fica desligado)
+//    "nome":"portaria",          opcional: origem desta placa (padrão: identidadeDispositivo())
+//    "reagir_zonas":["*"],       zonas remotas que acionam a sirene local ("*" = todas)
+//    "mestre":"portaria"}        opcional: segue arm/desarm da placa com este nome
+void p2p_setup(Alarme *alarme, Sirene *sirene);
+void p2p_loop(bool wifiConectado);
+
+#endif
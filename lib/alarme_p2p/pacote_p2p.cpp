@@ -0,0 +1,77 @@
+#include "pacote_p2p.h"
+#include <string.h>
+#include <Crypto.h>
+
+static void copiarTexto(char *destino, const char *origem, size_t tamanho)
+{
+    strncpy(destino, origem, tamanho - 1);
+    destino[tamanho - 1] = '\0';
+}
+
+static void calcularHmac(const PacoteP2P &p, const char *chave, uint8_t *saida)
+{
+    uint8_t completo[experimental::crypto::SHA256::NATURAL_LENGTH];
+    experimental::crypto::SHA256::hmac(&p, offsetof(PacoteP2P, hmac), chave, strlen(chave),
+                                       completo, sizeof(completo));
+    memcpy(saida, completo, sizeof(p.hmac));
+}
+
+void p2pMontar(PacoteP2P &p, TipoP2P tipo, uint32_t seq, const char *origem, const char *zona, const char *chave)
+{
+    memset(&p, 0, sizeof(p));
+    p.magica[0] = 'A';
+    p.magica[1] = 'L';
+    p.versao = P2P_VERSAO;
+    p.tipo = tipo;
+    p.seq = seq;
+    copiarTexto(p.origem, origem, sizeof(p.origem));
+    if (zona) copiarTexto(p.zona, zona, sizeof(p.zona));
+    calcularHmac(p, chave, p.hmac);
+}
+
+bool p2pValidar(PacoteP2P &p, const char *chave)
+{
+    if (p.magica[0] != 'A' || p.magica[1] != 'L' || p.versao != P2P_VERSAO) return false;
+
+    uint8_t esperado[sizeof(p.hmac)];
+    calcularHmac(p, chave, esperado);
+    uint8_t dif = 0;
+    for (size_t i = 0; i < sizeof(esperado); i++) dif |= esperado[i] ^ p.hmac[i];
+
+    p.origem[sizeof(p.origem) - 1] = '\0';
+    p.zona[sizeof(p.zona) - 1] = '\0';
+    return dif == 0 && p.origem[0];
+}
+
+void TabelaPares::limpar() { memset(pares, 0, sizeof(pares)); }
+
+TabelaPares::Resultado TabelaPares::aceitar(const char *origem, uint32_t seq)
+{
+    Par *livre = nullptr;
+    for (Par &par : pares)
+    {
+        if (!par.origem[0])
+        {
+            if (!livre) livre = &par;
+            continue;
+        }
+        if (strncmp(par.origem, origem, sizeof(par.origem)) != 0) continue;
+        if (seq <= par.ultimoSeq) return REPETIDO;
+        par.ultimoSeq = seq;
+        return NOVO;
+    }
+    if (!livre) return CHEIA;
+
+    copiarTexto(livre->origem, origem, sizeof(livre->origem));
+    livre->ultimoSeq = seq;
+    return NOVO;
+}
+
+bool TabelaPares::carregar(const uint8_t *dados, size_t n)
+{
+    limpar();
+    if (n != sizeof(pares)) return false;
+    memcpy(pares, dados, n);
+    for (Par &par : pares) par.origem[sizeof(par.origem) - 1] = '\0';
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef PACOTE_P2P_H
+#define PACOTE_P2P_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Formato do pacote P2P e a proteção contra replay, separados do transporte
+// (WiFiUDP) e da flash para rodarem também no host (tools/p2p_loopback).
+
+static const uint8_t P2P_VERSAO = 1;
+static const uint8_t P2P_MAX_PARES = 16;   // placas da frota que esta placa acompanha
+static const size_t P2P_ORIGEM_BYTES = 16;
+static const size_t P2P_ZONA_BYTES = 32;   // CONFIG_MAX_NOME + 1
+
+enum TipoP2P : uint8_t
+{
+    P2P_ARMOU = 1,
+    P2P_DESARMOU = 2,
+    P2P_ZONA_VIOLADA = 3
+};
+
+struct __attribute__((packed)) PacoteP2P
+{
+    char magica[2]; // "AL"
+    uint8_t versao;
+    uint8_t tipo;
+    uint32_t seq;
+    char origem[P2P_ORIGEM_BYTES];
+    char zona[P2P_ZONA_BYTES];
+    uint8_t hmac[16]; // HMAC-SHA256 (truncado) de tudo acima
+};
+
+// Preenche cabeçalho, origem/zona (zona pode ser nullptr) e assina
+void p2pMontar(PacoteP2P &p, TipoP2P tipo, uint32_t seq, const char *origem, const char *zona, const char *chave);
+
+// Mágica, versão e HMAC; termina as strings (origem/zona) do pacote recebido
+bool p2pValidar(PacoteP2P &p, const char *chave);
+
+// Último seq aceito de cada placa, gravado na flash a cada pacote novo: um
+// pacote capturado não volta a ser aceito nem depois de um reinício desta
+// placa. Não há despejo (uma origem esquecida reabriria o replay): com a
+// tabela cheia, origens novas são recusadas até a config mudar.
+class TabelaPares
+{
+public:
+    enum Resultado : uint8_t
+    {
+        NOVO,     // seq acima do último: aceitar (e gravar dados())
+        REPETIDO, // reenvio ou replay
+        CHEIA     // origem desconhecida e sem espaço
+    };
+
+    void limpar();
+    Resultado aceitar(const char *origem, uint32_t seq);
+
+    // Imagem gravada na flash (tamanho fixo)
+    const uint8_t *dados() const { return (const uint8_t *)pares; }
+    static size_t tamanho() { return sizeof(pares); }
+    bool carregar(const uint8_t *dados, size_t n);
+
+private:
+    struct Par
+    {
+        char origem[P2P_ORIGEM_BYTES];
+        uint32_t ultimoSeq;
+    };
+    Par pares[P2P_MAX_PARES];
+};
+
+#endif
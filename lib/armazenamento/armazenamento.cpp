@@ -0,0 +1,337 @@
+#include "armazenamento.h"
+#include <LittleFS.h>
+
+#include "system_config.h"
+#include "metricas.h"
+
+// LittleFS grava cada commit de metadados (~64 B) no par de blocos de
+// metadados; quando o bloco enche, ele é compactado (apagado).
+static const uint16_t BYTES_COMMIT_METADADOS = 64;
+static const uint8_t MAX_ARQUIVOS = 12;
+
+struct EstatisticaArquivo
+{
+    char caminho[32];
+    uint32_t bytes;
+    uint32_t commits; // cada close() = um commit de metadados
+    uint32_t blocos;  // blocos de dados novos (cada um custa um apagamento)
+};
+
+struct BufferAnexo
+{
+    char caminho[32];
+    size_t tamanhoArquivo; // já na flash
+    uint16_t usados;
+    uint32_t desdeMs;      // quando o dado mais antigo entrou no buffer
+    uint8_t dados[ARMAZ_BUFFER_BYTES];
+};
+
+static EstatisticaArquivo estatisticas[MAX_ARQUIVOS + 1]; // último = "outros"
+static BufferAnexo buffers[ARMAZ_MAX_BUFFERS];
+
+static size_t tamanhoBloco = 8192;
+static size_t tamanhoPagina = 256;
+static size_t totalBlocos = 0;
+static float apagamentosAnteriores = 0; // boots anteriores (ARMAZ_ESTATISTICAS_PATH)
+static uint32_t ultimaPersistenciaMs = 0;
+
+// ================== Contabilidade ==================
+static EstatisticaArquivo &estatistica(const char *caminho)
+{
+    for (uint8_t i = 0; i < MAX_ARQUIVOS; i++)
+    {
+        EstatisticaArquivo &e = estatisticas[i];
+        if (!e.caminho[0]) strlcpy(e.caminho, caminho, sizeof(e.caminho));
+        if (strcmp(e.caminho, caminho) == 0) return e;
+    }
+    EstatisticaArquivo &outros = estatisticas[MAX_ARQUIVOS];
+    if (!outros.caminho[0]) strlcpy(outros.caminho, "outros", sizeof(outros.caminho));
+    return outros;
+}
+
+void armazenamentoContabilizar(const char *caminho, uint32_t offset, size_t tamanho)
+{
+    EstatisticaArquivo &e = estatistica(caminho);
+    e.bytes += tamanho;
+    e.commits++;
+    if (tamanho)
+    {
+        // cada sessão de escrita do LittleFS copia o bloco final incompleto
+        // para um bloco novo: todo bloco tocado, inclusive o primeiro, custa
+        // um apagamento (tools/bancada/desgaste_flash mede)
+        const uint32_t primeiro = offset / tamanhoBloco;
+        const uint32_t ultimo = (offset + tamanho - 1) / tamanhoBloco;
+        e.blocos += ultimo - primeiro + 1;
+    }
+    metricasBytesEscritos(tamanho);
+}
+
+static float apagamentosEstimados(const EstatisticaArquivo &e)
+{
+    return e.blocos + (float)e.commits * BYTES_COMMIT_METADADOS * 2 / tamanhoBloco;
+}
+
+static float apagamentosSessao()
+{
+    float total = 0;
+    for (const EstatisticaArquivo &e : estatisticas) total += apagamentosEstimados(e);
+    return total;
+}
+
+static void persistirEstatisticas()
+{
+    ultimaPersistenciaMs = millis();
+    StaticJsonDocument<64> doc;
+    doc["apagamentos"] = apagamentosAnteriores + apagamentosSessao();
+
+    // direto, sem contabilizar: a própria persistência entra no próximo boot
+    File f = LittleFS.open(ARMAZ_ESTATISTICAS_PATH, "w");
+    if (!f) return;
+    metricasArquivoAberto();
+    serializeJson(doc, f);
+    f.close();
+}
+
+// ================== Anexos coalescidos ==================
+static BufferAnexo *buscarBuffer(const char *caminho)
+{
+    for (BufferAnexo &b : buffers)
+    {
+        if (b.caminho[0] && strcmp(b.caminho, caminho) == 0) return &b;
+    }
+    return nullptr;
+}
+
+// Grava os 'n' primeiros bytes do buffer no fim do arquivo
+static bool gravarBuffer(BufferAnexo &b, size_t n)
+{
+    if (!n) return true;
+
+    File f = LittleFS.open(b.caminho, "a");
+    if (!f) return false;
+    metricasArquivoAberto();
+    const size_t escritos = f.write(b.dados, n);
+    f.close();
+
+    armazenamentoContabilizar(b.caminho, b.tamanhoArquivo, escritos);
+    b.tamanhoArquivo += escritos;
+    b.usados -= n;
+    memmove(b.dados, b.dados + n, b.usados);
+    b.desdeMs = millis();
+    return escritos == n;
+}
+
+// Maior prefixo do buffer que termina numa fronteira de página do arquivo
+static size_t prefixoAlinhado(const BufferAnexo &b)
+{
+    const size_t fim = (b.tamanhoArquivo + b.usados) / tamanhoPagina * tamanhoPagina;
+    return fim > b.tamanhoArquivo ? fim - b.tamanhoArquivo : 0;
+}
+
+static BufferAnexo &obterBuffer(const char *caminho)
+{
+    BufferAnexo *b = buscarBuffer(caminho);
+    if (b) return *b;
+
+    // slot livre ou o que está há mais tempo com dados
+    BufferAnexo *alvo = &buffers[0];
+    for (BufferAnexo &c : buffers)
+    {
+        if (!c.caminho[0] || !c.usados) { alvo = &c; break; }
+        if (c.desdeMs < alvo->desdeMs) alvo = &c;
+    }
+    if (alvo->caminho[0]) gravarBuffer(*alvo, alvo->usados);
+
+    strlcpy(alvo->caminho, caminho, sizeof(alvo->caminho));
+    File f = LittleFS.open(caminho, "r");
+    alvo->tamanhoArquivo = f ? f.size() : 0;
+    if (f) f.close();
+    alvo->usados = 0;
+    return *alvo;
+}
+
+bool armazenamentoAnexar(const char *caminho, const uint8_t *dados, size_t tamanho)
+{
+    BufferAnexo &b = obterBuffer(caminho);
+    if (!b.usados) b.desdeMs = millis();
+
+    if (b.usados + tamanho > sizeof(b.dados))
+    {
+        // libera espaço gravando só páginas completas; se não bastar, tudo
+        gravarBuffer(b, prefixoAlinhado(b));
+        if (b.usados + tamanho > sizeof(b.dados) && !gravarBuffer(b, b.usados)) return false;
+    }
+
+    if (tamanho > sizeof(b.dados))
+    {
+        File f = LittleFS.open(caminho, "a");
+        if (!f) return false;
+        metricasArquivoAberto();
+        const size_t escritos = f.write(dados, tamanho);
+        f.close();
+        armazenamentoContabilizar(caminho, b.tamanhoArquivo, escritos);
+        b.tamanhoArquivo += escritos;
+        return escritos == tamanho;
+    }
+
+    memcpy(b.dados + b.usados, dados, tamanho);
+    b.usados += tamanho;
+    return true;
+}
+
+size_t armazenamentoTamanho(const char *caminho)
+{
+    BufferAnexo *b = buscarBuffer(caminho);
+    if (b) return b->tamanhoArquivo + b->usados;
+
+    File f = LittleFS.open(caminho, "r");
+    const size_t tamanho = f ? f.size() : 0;
+    if (f) f.close();
+    return tamanho;
+}
+
+const uint8_t *armazenamentoPendente(const char *caminho, size_t &tamanho)
+{
+    BufferAnexo *b = buscarBuffer(caminho);
+    tamanho = b ? b->usados : 0;
+    return b ? b->dados : nullptr;
+}
+
+void armazenamentoDescarregar(const char *caminho)
+{
+    BufferAnexo *b = buscarBuffer(caminho);
+    if (b) gravarBuffer(*b, b->usados);
+}
+
+void armazenamentoDescarregarTudo()
+{
+    for (BufferAnexo &b : buffers)
+    {
+        if (b.caminho[0]) gravarBuffer(b, b.usados);
+    }
+    persistirEstatisticas();
+}
+
+bool armazenamentoRemover(const char *caminho)
+{
+    BufferAnexo *b = buscarBuffer(caminho);
+    if (b) b->caminho[0] = '\0';
+    return LittleFS.remove(caminho);
+}
+
+// ================== Regravação atômica ==================
+File armazenamentoIniciarGravacao(const char *caminho)
+{
+    armazenamentoDescarregar(caminho); // o conteúdo novo parte do arquivo completo
+    char tmp[40];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", caminho);
+    File f = LittleFS.open(tmp, "w");
+    if (f) metricasArquivoAberto();
+    return f;
+}
+
+bool armazenamentoConcluirGravacao(const char *caminho, File &arquivo, bool ok)
+{
+    char tmp[40];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", caminho);
+    if (!arquivo) return false;
+
+    const size_t tamanho = arquivo.size();
+    arquivo.close();
+    armazenamentoContabilizar(caminho, 0, tamanho);
+
+    if (!ok)
+    {
+        LittleFS.remove(tmp);
+        return false;
+    }
+    // o rename do LittleFS troca o destino de uma vez: sem remove antes,
+    // uma falha aqui deixa o arquivo anterior inteiro
+    if (!LittleFS.rename(tmp, caminho)) return false;
+
+    BufferAnexo *b = buscarBuffer(caminho);
+    if (b) b->tamanhoArquivo = tamanho;
+    return true;
+}
+
+bool armazenamentoGravar(const char *caminho, const uint8_t *dados, size_t tamanho)
+{
+    File f = armazenamentoIniciarGravacao(caminho);
+    const bool ok = f && f.write(dados, tamanho) == tamanho;
+    return armazenamentoConcluirGravacao(caminho, f, ok);
+}
+
+bool armazenamentoGravarJson(const char *caminho, JsonVariantConst valor)
+{
+    File f = armazenamentoIniciarGravacao(caminho);
+    const bool ok = f && serializeJson(valor, f) == measureJson(valor);
+    return armazenamentoConcluirGravacao(caminho, f, ok);
+}
+
+// ================== Ciclo ==================
+void armazenamentoSetup()
+{
+    FSInfo info;
+    if (LittleFS.info(info) && info.blockSize)
+    {
+        tamanhoBloco = info.blockSize;
+        tamanhoPagina = info.pageSize ? info.pageSize : tamanhoPagina;
+        totalBlocos = info.totalBytes / info.blockSize;
+    }
+
+    File f = LittleFS.open(ARMAZ_ESTATISTICAS_PATH, "r");
+    if (f)
+    {
+        StaticJsonDocument<64> doc;
+        if (!deserializeJson(doc, f)) apagamentosAnteriores = doc["apagamentos"] | 0.0f;
+        f.close();
+    }
+    ultimaPersistenciaMs = millis();
+}
+
+void armazenamentoLoop()
+{
+    const uint32_t agora = millis();
+    for (BufferAnexo &b : buffers)
+    {
+        if (b.usados && agora - b.desdeMs >= ARMAZ_PRAZO_MS) gravarBuffer(b, b.usados);
+    }
+    if (agora - ultimaPersistenciaMs >= ARMAZ_PERSISTIR_MS) persistirEstatisticas();
+}
+
+void armazenamentoEscreverPrometheus(Print &out)
+{
+    out.println("# TYPE alarme_flash_arquivo_bytes_total counter");
+    for (const EstatisticaArquivo &e : estatisticas)
+    {
+        if (e.caminho[0]) out.printf("alarme_flash_arquivo_bytes_total{arquivo=\"%s\"} %u\n", e.caminho, e.bytes);
+    }
+    out.println("# TYPE alarme_flash_arquivo_commits_total counter");
+    for (const EstatisticaArquivo &e : estatisticas)
+    {
+        if (e.caminho[0]) out.printf("alarme_flash_arquivo_commits_total{arquivo=\"%s\"} %u\n", e.caminho, e.commits);
+    }
+    out.println("# TYPE alarme_flash_arquivo_apagamentos_estimados gauge");
+    for (const EstatisticaArquivo &e : estatisticas)
+    {
+        if (e.caminho[0]) out.printf("alarme_flash_arquivo_apagamentos_estimados{arquivo=\"%s\"} %.2f\n", e.caminho, apagamentosEstimados(e));
+    }
+
+    // Orçamento: com o wear leveling do LittleFS os apagamentos se espalham
+    // por todos os blocos, cada um com ARMAZ_CICLOS_BLOCO ciclos.
+    const float sessao = apagamentosSessao();
+    const float total = apagamentosAnteriores + sessao;
+    const float orcamento = (float)totalBlocos * ARMAZ_CICLOS_BLOCO;
+    out.printf("# TYPE alarme_flash_apagamentos_estimados_total counter\nalarme_flash_apagamentos_estimados_total %.1f\n", total);
+    if (orcamento > 0)
+    {
+        out.printf("# TYPE alarme_flash_desgaste_ratio gauge\nalarme_flash_desgaste_ratio %.6f\n", total / orcamento);
+
+        const float segundos = millis() / 1000.0f;
+        if (sessao > 0 && segundos > 0)
+        {
+            const float anos = (orcamento - total) / (sessao / segundos) / (365.0f * 86400.0f);
+            out.printf("# TYPE alarme_flash_vida_util_anos gauge\nalarme_flash_vida_util_anos %.1f\n", anos);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef ARMAZENAMENTO_H
+#define ARMAZENAMENTO_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ArduinoJson.h>
+
+// Camada única de escrita no LittleFS.
+//
+// - Anexos (histórico, outbox MQTT) ficam num buffer em RAM por arquivo e
+//   vão para a flash em lotes alinhados à página do LittleFS: quando o
+//   buffer enche, no prazo ARMAZ_PRAZO_MS ou em armazenamentoDescarregar().
+// - Regravações inteiras passam por <arquivo>.tmp + rename.
+// - Cada escrita é contabilizada por arquivo (bytes, commits, blocos) para
+//   estimar apagamentos e o orçamento de desgaste exposto em /metrics.
+
+void armazenamentoSetup();
+void armazenamentoLoop();
+
+// Anexa ao fim do arquivo (coalescido). false se não couber nem em disco.
+bool armazenamentoAnexar(const char *caminho, const uint8_t *dados, size_t tamanho);
+// Tamanho do arquivo contando o que ainda está no buffer
+size_t armazenamentoTamanho(const char *caminho);
+// Bytes anexados que ainda não foram para a flash (leitores somam ao arquivo)
+const uint8_t *armazenamentoPendente(const char *caminho, size_t &tamanho);
+void armazenamentoDescarregar(const char *caminho);
+// Antes de reiniciar: esvazia os buffers e grava as estatísticas
+void armazenamentoDescarregarTudo();
+bool armazenamentoRemover(const char *caminho);
+
+// Regravação atômica. IniciarGravacao abre <caminho>.tmp; Concluir fecha,
+// contabiliza e troca pelo arquivo em uso (ou descarta se ok == false).
+File armazenamentoIniciarGravacao(const char *caminho);
+bool armazenamentoConcluirGravacao(const char *caminho, File &tmp, bool ok = true);
+bool armazenamentoGravar(const char *caminho, const uint8_t *dados, size_t tamanho);
+bool armazenamentoGravarJson(const char *caminho, JsonVariantConst valor);
+
+// Para quem grava o arquivo por conta própria (cópia da imagem de OTA...)
+void armazenamentoContabilizar(const char *caminho, uint32_t offset, size_t tamanho);
+
+void armazenamentoEscreverPrometheus(Print &out);
+
+#endif
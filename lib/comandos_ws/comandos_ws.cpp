@@ -0,0 +1,248 @@
+#include "comandos_ws.h"
+#include <WebSocketsServer.h>
+#include <ArduinoJson.h>
+#include "system_config.h"
+#include "alarme.h"
+#include "event_logger.h"
+#include "web_server.h"
+#include "limitador.h"
+
+static WebSocketsServer ws(WS_PORTA);
+static Alarme *alarmePtr = nullptr;
+
+// Sessão por conexão: usuário autenticado (vazio = não autenticado)
+static char usuarios[WEBSOCKETS_SERVER_CLIENT_MAX][24];
+
+// Resultado de um comando já executado, para responder reenvios
+struct ComandoExecutado
+{
+    char id[WS_MAX_ID];
+    char usuario[24];
+    uint32_t versao;
+    const char *erro; // nullptr = ok; sempre literal
+};
+static ComandoExecutado cache[WS_CACHE_COMANDOS];
+static uint8_t proximoCache = 0;
+
+// Versão do estado: muda sempre que a impressão digital do estado muda
+static uint32_t versao = 0;
+static uint32_t digitalAnterior = 0;
+
+static uint32_t digitalEstado()
+{
+    // FNV-1a sobre estado, modo e zonas ativas
+    uint32_t h = 2166136261u;
+    auto mistura = [&h](uint8_t b) { h = (h ^ b) * 16777619u; };
+    mistura((uint8_t)alarmePtr->getEstado());
+    mistura((uint8_t)alarmePtr->getModo());
+    for (const String &z : alarmePtr->getZonasAtivas())
+    {
+        for (const char *c = z.c_str(); *c; c++) mistura(*c);
+        mistura(',');
+    }
+    return h;
+}
+
+// Atualiza a versão; true se o estado mudou desde a última chamada
+static bool atualizarVersao()
+{
+    const uint32_t d = digitalEstado();
+    if (d == digitalAnterior) return false;
+    digitalAnterior = d;
+    versao++;
+    return true;
+}
+
+static void escreverEstado(JsonDocument &doc)
+{
+    doc["versao"] = versao;
+    doc["estado"] = alarmePtr->getEstado() == Alarme::Estado::ARMADO ? "ARMADO" : "DESARMADO";
+    doc["modo"] = alarmePtr->getModo() == Alarme::Modo::MANUAL ? "MANUAL" : "AUTOMATICO";
+    JsonArray zonas = doc.createNestedArray("zonas_ativas");
+    for (const String &z : alarmePtr->getZonasAtivas()) zonas.add(z);
+}
+
+static void enviar(uint8_t num, JsonDocument &doc)
+{
+    String out;
+    serializeJson(doc, out);
+    ws.sendTXT(num, out);
+}
+
+static void anunciarEstado()
+{
+    StaticJsonDocument<768> doc;
+    doc["evento"] = "estado";
+    escreverEstado(doc);
+    String out;
+    serializeJson(doc, out);
+    ws.broadcastTXT(out);
+}
+
+static void responder(uint8_t num, const char *id, const char *erro, uint32_t versaoResultado, bool repetido)
+{
+    StaticJsonDocument<768> doc;
+    doc["id"] = id;
+    doc["ok"] = erro == nullptr;
+    if (erro) doc["erro"] = erro;
+    escreverEstado(doc);
+    doc["versao"] = versaoResultado; // versão que o comando produziu (a atual vai em broadcast)
+    if (repetido) doc["repetido"] = true;
+    enviar(num, doc);
+}
+
+static ComandoExecutado *buscarCache(const char *usuario, const char *id)
+{
+    for (ComandoExecutado &c : cache)
+        if (c.id[0] && strcmp(c.id, id) == 0 && strcmp(c.usuario, usuario) == 0) return &c;
+    return nullptr;
+}
+
+static void lembrar(const char *usuario, const char *id, const char *erro)
+{
+    ComandoExecutado &c = cache[proximoCache];
+    proximoCache = (proximoCache + 1) % WS_CACHE_COMANDOS;
+    strlcpy(c.id, id, sizeof(c.id));
+    strlcpy(c.usuario, usuario, sizeof(c.usuario));
+    c.versao = versao;
+    c.erro = erro;
+}
+
+static void autenticar(uint8_t num, const char *id, JsonDocument &req)
+{
+    const IPAddress ip = ws.remoteIP(num);
+    if (limitadorLoginBloqueado(ip))
+    {
+        responder(num, id, "Muitas tentativas. Aguarde.", versao, false);
+        return;
+    }
+
+    const char *usuario = req["usuario"] | "";
+    if (!credenciais_validas(usuario, req["senha"] | ""))
+    {
+        limitadorFalhaLogin(ip);
+        responder(num, id, "Credenciais inválidas", versao, false);
+        return;
+    }
+
+    limitadorSucessoLogin(ip);
+    strlcpy(usuarios[num], usuario, sizeof(usuarios[num]));
+    responder(num, id, nullptr, versao, false);
+}
+
+// Executa o comando; devolve a mensagem de erro ou nullptr
+static const char *executar(const char *cmd, JsonDocument &req, const char *usuario)
+{
+    if (strcmp(cmd, "armar") == 0)
+    {
+        JsonArrayConst lista = req["zonas"];
+        if (lista.isNull() || lista.size() == 0) return "Zonas não especificadas";
+        std::vector<String> zonas;
+        for (const char *z : lista) zonas.push_back(z);
+        alarmePtr->armar(zonas);
+        registrarEventoF("Alarme armado por: %s", usuario);
+        return nullptr;
+    }
+    if (strcmp(cmd, "desarmar") == 0)
+    {
+        alarmePtr->desarmar();
+        registrarEventoF("Alarme desarmado por: %s", usuario);
+        return nullptr;
+    }
+    if (strcmp(cmd, "modo") == 0)
+    {
+        if (!req["manual"].is<bool>()) return "Modo não especificado";
+        const bool manual = req["manual"];
+        alarmePtr->setModo(manual ? Alarme::Modo::MANUAL : Alarme::Modo::AUTOMATICO);
+        registrarEventoF("[MODO] Modo alterado para %s por %s", manual ? "MANUAL" : "AUTOMATICO", usuario);
+        return nullptr;
+    }
+    return "Comando desconhecido";
+}
+
+static void tratarMensagem(uint8_t num, uint8_t *payload, size_t tamanho)
+{
+    StaticJsonDocument<512> req;
+    if (deserializeJson(req, payload, tamanho))
+    {
+        responder(num, "", "JSON inválido", versao, false);
+        return;
+    }
+
+    const char *id = req["id"] | "";
+    const char *cmd = req["cmd"] | "";
+    if (!id[0] || strlen(id) >= WS_MAX_ID)
+    {
+        responder(num, id, "id ausente ou longo demais", versao, false);
+        return;
+    }
+
+    if (strcmp(cmd, "auth") == 0)
+    {
+        autenticar(num, id, req);
+        return;
+    }
+
+    const char *usuario = usuarios[num];
+    if (!usuario[0])
+    {
+        responder(num, id, "Não autenticado", versao, false);
+        return;
+    }
+
+    if (strcmp(cmd, "estado") == 0)
+    {
+        responder(num, id, nullptr, versao, false);
+        return;
+    }
+
+    if (const ComandoExecutado *c = buscarCache(usuario, id))
+    {
+        responder(num, id, c->erro, c->versao, true);
+        return;
+    }
+
+    const char *erro = executar(cmd, req, usuario);
+    const bool mudou = atualizarVersao();
+    lembrar(usuario, id, erro);
+    responder(num, id, erro, versao, false);
+
+    if (mudou) anunciarEstado();
+}
+
+static void aoEvento(uint8_t num, WStype_t tipo, uint8_t *payload, size_t tamanho)
+{
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    switch (tipo)
+    {
+    case WStype_CONNECTED:
+    case WStype_DISCONNECTED:
+        usuarios[num][0] = '\0';
+        break;
+    case WStype_TEXT:
+        tratarMensagem(num, payload, tamanho);
+        break;
+    default:
+        break;
+    }
+}
+
+void comandosWsSetup(Alarme *alarme)
+{
+    alarmePtr = alarme;
+    digitalAnterior = digitalEstado();
+    versao = 1;
+
+    ws.begin();
+    ws.onEvent(aoEvento);
+    ws.enableHeartbeat(15000, 3000, 2); // derruba conexões mortas (celular que saiu do WiFi)
+    Serial.printf("[WS] Comandos na porta %d\n", WS_PORTA);
+}
+
+void comandosWsLoop()
+{
+    ws.loop();
+
+    // mudanças vindas da agenda, HTTP, P2P...
+    if (atualizarVersao()) anunciarEstado();
+}
@@ -0,0 +1,30 @@
+#ifndef COMANDOS_WS_H
+#define COMANDOS_WS_H
+
+#include <Arduino.h>
+
+class Alarme;
+
+// Canal de comandos por WebSocket (porta WS_PORTA), frames de texto JSON.
+//
+// Autenticação uma vez por conexão (mesmos usuários de /verifica_login):
+//   -> {"id":"a1","cmd":"auth","usuario":"..","senha":".."}
+// Comandos:
+//   -> {"id":"a2","cmd":"armar","zonas":["Externa","Garagem"]}
+//   -> {"id":"a3","cmd":"desarmar"}
+//   -> {"id":"a4","cmd":"modo","manual":true}
+//   -> {"id":"a5","cmd":"estado"}
+// Resposta imediata, já com o estado resultante:
+//   <- {"id":"a2","ok":true,"versao":17,"estado":"ARMADO","modo":"MANUAL","zonas_ativas":[..]}
+//   <- {"id":"a2","ok":false,"erro":"..."}
+// Mudança de estado por qualquer origem (agenda, HTTP, P2P) é enviada a todos:
+//   <- {"evento":"estado","versao":18,...}
+//
+// "versao" cresce a cada mudança de estado/modo/zonas ativas. Um id repetido
+// pelo mesmo usuário (reenvio depois de queda de WiFi, mesmo em outra conexão)
+// não executa nem registra de novo: devolve o resultado guardado com
+// "repetido":true. Falhas de senha contam no bloqueio por IP do limitador.
+void comandosWsSetup(Alarme *alarme);
+void comandosWsLoop();
+
+#endif
@@ -0,0 +1,259 @@
+#include "config_bundle.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+#include "system_config.h"
+#include "delta_patch.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "armazenamento.h"
+
+extern int ultimoDiaReinicio;
+
+struct ArquivoSecao
+{
+    SecaoBundle secao;
+    const char *chave;
+    const char *caminho;
+    const char *vazio; // conteúdo quando o arquivo não existe
+};
+
+static const ArquivoSecao SECOES[] = {
+    {BUNDLE_SECAO_SENSORES, "sensores", "/sensores.json", "[]"},
+    {BUNDLE_SECAO_USUARIOS, "usuarios", USUARIOS_PATH, "[]"},
+    {BUNDLE_SECAO_HORARIOS, "horarios", "/horarios.json", "{}"},
+};
+
+static String caminhoTmp(const ArquivoSecao &s)
+{
+    return String(s.caminho) + BUNDLE_SUFIXO_TMP;
+}
+
+static bool falhar(ResultadoBundle &r, int codigo, const char *msg)
+{
+    r.codigoHttp = codigo;
+    strlcpy(r.mensagem, msg, sizeof(r.mensagem));
+    return false;
+}
+
+static void removerTemporarios()
+{
+    for (const ArquivoSecao &s : SECOES) LittleFS.remove(caminhoTmp(s));
+}
+
+static bool gravarJson(const char *caminho, JsonVariantConst valor)
+{
+    File f = LittleFS.open(caminho, "w");
+    if (!f) return false;
+    metricasArquivoAberto();
+    const size_t esperado = measureJson(valor);
+    const size_t escritos = serializeJson(valor, f);
+    f.close();
+    armazenamentoContabilizar(caminho, 0, escritos);
+    return escritos == esperado;
+}
+
+static void lerVersaoInstalada(uint32_t &versao, uint32_t &crc)
+{
+    versao = 0;
+    crc = 0;
+    File f = LittleFS.open(BUNDLE_VERSAO_PATH, "r");
+    if (!f) return;
+    StaticJsonDocument<96> doc;
+    if (!deserializeJson(doc, f))
+    {
+        versao = doc["versao"] | 0;
+        crc = doc["crc32"] | 0;
+    }
+    f.close();
+}
+
+static bool validarUsuarios(JsonArrayConst usuarios)
+{
+    for (JsonObjectConst u : usuarios)
+    {
+        const char *nome = u["usuario"] | "";
+        const char *senha = u["senha"] | "";
+        if (!nome[0] || !senha[0]) return false;
+    }
+    return true;
+}
+
+static bool validarHorarios(JsonObject horarios)
+{
+    static const char *HORAS[] = {"ARM_HOUR_WEEKDAY", "DISARM_HOUR_WEEKDAY", "ARM_HOUR_WEEKEND",
+                                  "DISARM_HOUR_WEEKEND", "horaRestart"};
+    for (const char *campo : HORAS)
+    {
+        JsonVariant v = horarios[campo];
+        if (v.isNull()) continue;
+        if (!v.is<int>() || v.as<int>() < 0 || v.as<int>() > 23) return false;
+    }
+    if (!horarios["restartConfig"].isNull() && !horarios["restartConfig"].is<bool>()) return false;
+
+    // estado local da placa, não vem da frota
+    horarios["ultimoDiaReinicio"] = ultimoDiaReinicio;
+    return true;
+}
+
+// Troca os arquivos em uso pelos temporários listados no journal
+static void concluirCommit(uint8_t secoes, uint32_t versao, uint32_t crc)
+{
+    for (const ArquivoSecao &s : SECOES)
+    {
+        if (!(secoes & s.secao)) continue;
+        const String tmp = caminhoTmp(s);
+        if (!LittleFS.exists(tmp)) continue; // já trocado antes de um reinício
+        LittleFS.remove(s.caminho);
+        LittleFS.rename(tmp, s.caminho);
+    }
+
+    StaticJsonDocument<96> doc;
+    doc["versao"] = versao;
+    doc["crc32"] = crc;
+    gravarJson(BUNDLE_VERSAO_PATH, doc.as<JsonVariantConst>());
+    LittleFS.remove(BUNDLE_JOURNAL_PATH);
+}
+
+bool configBundleAplicar(String &corpo, const String &crcHex, bool forcar, ResultadoBundle &r)
+{
+    if (corpo.length() == 0 || corpo.length() > BUNDLE_MAX_BYTES)
+        return falhar(r, 413, "bundle vazio ou grande demais");
+
+    // 1) Integridade antes de qualquer parse
+    const uint32_t crc = deltaCrc32(0, (const uint8_t *)corpo.c_str(), corpo.length());
+    if (crcHex.length() == 0 || strtoul(crcHex.c_str(), nullptr, 16) != crc)
+        return falhar(r, 400, "CRC-32 ausente ou não confere");
+
+    // 2) Versão
+    uint32_t versaoAtual, crcAtual;
+    lerVersaoInstalada(versaoAtual, crcAtual);
+
+    // zero-copy: as strings ficam no próprio corpo, o documento guarda só os nós
+    DynamicJsonDocument doc(corpo.length() * 3 / 2 + 512);
+    const DeserializationError err = deserializeJson(doc, corpo.begin());
+    if (err == DeserializationError::NoMemory) return falhar(r, 413, "bundle complexo demais para a RAM");
+    if (err || !doc.is<JsonObject>()) return falhar(r, 400, "JSON inválido");
+    if ((doc["formato"] | 0) != BUNDLE_FORMATO)
+        return falhar(r, 400, "formato de bundle não suportado");
+
+    r.versao = doc["versao"] | 0;
+    if (r.versao == 0) return falhar(r, 400, "versao ausente");
+    if (r.versao == versaoAtual && crc == crcAtual)
+    {
+        strlcpy(r.mensagem, "bundle já aplicado", sizeof(r.mensagem));
+        return true;
+    }
+    if (r.versao <= versaoAtual && !forcar)
+    {
+        snprintf(r.mensagem, sizeof(r.mensagem), "versão %u não é mais nova que a instalada (%u)", r.versao, versaoAtual);
+        r.codigoHttp = 409;
+        return false;
+    }
+
+    // 3) Validação das seções que não precisam de arquivo
+    if (!doc["usuarios"].isNull() && (!doc["usuarios"].is<JsonArray>() || !validarUsuarios(doc["usuarios"])))
+        return falhar(r, 400, "usuarios: esperado [{\"usuario\",\"senha\"}]");
+    if (!doc["horarios"].isNull() && (!doc["horarios"].is<JsonObject>() || !validarHorarios(doc["horarios"])))
+        return falhar(r, 400, "horarios: horas devem ser inteiros de 0 a 23");
+    if (!doc["sensores"].isNull() && !doc["sensores"].is<JsonArray>())
+        return falhar(r, 400, "sensores: esperado um array");
+
+    // 4) Grava os temporários; sensores são validados lendo o próprio temporário
+    for (const ArquivoSecao &s : SECOES)
+    {
+        if (doc[s.chave].isNull()) continue;
+        if (!gravarJson(caminhoTmp(s).c_str(), doc[s.chave]))
+        {
+            removerTemporarios();
+            return falhar(r, 500, "erro ao gravar (flash cheia?)");
+        }
+        r.secoes |= s.secao;
+    }
+
+    if (r.secoes & BUNDLE_SECAO_SENSORES)
+    {
+        File f = LittleFS.open(String("/sensores.json") + BUNDLE_SUFIXO_TMP, "r");
+        const bool ok = f && lerConfigSensores(f, nullptr, r.sensores);
+        if (f) f.close();
+        if (!ok)
+        {
+            removerTemporarios();
+            return falhar(r, 400, "sensores inválidos");
+        }
+    }
+    if (!r.secoes) return falhar(r, 400, "bundle sem seções");
+
+    // 5) Commit: o journal permite terminar a troca se a placa reiniciar no meio
+    StaticJsonDocument<96> jnl;
+    jnl["secoes"] = r.secoes;
+    jnl["versao"] = r.versao;
+    jnl["crc32"] = crc;
+    if (!gravarJson(BUNDLE_JOURNAL_PATH, jnl.as<JsonVariantConst>()))
+    {
+        removerTemporarios();
+        return falhar(r, 500, "erro ao gravar o journal");
+    }
+    concluirCommit(r.secoes, r.versao, crc);
+
+    r.mudou = true;
+    snprintf(r.mensagem, sizeof(r.mensagem), "versão %u aplicada", r.versao);
+    registrarEventoF("[CONFIG] Bundle versão %u aplicado (seções 0x%02x)", r.versao, r.secoes);
+    return true;
+}
+
+void configBundleRecuperar()
+{
+    File f = LittleFS.open(BUNDLE_JOURNAL_PATH, "r");
+    if (!f)
+    {
+        removerTemporarios(); // gravação interrompida antes do commit
+        return;
+    }
+
+    StaticJsonDocument<96> jnl;
+    const bool ok = !deserializeJson(jnl, f);
+    f.close();
+    if (!ok)
+    {
+        LittleFS.remove(BUNDLE_JOURNAL_PATH);
+        removerTemporarios();
+        return;
+    }
+
+    Serial.println("[CONFIG] Concluindo bundle interrompido por reinício");
+    concluirCommit(jnl["secoes"] | 0, jnl["versao"] | 0, jnl["crc32"] | 0);
+}
+
+static void copiarArquivo(Print &saida, const ArquivoSecao &s)
+{
+    File f = LittleFS.open(s.caminho, "r");
+    if (!f || f.size() == 0)
+    {
+        saida.print(s.vazio);
+        if (f) f.close();
+        return;
+    }
+
+    uint8_t buf[128];
+    while (f.available())
+    {
+        const size_t n = f.read(buf, sizeof(buf));
+        saida.write(buf, n);
+    }
+    f.close();
+}
+
+void configBundleEscrever(Print &saida)
+{
+    uint32_t versao, crc;
+    lerVersaoInstalada(versao, crc);
+
+    saida.printf("{\"formato\":%d,\"versao\":%u,\"crc32\":\"%08x\"", BUNDLE_FORMATO, versao, crc);
+    for (const ArquivoSecao &s : SECOES)
+    {
+        saida.printf(",\"%s\":", s.chave);
+        copiarArquivo(saida, s);
+    }
+    saida.print('}');
+}
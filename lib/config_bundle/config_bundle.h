@@ -0,0 +1,44 @@
+#ifndef CONFIG_BUNDLE_H
+#define CONFIG_BUNDLE_H
+
+#include <Arduino.h>
+#include "config_sensores.h"
+
+// Bundle de configuração da frota (tools/frota): sensores, usuários e
+// horários num único JSON versionado, aplicado como uma transação.
+//
+//   {"formato":1, "versao":N, "sensores":[...], "usuarios":[...], "horarios":{...}}
+//
+// Seções ausentes ficam como estão. O CRC-32 do corpo vem no cabeçalho
+// X-Bundle-CRC32 (hex). Uma versão menor ou igual à instalada é recusada
+// (409), salvo ?forcar=1; reenviar o mesmo bundle não muda nada.
+#define BUNDLE_FORMATO 1
+
+struct ResultadoBundle
+{
+    int codigoHttp = 200;
+    char mensagem[80] = "";
+    bool mudou = false;
+    uint32_t versao = 0;
+    uint8_t secoes = 0;        // BUNDLE_SECAO_* aplicadas
+    ResultadoValidacao sensores;
+};
+
+enum SecaoBundle : uint8_t
+{
+    BUNDLE_SECAO_SENSORES = 1,
+    BUNDLE_SECAO_USUARIOS = 2,
+    BUNDLE_SECAO_HORARIOS = 4
+};
+
+// Valida tudo, grava arquivos temporários e só então troca os arquivos
+// em uso (com journal). O corpo é usado como buffer do parse (zero-copy).
+bool configBundleAplicar(String &corpo, const String &crcHex, bool forcar, ResultadoBundle &resultado);
+
+// Bundle atual (mesmo formato do POST), sem montar o JSON inteiro em RAM
+void configBundleEscrever(Print &saida);
+
+// No boot: termina um commit interrompido ou descarta temporários órfãos
+void configBundleRecuperar();
+
+#endif
@@ -0,0 +1,54 @@
+#include "boot_profiler.h"
+#include <ArduinoJson.h>
+
+// Tabela fixa: sem alocação durante o boot
+static const uint8_t BOOT_MAX_FASES = 16;
+
+struct FaseBoot
+{
+    const char *nome;
+    uint32_t us;
+};
+
+static FaseBoot fases[BOOT_MAX_FASES];
+static uint8_t totalFases = 0;
+
+void bootMarcarFase(const char *fase)
+{
+    if (totalFases >= BOOT_MAX_FASES) return;
+    fases[totalFases].nome = fase;
+    fases[totalFases].us = micros();
+    totalFases++;
+}
+
+void bootMarcarFaseUmaVez(const char *fase)
+{
+    for (uint8_t i = 0; i < totalFases; i++)
+    {
+        if (strcmp(fases[i].nome, fase) == 0) return;
+    }
+    bootMarcarFase(fase);
+}
+
+String bootProfilerJson()
+{
+    StaticJsonDocument<1024> doc;
+
+    doc["motivo_reset"] = ESP.getResetReason();
+    doc["total_fases"] = totalFases;
+
+    JsonArray arr = doc.createNestedArray("fases");
+    uint32_t anterior = 0;
+    for (uint8_t i = 0; i < totalFases; i++)
+    {
+        JsonObject f = arr.createNestedObject();
+        f["fase"] = fases[i].nome;
+        f["us"] = fases[i].us;
+        f["duracao_us"] = fases[i].us - anterior;
+        anterior = fases[i].us;
+    }
+
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
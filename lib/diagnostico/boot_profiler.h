@@ -0,0 +1,16 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <Arduino.h>
+
+// Registra o instante (µs desde o power-on) em que cada fase do boot terminou.
+// "fase" deve ser um literal (o ponteiro é guardado, não copiado).
+void bootMarcarFase(const char *fase);
+
+// Marca a fase apenas na primeira vez (ex.: primeira conexão WiFi)
+void bootMarcarFaseUmaVez(const char *fase);
+
+// JSON servido em /diag/boot.json
+String bootProfilerJson();
+
+#endif
@@ -0,0 +1,209 @@
+#include "energia.h"
+#include <ESP8266WiFi.h>
+#include <ArduinoJson.h>
+#include <coredecls.h>
+
+#include "system_config.h"
+#include "entradas.h"
+
+// Latência borda -> tick, por modo
+struct LatenciaDeteccao
+{
+    uint32_t contagem;
+    uint32_t ultimaUs;
+    uint32_t maxUs;
+    uint64_t somaUs;
+
+    void registrar(uint32_t us)
+    {
+        contagem++;
+        ultimaUs = us;
+        somaUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+};
+
+static bool economia = false;
+static uint32_t ultimoTickMs = 0;
+static uint32_t ultimaAtividadeMs = 0;
+static uint32_t pinosSensores = 0; // máscara entradasBit()
+
+// borda vista pela interrupção e ainda não atendida por um tick
+static volatile bool bordaPendente = false;
+static volatile uint32_t bordaUs = 0;
+static volatile bool pausando = false;
+
+// a mesma borda por pino (teste de caminhada): a interrupção compara o GPI
+// com o da anterior; só a primeira borda de cada pino até o tick conta
+static volatile uint32_t bordasPinos = 0;
+static volatile uint32_t bordaPinoUs[16];
+static volatile uint32_t nivelAnterior = 0;
+
+// bordas tiradas da interrupção no início do tick (energiaTickDevido): as
+// que chegarem depois ficam pendentes para o tick seguinte
+static bool bordaTick = false;
+static uint32_t bordaTickUs = 0;
+static uint32_t bordasTick = 0;
+static uint32_t bordaPinoTickUs[16];
+
+static LatenciaDeteccao latencias[2]; // [0] vigilância, [1] economia
+static uint32_t pausas = 0;
+static uint32_t pausasInterrompidas = 0;
+static uint64_t pausaMsTotal = 0;
+static uint64_t totalMs = 0;
+static uint32_t ultimaContagemMs = 0;
+
+static void IRAM_ATTR aoMudarSensor()
+{
+    const uint32_t agora = micros();
+    if (!bordaPendente)
+    {
+        bordaUs = agora;
+        bordaPendente = true;
+    }
+
+    // pino que voltou ao nível antes da interrupção não aparece aqui: fica
+    // sem borda e o teste usa o tick
+    const uint32_t nivel = GPI & pinosSensores;
+    const uint32_t mudaram = (nivel ^ nivelAnterior) & pinosSensores & ~bordasPinos;
+    nivelAnterior = nivel;
+    for (uint32_t m = mudaram; m; m &= m - 1) bordaPinoUs[__builtin_ctz(m)] = agora;
+    bordasPinos |= mudaram;
+    if (pausando) esp_schedule(); // acorda o esp_delay da pausa
+}
+
+void energiaDefinirSensores(Faixa<Zona> zonas)
+{
+    uint32_t novos = 0;
+    for (const Zona &zona : zonas)
+        for (const Sensor &sensor : zona.getSensores())
+            novos |= entradasBit(sensor.getPino());
+    novos &= 0xFFFF; // GPIO16 não tem interrupção
+
+    for (uint8_t pino = 0; pino < 16; pino++)
+    {
+        const uint32_t bit = 1UL << pino;
+        if ((pinosSensores & bit) && !(novos & bit)) detachInterrupt(pino);
+        else if (!(pinosSensores & bit) && (novos & bit)) attachInterrupt(pino, aoMudarSensor, CHANGE);
+    }
+    pinosSensores = novos;
+    nivelAnterior = GPI & novos;
+    bordasPinos = 0;
+}
+
+bool energiaTickDevido()
+{
+    const uint32_t agora = millis();
+    const uint32_t intervalo = economia ? ENERGIA_TICK_LENTO_MS : ENERGIA_TICK_RAPIDO_MS;
+    if (agora - ultimoTickMs < intervalo && !bordaPendente) return false;
+    ultimoTickMs = agora;
+
+    noInterrupts();
+    bordaTick = bordaPendente;
+    bordaTickUs = bordaUs;
+    bordasTick = bordasPinos;
+    for (uint32_t m = bordasTick; m; m &= m - 1)
+    {
+        const int pino = __builtin_ctz(m);
+        bordaPinoTickUs[pino] = bordaPinoUs[pino];
+    }
+    bordaPendente = false;
+    bordasPinos = 0;
+    interrupts();
+    return true;
+}
+
+void energiaTickConcluido(bool vigilancia)
+{
+    if (bordaTick)
+    {
+        latencias[economia ? 1 : 0].registrar(micros() - bordaTickUs);
+        bordaTick = false;
+    }
+    bordasTick = 0;
+
+    if (vigilancia == !economia) return;
+    economia = !vigilancia;
+    // light sleep só com a CPU ociosa (pausas do loop); o modem sleep é o padrão do SDK
+    WiFi.setSleepMode(economia ? WIFI_LIGHT_SLEEP : WIFI_MODEM_SLEEP, ENERGIA_LISTEN_INTERVAL);
+    Serial.printf("[ENERGIA] Modo %s (tick %u ms)\n", economia ? "economia" : "vigilancia",
+                  economia ? ENERGIA_TICK_LENTO_MS : ENERGIA_TICK_RAPIDO_MS);
+}
+
+bool energiaBordaPendente(int pino, uint32_t &us)
+{
+    const uint32_t bit = entradasBit(pino) & 0xFFFF;
+    const bool pendente = bit && (bordasTick & bit);
+    us = pendente ? bordaPinoTickUs[pino] : 0;
+    return pendente;
+}
+
+void energiaAtividade()
+{
+    ultimaAtividadeMs = millis();
+}
+
+void energiaPausar(bool permitido)
+{
+    const uint32_t agora = millis();
+    totalMs += agora - ultimaContagemMs;
+    ultimaContagemMs = agora;
+
+    const uint32_t decorrido = agora - ultimoTickMs;
+    if (!economia || !permitido || agora - ultimaAtividadeMs < ENERGIA_ACORDADO_MS ||
+        decorrido + ENERGIA_PAUSA_MIN_MS >= ENERGIA_TICK_LENTO_MS)
+    {
+        yield();
+        return;
+    }
+
+    uint32_t pausa = ENERGIA_TICK_LENTO_MS - decorrido;
+    if (pausa > ENERGIA_PAUSA_MAX_MS) pausa = ENERGIA_PAUSA_MAX_MS;
+
+    // 'pausando' antes de olhar a borda: uma que chegue entre o teste e o
+    // esp_delay já agenda o despertar
+    pausando = true;
+    if (!bordaPendente) esp_delay(pausa, [] { return !bordaPendente; });
+    pausando = false;
+
+    const uint32_t depois = millis();
+    pausas++;
+    if (bordaPendente) pausasInterrompidas++;
+    pausaMsTotal += depois - agora;
+    totalMs += depois - agora;
+    ultimaContagemMs = depois;
+}
+
+static void escreverLatencia(JsonObject o, const LatenciaDeteccao &l)
+{
+    o["contagem"] = l.contagem;
+    o["ultima_us"] = l.ultimaUs;
+    o["media_us"] = l.contagem ? (uint32_t)(l.somaUs / l.contagem) : 0;
+    o["max_us"] = l.maxUs;
+}
+
+String energiaJson()
+{
+    StaticJsonDocument<512> doc;
+
+    doc["modo"] = economia ? "economia" : "vigilancia";
+    doc["tick_ms"] = economia ? ENERGIA_TICK_LENTO_MS : ENERGIA_TICK_RAPIDO_MS;
+    doc["sono_wifi"] = economia ? "light" : "modem";
+    doc["pausas"] = pausas;
+    doc["pausas_interrompidas"] = pausasInterrompidas; // por borda num sensor
+    doc["pausa_ms"] = pausaMsTotal;
+    doc["total_ms"] = totalMs;
+
+    // média ponderada pelo tempo em pausa; é estimativa, não medição
+    const float fracao = totalMs ? (float)pausaMsTotal / totalMs : 0;
+    doc["fracao_pausa"] = fracao;
+    doc["corrente_estimada_ma"] = ENERGIA_CORRENTE_ACORDADO_MA * (1 - fracao) + ENERGIA_CORRENTE_PAUSA_MA * fracao;
+
+    JsonObject lat = doc.createNestedObject("latencia_deteccao");
+    escreverLatencia(lat.createNestedObject("vigilancia"), latencias[0]);
+    escreverLatencia(lat.createNestedObject("economia"), latencias[1]);
+
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
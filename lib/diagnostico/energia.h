@@ -0,0 +1,42 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <Arduino.h>
+#include "faixa.h"
+#include "zona.h"
+
+// Ritmo do loop conforme o estado do alarme.
+//
+// Vigilância (armado ou sirene tocando): tick a cada ENERGIA_TICK_RAPIDO_MS,
+// WiFi em modem sleep (padrão do SDK) e o loop só faz yield().
+// Economia (desarmado, sirene parada): tick a cada ENERGIA_TICK_LENTO_MS,
+// WiFi em light sleep automático e o fim do loop pausa até o próximo tick
+// (no máximo ENERGIA_PAUSA_MAX_MS), tempo em que o SDK desliga a CPU entre
+// beacons. Uma borda num pino de sensor encerra a pausa e antecipa o tick.
+//
+// O light sleep forçado (único com despertar por nível de GPIO) derruba o
+// WiFi; aqui a borda é atendida no próximo despertar do SDK, e a latência
+// real borda -> tick fica medida em /diag/energia.json.
+
+// Pinos dos sensores que interrompem a pausa (após cada configurarSistema)
+void energiaDefinirSensores(Faixa<Zona> zonas);
+
+// Hora do tick: intervalo do modo vencido ou borda pendente num sensor.
+// Quando true, as bordas pendentes passam a ser deste tick
+bool energiaTickDevido();
+// Depois do tick: mede a latência da borda atendida e escolhe o modo
+void energiaTickConcluido(bool vigilancia);
+// Durante o tick: micros() da primeira borda do tick no pino, se houver
+// (GPIO16 não tem interrupção: sempre false)
+bool energiaBordaPendente(int pino, uint32_t &us);
+
+// Requisição HTTP chegou: fica sem pausas por ENERGIA_ACORDADO_MS
+void energiaAtividade();
+
+// Último passo do loop: yield() ou pausa (economia e 'permitido')
+void energiaPausar(bool permitido);
+
+// JSON servido em /diag/energia.json
+String energiaJson();
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef RASTRO_FORMATO_H
+#define RASTRO_FORMATO_H
+
+// Formato do rastro de GPIO (rastro_gpio.h). Sem dependência de Arduino:
+// a ferramenta de host (tools/replay_rastro) lê o mesmo formato.
+//
+// Inteiros em varint (7 bits por byte, o menos significativo primeiro).
+//
+// Segmento = cabeçalho + registros. O cabeçalho descreve o modelo e o
+// estado inteiro no início do segmento (inclusive no meio de um alerta ou
+// de um teste de caminhada):
+//   "RGPI" | versao u8
+//   seq | inicio_ms | leitura | flags (RASTRO_F_*)
+//   sirene_alto_ms | sirene_baixo_ms | sirene_ciclos
+//   com RASTRO_F_SIRENE: em_alto | ciclos | ms_desde_troca | alvo (índice do sensor + 1; 0 = remoto)
+//   total_zonas, e para cada zona (na ordem do PoolModelo):
+//     nome | total_sensores | flags (RASTRO_Z_*) | ignorada_ms
+//     e para cada sensor da zona:
+//       nome | pino | tipo (0 PIR, 1 REED) | flags (RASTRO_S_*) | tentativas
+//       [| ms_desde_alerta, com tentativas > 0]
+// Nomes: tamanho (varint, até RASTRO_MAX_NOME) + bytes, sem terminador.
+// "leitura" e os xor abaixo usam os bits de entradasLer(), só dos pinos de sensores.
+//
+// Registro: varint (delta_ms << 2 | tipo), delta desde o registro anterior
+// (o primeiro conta de inicio_ms), seguido de:
+//   RASTRO_TICK          nada: tick do alarme com a leitura atual
+//   RASTRO_LEITURA       xor dos pinos que mudaram (fora de um tick)
+//   RASTRO_TICK_LEITURA  xor dos pinos que mudaram, e então o tick
+//   RASTRO_OPERACAO      código u8 (RastroOp) + argumentos
+//
+// Download (/diag/rastro.bin): segmentos do mais antigo ao atual, cada um
+// precedido do seu tamanho (u32 little-endian).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RASTRO_MAGICA   "RGPI"
+#define RASTRO_VERSAO   1
+#define RASTRO_MAX_NOME 31
+#define RASTRO_VARINT_MAX 10
+
+enum RastroTipo : uint8_t
+{
+    RASTRO_TICK = 0,
+    RASTRO_LEITURA = 1,
+    RASTRO_TICK_LEITURA = 2,
+    RASTRO_OPERACAO = 3
+};
+
+enum RastroOp : uint8_t
+{
+    RASTRO_OP_ARMAR = 1,          // máscara das zonas armadas (índice = bit, até 64)
+    RASTRO_OP_DESARMAR = 2,
+    RASTRO_OP_TESTE_INICIAR = 3,
+    RASTRO_OP_TESTE_ENCERRAR = 4,
+    RASTRO_OP_SENSOR = 5,         // índice do sensor | flags RASTRO_S_* depois do ajuste
+    RASTRO_OP_BYPASS = 6,         // índice da zona | ms (0 = cancelado)
+    RASTRO_OP_SIRENE_REMOTA = 7,  // P2P: Sirene::ativar(nullptr)
+    RASTRO_OP_ALERTA = 8          // índice do sensor; do tick anterior (conferência)
+};
+
+// flags do cabeçalho
+#define RASTRO_F_ARMADO  0x01
+#define RASTRO_F_TESTE   0x02
+#define RASTRO_F_SIRENE  0x04
+#define RASTRO_F_ARMADO_ANTES_TESTE 0x08 // estado a que o teste volta
+// flags da zona
+#define RASTRO_Z_ARMADA  0x01
+#define RASTRO_Z_ARMADA_ANTES_TESTE 0x02
+// flags do sensor (RASTRO_OP_SENSOR só usa ATIVO e ISOLADO)
+#define RASTRO_S_ATIVO    0x01
+#define RASTRO_S_ISOLADO  0x02
+#define RASTRO_S_VIOLADO  0x04
+#define RASTRO_S_ALERTADO 0x08 // alerta já emitido nesta violação
+
+// Grava 'valor' em 'saida' (até RASTRO_VARINT_MAX bytes); retorna os bytes usados
+inline size_t rastroVarintGravar(uint8_t *saida, uint64_t valor)
+{
+    size_t n = 0;
+    while (valor >= 0x80)
+    {
+        saida[n++] = (uint8_t)(valor | 0x80);
+        valor >>= 7;
+    }
+    saida[n++] = (uint8_t)valor;
+    return n;
+}
+
+// Lê um varint de [p, fim) e avança p; false se faltar byte
+inline bool rastroVarintLer(const uint8_t *&p, const uint8_t *fim, uint64_t &valor)
+{
+    valor = 0;
+    for (unsigned deslocamento = 0; p < fim && deslocamento < 64; deslocamento += 7)
+    {
+        const uint8_t b = *p++;
+        valor |= (uint64_t)(b & 0x7F) << deslocamento;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,397 @@
+#include "rastro_gpio.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+#include "system_config.h"
+#include "rastro_formato.h"
+#include "alarme.h"
+#include "entradas.h"
+#include "armazenamento.h"
+#include "metricas.h"
+
+static const char *const ARQUIVOS[2] = {RASTRO_PATH_0, RASTRO_PATH_1};
+
+// Um registro (ou pedaço do cabeçalho) montado antes de ir para o buffer
+struct Bloco
+{
+    uint8_t dados[64];
+    size_t n = 0;
+
+    void byte(uint8_t b) { dados[n++] = b; }
+    void varint(uint64_t v) { n += rastroVarintGravar(dados + n, v); }
+    void texto(const char *s)
+    {
+        size_t tamanho = strlen(s);
+        if (tamanho > RASTRO_MAX_NOME) tamanho = RASTRO_MAX_NOME;
+        varint(tamanho);
+        memcpy(dados + n, s, tamanho);
+        n += tamanho;
+    }
+};
+
+static bool ligado = RASTRO_ATIVO_PADRAO;
+static const Alarme *alarme = nullptr; // nulo = sem modelo (recarga em andamento)
+static const Sirene *sirene = nullptr;
+static Faixa<Zona> zonas;
+static const Sensor *primeiroSensor = nullptr;
+static uint32_t mascaraPinos = 0;
+
+static uint8_t segmento = 1; // arquivo em uso (o primeiro novoSegmento vai para o 0)
+static uint32_t seq = 0;
+static uint32_t tamanhoSegmento = 0; // com o que ainda está no buffer
+static uint32_t ultimoMs = 0;        // base do delta do próximo registro
+static uint32_t ultimaLeitura = 0;
+static bool forcarTick = false;      // houve operação desde o último tick
+
+static uint32_t registros = 0;
+static uint32_t falhas = 0;
+
+static bool gravando() { return ligado && alarme; }
+
+static void anexar(const Bloco &b)
+{
+    if (!armazenamentoAnexar(ARQUIVOS[segmento], b.dados, b.n)) falhas++;
+    tamanhoSegmento += b.n;
+}
+
+static void iniciarRegistro(Bloco &b, uint8_t tipo)
+{
+    const uint32_t agora = millis();
+    b.varint((uint64_t)(agora - ultimoMs) << 2 | tipo);
+    ultimoMs = agora;
+    registros++;
+}
+
+static uint8_t flagsSensor(const Sensor &s)
+{
+    return (s.estaAtivo() ? RASTRO_S_ATIVO : 0) | (s.estaIsolado() ? RASTRO_S_ISOLADO : 0);
+}
+
+static bool armadaAntesDoTeste(const Zona &zona)
+{
+    for (const String &nome : alarme->getZonasAntesDoTeste())
+        if (nome == zona.getNome()) return true;
+    return false;
+}
+
+static void novoSegmento()
+{
+    segmento ^= 1;
+    seq++;
+    armazenamentoRemover(ARQUIVOS[segmento]);
+    tamanhoSegmento = 0;
+    ultimoMs = millis();
+    ultimaLeitura = entradasLer() & mascaraPinos;
+    forcarTick = false;
+
+    Bloco b;
+    memcpy(b.dados, RASTRO_MAGICA, 4);
+    b.n = 4;
+    b.byte(RASTRO_VERSAO);
+    b.varint(seq);
+    b.varint(ultimoMs);
+    b.varint(ultimaLeitura);
+    const bool teste = alarme->emTesteCaminhada();
+    b.varint((alarme->getEstado() == Alarme::Estado::ARMADO ? RASTRO_F_ARMADO : 0) |
+             (teste ? RASTRO_F_TESTE : 0) |
+             (sirene->estaAtiva() ? RASTRO_F_SIRENE : 0) |
+             (teste && alarme->getEstadoAntesDoTeste() == Alarme::Estado::ARMADO ? RASTRO_F_ARMADO_ANTES_TESTE : 0));
+    b.varint(SIRENE_TEMPO_ALTO_MS);
+    b.varint(SIRENE_TEMPO_BAIXO_MS);
+    b.varint(SIRENE_CICLOS);
+    if (sirene->estaAtiva())
+    {
+        const Sirene::Instantaneo i = sirene->instantaneo();
+        b.varint(i.emHigh);
+        b.varint(i.ciclos);
+        b.varint(i.msDesdeTroca);
+        b.varint(i.alvo ? i.alvo - primeiroSensor + 1 : 0);
+    }
+    b.varint(zonas.size());
+    anexar(b);
+
+    for (const Zona &zona : zonas)
+    {
+        Bloco z;
+        z.texto(zona.getNome());
+        z.varint(zona.getSensores().size());
+        z.byte((zona.estaArmada() ? RASTRO_Z_ARMADA : 0) |
+               (teste && armadaAntesDoTeste(zona) ? RASTRO_Z_ARMADA_ANTES_TESTE : 0));
+        z.varint(zona.msIgnorada());
+        anexar(z);
+
+        for (const Sensor &sensor : zona.getSensores())
+        {
+            Bloco s;
+            s.texto(sensor.getNome());
+            s.varint(sensor.getPino());
+            s.byte(sensor.getTipo() == Sensor::Tipo::REED ? 1 : 0);
+            const Sensor::Instantaneo i = sensor.instantaneo();
+            s.byte(flagsSensor(sensor) | (i.violado ? RASTRO_S_VIOLADO : 0) |
+                   (i.alertaEmitido ? RASTRO_S_ALERTADO : 0));
+            s.varint(i.tentativas);
+            if (i.tentativas > 0) s.varint(i.msDesdeAlerta);
+            anexar(s);
+        }
+    }
+    Serial.printf("[RASTRO] Segmento %lu em %s\n", (unsigned long)seq, ARQUIVOS[segmento]);
+}
+
+// seq do cabeçalho de um segmento gravado; false se não houver um válido
+static bool lerSeq(const char *caminho, uint32_t &valor)
+{
+    File f = LittleFS.open(caminho, "r");
+    if (!f) return false;
+    metricasArquivoAberto();
+    uint8_t buf[5 + RASTRO_VARINT_MAX];
+    const size_t n = f.read(buf, sizeof(buf));
+    f.close();
+
+    const uint8_t *p = buf + 5;
+    uint64_t v;
+    if (n <= 5 || memcmp(buf, RASTRO_MAGICA, 4) != 0 || buf[4] != RASTRO_VERSAO ||
+        !rastroVarintLer(p, buf + n, v))
+        return false;
+    valor = (uint32_t)v;
+    return true;
+}
+
+void rastroSetup()
+{
+    uint32_t s0 = 0, s1 = 0;
+    const bool ok0 = lerSeq(ARQUIVOS[0], s0);
+    const bool ok1 = lerSeq(ARQUIVOS[1], s1);
+
+    // o primeiro segmento deste boot sobrescreve o mais antigo
+    if (ok1 && (!ok0 || (int32_t)(s1 - s0) > 0))
+    {
+        segmento = 1;
+        seq = s1;
+    }
+    else if (ok0)
+    {
+        segmento = 0;
+        seq = s0;
+    }
+}
+
+void rastroDefinirModelo(const Alarme &a, const Sirene &s)
+{
+    alarme = &a;
+    sirene = &s;
+    zonas = a.getZonas();
+    primeiroSensor = zonas.empty() ? nullptr : zonas.begin()->getSensores().begin();
+
+    mascaraPinos = 0;
+    for (const Zona &zona : zonas)
+        for (const Sensor &sensor : zona.getSensores())
+            mascaraPinos |= entradasBit(sensor.getPino());
+
+    if (ligado) novoSegmento();
+}
+
+void rastroModeloDescartado()
+{
+    alarme = nullptr;
+    sirene = nullptr;
+    zonas = Faixa<Zona>();
+}
+
+// Tick que pode decidir algo mesmo sem transição: sirene tocando, sensor
+// vigiado com alerta/tentativas pendentes, bypass a ponto de vencer.
+// Zona em bypass não avalia os sensores, então não conta como ocupada.
+static bool tickRelevante(bool &ocupado)
+{
+    ocupado = sirene->estaAtiva();
+    bool vencendo = false;
+    if (alarme->getEstado() != Alarme::Estado::ARMADO) return ocupado;
+
+    for (const Zona &zona : zonas)
+    {
+        if (!zona.estaArmada()) continue;
+        if (zona.estaIgnorada())
+        {
+            // com folga: o tick que vê o fim do bypass tem de entrar
+            if (zona.msIgnorada() < ENERGIA_TICK_LENTO_MS) vencendo = true;
+            continue;
+        }
+        for (const Sensor &sensor : zona.getSensores())
+            if (sensor.estaAtivo() && !sensor.estaIsolado() && !sensor.estaOcioso()) ocupado = true;
+    }
+    return ocupado || vencendo;
+}
+
+void rastroTick(uint32_t leitura)
+{
+    if (!gravando()) return;
+    leitura &= mascaraPinos;
+
+    bool ocupado;
+    const bool relevante = tickRelevante(ocupado);
+
+    // troca de segmento de preferência com o alarme ocioso (cabeçalho menor,
+    // o segmento começa num ponto calmo); no limite duro troca mesmo ocupado
+    if (tamanhoSegmento >= RASTRO_SEGMENTO_MAX_BYTES ||
+        (tamanhoSegmento >= RASTRO_SEGMENTO_BYTES && !ocupado && !alarme->emTesteCaminhada()))
+        novoSegmento();
+
+    Bloco b;
+    if (leitura != ultimaLeitura)
+    {
+        iniciarRegistro(b, RASTRO_TICK_LEITURA);
+        b.varint(leitura ^ ultimaLeitura);
+    }
+    else if (relevante || forcarTick) iniciarRegistro(b, RASTRO_TICK);
+    else return;
+
+    ultimaLeitura = leitura;
+    forcarTick = false;
+    anexar(b);
+}
+
+// Operação entre ticks: a leitura do momento vai antes (armar lê os pinos)
+static bool iniciarOperacao(Bloco &b, uint8_t op)
+{
+    if (!gravando()) return false;
+
+    const uint32_t leitura = entradasLer() & mascaraPinos;
+    if (leitura != ultimaLeitura)
+    {
+        Bloco l;
+        iniciarRegistro(l, RASTRO_LEITURA);
+        l.varint(leitura ^ ultimaLeitura);
+        anexar(l);
+        ultimaLeitura = leitura;
+    }
+
+    iniciarRegistro(b, RASTRO_OPERACAO);
+    b.byte(op);
+    forcarTick = true;
+    return true;
+}
+
+void rastroArmado()
+{
+    Bloco b;
+    if (!iniciarOperacao(b, RASTRO_OP_ARMAR)) return;
+    uint64_t mascara = 0;
+    uint8_t i = 0;
+    for (const Zona &zona : zonas)
+    {
+        if (i < 64 && zona.estaArmada()) mascara |= 1ULL << i;
+        i++;
+    }
+    b.varint(mascara);
+    anexar(b);
+}
+
+void rastroDesarmado()
+{
+    Bloco b;
+    if (iniciarOperacao(b, RASTRO_OP_DESARMAR)) anexar(b);
+}
+
+void rastroTesteCaminhada(bool iniciado)
+{
+    Bloco b;
+    if (iniciarOperacao(b, iniciado ? RASTRO_OP_TESTE_INICIAR : RASTRO_OP_TESTE_ENCERRAR)) anexar(b);
+}
+
+void rastroAjusteSensor(const Sensor &sensor)
+{
+    Bloco b;
+    if (!iniciarOperacao(b, RASTRO_OP_SENSOR)) return;
+    b.varint(&sensor - primeiroSensor);
+    b.byte(flagsSensor(sensor));
+    anexar(b);
+}
+
+void rastroBypass(const Zona &zona)
+{
+    Bloco b;
+    if (!iniciarOperacao(b, RASTRO_OP_BYPASS)) return;
+    b.varint(&zona - zonas.begin());
+    b.varint(zona.msIgnorada());
+    anexar(b);
+}
+
+void rastroSireneRemota()
+{
+    Bloco b;
+    if (iniciarOperacao(b, RASTRO_OP_SIRENE_REMOTA)) anexar(b);
+}
+
+// Dentro do tick (Alarme::atualizar): vai logo depois do registro do tick
+void rastroAlerta(const Sensor &sensor)
+{
+    if (!gravando()) return;
+    Bloco b;
+    iniciarRegistro(b, RASTRO_OPERACAO);
+    b.byte(RASTRO_OP_ALERTA);
+    b.varint(&sensor - primeiroSensor);
+    anexar(b);
+}
+
+void rastroLigar(bool ligar)
+{
+    if (ligar == ligado) return;
+    ligado = ligar;
+    // o que mudou enquanto desligado não está no rastro: recomeça do estado atual
+    if (gravando()) novoSegmento();
+    Serial.printf("[RASTRO] %s\n", ligado ? "Ligado" : "Desligado");
+}
+
+void rastroLimpar()
+{
+    armazenamentoRemover(ARQUIVOS[0]);
+    armazenamentoRemover(ARQUIVOS[1]);
+    tamanhoSegmento = 0;
+    if (gravando()) novoSegmento();
+}
+
+// Arquivo + o que ainda está no buffer, precedido do tamanho total
+static void escreverSegmento(Print &saida, const char *caminho)
+{
+    size_t pendentes = 0;
+    const uint8_t *pendente = armazenamentoPendente(caminho, pendentes);
+
+    File f = LittleFS.open(caminho, "r");
+    if (f) metricasArquivoAberto();
+    const uint32_t total = (f ? f.size() : 0) + pendentes;
+    if (total)
+    {
+        const uint8_t tamanho[4] = {(uint8_t)total, (uint8_t)(total >> 8), (uint8_t)(total >> 16),
+                                    (uint8_t)(total >> 24)};
+        saida.write(tamanho, sizeof(tamanho));
+
+        uint8_t buf[128];
+        size_t lidos;
+        while (f && (lidos = f.read(buf, sizeof(buf))) > 0) saida.write(buf, lidos);
+        if (pendentes) saida.write(pendente, pendentes);
+    }
+    if (f) f.close();
+}
+
+void rastroEscrever(Print &saida)
+{
+    escreverSegmento(saida, ARQUIVOS[segmento ^ 1]);
+    escreverSegmento(saida, ARQUIVOS[segmento]);
+}
+
+String rastroJson()
+{
+    StaticJsonDocument<256> doc;
+
+    doc["ligado"] = ligado;
+    doc["gravando"] = gravando();
+    doc["seq"] = seq;
+    doc["arquivo"] = ARQUIVOS[segmento];
+    doc["segmento_bytes"] = tamanhoSegmento;
+    doc["segmento_max_bytes"] = RASTRO_SEGMENTO_BYTES;
+    doc["registros"] = registros; // desde o boot
+    doc["falhas"] = falhas;       // anexos que não couberam
+
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
@@ -0,0 +1,53 @@
+#ifndef RASTRO_GPIO_H
+#define RASTRO_GPIO_H
+
+#include <Arduino.h>
+
+class Alarme;
+class Sirene;
+class Sensor;
+class Zona;
+
+// Rastro das entradas dos sensores para reproduzir as decisões do alarme no
+// host (tools/replay_rastro), no formato de rastro_formato.h.
+//
+// Entram: as transições dos pinos de sensores, com o ms do tick que as viu;
+// as operações que mexem no modelo entre ticks (armar, teste de caminhada,
+// ajuste de sensor, bypass, sirene remota), com a leitura daquele momento;
+// e os alertas emitidos, para o replay conferir. Ticks sem transição só
+// entram quando podem decidir algo (sirene tocando, sensor com alerta ou
+// tentativas pendentes, bypass vencendo); nos outros o modelo não muda.
+//
+// Dois segmentos no LittleFS (RASTRO_PATH_0/1) que se alternam: o cheio é
+// trocado com o alarme ocioso e o mais antigo sobrescrito. Cada segmento
+// começa com o modelo e o estado completos, e o replay parte dele.
+
+// Após armazenamentoSetup: acha o segmento mais novo
+void rastroSetup();
+// Depois de cada configurarSistema: segmento novo com o modelo atual
+void rastroDefinirModelo(const Alarme &alarme, const Sirene &sirene);
+// Chamado pelo Alarme::limparZonas: nada é gravado até o próximo modelo
+void rastroModeloDescartado();
+
+// Antes de alarme.atualizar(leitura), com a mesma leitura
+void rastroTick(uint32_t leitura);
+
+// Operações, chamadas por quem as executa
+void rastroArmado();
+void rastroDesarmado();
+void rastroTesteCaminhada(bool iniciado);
+void rastroAjusteSensor(const Sensor &sensor);
+void rastroBypass(const Zona &zona);
+void rastroSireneRemota();
+void rastroAlerta(const Sensor &sensor);
+
+// POST /diag/rastro.json; ligado volta a RASTRO_ATIVO_PADRAO no boot
+void rastroLigar(bool ligar);
+void rastroLimpar();
+
+// GET /diag/rastro.bin
+void rastroEscrever(Print &saida);
+// GET /diag/rastro.json
+String rastroJson();
+
+#endif
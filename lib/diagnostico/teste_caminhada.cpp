@@ -0,0 +1,172 @@
+#include "teste_caminhada.h"
+#include <vector>
+
+#include "alarme.h"
+#include "energia.h"
+#include "event_logger.h"
+
+struct RegistroSensor
+{
+    const Zona *zona;
+    const Sensor *sensor;
+    uint32_t disparos;
+    uint64_t primeiroUs; // desde o início do teste
+    uint32_t pipelineUs; // borda -> detecção (0 sem borda)
+    bool porBorda;
+};
+
+static std::vector<RegistroSensor> registros;
+static bool ativo = false;
+static uint64_t inicioUs = 0;
+static uint64_t fimUs = 0;
+static uint32_t inicioMs = 0;
+static uint32_t duracaoMs = 0;
+
+static uint32_t disparados()
+{
+    uint32_t n = 0;
+    for (const RegistroSensor &r : registros)
+        if (r.disparos) n++;
+    return n;
+}
+
+void testeCaminhadaIniciar(Alarme &alarme, uint32_t duracaoS)
+{
+    alarme.encerrarTesteCaminhada(); // recomeçar = relatório novo
+
+    registros.clear();
+    for (const Zona &zona : alarme.getZonas())
+        for (const Sensor &sensor : zona.getSensores())
+            registros.push_back({&zona, &sensor, 0, 0, 0, false});
+
+    inicioMs = millis();
+    duracaoMs = duracaoS * 1000;
+    inicioUs = micros64();
+    fimUs = 0;
+    ativo = true;
+    alarme.iniciarTesteCaminhada();
+
+    Serial.printf("[TESTE] Caminhada iniciada: %u sensores, %lu s\n", (unsigned)registros.size(), (unsigned long)duracaoS);
+    registrarEventoF("[TESTE] Teste de caminhada iniciado (%u sensores)", (unsigned)registros.size());
+}
+
+void testeCaminhadaLoop(Alarme &alarme)
+{
+    if (ativo && millis() - inicioMs >= duracaoMs) alarme.encerrarTesteCaminhada();
+}
+
+void testeCaminhadaDetectado(const Zona &zona, const Sensor &sensor)
+{
+    if (!ativo) return;
+    const uint64_t agora = micros64();
+
+    for (RegistroSensor &r : registros)
+    {
+        if (r.sensor != &sensor) continue;
+        if (r.disparos++) return;
+
+        // a borda de interrupção no pino do sensor marca o acionamento com
+        // precisão de µs; sem ela (GPIO16, borda de antes do teste) vale o tick
+        uint32_t bordaUs;
+        r.porBorda = energiaBordaPendente(sensor.getPino(), bordaUs);
+        r.pipelineUs = r.porBorda ? (uint32_t)agora - bordaUs : 0;
+        if (r.pipelineUs > agora - inicioUs)
+        {
+            r.porBorda = false;
+            r.pipelineUs = 0;
+        }
+        r.primeiroUs = agora - inicioUs - r.pipelineUs;
+
+        Serial.printf("[TESTE] %s/%s disparou em %lu ms\n", zona.getNome(), sensor.getNome(),
+                      (unsigned long)(r.primeiroUs / 1000));
+        registrarEventoF("[TESTE] Sensor %s da zona %s disparou", sensor.getNome(), zona.getNome());
+        return;
+    }
+}
+
+void testeCaminhadaFim()
+{
+    if (!ativo) return;
+    ativo = false;
+    fimUs = micros64();
+
+    Serial.printf("[TESTE] Caminhada encerrada: %lu de %u sensores dispararam\n",
+                  (unsigned long)disparados(), (unsigned)registros.size());
+    registrarEventoF("[TESTE] Teste de caminhada encerrado: %lu de %u sensores dispararam",
+                     (unsigned long)disparados(), (unsigned)registros.size());
+}
+
+void testeCaminhadaDescartar()
+{
+    registros.clear();
+    registros.shrink_to_fit();
+}
+
+static void escreverEscapado(Print &saida, const char *texto)
+{
+    for (const char *p = texto; *p; p++)
+    {
+        if (*p == '"' || *p == '\\') saida.print('\\');
+        saida.print(*p);
+    }
+}
+
+// µs como ms com 3 casas (Print não tem %llu confiável)
+static void escreverMs(Print &saida, uint64_t us)
+{
+    saida.printf("%lu.%03u", (unsigned long)(us / 1000), (unsigned)(us % 1000));
+}
+
+static const char *situacao(const RegistroSensor &r)
+{
+    if (r.sensor->getSituacao() != Sensor::Situacao::ATIVO) return "inativo";
+    if (r.sensor->estaIsolado()) return "isolado";
+    if (r.zona->estaIgnorada()) return "zona_ignorada";
+    return "ativo";
+}
+
+void testeCaminhadaEscreverJson(Print &saida)
+{
+    const uint64_t agora = ativo ? micros64() : fimUs;
+    saida.printf("{\"ativo\":%s,\"duracao_s\":%lu,\"decorrido_ms\":", ativo ? "true" : "false",
+                 (unsigned long)(duracaoMs / 1000));
+    escreverMs(saida, registros.empty() ? 0 : agora - inicioUs);
+    saida.printf(",\"sensores\":%u,\"disparados\":%lu,\"resultados\":[", (unsigned)registros.size(),
+                 (unsigned long)disparados());
+
+    bool primeiro = true;
+    for (const RegistroSensor &r : registros)
+    {
+        if (!primeiro) saida.print(',');
+        primeiro = false;
+        saida.print("{\"zona\":\"");
+        escreverEscapado(saida, r.zona->getNome());
+        saida.print("\",\"sensor\":\"");
+        escreverEscapado(saida, r.sensor->getNome());
+        saida.printf("\",\"pino\":%d,\"situacao\":\"%s\",\"disparos\":%lu,\"primeiro_ms\":", r.sensor->getPino(),
+                     situacao(r), (unsigned long)r.disparos);
+        if (!r.disparos)
+        {
+            saida.print("null,\"pipeline_us\":null,\"fonte\":null}");
+            continue;
+        }
+        escreverMs(saida, r.primeiroUs);
+        if (r.porBorda) saida.printf(",\"pipeline_us\":%lu,\"fonte\":\"borda\"}", (unsigned long)r.pipelineUs);
+        else saida.print(",\"pipeline_us\":null,\"fonte\":\"tick\"}");
+    }
+
+    saida.print("],\"nunca_disparados\":[");
+    primeiro = true;
+    for (const RegistroSensor &r : registros)
+    {
+        if (r.disparos) continue;
+        if (!primeiro) saida.print(',');
+        primeiro = false;
+        saida.print('"');
+        escreverEscapado(saida, r.zona->getNome());
+        saida.print('/');
+        escreverEscapado(saida, r.sensor->getNome());
+        saida.print('"');
+    }
+    saida.print("]}");
+}
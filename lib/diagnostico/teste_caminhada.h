@@ -0,0 +1,33 @@
+#ifndef TESTE_CAMINHADA_H
+#define TESTE_CAMINHADA_H
+
+#include <Arduino.h>
+#include "zona.h"
+
+class Alarme;
+
+// Teste de caminhada (comissionamento): alguém aciona sensor por sensor e o
+// relatório mostra quem disparou, quando e quem nunca disparou.
+//
+// A detecção é a do alarme armado (tick -> Zona::atualizar -> sensor
+// VIOLADO); no lugar do alerta, Alarme::atualizar chama
+// testeCaminhadaDetectado. Tempos em µs desde o início do teste: com uma
+// borda de interrupção pendente no pino do sensor (energia.h) o primeiro
+// disparo usa o instante da borda, e "pipeline_us" é quanto a detecção levou
+// depois dela.
+
+// Zera o relatório, marca o início e põe o alarme em teste (sirene muda)
+void testeCaminhadaIniciar(Alarme &alarme, uint32_t duracaoS);
+
+// Encerra quando a duração vence (chamado do loop)
+void testeCaminhadaLoop(Alarme &alarme);
+
+// Chamados pelo Alarme
+void testeCaminhadaDetectado(const Zona &zona, const Sensor &sensor);
+void testeCaminhadaFim();
+void testeCaminhadaDescartar(); // sensores vão ser recriados (configurarSistema)
+
+// Relatório servido em /diag/walktest.json
+void testeCaminhadaEscreverJson(Print &saida);
+
+#endif
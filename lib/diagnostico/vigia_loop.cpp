@@ -0,0 +1,194 @@
+#include "vigia_loop.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+#include "system_config.h"
+#include "event_logger.h"
+#include "armazenamento.h"
+#include "metricas.h"
+
+static const char *const NOMES_FASES[FASE_TOTAL] = {
+    "setup", "wifi", "http", "tick_alarme", "p2p", "mqtt", "armazenamento", "ntp", "ota", "ws", "notificacoes", "pausa"};
+
+static const uint32_t RTC_MAGICA = 0xA1A2C0DE;
+static const uint8_t MAX_TRAVAMENTOS = 4;
+static const uint8_t MAX_EVENTOS = 4;
+static const uint8_t EVENTO_CHARS = 40;
+
+struct Travamento
+{
+    uint8_t fase;
+    uint32_t duracaoMs;
+    uint32_t uptimeS;
+};
+
+// Espelho da memória RTC. A fase atual é gravada a cada troca (8 bytes);
+// o resto só quando muda (eventos, travamentos) ou no crash callback.
+struct RegistroRtc
+{
+    uint32_t magica;
+    uint32_t fase;
+    uint32_t faseInicioMs;
+    uint32_t uptimeMs; // atualizado no crash callback
+    uint32_t totalTravamentos;
+    Travamento travamentos[MAX_TRAVAMENTOS];
+    char eventos[MAX_EVENTOS][EVENTO_CHARS];
+    uint32_t proximoEvento;
+};
+static_assert(sizeof(RegistroRtc) % 4 == 0, "memória RTC é lida em blocos de 4 bytes");
+static_assert(sizeof(RegistroRtc) <= 512 - VIGIA_RTC_OFFSET * 4, "não cabe na memória RTC de usuário");
+
+static RegistroRtc registro;
+
+static void gravarRtc(size_t offsetBytes, size_t tamanho)
+{
+    ESP.rtcUserMemoryWrite(VIGIA_RTC_OFFSET + offsetBytes / 4,
+                           (uint32_t *)((uint8_t *)&registro + offsetBytes), tamanho);
+}
+
+static void observarEvento(uint32_t, time_t, const char *mensagem)
+{
+    strlcpy(registro.eventos[registro.proximoEvento % MAX_EVENTOS], mensagem, EVENTO_CHARS);
+    registro.proximoEvento++;
+    gravarRtc(offsetof(RegistroRtc, eventos), sizeof(registro.eventos) + sizeof(registro.proximoEvento));
+}
+
+void vigiaFase(FaseLoop fase)
+{
+    const uint32_t agora = millis();
+    const uint32_t duracao = agora - registro.faseInicioMs;
+
+    if (duracao > VIGIA_LIMIAR_MS && registro.fase != FASE_SETUP)
+    {
+        Travamento &t = registro.travamentos[registro.totalTravamentos % MAX_TRAVAMENTOS];
+        t.fase = registro.fase;
+        t.duracaoMs = duracao;
+        t.uptimeS = agora / 1000;
+        registro.totalTravamentos++;
+        contadores.loopTravamentos++;
+        gravarRtc(offsetof(RegistroRtc, totalTravamentos), sizeof(registro.totalTravamentos) + sizeof(registro.travamentos));
+        Serial.printf("[VIGIA] Fase '%s' travou o loop por %u ms\n", NOMES_FASES[t.fase], duracao);
+    }
+
+    registro.fase = fase;
+    registro.faseInicioMs = agora;
+    gravarRtc(offsetof(RegistroRtc, fase), 2 * sizeof(uint32_t));
+}
+
+// Chamado pelo core em exceção e watchdog de software (não no de hardware:
+// nesse caso vale a fase gravada na última troca)
+extern "C" void custom_crash_callback(struct rst_info *, uint32_t, uint32_t)
+{
+    registro.uptimeMs = millis();
+    gravarRtc(0, sizeof(registro));
+}
+
+static void salvarCrash(const RegistroRtc &anterior, const rst_info &info)
+{
+    StaticJsonDocument<768> doc;
+    doc["motivo"] = ESP.getResetReason();
+    doc["codigo_motivo"] = info.reason;
+    if (info.reason == REASON_EXCEPTION_RST)
+    {
+        char hex[11];
+        doc["causa_excecao"] = info.exccause;
+        snprintf(hex, sizeof(hex), "0x%08x", info.epc1);
+        doc["epc1"] = hex;
+        snprintf(hex, sizeof(hex), "0x%08x", info.excvaddr);
+        doc["excvaddr"] = hex;
+    }
+    doc["fase"] = anterior.fase < FASE_TOTAL ? NOMES_FASES[anterior.fase] : "?";
+    if (anterior.uptimeMs)
+    {
+        doc["fase_ms"] = anterior.uptimeMs - anterior.faseInicioMs;
+        doc["uptime_s"] = anterior.uptimeMs / 1000;
+    }
+    else
+    {
+        doc["fase_desde_s"] = anterior.faseInicioMs / 1000; // watchdog de hardware
+    }
+
+    doc["total_travamentos"] = anterior.totalTravamentos;
+    JsonArray travamentos = doc.createNestedArray("travamentos");
+    for (uint8_t i = 0; i < MAX_TRAVAMENTOS && i < anterior.totalTravamentos; i++)
+    {
+        const Travamento &t = anterior.travamentos[(anterior.totalTravamentos - 1 - i) % MAX_TRAVAMENTOS];
+        JsonObject o = travamentos.createNestedObject();
+        o["fase"] = t.fase < FASE_TOTAL ? NOMES_FASES[t.fase] : "?";
+        o["duracao_ms"] = t.duracaoMs;
+        o["uptime_s"] = t.uptimeS;
+    }
+
+    // mais recente primeiro
+    JsonArray eventos = doc.createNestedArray("ultimos_eventos");
+    for (uint8_t i = 0; i < MAX_EVENTOS && i < anterior.proximoEvento; i++)
+    {
+        eventos.add((const char *)anterior.eventos[(anterior.proximoEvento - 1 - i) % MAX_EVENTOS]);
+    }
+
+    armazenamentoGravarJson(VIGIA_CRASH_PATH, doc.as<JsonVariantConst>());
+}
+
+void vigiaSetup()
+{
+    RegistroRtc anterior;
+    const bool valido = ESP.rtcUserMemoryRead(VIGIA_RTC_OFFSET, (uint32_t *)&anterior, sizeof(anterior)) &&
+                        anterior.magica == RTC_MAGICA;
+
+    // reset por energia/pino ou ESP.restart() não é falha
+    const rst_info &info = *ESP.getResetInfoPtr();
+    if (valido && (info.reason == REASON_WDT_RST || info.reason == REASON_EXCEPTION_RST ||
+                   info.reason == REASON_SOFT_WDT_RST))
+    {
+        for (auto &e : anterior.eventos) e[EVENTO_CHARS - 1] = '\0';
+        salvarCrash(anterior, info);
+        registrarEventoF("[VIGIA] Reinício anormal (%s) na fase '%s'", ESP.getResetReason().c_str(),
+                         anterior.fase < FASE_TOTAL ? NOMES_FASES[anterior.fase] : "?");
+    }
+
+    memset(&registro, 0, sizeof(registro));
+    registro.magica = RTC_MAGICA;
+    registro.fase = FASE_SETUP;
+    gravarRtc(0, sizeof(registro));
+
+    adicionarObservadorEventos(observarEvento);
+}
+
+String vigiaCrashJson()
+{
+    // este boot
+    StaticJsonDocument<512> doc;
+    doc["motivo_reset"] = ESP.getResetReason();
+    doc["fase_atual"] = NOMES_FASES[registro.fase];
+    doc["total_travamentos"] = registro.totalTravamentos;
+    JsonArray travamentos = doc.createNestedArray("travamentos");
+    for (uint8_t i = 0; i < MAX_TRAVAMENTOS && i < registro.totalTravamentos; i++)
+    {
+        const Travamento &t = registro.travamentos[(registro.totalTravamentos - 1 - i) % MAX_TRAVAMENTOS];
+        JsonObject o = travamentos.createNestedObject();
+        o["fase"] = NOMES_FASES[t.fase];
+        o["duracao_ms"] = t.duracaoMs;
+        o["uptime_s"] = t.uptimeS;
+    }
+
+    // o registro do último crash já está em JSON no arquivo: copia sem parse
+    String out = "{\"ultimo_reinicio_anormal\":";
+    File f = LittleFS.open(VIGIA_CRASH_PATH, "r");
+    if (f && f.size())
+    {
+        out.reserve(f.size() + measureJson(doc) + 48);
+        while (f.available()) out += (char)f.read();
+    }
+    else
+    {
+        out += "null";
+    }
+    if (f) f.close();
+
+    String atual;
+    serializeJson(doc, atual);
+    out += ",\"boot_atual\":";
+    out += atual;
+    out += '}';
+    return out;
+}
@@ -0,0 +1,38 @@
+#ifndef VIGIA_LOOP_H
+#define VIGIA_LOOP_H
+
+#include <Arduino.h>
+
+// Detector de travamentos do loop + registro pós-morte.
+//
+// O loop marca em que fase está (vigiaFase). Uma fase que dura mais que
+// VIGIA_LIMIAR_MS é registrada como travamento. A fase atual, os últimos
+// travamentos e os últimos eventos ficam também na memória RTC, que
+// sobrevive ao reset: depois de um watchdog/exceção, o boot seguinte sabe
+// onde o loop estava e serve isso em /diag/crash.json.
+enum FaseLoop : uint8_t
+{
+    FASE_SETUP,
+    FASE_WIFI,
+    FASE_HTTP,
+    FASE_TICK_ALARME,
+    FASE_P2P,
+    FASE_MQTT,
+    FASE_ARMAZENAMENTO,
+    FASE_NTP,
+    FASE_OTA,
+    FASE_WS,
+    FASE_NOTIFICACOES,
+    FASE_PAUSA, // energiaPausar (limitada a ENERGIA_PAUSA_MAX_MS)
+    FASE_TOTAL
+};
+
+// Chamar logo após montar o LittleFS (grava /crash.json se o reset foi anormal)
+void vigiaSetup();
+
+// Início de uma fase (fecha a anterior e mede a duração dela)
+void vigiaFase(FaseLoop fase);
+
+String vigiaCrashJson();
+
+#endif
@@ -0,0 +1,547 @@
+#include "arquivo_historico.h"
+#include <LittleFS.h>
+
+#include "system_config.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "event_logger.h"
+
+// Registro (antes do LZ): varint tipo, campos, resto da linha até '\n'
+//   0     -> linha inteira
+//   1     -> varint seq, varint zigzag(timestamp)      (início de bloco)
+//   d + 1 -> seq = anterior + d, varint zigzag(timestamp - anterior)
+// O resto é o JSON depois de {"seq":N,"timestamp":T, (já com "evento").
+// Nele, inteiros de 9+ dígitos logo após ": (primeiro/ultimo dos resumos)
+// vão como MARCA_TEMPO + varint zigzag(valor - timestamp).
+// Resto igual ao de uma linha recente (TextosRecentes) vai como um byte,
+// MARCA_RECENTE + posição, sem o '\n'.
+static const uint8_t REGISTRO_LINHA = 0;
+static const uint8_t REGISTRO_ABSOLUTO = 1;
+static const uint8_t MARCA_TEMPO = 0x01;
+static const uint8_t MARCA_RECENTE = 0x02;
+static const uint8_t MAX_RECENTES = 0x20 - MARCA_RECENTE; // o resto começa em texto (>= ' ')
+static const uint8_t DIGITOS_TEMPO_MIN = 9;
+static const uint8_t DIGITOS_TEMPO_MAX = 18;
+static const size_t PREFIXO_MAX = 48;
+
+static uint32_t ultimoSeqArquivado = 0;
+
+// Dicionário do LZ (lz_historico.h): o resto das linhas (o que vem depois
+// de montarPrefixo) com os textos fixos das mensagens do firmware; os
+// campos variáveis ficam vazios. Mudar o texto muda o formato dos
+// segmentos gravados.
+static const char DICIONARIO[] PROGMEM =
+    "\"evento\":\"[OTA] Imagem nova confirmada ()\"}\n"
+    "\"evento\":\"[OTA] Rollback (): restaurando a imagem anterior\"}\n"
+    "\"evento\":\"[VIGIA] Reinício anormal () na fase '\"}\n"
+    "\"evento\":\"[REINICIO] Reiniciando o sistema conforme horário configurado...\"}\n"
+    "\"evento\":\"[TESTE] Teste de caminhada iniciado ( sensores)\"}\n"
+    "\"evento\":\"[TESTE] Teste de caminhada encerrado:  de  sensores dispararam\"}\n"
+    "\"evento\":\"[TESTE] Sensor  da zona  disparou\"}\n"
+    "\"evento\":\"[AJUSTE] Isolamento do sensor  removido\"}\n"
+    "\"evento\":\"[AJUSTE] Bypass da zona  cancelado\"}\n"
+    "\"evento\":\"[AJUSTE] Zona  em bypass por  s\"}\n"
+    "\"evento\":\"[SEGURANCA] IP  bloqueado por  min após  senhas erradas\"}\n"
+    "\"evento\":\"[P2P] Alarme armado pela placa mestre alarme-\"}\n"
+    "\"evento\":\"[P2P] Alarme desarmado pela placa mestre alarme-\"}\n"
+    "\"evento\":\"[P2P] Zona  violada na placa alarme-: sirene acionada\"}\n"
+    "\"evento\":\"[ALERTA] Sirene tocou 4 vezes seguidas. Sensor  da zona  foi desabilitado.\"}\n"
+    "\"evento\":\"[MODO] Modo alterado para MANUAL por \"}\n"
+    "\"evento\":\"[MODO] Modo alterado para AUTOMATICO por \"}\n"
+    "\"evento\":\"[INFO] Alarme desarmado automaticamente (por horário)\"}\n"
+    "\"evento\":\"[INFO] Alarme armado automaticamente (por horário)\"}\n"
+    "\"evento\":\"Tentativa de login admin falhou\"}\n"
+    "\"evento\":\"Alarme desarmado por: admin\"}\n"
+    "\"evento\":\"Alarme armado por: admin\"}\n"
+    "\"evento\":\"[ALERTA] Zona  violada (). (+ repetições)\",\"repeticoes\":,\"primeiro\":\x01,\"ultimo\":\x01}\n"
+    "\"evento\":\"[ALERTA] Zona  violada ().\"}\n";
+static const size_t TAMANHO_DICIONARIO = sizeof(DICIONARIO) - 1;
+static_assert(TAMANHO_DICIONARIO <= LZ_JANELA, "dicionário maior que a janela do LZ");
+
+static size_t escreverVarint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static uint64_t zigzag(long long v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static long long dezigzag(uint64_t v) { return (long long)(v >> 1) ^ -(long long)(v & 1); }
+
+TextosRecentes::TextosRecentes() { bloco = (uint8_t *)malloc(HISTORICO_ARQUIVO_RECENTES_BYTES); }
+TextosRecentes::~TextosRecentes() { free(bloco); }
+
+int TextosRecentes::procurar(const uint8_t *texto, size_t n) const
+{
+    size_t p = 0;
+    for (uint8_t i = 0; i < total; i++)
+    {
+        if (bloco[p] == n && memcmp(bloco + p + 1, texto, n) == 0) return i;
+        p += 1 + bloco[p];
+    }
+    return -1;
+}
+
+const uint8_t *TextosRecentes::texto(uint8_t posicao, size_t &n) const
+{
+    size_t p = 0;
+    while (posicao--) p += 1 + bloco[p];
+    n = bloco[p];
+    return bloco + p + 1;
+}
+
+// Os do fim que não couberem atrás do novo saem
+void TextosRecentes::usar(const uint8_t *texto, size_t n)
+{
+    if (!bloco || n > 255 || 1 + n > HISTORICO_ARQUIVO_RECENTES_BYTES) return;
+
+    // bytes dos textos que ficam atrás do novo (sem o próprio, se já estava)
+    const int atual = procurar(texto, n);
+    size_t p = 0;
+    uint8_t ficam = 0;
+    if (atual >= 0)
+    {
+        for (; ficam < atual; ficam++) p += 1 + bloco[p];
+    }
+    else
+    {
+        while (ficam < total && ficam + 1 < MAX_RECENTES && 1 + n + p + 1 + bloco[p] <= HISTORICO_ARQUIVO_RECENTES_BYTES)
+        {
+            p += 1 + bloco[p];
+            ficam++;
+        }
+        total = ficam + 1;
+    }
+    memmove(bloco + 1 + n, bloco, p);
+    bloco[0] = n;
+    memcpy(bloco + 1, texto, n);
+}
+
+static size_t montarPrefixo(char *p, uint32_t seq, long long timestamp)
+{
+    return snprintf(p, PREFIXO_MAX, "{\"seq\":%lu,\"timestamp\":%lld,", (unsigned long)seq, timestamp);
+}
+
+// Inteiro sem sinal em p[0..n) (a linha lida não termina em '\0');
+// retorna o número de dígitos
+static size_t lerInteiro(const char *p, size_t n, long long &valor)
+{
+    size_t d = 0;
+    valor = 0;
+    while (d < n && d < DIGITOS_TEMPO_MAX && p[d] >= '0' && p[d] <= '9') valor = valor * 10 + (p[d++] - '0');
+    return d;
+}
+
+// Separa seq e timestamp do início da linha; false se a linha não for
+// exatamente o que montarPrefixo reconstrói
+static bool lerPrefixo(const char *linha, size_t n, uint32_t &seq, long long &timestamp, size_t &tamanhoPrefixo)
+{
+    static const char SEQ[] = "{\"seq\":";
+    static const char TIMESTAMP[] = ",\"timestamp\":";
+    if (n < 24 || memcmp(linha, SEQ, 7) != 0) return false;
+
+    long long valor;
+    size_t i = 7;
+    i += lerInteiro(linha + i, n - i, valor);
+    seq = (uint32_t)valor;
+    if (i + 13 > n || memcmp(linha + i, TIMESTAMP, 13) != 0) return false;
+    i += 13;
+    i += lerInteiro(linha + i, n - i, timestamp);
+
+    char prefixo[PREFIXO_MAX];
+    tamanhoPrefixo = montarPrefixo(prefixo, seq, timestamp);
+    return tamanhoPrefixo == i + 1 && tamanhoPrefixo < n && memcmp(prefixo, linha, tamanhoPrefixo) == 0;
+}
+
+// Recebe os bytes descompactados e devolve as linhas JSON originais
+class DecodificadorRegistros : public Print
+{
+public:
+    explicit DecodificadorRegistros(Print *destino) : destino(destino) {}
+
+    size_t write(uint8_t c) override
+    {
+        if (estado == TEXTO && inicioTexto)
+        {
+            inicioTexto = false;
+            tamanhoResto = 0;
+            if (c >= MARCA_RECENTE && c < MARCA_RECENTE + MAX_RECENTES)
+            {
+                reproduzir(c - MARCA_RECENTE);
+                return 1;
+            }
+        }
+        // o resto como foi codificado (varints de tempo inclusive), para os recentes
+        if (compacto && !reproduzindo && (estado == TEMPO || (estado == TEXTO && c != '\n')))
+        {
+            if (tamanhoResto < sizeof(resto)) resto[tamanhoResto] = c;
+            tamanhoResto++;
+        }
+
+        if (estado == TEXTO)
+        {
+            if (c == MARCA_TEMPO && compacto)
+            {
+                estado = TEMPO;
+                return 1;
+            }
+            if (destino) destino->write(c);
+            if (c == '\n')
+            {
+                if (compacto && tamanhoResto <= sizeof(resto)) recentes.usar(resto, tamanhoResto);
+                estado = TIPO;
+            }
+            return 1;
+        }
+
+        valor |= (uint64_t)(c & 0x7F) << deslocamento;
+        deslocamento += 7;
+        if (c & 0x80) return 1;
+        const uint64_t v = valor;
+        valor = 0;
+        deslocamento = 0;
+
+        switch (estado)
+        {
+        case TIPO:
+            compacto = v != REGISTRO_LINHA;
+            if (v == REGISTRO_LINHA) estado = TEXTO;
+            else if (v == REGISTRO_ABSOLUTO)
+            {
+                recentes.limpar();
+                estado = SEQ;
+            }
+            else
+            {
+                seq += v - 1;
+                estado = DELTA_TIMESTAMP;
+            }
+            break;
+        case DELTA_TIMESTAMP:
+            timestamp += dezigzag(v);
+            iniciarTexto();
+            break;
+        case TEMPO:
+            if (destino)
+            {
+                char numero[24];
+                destino->write((const uint8_t *)numero, snprintf(numero, sizeof(numero), "%lld", timestamp + dezigzag(v)));
+            }
+            estado = TEXTO;
+            break;
+        case SEQ:
+            seq = v;
+            estado = TIMESTAMP;
+            break;
+        default: // TIMESTAMP
+            timestamp = dezigzag(v);
+            iniciarTexto();
+            break;
+        }
+        return 1;
+    }
+    using Print::write;
+
+    void iniciarTexto()
+    {
+        if (destino)
+        {
+            char prefixo[PREFIXO_MAX];
+            destino->write((const uint8_t *)prefixo, montarPrefixo(prefixo, seq, timestamp));
+        }
+        estado = TEXTO;
+        inicioTexto = true;
+    }
+
+    // Resto de uma linha recente: passa pelo mesmo caminho (tempos em delta
+    // ao timestamp desta linha) e fecha a linha, que veio sem '\n'
+    void reproduzir(uint8_t posicao)
+    {
+        tamanhoResto = 0;
+        if (posicao < recentes.quantos())
+        {
+            const uint8_t *texto = recentes.texto(posicao, tamanhoResto);
+            memcpy(resto, texto, tamanhoResto);
+            reproduzindo = true;
+            for (size_t i = 0; i < tamanhoResto; i++) write(resto[i]);
+            reproduzindo = false;
+        }
+        write('\n'); // posição inválida (arquivo corrompido): linha vazia, descartada por quem lê
+    }
+
+    // Arquivo acabou no meio de uma linha: fecha (a linha é descartada por
+    // quem lê, por não terminar em '}')
+    void terminar()
+    {
+        if (estado == TEXTO && destino) destino->write('\n');
+        estado = TIPO;
+        inicioTexto = false;
+        reproduzindo = false;
+        valor = 0;
+        deslocamento = 0;
+    }
+
+    uint32_t seq = 0; // último decodificado
+
+private:
+    enum Estado : uint8_t { TIPO, SEQ, TIMESTAMP, DELTA_TIMESTAMP, TEXTO, TEMPO };
+
+    Print *destino;
+    Estado estado = TIPO;
+    bool compacto = false;
+    bool inicioTexto = false;
+    bool reproduzindo = false;
+    TextosRecentes recentes;
+    uint8_t resto[255];
+    size_t tamanhoResto = 0;
+    uint64_t valor = 0;
+    uint8_t deslocamento = 0;
+    long long timestamp = 0;
+};
+
+static void caminhoSegmento(char *caminho, size_t tamanho, uint32_t primeiroSeq)
+{
+    snprintf(caminho, tamanho, "%s/%08lx", HISTORICO_ARQUIVO_DIR, (unsigned long)primeiroSeq);
+}
+
+// Segmentos em ordem crescente de seq; 'tamanhos' opcional
+static uint8_t listarSegmentos(uint32_t *seqs, size_t *tamanhos)
+{
+    uint8_t n = 0;
+    Dir dir = LittleFS.openDir(HISTORICO_ARQUIVO_DIR);
+    while (dir.next() && n < HISTORICO_ARQUIVO_MAX_SEGMENTOS)
+    {
+        const uint32_t seq = strtoul(dir.fileName().c_str(), nullptr, 16);
+        const size_t tamanho = dir.fileSize();
+        uint8_t i = n++;
+        for (; i > 0 && seqs[i - 1] > seq; i--)
+        {
+            seqs[i] = seqs[i - 1];
+            if (tamanhos) tamanhos[i] = tamanhos[i - 1];
+        }
+        seqs[i] = seq;
+        if (tamanhos) tamanhos[i] = tamanho;
+    }
+    return n;
+}
+
+void arquivoHistoricoSetup()
+{
+    LittleFS.mkdir(HISTORICO_ARQUIVO_DIR);
+
+    uint32_t seqs[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    uint8_t n = listarSegmentos(seqs, nullptr);
+
+    DescompressorLz lz((const uint8_t *)DICIONARIO, TAMANHO_DICIONARIO);
+    while (n && lz.ok())
+    {
+        char caminho[32];
+        caminhoSegmento(caminho, sizeof(caminho), seqs[n - 1]);
+        File f = LittleFS.open(caminho, "r");
+        if (!f) return;
+
+        DecodificadorRegistros registros(nullptr);
+        const size_t completos = lz.descompactar(f, registros);
+        const size_t tamanho = f.size();
+        f.close();
+
+        if (completos == tamanho)
+        {
+            ultimoSeqArquivado = registros.seq;
+            return;
+        }
+
+        // queda de energia durante o anexo: o bloco incompleto sai
+        Serial.printf("[LOG] Segmento %s cortado em %u de %u bytes\n", caminho, (unsigned)completos, (unsigned)tamanho);
+        if (completos)
+        {
+            f = LittleFS.open(caminho, "r+");
+            const bool cortado = f && f.truncate(completos);
+            if (f) f.close();
+            if (cortado) continue; // relê para achar o último seq
+        }
+        LittleFS.remove(caminho);
+        n--;
+    }
+}
+
+uint32_t arquivoHistoricoUltimoSeq()
+{
+    return ultimoSeqArquivado;
+}
+
+void arquivoHistoricoLer(Print &saida, uint32_t desde)
+{
+    if (desde >= ultimoSeqArquivado) return;
+
+    uint32_t seqs[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    const uint8_t n = listarSegmentos(seqs, nullptr);
+
+    DescompressorLz lz((const uint8_t *)DICIONARIO, TAMANHO_DICIONARIO);
+    if (!lz.ok()) return;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        // segmento inteiro já visto pelo cliente: nem abre
+        if (i + 1 < n && seqs[i + 1] - 1 <= desde) continue;
+
+        char caminho[32];
+        caminhoSegmento(caminho, sizeof(caminho), seqs[i]);
+        File f = LittleFS.open(caminho, "r");
+        if (!f) continue;
+        DecodificadorRegistros registros(&saida);
+        lz.descompactar(f, registros);
+        registros.terminar();
+        f.close();
+    }
+}
+
+// ================== Gravação ==================
+ArquivamentoHistorico::ArquivamentoHistorico() : lz(arquivo, (const uint8_t *)DICIONARIO, TAMANHO_DICIONARIO)
+{
+    caminho[0] = '\0';
+}
+
+bool ArquivamentoHistorico::abrir(uint32_t primeiroSeq)
+{
+    uint32_t seqs[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    size_t tamanhos[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    const uint8_t n = listarSegmentos(seqs, tamanhos);
+
+    // continua no segmento mais novo enquanto ele não ocupa um bloco
+    if (n && tamanhos[n - 1] < HISTORICO_ARQUIVO_SEGMENTO_BYTES)
+    {
+        caminhoSegmento(caminho, sizeof(caminho), seqs[n - 1]);
+        tamanhoInicial = tamanhos[n - 1];
+    }
+    else
+    {
+        caminhoSegmento(caminho, sizeof(caminho), primeiroSeq ? primeiroSeq : ultimoSeqArquivado + 1);
+        tamanhoInicial = 0;
+    }
+
+    arquivo = LittleFS.open(caminho, "a");
+    if (!arquivo) return false;
+    metricasArquivoAberto();
+    return true;
+}
+
+// Resto da linha em 'destino', com os tempos absolutos trocados por delta
+// ao timestamp; retorna o tamanho (0 se não couber)
+static size_t montarResto(uint8_t *destino, size_t capacidade, const char *p, size_t n, long long timestamp)
+{
+    size_t inicio = 0, usado = 0;
+    for (size_t i = 0; i + 2 < n; i++)
+    {
+        if (p[i] != '"' || p[i + 1] != ':' || p[i + 2] == '0') continue;
+        long long valor;
+        const size_t digitos = lerInteiro(p + i + 2, n - i - 2, valor);
+        if (digitos < DIGITOS_TEMPO_MIN || (i + 2 + digitos < n && p[i + 2 + digitos] >= '0' && p[i + 2 + digitos] <= '9')) continue;
+
+        if (usado + i + 2 - inicio + 11 > capacidade) return 0;
+        memcpy(destino + usado, p + inicio, i + 2 - inicio);
+        usado += i + 2 - inicio;
+        destino[usado++] = MARCA_TEMPO;
+        usado += escreverVarint(destino + usado, zigzag(valor - timestamp));
+        inicio = i + 2 + digitos;
+        i = inicio - 1;
+    }
+    if (usado + n - inicio > capacidade) return 0;
+    memcpy(destino + usado, p + inicio, n - inicio);
+    return usado + n - inicio;
+}
+
+void ArquivamentoHistorico::adicionar(const char *linha, size_t n)
+{
+    if (!lz.ok() || !recentes.ok()) return;
+
+    uint32_t seq;
+    long long timestamp;
+    size_t prefixo;
+    uint8_t resto[HISTORICO_LINHA_MAX + 16];
+    size_t tamanhoResto = 0;
+    const bool compacta = lerPrefixo(linha, n, seq, timestamp, prefixo) && !memchr(linha, MARCA_TEMPO, n) &&
+                          prefixo < n && (uint8_t)linha[prefixo] >= 0x20 &&
+                          (tamanhoResto = montarResto(resto, sizeof(resto), linha + prefixo, n - prefixo, timestamp));
+    if (!arquivo && !abrir(compacta ? seq : 0)) return;
+
+    uint8_t campos[24];
+    size_t tamanho = 0;
+    if (!compacta)
+    {
+        campos[tamanho++] = REGISTRO_LINHA;
+        prefixo = 0;
+    }
+    else if (!seqAnterior || seq <= seqAnterior)
+    {
+        campos[tamanho++] = REGISTRO_ABSOLUTO;
+        recentes.limpar();
+        tamanho += escreverVarint(campos + tamanho, seq);
+        tamanho += escreverVarint(campos + tamanho, zigzag(timestamp));
+    }
+    else
+    {
+        tamanho += escreverVarint(campos, (uint64_t)(seq - seqAnterior) + 1);
+        tamanho += escreverVarint(campos + tamanho, zigzag(timestamp - timestampAnterior));
+    }
+    if (compacta)
+    {
+        seqAnterior = seq;
+        timestampAnterior = timestamp;
+    }
+
+    lz.escrever(campos, tamanho);
+    const int recente = compacta ? recentes.procurar(resto, tamanhoResto) : -1;
+    if (recente >= 0)
+    {
+        const uint8_t marca = MARCA_RECENTE + recente;
+        lz.escrever(&marca, 1);
+    }
+    else
+    {
+        if (compacta) lz.escrever(resto, tamanhoResto);
+        else lz.escrever((const uint8_t *)linha, n);
+        const uint8_t nl = '\n';
+        lz.escrever(&nl, 1);
+    }
+    if (compacta) recentes.usar(resto, tamanhoResto);
+    linhas++;
+}
+
+// Apaga os segmentos mais antigos até caber no orçamento (o mais novo fica)
+static void aplicarOrcamento()
+{
+    uint32_t seqs[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    size_t tamanhos[HISTORICO_ARQUIVO_MAX_SEGMENTOS];
+    const uint8_t n = listarSegmentos(seqs, tamanhos);
+
+    size_t total = 0;
+    for (uint8_t i = 0; i < n; i++) total += tamanhos[i];
+
+    for (uint8_t i = 0; i + 1 < n && (total > HISTORICO_ARQUIVO_MAX_BYTES || n - i >= HISTORICO_ARQUIVO_MAX_SEGMENTOS); i++)
+    {
+        char caminho[32];
+        caminhoSegmento(caminho, sizeof(caminho), seqs[i]);
+        LittleFS.remove(caminho);
+        total -= tamanhos[i];
+        Serial.printf("[LOG] Segmento %s do arquivo apagado (orçamento)\n", caminho);
+    }
+}
+
+ArquivamentoHistorico::~ArquivamentoHistorico()
+{
+    if (!arquivo) return;
+
+    lz.concluir();
+    arquivo.close();
+    armazenamentoContabilizar(HISTORICO_ARQUIVO_DIR, tamanhoInicial, lz.bytesGravados());
+    contadores.eventosArquivados += linhas;
+    if (seqAnterior > ultimoSeqArquivado) ultimoSeqArquivado = seqAnterior;
+
+    Serial.printf("[LOG] %u eventos arquivados em %s (%u bytes)\n", linhas, caminho, (unsigned)lz.bytesGravados());
+    aplicarOrcamento();
+}
@@ -0,0 +1,76 @@
+#ifndef ARQUIVO_HISTORICO_H
+#define ARQUIVO_HISTORICO_H
+#include <Arduino.h>
+#include <FS.h>
+#include "lz_historico.h"
+
+// Arquivo compactado do histórico. Cada compactação de HISTORICO_PATH anexa
+// as linhas descartadas, num bloco LZSS, ao segmento mais novo em
+// HISTORICO_ARQUIVO_DIR (nome = seq do primeiro evento, em hex). Antes do LZ
+// cada linha vira: varint seq/timestamp em delta + o resto do JSON (tempos
+// absolutos também em delta), ou um byte se o resto repete o de uma linha
+// recente; linhas fora desse formato vão inteiras. O LZ de cada bloco
+// começa com um dicionário dos textos fixos das mensagens do firmware.
+// Passando de HISTORICO_ARQUIVO_MAX_BYTES, os segmentos mais antigos são
+// apagados.
+
+// Corta um bloco interrompido no fim do segmento mais novo
+void arquivoHistoricoSetup();
+// seq do último evento arquivado (0 = arquivo vazio)
+uint32_t arquivoHistoricoUltimoSeq();
+
+// Escreve em 'saida' as linhas arquivadas com seq > desde (um '\n' por linha)
+void arquivoHistoricoLer(Print &saida, uint32_t desde);
+
+// Restos (já com os tempos em delta) das últimas linhas de um bloco, o mais
+// recente primeiro, em [tamanho][bytes] num bloco de
+// HISTORICO_ARQUIVO_RECENTES_BYTES. Uma linha com o resto igual ao de uma
+// delas vai como um byte. Codificador e decodificador fazem as mesmas
+// operações na mesma ordem: usar() a cada linha compactada, limpar() a cada
+// seq absoluto.
+class TextosRecentes
+{
+public:
+    TextosRecentes();
+    ~TextosRecentes();
+
+    bool ok() const { return bloco != nullptr; }
+    void limpar() { total = 0; }
+    uint8_t quantos() const { return total; }
+
+    // Posição do texto (-1 se não estiver)
+    int procurar(const uint8_t *texto, size_t n) const;
+    const uint8_t *texto(uint8_t posicao, size_t &n) const;
+    // Passa o texto para a frente (entra, se não estava). 'texto' não pode
+    // apontar para dentro do bloco.
+    void usar(const uint8_t *texto, size_t n);
+
+private:
+    uint8_t *bloco;
+    uint8_t total = 0;
+};
+
+// Um bloco novo no arquivo: adicionar() para cada linha, na ordem; o bloco é
+// fechado e o orçamento aplicado no destrutor
+class ArquivamentoHistorico
+{
+public:
+    ArquivamentoHistorico();
+    ~ArquivamentoHistorico();
+
+    void adicionar(const char *linha, size_t n);
+
+private:
+    bool abrir(uint32_t primeiroSeq);
+
+    File arquivo;
+    CompressorLz lz; // grava em 'arquivo'
+    TextosRecentes recentes;
+    char caminho[32];
+    size_t tamanhoInicial = 0;
+    uint16_t linhas = 0;
+    uint32_t seqAnterior = 0;
+    long long timestampAnterior = 0;
+};
+
+#endif
@@ -1,18 +1,406 @@
 #include "event_logger.h"
 #include <FS.h>
 #include <LittleFS.h>
+#include <ArduinoJson.h>
 #include <time.h>
 
-void registrarEvento(const String &mensagem)
+#include "system_config.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "arquivo_historico.h"
+
+static const size_t LINHA_MAX = HISTORICO_LINHA_MAX;
+
+static ObservadorEvento observadores[MAX_OBSERVADORES_EVENTOS];
+static uint8_t totalObservadores = 0;
+
+static uint32_t ultimoSeq = 0;
+static uint16_t linhasNoArquivo = 0;
+
+// Compactação que falhou (flash cheia, rename recusado): espera antes de
+// tentar de novo, dobrando até HISTORICO_COMPACTAR_ESPERA_MAX_MS
+static uint32_t esperaCompactacaoMs = 0;
+static uint32_t ultimaFalhaCompactacaoMs = 0;
+
+// Janela aberta de uma origem de eventos repetidos
+struct Agrupamento
+{
+    uint32_t origem;   // hash; 0 = livre
+    uint32_t inicioMs; // primeira ocorrência (gravada)
+    uint32_t ultimoMs;
+    time_t primeiraRepeticao;
+    time_t ultimaRepeticao;
+    uint16_t repeticoes;
+    char mensagem[EVENTO_MAX_CHARS];
+};
+static Agrupamento agrupamentos[EVENTOS_AGRUPAMENTOS];
+
+bool adicionarObservadorEventos(ObservadorEvento observador)
+{
+    if (totalObservadores >= MAX_OBSERVADORES_EVENTOS) return false;
+    observadores[totalObservadores++] = observador;
+    return true;
+}
+
+// Linha válida: {"seq":N,...} completa (linha cortada por queda de energia é ignorada)
+static uint32_t seqDaLinha(const char *linha, size_t n)
+{
+    if (n < 10 || strncmp(linha, "{\"seq\":", 7) != 0 || linha[n - 1] != '}') return 0;
+    return strtoul(linha + 7, nullptr, 10);
+}
+
+// Converte o /historico.json antigo (array) em linhas
+static void migrarHistoricoAntigo()
+{
+    File antigo = LittleFS.open(HISTORICO_ANTIGO_PATH, "r");
+    if (!antigo) return;
+
+    DynamicJsonDocument doc(4096);
+    const bool ok = !deserializeJson(doc, antigo) && doc.is<JsonArray>();
+    antigo.close();
+
+    File f = armazenamentoIniciarGravacao(HISTORICO_PATH);
+    if (ok && f)
+    {
+        uint32_t seq = 0;
+        for (JsonObject e : doc.as<JsonArray>())
+        {
+            e["seq"] = seq = e["seq"] | (seq + 1);
+            serializeJson(e, f);
+            f.print('\n');
+        }
+    }
+    armazenamentoConcluirGravacao(HISTORICO_PATH, f, ok);
+    LittleFS.remove(HISTORICO_ANTIGO_PATH);
+    Serial.println("[LOG] Histórico migrado para uma linha por evento");
+}
+
+void historicoSetup()
+{
+    if (!LittleFS.exists(HISTORICO_PATH)) migrarHistoricoAntigo();
+    arquivoHistoricoSetup();
+    ultimoSeq = arquivoHistoricoUltimoSeq();
+
+    File f = LittleFS.open(HISTORICO_PATH, "r");
+    if (!f) return;
+
+    char linha[LINHA_MAX];
+    f.setTimeout(0);
+    while (f.available())
+    {
+        const size_t n = f.readBytesUntil('\n', linha, sizeof(linha));
+        const uint32_t seq = seqDaLinha(linha, n);
+        if (seq > ultimoSeq) ultimoSeq = seq;
+        linhasNoArquivo++;
+    }
+
+    char ultimo = '\n';
+    if (f.size())
+    {
+        f.seek(f.size() - 1);
+        ultimo = f.read();
+    }
+    f.close();
+
+    // resto de uma escrita interrompida: isola numa linha própria
+    if (ultimo != '\n')
+    {
+        const uint8_t nl = '\n';
+        armazenamentoAnexar(HISTORICO_PATH, &nl, 1);
+    }
+}
+
+// Reescreve o arquivo só com os últimos HISTORICO_MAX_REGISTROS eventos;
+// os mais antigos vão para o arquivo compactado. Linhas já arquivadas por
+// uma tentativa anterior (regravação que falhou) não são arquivadas de novo.
+static bool compactarHistorico()
+{
+    armazenamentoDescarregar(HISTORICO_PATH);
+    File origem = LittleFS.open(HISTORICO_PATH, "r");
+    if (!origem) return false;
+    File destino = armazenamentoIniciarGravacao(HISTORICO_PATH);
+
+    char linha[LINHA_MAX];
+    origem.setTimeout(0);
+    uint16_t pular = linhasNoArquivo > HISTORICO_MAX_REGISTROS ? linhasNoArquivo - HISTORICO_MAX_REGISTROS : 0;
+    uint16_t mantidas = 0;
+    {
+        ArquivamentoHistorico arquivo;
+        const uint32_t arquivadoAte = arquivoHistoricoUltimoSeq();
+        while (pular && origem.available())
+        {
+            const size_t n = origem.readBytesUntil('\n', linha, sizeof(linha));
+            pular--;
+            if (seqDaLinha(linha, n) > arquivadoAte) arquivo.adicionar(linha, n);
+        }
+    }
+    while (origem.available())
+    {
+        const size_t n = origem.readBytesUntil('\n', linha, sizeof(linha));
+        if (!seqDaLinha(linha, n)) continue;
+        destino.write((const uint8_t *)linha, n);
+        destino.write('\n');
+        mantidas++;
+    }
+    origem.close();
+
+    if (!armazenamentoConcluirGravacao(HISTORICO_PATH, destino, (bool)destino)) return false;
+    linhasNoArquivo = mantidas;
+    return true;
+}
+
+void historicoLoop()
+{
+    if (linhasNoArquivo < 2 * HISTORICO_MAX_REGISTROS) return;
+    const uint32_t agoraMs = millis();
+    if (esperaCompactacaoMs && agoraMs - ultimaFalhaCompactacaoMs < esperaCompactacaoMs) return;
+
+    if (compactarHistorico())
+    {
+        esperaCompactacaoMs = 0;
+        return;
+    }
+    ultimaFalhaCompactacaoMs = agoraMs;
+    esperaCompactacaoMs = esperaCompactacaoMs ? esperaCompactacaoMs * 2 : HISTORICO_COMPACTAR_ESPERA_MS;
+    if (esperaCompactacaoMs > HISTORICO_COMPACTAR_ESPERA_MAX_MS) esperaCompactacaoMs = HISTORICO_COMPACTAR_ESPERA_MAX_MS;
+    Serial.printf("[LOG] Compactação do histórico falhou (%u linhas); nova tentativa em %lu s\n", linhasNoArquivo,
+                  (unsigned long)(esperaCompactacaoMs / 1000));
+}
+
+// Copia até "tamanho" bytes de origem sem partir um caractere UTF-8
+// (destino pode ser a própria origem)
+static void cortarTexto(char *destino, const char *origem, size_t tamanho)
+{
+    size_t n = strnlen(origem, tamanho + 1);
+    if (n > tamanho)
+    {
+        n = tamanho;
+        while (n > 0 && ((uint8_t)origem[n] & 0xC0) == 0x80) n--;
+    }
+    memmove(destino, origem, n);
+    destino[n] = '\0';
+}
+
+// Grava uma linha; "resumo" acrescenta os campos de um agrupamento
+static void gravarEvento(const char *mensagem, const Agrupamento *resumo)
+{
+    TemporizadorEscopo tempo(LAT_REGISTRAR_EVENTO);
+
+    const time_t agora = time(nullptr);
+
+    // seq continua do último registro: permite a clientes buscar só o que é novo
+    const uint32_t seq = ++ultimoSeq;
+
+    // o texto gravado (e passado aos observadores) é o que coube na linha
+    char texto[EVENTO_MAX_CHARS];
+    cortarTexto(texto, mensagem, sizeof(texto) - 1);
+
+    StaticJsonDocument<320> doc;
+    doc["seq"] = seq;
+    doc["timestamp"] = agora;
+    doc["evento"] = (const char *)texto;
+    if (resumo)
+    {
+        doc["repeticoes"] = resumo->repeticoes;
+        doc["primeiro"] = resumo->primeiraRepeticao;
+        doc["ultimo"] = resumo->ultimaRepeticao;
+    }
+
+    // Linha cortada não tem '}' e seqDaLinha a descartaria: com escapes
+    // demais, encurta o evento pelo excesso até a linha caber
+    size_t tamanho = measureJson(doc);
+    while (tamanho > LINHA_MAX - 1 && texto[0])
+    {
+        const size_t excesso = tamanho - (LINHA_MAX - 1);
+        const size_t atual = strlen(texto);
+        cortarTexto(texto, texto, atual > excesso ? atual - excesso : 0);
+        doc["evento"] = (const char *)texto;
+        tamanho = measureJson(doc);
+    }
+
+    char linha[LINHA_MAX];
+    size_t n = serializeJson(doc, linha, sizeof(linha) - 1);
+    linha[n++] = '\n';
+    armazenamentoAnexar(HISTORICO_PATH, (const uint8_t *)linha, n);
+
+    linhasNoArquivo++; // compactação fica para o historicoLoop, fora do tick
+
+    for (uint8_t i = 0; i < totalObservadores; i++) observadores[i](seq, agora, texto);
+}
+
+// ------------------------------------
+// Registra evento no histórico
+// ------------------------------------
+void registrarEvento(const char *mensagem)
+{
+    gravarEvento(mensagem, nullptr);
+}
+
+static uint32_t hashOrigem(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h ? h : 1;
+}
+
+// Resumo das repetições (se houve) e libera a entrada
+static void fecharAgrupamento(Agrupamento &a)
 {
-    File f = LittleFS.open("/historico.json", "a+");
+    if (a.repeticoes)
+    {
+        char texto[EVENTO_MAX_CHARS];
+        snprintf(texto, sizeof(texto), "%.*s (+%u repetições)",
+                 EVENTO_MAX_CHARS - 24, a.mensagem, a.repeticoes);
+        gravarEvento(texto, &a);
+    }
+    a.origem = 0;
+}
+
+void registrarEventoAgrupado(const char *origem, const char *formato, ...)
+{
+    char mensagem[EVENTO_MAX_CHARS];
+    va_list args;
+    va_start(args, formato);
+    vsnprintf(mensagem, sizeof(mensagem), formato, args);
+    va_end(args);
+
+    const uint32_t h = hashOrigem(origem);
+    const uint32_t agoraMs = millis();
+    Agrupamento *livre = nullptr;
+    Agrupamento *maisAntigo = &agrupamentos[0];
+
+    for (Agrupamento &a : agrupamentos)
+    {
+        if (a.origem == h)
+        {
+            if (agoraMs - a.ultimoMs < EVENTOS_JANELA_AGRUPAR_MS && agoraMs - a.inicioMs < EVENTOS_AGRUPAR_MAX_MS)
+            {
+                const time_t agora = time(nullptr);
+                if (!a.repeticoes) a.primeiraRepeticao = agora;
+                a.ultimaRepeticao = agora;
+                a.ultimoMs = agoraMs;
+                if (a.repeticoes < UINT16_MAX) a.repeticoes++;
+                contadores.eventosAgrupados++;
+                return;
+            }
+            fecharAgrupamento(a); // janela vencida: resumo e recomeça
+            livre = &a;
+            break;
+        }
+        if (!a.origem && !livre) livre = &a;
+        if (a.origem && (int32_t)(a.ultimoMs - maisAntigo->ultimoMs) < 0) maisAntigo = &a;
+    }
+
+    if (!livre)
+    {
+        fecharAgrupamento(*maisAntigo);
+        livre = maisAntigo;
+    }
+
+    livre->origem = h;
+    livre->inicioMs = livre->ultimoMs = agoraMs;
+    livre->repeticoes = 0;
+    strlcpy(livre->mensagem, mensagem, sizeof(livre->mensagem));
+    gravarEvento(mensagem, nullptr);
+}
+
+void eventosAgrupadosFecharTodos()
+{
+    for (Agrupamento &a : agrupamentos)
+        if (a.origem) fecharAgrupamento(a);
+}
+
+void eventosAgrupadosLoop()
+{
+    static uint32_t ultimaVerificacao = 0;
+    const uint32_t agoraMs = millis();
+    if (agoraMs - ultimaVerificacao < 1000) return;
+    ultimaVerificacao = agoraMs;
+
+    for (Agrupamento &a : agrupamentos)
+    {
+        if (a.origem && (agoraMs - a.ultimoMs >= EVENTOS_JANELA_AGRUPAR_MS ||
+                         agoraMs - a.inicioMs >= EVENTOS_AGRUPAR_MAX_MS))
+            fecharAgrupamento(a);
+    }
+}
+
+void registrarEventoF(const char *formato, ...)
+{
+    char buffer[EVENTO_MAX_CHARS];
+    va_list args;
+    va_start(args, formato);
+    vsnprintf(buffer, sizeof(buffer), formato, args);
+    va_end(args);
+    registrarEvento(buffer);
+}
+
+// Junta as linhas do arquivo com as do buffer de escrita: a gravação
+// alinhada à página pode ter deixado metade de uma linha em cada lado.
+// Também recebe as linhas que o arquivo compactado reconstrói.
+class SaidaHistorico : public Print
+{
+public:
+    SaidaHistorico(Print &saida, uint32_t desde) : saida(saida), desde(desde) {}
+
+    size_t write(uint8_t c) override
+    {
+        if (c == '\n') linhaCompleta();
+        else if (usados < sizeof(linha)) linha[usados++] = c;
+        return 1;
+    }
+    using Print::write;
+
+    void bytes(const char *p, size_t n)
+    {
+        while (n--) write((uint8_t)*p++);
+    }
+
+    void linhaCompleta()
+    {
+        // seq sempre crescente: descarta o que a compactação arquivou e não
+        // chegou a tirar do arquivo vivo (queda de energia no meio)
+        const uint32_t seq = seqDaLinha(linha, usados);
+        if (seq && seq > desde)
+        {
+            if (!primeiro) saida.print(',');
+            saida.write((const uint8_t *)linha, usados);
+            primeiro = false;
+            desde = seq;
+        }
+        usados = 0;
+    }
+
+private:
+    Print &saida;
+    uint32_t desde;
+    char linha[LINHA_MAX];
+    size_t usados = 0;
+    bool primeiro = true;
+};
+
+void historicoEscreverJson(Print &saida, uint32_t desde, bool incluirArquivo)
+{
+    saida.print('[');
+    SaidaHistorico historico(saida, desde);
+    if (incluirArquivo) arquivoHistoricoLer(historico, desde);
+
+    File f = LittleFS.open(HISTORICO_PATH, "r");
     if (f)
     {
-        time_t agora = time(nullptr);
-        char buffer[30];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&agora));
-        String linha = "{\"hora\":\"" + String(buffer) + "\",\"evento\":\"" + mensagem + "\"},\n";
-        f.print(linha);
+        char buf[128];
+        while (f.available())
+        {
+            const size_t n = f.read((uint8_t *)buf, sizeof(buf));
+            historico.bytes(buf, n);
+        }
         f.close();
     }
-}
\ No newline at end of file
+
+    size_t pendentes = 0;
+    const char *p = (const char *)armazenamentoPendente(HISTORICO_PATH, pendentes);
+    historico.bytes(p, pendentes);
+    historico.linhaCompleta();
+
+    saida.print(']');
+}
@@ -1,5 +1,52 @@
 #ifndef EVENT_LOGGER_H
 #define EVENT_LOGGER_H
 #include <Arduino.h>
-void registrarEvento(const String& mensagem);
-#endif
\ No newline at end of file
+
+// Tamanho máximo de uma mensagem montada por registrarEventoF
+#define EVENTO_MAX_CHARS 128
+
+// Maior linha do histórico com o '\n': campos de um resumo (seq, timestamp,
+// repeticoes, primeiro, ultimo: ~115 B) + evento com folga para escapes.
+// Evento que não cabe (aspas, controles) é encurtado, nunca a linha cortada.
+#define HISTORICO_LINHA_MAX (EVENTO_MAX_CHARS + 160)
+
+// Histórico em HISTORICO_PATH: uma linha {"seq","timestamp","evento"} por
+// evento, anexada pela camada de armazenamento (coalescida em RAM). O
+// arquivo é compactado para os últimos HISTORICO_MAX_REGISTROS quando passa
+// do dobro disso; os descartados vão para o arquivo compactado
+// (arquivo_historico.h).
+void historicoSetup();
+// Compactação pendente, fora do tick (registrarEvento só anexa); depois de
+// uma falha espera HISTORICO_COMPACTAR_ESPERA_MS, dobrando. Chamar do loop()
+void historicoLoop();
+
+void registrarEvento(const char *mensagem);
+inline void registrarEvento(const String &mensagem) { registrarEvento(mensagem.c_str()); }
+
+// Formata a mensagem num buffer fixo na pilha (sem concatenar String)
+void registrarEventoF(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+// Para eventos que se repetem (PIR oscilando, invasão em curso): a primeira
+// ocorrência de "origem" é gravada na hora; as seguintes, com intervalo menor
+// que EVENTOS_JANELA_AGRUPAR_MS, só são contadas. Ao fechar a janela (ou a
+// cada EVENTOS_AGRUPAR_MAX_MS, se não parar) sai um registro de resumo com
+// "repeticoes", "primeiro" e "ultimo". Uma origem gera no máximo 2 registros
+// por EVENTOS_AGRUPAR_MAX_MS, qualquer que seja a taxa de disparo.
+void registrarEventoAgrupado(const char *origem, const char *formato, ...) __attribute__((format(printf, 2, 3)));
+
+// Fecha janelas vencidas; chamar do loop()
+void eventosAgrupadosLoop();
+// Grava os resumos pendentes (antes de reiniciar)
+void eventosAgrupadosFecharTodos();
+
+// Escreve o histórico como array JSON (só eventos com seq > desde),
+// incluindo os que ainda estão no buffer de escrita; incluirArquivo
+// descompacta antes os eventos arquivados
+void historicoEscreverJson(Print &saida, uint32_t desde, bool incluirArquivo = false);
+
+// Módulos que querem reagir a cada evento gravado (MQTT, notificações...)
+#define MAX_OBSERVADORES_EVENTOS 4
+// seq: número sequencial do evento neste dispositivo (campo "seq" do histórico)
+typedef void (*ObservadorEvento)(uint32_t seq, time_t timestamp, const char *mensagem);
+bool adicionarObservadorEventos(ObservadorEvento observador);
+#endif
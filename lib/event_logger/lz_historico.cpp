@@ -0,0 +1,227 @@
+#include "lz_historico.h"
+
+// Entrada acumulada além da janela antes de codificar
+static const size_t LZ_BLOCO = 512;
+
+// ================== Compressor ==================
+CompressorLz::CompressorLz(Print &destino, const uint8_t *dicionario, size_t tamanhoDicionario)
+    : destino(destino), dicionario(dicionario),
+      tamanhoDicionario(tamanhoDicionario < LZ_JANELA ? tamanhoDicionario : LZ_JANELA)
+{
+    buf = (uint8_t *)malloc(LZ_JANELA + LZ_BLOCO);
+    grupo[0] = 0;
+    iniciarBloco();
+}
+
+// Janela só com o dicionário: referências a ele valem desde o primeiro byte
+void CompressorLz::iniciarBloco()
+{
+    if (!buf) return;
+    if (tamanhoDicionario) memcpy_P(buf, dicionario, tamanhoDicionario);
+    pos = fim = tamanhoDicionario;
+}
+
+CompressorLz::~CompressorLz()
+{
+    free(buf);
+}
+
+void CompressorLz::esvaziarGrupo()
+{
+    if (!itens) return;
+    const size_t n = 1 + itens + __builtin_popcount(grupo[0]);
+    destino.write(grupo, n);
+    gravados += n;
+    grupo[0] = 0;
+    itens = 0;
+}
+
+void CompressorLz::emitir(bool referencia, uint16_t valor)
+{
+    // posição livre no grupo: flag + 1 byte por literal, 2 por referência
+    size_t usados = 1 + itens + __builtin_popcount(grupo[0]);
+    if (referencia)
+    {
+        grupo[0] |= 1 << itens;
+        grupo[usados++] = valor >> 8;
+    }
+    grupo[usados] = valor & 0xFF;
+    if (++itens == 8) esvaziarGrupo();
+}
+
+// Maior repetição de buf[p..] na janela (busca linear da mais próxima para a
+// mais distante; para no comprimento máximo)
+size_t CompressorLz::procurar(size_t p, size_t &distancia) const
+{
+    const size_t disponivel = fim - p;
+    const size_t maximo = disponivel < LZ_MAX ? disponivel : LZ_MAX;
+    if (maximo < LZ_MIN) return 0;
+
+    const size_t inicio = p > LZ_JANELA ? p - LZ_JANELA : 0;
+    const uint8_t *atual = buf + p;
+    size_t melhor = 0;
+    for (size_t c = p; c-- > inicio;)
+    {
+        const uint8_t *candidato = buf + c;
+        if (candidato[0] != atual[0] || candidato[melhor] != atual[melhor]) continue;
+        size_t n = 1;
+        while (n < maximo && candidato[n] == atual[n]) n++;
+        if (n > melhor)
+        {
+            melhor = n;
+            distancia = p - c;
+            if (n == maximo) break;
+        }
+    }
+    return melhor;
+}
+
+// Codifica até 'limite'. Avaliação preguiçosa de um passo: se a repetição
+// que começa no byte seguinte é maior, este vai como literal.
+void CompressorLz::codificar(size_t limite)
+{
+    size_t distancia = 0;
+    size_t comprimento = procurar(pos, distancia);
+    while (pos < limite)
+    {
+        size_t proximaDistancia = 0;
+        const size_t proximo = comprimento >= LZ_MIN && comprimento < LZ_MAX ? procurar(pos + 1, proximaDistancia) : 0;
+
+        if (comprimento >= LZ_MIN && proximo <= comprimento)
+        {
+            emitir(true, (uint16_t)((distancia - 1) << LZ_BITS_COMPRIMENTO | (comprimento - LZ_MIN)));
+            pos += comprimento;
+            comprimento = pos < limite ? procurar(pos, distancia) : 0;
+            continue;
+        }
+
+        emitir(false, buf[pos++]);
+        if (proximo)
+        {
+            comprimento = proximo;
+            distancia = proximaDistancia;
+        }
+        else comprimento = pos < limite ? procurar(pos, distancia) : 0;
+    }
+}
+
+void CompressorLz::escrever(const uint8_t *dados, size_t n)
+{
+    if (!buf) return;
+    while (n)
+    {
+        size_t cabe = LZ_JANELA + LZ_BLOCO - fim;
+        if (cabe > n) cabe = n;
+        memcpy(buf + fim, dados, cabe);
+        fim += cabe;
+        dados += cabe;
+        n -= cabe;
+
+        if (fim < LZ_JANELA + LZ_BLOCO) continue;
+        // cheio: codifica deixando LZ_MAX de antecipação e descarta o que
+        // saiu da janela
+        codificar(fim - LZ_MAX);
+        const size_t descarte = pos - LZ_JANELA;
+        memmove(buf, buf + descarte, fim - descarte);
+        pos -= descarte;
+        fim -= descarte;
+    }
+}
+
+void CompressorLz::concluir()
+{
+    if (!buf) return;
+    codificar(fim);
+    emitir(true, LZ_CODIGO_FIM);
+    esvaziarGrupo();
+    iniciarBloco();
+}
+
+// ================== Descompressor ==================
+DescompressorLz::DescompressorLz(const uint8_t *dicionario, size_t tamanhoDicionario)
+    : dicionario(dicionario), tamanhoDicionario(tamanhoDicionario < LZ_JANELA ? tamanhoDicionario : LZ_JANELA)
+{
+    janela = (uint8_t *)malloc(LZ_JANELA);
+}
+
+DescompressorLz::~DescompressorLz()
+{
+    free(janela);
+}
+
+// Leitura de 'origem' em pedaços (File::read byte a byte passa pelo LittleFS)
+class LeitorBuffer
+{
+public:
+    explicit LeitorBuffer(Stream &origem) : origem(origem) {}
+
+    int proximo()
+    {
+        if (pos == usados)
+        {
+            usados = origem.readBytes(dados, sizeof(dados));
+            pos = 0;
+            if (!usados) return -1;
+        }
+        consumidos++;
+        return (uint8_t)dados[pos++];
+    }
+
+    size_t consumidos = 0;
+
+private:
+    Stream &origem;
+    char dados[64];
+    size_t usados = 0;
+    size_t pos = 0;
+};
+
+size_t DescompressorLz::descompactar(Stream &origem, Print &saida)
+{
+    if (!janela) return 0;
+
+    LeitorBuffer leitor(origem);
+    size_t completos = 0;
+    // cada bloco começa com o dicionário na janela, como no codificador
+    if (tamanhoDicionario) memcpy_P(janela, dicionario, tamanhoDicionario);
+    uint16_t p = tamanhoDicionario;
+    const uint16_t mascara = LZ_JANELA - 1;
+
+    for (;;)
+    {
+        const int flags = leitor.proximo();
+        if (flags < 0) return completos;
+
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            const int a = leitor.proximo();
+            if (a < 0) return completos;
+            if (!(flags & (1 << i)))
+            {
+                janela[p++ & mascara] = a;
+                saida.write((uint8_t)a);
+                continue;
+            }
+
+            const int b = leitor.proximo();
+            if (b < 0) return completos;
+            const uint16_t valor = a << 8 | b;
+            if ((valor & LZ_CODIGO_FIM) == LZ_CODIGO_FIM)
+            {
+                // fim do bloco: o resto do grupo não existe
+                completos = leitor.consumidos;
+                if (tamanhoDicionario) memcpy_P(janela, dicionario, tamanhoDicionario);
+                p = tamanhoDicionario;
+                break;
+            }
+
+            const uint16_t distancia = (valor >> LZ_BITS_COMPRIMENTO) + 1;
+            for (uint8_t n = (valor & LZ_CODIGO_FIM) + LZ_MIN; n; n--)
+            {
+                const uint8_t c = janela[(uint16_t)(p - distancia) & mascara];
+                janela[p++ & mascara] = c;
+                saida.write(c);
+            }
+        }
+    }
+}
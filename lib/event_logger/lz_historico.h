@@ -0,0 +1,72 @@
+#ifndef LZ_HISTORICO_H
+#define LZ_HISTORICO_H
+#include <Arduino.h>
+
+// LZSS em fluxo para o arquivo do histórico (mesma família do heatshrink).
+// Janela de LZ_JANELA bytes alocada só enquanto o codificador existe.
+// Cada bloco começa com a janela pré-carregada com o dicionário (em flash,
+// PROGMEM) que codificador e decodificador recebem: os blocos são pequenos e
+// sem ele os primeiros textos de cada um iriam quase todos como literais.
+//
+// Formato: um byte de flags (bit 0 primeiro) para cada 8 itens; flag 0 =
+// literal de 1 byte, flag 1 = referência de 2 bytes, big-endian:
+//   LZ_BITS_JANELA bits (distância - 1) | resto (comprimento - LZ_MIN)
+// O maior código de comprimento marca o fim do bloco.
+#ifndef LZ_BITS_JANELA
+#define LZ_BITS_JANELA 11
+#endif
+#define LZ_BITS_COMPRIMENTO (16 - LZ_BITS_JANELA)
+#define LZ_JANELA      (1 << LZ_BITS_JANELA)
+#define LZ_MIN         3
+#define LZ_CODIGO_FIM  ((1 << LZ_BITS_COMPRIMENTO) - 1)
+#define LZ_MAX         (LZ_MIN + LZ_CODIGO_FIM - 1)
+
+class CompressorLz
+{
+public:
+    CompressorLz(Print &destino, const uint8_t *dicionario = nullptr, size_t tamanhoDicionario = 0);
+    ~CompressorLz();
+
+    bool ok() const { return buf != nullptr; }
+    void escrever(const uint8_t *dados, size_t n);
+    // Codifica o que falta e grava o marcador de fim (a janela recomeça)
+    void concluir();
+    size_t bytesGravados() const { return gravados; }
+
+private:
+    void iniciarBloco();
+    size_t procurar(size_t p, size_t &distancia) const;
+    void codificar(size_t limite);
+    void emitir(bool referencia, uint16_t valor);
+    void esvaziarGrupo();
+
+    Print &destino;
+    const uint8_t *dicionario;
+    size_t tamanhoDicionario;
+    uint8_t *buf;     // LZ_JANELA de histórico + bloco de entrada
+    size_t fim = 0;   // bytes em buf
+    size_t pos = 0;   // próximo byte a codificar
+    uint8_t grupo[17];
+    uint8_t itens = 0;
+    size_t gravados = 0;
+};
+
+class DescompressorLz
+{
+public:
+    explicit DescompressorLz(const uint8_t *dicionario = nullptr, size_t tamanhoDicionario = 0);
+    ~DescompressorLz();
+
+    bool ok() const { return janela != nullptr; }
+    // Lê os blocos de 'origem' até o fim, entregando os bytes a 'saida'.
+    // Retorna quantos bytes de 'origem' formam blocos completos: menos que
+    // o tamanho do arquivo indica uma gravação interrompida no último.
+    size_t descompactar(Stream &origem, Print &saida);
+
+private:
+    const uint8_t *dicionario;
+    size_t tamanhoDicionario;
+    uint8_t *janela;
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "resumo_historico.h"
+#include <LittleFS.h>
+#include <time.h>
+#include "system_config.h"
+#include "armazenamento.h"
+
+static const uint32_t RESUMO_MAGICA = 0x52534D31; // "RSM1"
+
+struct ResumoSensor
+{
+    uint32_t chave; // hash de "zona/nome"; 0 = livre
+    uint32_t total; // alertas desde que entrou na tabela
+    uint8_t alertas[RESUMO_DIAS]; // satura em 255/dia
+};
+
+struct Resumo
+{
+    uint32_t magica;
+    int32_t diaHoje; // dias desde 1970-01-01 (data local); 0 = hora ainda não válida
+    uint16_t armes[RESUMO_DIAS];
+    uint16_t desarmes[RESUMO_DIAS];
+    uint16_t minutosArmado[RESUMO_DIAS];
+    ResumoSensor sensores[RESUMO_MAX_SENSORES];
+};
+
+static Resumo resumo;
+static bool alterado = false;
+static uint32_t ultimaGravacaoMs = 0;
+
+// Dias civis <-> número do dia (algoritmo de H. Hinnant)
+static int32_t diasDesdeEpoca(int ano, unsigned mes, unsigned dia)
+{
+    ano -= mes <= 2;
+    const int era = (ano >= 0 ? ano : ano - 399) / 400;
+    const unsigned ae = (unsigned)(ano - era * 400);
+    const unsigned ad = (153 * (mes + (mes > 2 ? -3 : 9)) + 2) / 5 + dia - 1;
+    const unsigned ea = ae * 365 + ae / 4 - ae / 100 + ad;
+    return era * 146097 + (int32_t)ea - 719468;
+}
+
+static void dataDoDia(int32_t z, char *buf, size_t tamanho)
+{
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned de = (unsigned)(z - era * 146097);
+    const unsigned ae = (de - de / 1460 + de / 36524 - de / 146096) / 365;
+    const unsigned ad = de - (365 * ae + ae / 4 - ae / 100);
+    const unsigned mp = (5 * ad + 2) / 153;
+    const unsigned dia = ad - (153 * mp + 2) / 5 + 1;
+    const unsigned mes = mp < 10 ? mp + 3 : mp - 9;
+    const int ano = (int)ae + era * 400 + (mes <= 2);
+    snprintf(buf, tamanho, "%04d-%02u-%02u", ano, mes, dia);
+}
+
+static unsigned slot(int32_t dia) { return (unsigned)(((dia % RESUMO_DIAS) + RESUMO_DIAS) % RESUMO_DIAS); }
+
+static void zerarSlot(unsigned s)
+{
+    resumo.armes[s] = resumo.desarmes[s] = resumo.minutosArmado[s] = 0;
+    for (ResumoSensor &r : resumo.sensores) r.alertas[s] = 0;
+}
+
+// Avança o anel até o dia local de hoje; devolve o slot de hoje
+static unsigned slotHoje()
+{
+    const time_t agora = time(nullptr);
+    if (agora < 1700000000) return slot(resumo.diaHoje); // sem NTP: conta no dia corrente
+
+    struct tm t;
+    localtime_r(&agora, &t);
+    const int32_t hoje = diasDesdeEpoca(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+    if (hoje == resumo.diaHoje) return slot(hoje);
+
+    if (resumo.diaHoje == 0)
+    {
+        // primeiro dia com hora válida: o que foi contado antes é de hoje
+        const unsigned s = slot(hoje);
+        if (s != 0)
+        {
+            resumo.armes[s] = resumo.armes[0];
+            resumo.desarmes[s] = resumo.desarmes[0];
+            resumo.minutosArmado[s] = resumo.minutosArmado[0];
+            for (ResumoSensor &r : resumo.sensores) r.alertas[s] = r.alertas[0];
+            zerarSlot(0);
+        }
+    }
+    else if (hoje > resumo.diaHoje)
+    {
+        const int32_t passos = hoje - resumo.diaHoje < RESUMO_DIAS ? hoje - resumo.diaHoje : RESUMO_DIAS;
+        for (int32_t i = 1; i <= passos; i++) zerarSlot(slot(resumo.diaHoje + i));
+    }
+    // hoje < diaHoje (relógio voltou): adota o dia novo sem apagar nada
+
+    resumo.diaHoje = hoje;
+    alterado = true;
+    return slot(hoje);
+}
+
+static uint32_t chaveSensor(const char *zona, const char *nome)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = zona; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    h = (h ^ '/') * 16777619u;
+    for (const char *p = nome; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    return h ? h : 1;
+}
+
+static ResumoSensor *buscar(uint32_t chave)
+{
+    for (ResumoSensor &r : resumo.sensores)
+        if (r.chave == chave) return &r;
+    return nullptr;
+}
+
+void resumoSetup()
+{
+    File f = LittleFS.open(RESUMO_PATH, "r");
+    const bool ok = f && f.read((uint8_t *)&resumo, sizeof(resumo)) == sizeof(resumo) &&
+                    resumo.magica == RESUMO_MAGICA;
+    if (f) f.close();
+    if (!ok)
+    {
+        memset(&resumo, 0, sizeof(resumo));
+        resumo.magica = RESUMO_MAGICA;
+    }
+}
+
+void resumoAlerta(const Sensor &sensor)
+{
+    const unsigned s = slotHoje();
+    const uint32_t chave = chaveSensor(sensor.getZona(), sensor.getNome());
+
+    ResumoSensor *r = buscar(chave);
+    if (!r)
+    {
+        // entrada livre ou, com a tabela cheia, a de menos alertas
+        r = &resumo.sensores[0];
+        for (ResumoSensor &e : resumo.sensores)
+        {
+            if (!e.chave) { r = &e; break; }
+            if (e.total < r->total) r = &e;
+        }
+        memset(r, 0, sizeof(*r));
+        r->chave = chave;
+    }
+
+    r->total++;
+    if (r->alertas[s] < 255) r->alertas[s]++;
+    alterado = true;
+}
+
+void resumoArmado()
+{
+    const unsigned s = slotHoje();
+    if (resumo.armes[s] < UINT16_MAX) resumo.armes[s]++;
+    alterado = true;
+}
+
+void resumoDesarmado()
+{
+    const unsigned s = slotHoje();
+    if (resumo.desarmes[s] < UINT16_MAX) resumo.desarmes[s]++;
+    alterado = true;
+}
+
+void resumoGravar()
+{
+    if (!alterado) return;
+    if (armazenamentoGravar(RESUMO_PATH, (const uint8_t *)&resumo, sizeof(resumo))) alterado = false;
+    ultimaGravacaoMs = millis();
+}
+
+void resumoLoop(bool armado)
+{
+    static uint32_t ultimoMinutoMs = 0;
+    const uint32_t agora = millis();
+
+    if (agora - ultimoMinutoMs >= 60000)
+    {
+        ultimoMinutoMs = agora;
+        if (armado)
+        {
+            const unsigned s = slotHoje();
+            if (resumo.minutosArmado[s] < 24 * 60) resumo.minutosArmado[s]++;
+            alterado = true;
+        }
+    }
+
+    if (alterado && agora - ultimaGravacaoMs >= RESUMO_GRAVAR_MS) resumoGravar();
+}
+
+// Série de RESUMO_DIAS valores, do dia mais antigo para hoje
+template <typename T>
+static void escreverSerie(Print &saida, const T *valores)
+{
+    saida.print('[');
+    for (int32_t i = 0; i < RESUMO_DIAS; i++)
+    {
+        if (i) saida.print(',');
+        saida.print((unsigned long)valores[slot(resumo.diaHoje - (RESUMO_DIAS - 1) + i)]);
+    }
+    saida.print(']');
+}
+
+static void escreverTexto(Print &saida, const char *texto)
+{
+    // nomes vêm da config validada (sem aspas/barras); escapa por garantia
+    saida.print('"');
+    for (const char *p = texto; *p; p++)
+    {
+        if (*p == '"' || *p == '\\') saida.print('\\');
+        saida.print(*p);
+    }
+    saida.print('"');
+}
+
+void resumoEscreverJson(Print &saida, Faixa<Zona> zonas)
+{
+    slotHoje(); // vira o dia mesmo sem eventos hoje
+
+    char data[12];
+    dataDoDia(resumo.diaHoje - (RESUMO_DIAS - 1), data, sizeof(data));
+    saida.printf("{\"dias\":%d,\"inicio\":\"%s\",", RESUMO_DIAS, data);
+    dataDoDia(resumo.diaHoje, data, sizeof(data));
+    saida.printf("\"hoje\":\"%s\",\"hora_valida\":%s,", data, resumo.diaHoje ? "true" : "false");
+
+    saida.print("\"armes\":");
+    escreverSerie(saida, resumo.armes);
+    saida.print(",\"desarmes\":");
+    escreverSerie(saida, resumo.desarmes);
+    saida.print(",\"minutos_armado\":");
+    escreverSerie(saida, resumo.minutosArmado);
+
+    saida.print(",\"zonas\":[");
+    bool primeiraZona = true;
+    for (const Zona &zona : zonas)
+    {
+        uint16_t porDia[RESUMO_DIAS] = {0};
+        uint32_t total = 0;
+
+        if (!primeiraZona) saida.print(',');
+        primeiraZona = false;
+        saida.print("{\"nome\":");
+        escreverTexto(saida, zona.getNome());
+        saida.print(",\"sensores\":[");
+
+        bool primeiroSensor = true;
+        for (const Sensor &sensor : zona.getSensores())
+        {
+            const ResumoSensor *r = buscar(chaveSensor(zona.getNome(), sensor.getNome()));
+            if (!primeiroSensor) saida.print(',');
+            primeiroSensor = false;
+            saida.print("{\"nome\":");
+            escreverTexto(saida, sensor.getNome());
+            saida.printf(",\"total\":%lu,\"alertas\":", (unsigned long)(r ? r->total : 0));
+            if (r)
+            {
+                escreverSerie(saida, r->alertas);
+                total += r->total;
+                for (unsigned s = 0; s < RESUMO_DIAS; s++) porDia[s] += r->alertas[s];
+            }
+            else
+            {
+                static const uint8_t SEM_ALERTAS[RESUMO_DIAS] = {0};
+                escreverSerie(saida, SEM_ALERTAS);
+            }
+            saida.print('}');
+        }
+        saida.printf("],\"total\":%lu,\"alertas\":", (unsigned long)total);
+        escreverSerie(saida, porDia);
+        saida.print('}');
+    }
+    saida.print("]}");
+}
@@ -0,0 +1,29 @@
+#ifndef RESUMO_HISTORICO_H
+#define RESUMO_HISTORICO_H
+
+#include <Arduino.h>
+#include "zona.h"
+#include "faixa.h"
+
+// Agregados do histórico mantidos a cada evento (O(1)), para não varrer o log:
+// por dia, nos últimos RESUMO_DIAS dias (anel indexado pelo dia local):
+//   - alertas por sensor (zona = soma dos seus sensores, calculada ao servir)
+//   - armes, desarmes e minutos armado
+// Sensores são identificados por hash de "zona/nome": o resumo sobrevive a
+// reinícios e a recargas da config. Gravado em RESUMO_PATH (binário, ~1,5 KB)
+// no máximo a cada RESUMO_GRAVAR_MS.
+void resumoSetup();
+
+void resumoAlerta(const Sensor &sensor);
+void resumoArmado();
+void resumoDesarmado();
+
+// Minutos armado e gravação periódica; chamar do loop()
+void resumoLoop(bool armado);
+// Grava já se houver mudança (antes de reiniciar)
+void resumoGravar();
+
+// /historico/resumo.json: tamanho limitado pelas tabelas, não pelo histórico
+void resumoEscreverJson(Print &saida, Faixa<Zona> zonas);
+
+#endif
@@ -0,0 +1,9 @@
+#include "identidade.h"
+#include <Arduino.h>
+
+const char *identidadeDispositivo()
+{
+    static char id[16] = "";
+    if (!id[0]) snprintf(id, sizeof(id), "alarme-%06x", ESP.getChipId());
+    return id;
+}
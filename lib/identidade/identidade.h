@@ -0,0 +1,11 @@
+#ifndef IDENTIDADE_H
+#define IDENTIDADE_H
+
+// Identificador desta placa, único na frota: "alarme-<chip id em hex>".
+// O HOSTNAME ("alarme") é o mesmo em todas as centrais e serve só para o
+// mDNS; o que precisa distinguir uma central da outra (tópicos MQTT, origem
+// dos pacotes P2P, chaves de idempotência das notificações) parte daqui,
+// a não ser que a config do módulo dê um nome próprio.
+const char *identidadeDispositivo();
+
+#endif
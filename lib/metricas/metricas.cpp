@@ -0,0 +1,97 @@
+#include "metricas.h"
+
+const uint32_t HistogramaLatencia::LIMITES_US[HistogramaLatencia::NUM_BALDES] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 250000};
+
+HistogramaLatencia histogramas[LAT_TOTAL];
+ContadoresSistema contadores;
+
+static const char *const NOMES_LATENCIA[LAT_TOTAL] = {
+    "loop", "tick_alarme", "http", "registrar_evento"};
+
+void HistogramaLatencia::registrar(uint32_t us)
+{
+    uint8_t i = 0;
+    while (i < NUM_BALDES && us > LIMITES_US[i]) i++;
+    baldes[i]++;
+    contagem++;
+    somaUs += us;
+    if (us > maxUs) maxUs = us;
+}
+
+// Print do core não tem %llu confiável: converte na mão
+static void imprimirU64(Print &out, uint64_t v)
+{
+    char buf[21];
+    char *p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do
+    {
+        *--p = '0' + (v % 10);
+        v /= 10;
+    } while (v);
+    out.print(p);
+}
+
+static void escreverContador(Print &out, const char *nome, const char *tipo, uint32_t valor)
+{
+    out.printf("# TYPE %s %s\n%s %u\n", nome, tipo, nome, valor);
+}
+
+void metricasEscreverPrometheus(Print &out)
+{
+    // ---- Latências ----
+    out.print("# TYPE alarme_latencia_us histogram\n");
+    for (uint8_t m = 0; m < LAT_TOTAL; m++)
+    {
+        const HistogramaLatencia &h = histogramas[m];
+        const char *fase = NOMES_LATENCIA[m];
+
+        uint32_t acumulado = 0;
+        for (uint8_t i = 0; i < HistogramaLatencia::NUM_BALDES; i++)
+        {
+            acumulado += h.baldes[i];
+            out.printf("alarme_latencia_us_bucket{fase=\"%s\",le=\"%u\"} %u\n",
+                       fase, HistogramaLatencia::LIMITES_US[i], acumulado);
+        }
+        out.printf("alarme_latencia_us_bucket{fase=\"%s\",le=\"+Inf\"} %u\n", fase, h.contagem);
+        out.printf("alarme_latencia_us_sum{fase=\"%s\"} ", fase);
+        imprimirU64(out, h.somaUs);
+        out.printf("\nalarme_latencia_us_count{fase=\"%s\"} %u\n", fase, h.contagem);
+    }
+
+    out.print("# TYPE alarme_latencia_max_us gauge\n");
+    for (uint8_t m = 0; m < LAT_TOTAL; m++)
+    {
+        out.printf("alarme_latencia_max_us{fase=\"%s\"} %u\n", NOMES_LATENCIA[m], histogramas[m].maxUs);
+    }
+
+    // ---- Heap ----
+    escreverContador(out, "alarme_heap_livre_bytes", "gauge", ESP.getFreeHeap());
+    escreverContador(out, "alarme_heap_maior_bloco_bytes", "gauge", ESP.getMaxFreeBlockSize());
+    escreverContador(out, "alarme_heap_fragmentacao_pct", "gauge", ESP.getHeapFragmentation());
+
+    // ---- Flash ----
+    escreverContador(out, "alarme_flash_bytes_escritos_total", "counter", contadores.flashBytesEscritos);
+    escreverContador(out, "alarme_flash_arquivos_abertos_total", "counter", contadores.flashArquivosAbertos);
+
+    // ---- Rede ----
+    escreverContador(out, "alarme_wifi_desconexoes_total", "counter", contadores.wifiDesconexoes);
+    escreverContador(out, "alarme_wifi_tentativas_reconexao_total", "counter", contadores.wifiTentativasReconexao);
+    escreverContador(out, "alarme_ntp_falhas_total", "counter", contadores.ntpFalhas);
+    escreverContador(out, "alarme_mqtt_eventos_publicados_total", "counter", contadores.mqttEventosPublicados);
+    escreverContador(out, "alarme_mqtt_eventos_descartados_total", "counter", contadores.mqttEventosDescartados);
+    escreverContador(out, "alarme_p2p_recebidos_total", "counter", contadores.p2pRecebidos);
+    escreverContador(out, "alarme_p2p_rejeitados_total", "counter", contadores.p2pRejeitados);
+    escreverContador(out, "alarme_loop_travamentos_total", "counter", contadores.loopTravamentos);
+    escreverContador(out, "alarme_http_rejeitadas_total", "counter", contadores.httpRejeitadas);
+    escreverContador(out, "alarme_http_bloqueios_login_total", "counter", contadores.httpBloqueiosLogin);
+    escreverContador(out, "alarme_eventos_agrupados_total", "counter", contadores.eventosAgrupados);
+    escreverContador(out, "alarme_eventos_arquivados_total", "counter", contadores.eventosArquivados);
+    escreverContador(out, "alarme_notificacoes_enviadas_total", "counter", contadores.notificacoesEnviadas);
+    escreverContador(out, "alarme_notificacoes_falhas_total", "counter", contadores.notificacoesFalhas);
+    escreverContador(out, "alarme_notificacoes_descartadas_total", "counter", contadores.notificacoesDescartadas);
+    escreverContador(out, "alarme_notificacoes_duplicadas_total", "counter", contadores.notificacoesDuplicadas);
+
+    escreverContador(out, "alarme_uptime_segundos", "gauge", millis() / 1000);
+}
@@ -0,0 +1,75 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <Arduino.h>
+
+// Histograma de latência com baldes fixos (µs). Sem alocação: registrar()
+// custa uma leitura de micros() e uma busca linear em 10 limites.
+struct HistogramaLatencia
+{
+    static const uint8_t NUM_BALDES = 10;
+    static const uint32_t LIMITES_US[NUM_BALDES];
+
+    uint32_t baldes[NUM_BALDES + 1]; // último balde = +Inf
+    uint32_t contagem;
+    uint64_t somaUs;
+    uint32_t maxUs;
+
+    void registrar(uint32_t us);
+};
+
+enum MetricaLatencia : uint8_t
+{
+    LAT_LOOP,
+    LAT_TICK_ALARME,
+    LAT_HTTP,
+    LAT_REGISTRAR_EVENTO,
+    LAT_TOTAL
+};
+
+extern HistogramaLatencia histogramas[LAT_TOTAL];
+
+// Mede o tempo do escopo e registra no histograma ao sair
+class TemporizadorEscopo
+{
+public:
+    explicit TemporizadorEscopo(MetricaLatencia m) : hist(histogramas[m]), inicio(micros()) {}
+    ~TemporizadorEscopo() { hist.registrar(micros() - inicio); }
+
+private:
+    HistogramaLatencia &hist;
+    uint32_t inicio;
+};
+
+// Contadores globais (incrementados direto por quem faz a operação)
+struct ContadoresSistema
+{
+    uint32_t flashBytesEscritos;
+    uint32_t flashArquivosAbertos;
+    uint32_t wifiDesconexoes;
+    uint32_t wifiTentativasReconexao;
+    uint32_t ntpFalhas;
+    uint32_t mqttEventosPublicados;
+    uint32_t mqttEventosDescartados;
+    uint32_t p2pRecebidos;
+    uint32_t p2pRejeitados;
+    uint32_t loopTravamentos;
+    uint32_t httpRejeitadas;      // 429 do limitador
+    uint32_t httpBloqueiosLogin;  // IPs bloqueados por senha errada
+    uint32_t eventosAgrupados;    // repetições contadas sem gravar (registrarEventoAgrupado)
+    uint32_t eventosArquivados;   // eventos movidos para o arquivo compactado
+    uint32_t notificacoesEnviadas;
+    uint32_t notificacoesFalhas;       // tentativas (cada uma conta)
+    uint32_t notificacoesDescartadas;  // desistência, validade ou fila cheia
+    uint32_t notificacoesDuplicadas;   // texto repetido dentro de NOTIF_DEDUP_MS
+};
+
+extern ContadoresSistema contadores;
+
+inline void metricasArquivoAberto() { contadores.flashArquivosAbertos++; }
+inline void metricasBytesEscritos(size_t n) { contadores.flashBytesEscritos += n; }
+
+// Escreve todas as métricas no formato texto do Prometheus (/metrics)
+void metricasEscreverPrometheus(Print &out);
+
+#endif
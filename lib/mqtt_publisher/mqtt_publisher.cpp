@@ -0,0 +1,310 @@
+#include "mqtt_publisher.h"
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+#include "system_config.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "alarme.h"
+#include "pool_modelo.h"
+#include "config_sensores.h"
+#include "identidade.h"
+#include "sessao_mqtt.h"
+
+// o evento já coube numa linha do histórico, que tem mais campos
+static const size_t MQTT_LINHA_MAX = HISTORICO_LINHA_MAX;
+
+static WiFiClient rede;
+static SessaoMqtt sessao(rede);
+
+static Alarme *alarmePtr = nullptr;
+static bool habilitado = false;
+static char host[64];
+static uint16_t porta = MQTT_PORTA_PADRAO;
+static char usuario[32];
+static char senha[32];
+static char base[48]; // alarme/<id>
+
+static IPAddress ipBroker; // resolvido uma vez (DNS também bloqueia)
+static bool ipResolvido = false;
+
+static unsigned long proximaConexaoMs = 0;
+static unsigned long esperaReconexaoMs = MQTT_RECONEXAO_MS;
+static bool sessaoIniciada = false;  // CONNECT enviado
+static bool sessaoAnunciada = false; // "online" e estado retido já enviados nesta sessão
+
+// publicação do outbox aguardando o PUBACK: bytes da linha (com o '\n')
+static size_t linhaEmVoo = 0;
+
+// posição do próximo evento a publicar dentro do outbox
+static uint32_t offsetOutbox = 0;
+static bool outboxPendente = false; // evita abrir o arquivo a cada loop quando vazio
+
+// último estado publicado (para só publicar mudanças)
+static uint32_t geracaoPublicada = 0;
+static int8_t estadoAlarmePublicado = -1;
+static int8_t modoPublicado = -1;
+static int8_t zonaPublicada[CONFIG_MAX_SENSORES];
+
+static void carregarConfig()
+{
+    habilitado = false;
+
+    File f = LittleFS.open(MQTT_CONFIG_PATH, "r");
+    if (!f)
+    {
+        Serial.println("[MQTT] Sem /mqtt.json: publicação desativada");
+        return;
+    }
+
+    StaticJsonDocument<256> doc;
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+    if (err)
+    {
+        Serial.println("[MQTT] /mqtt.json inválido: publicação desativada");
+        return;
+    }
+
+    strlcpy(host, doc["host"] | "", sizeof(host));
+    porta = doc["porta"] | MQTT_PORTA_PADRAO;
+    strlcpy(usuario, doc["usuario"] | "", sizeof(usuario));
+    strlcpy(senha, doc["senha"] | "", sizeof(senha));
+    // "id": nome desta central nos tópicos; sem ele, o chip id (único na frota)
+    const char *id = doc["id"] | "";
+    snprintf(base, sizeof(base), "alarme/%s", id[0] ? id : identidadeDispositivo());
+    habilitado = host[0] != '\0';
+}
+
+// Observador do event_logger: grava o evento no fim do outbox
+static void enfileirarEvento(uint32_t seq, time_t timestamp, const char *mensagem)
+{
+    if (!habilitado) return;
+
+    StaticJsonDocument<256> doc;
+    doc["seq"] = seq;
+    doc["ts"] = (uint32_t)timestamp;
+    doc["evento"] = mensagem;
+
+    // linha cortada iria para o broker como JSON inválido
+    if (measureJson(doc) > MQTT_LINHA_MAX - 1)
+    {
+        contadores.mqttEventosDescartados++;
+        return;
+    }
+    char linha[MQTT_LINHA_MAX];
+    size_t n = serializeJson(doc, linha, sizeof(linha) - 1);
+    linha[n++] = '\n';
+
+    if (armazenamentoTamanho(MQTT_OUTBOX_PATH) + n > MQTT_OUTBOX_MAX_BYTES)
+    {
+        // fila cheia: preserva os eventos antigos (os primeiros da invasão)
+        contadores.mqttEventosDescartados++;
+        return;
+    }
+    // coalescido em RAM enquanto offline; vai para a flash em lotes
+    if (armazenamentoAnexar(MQTT_OUTBOX_PATH, (const uint8_t *)linha, n)) outboxPendente = true;
+}
+
+static void publicarEstado()
+{
+    // teste de caminhada: a central não deve ver as violações do teste
+    if (alarmePtr->emTesteCaminhada()) return;
+
+    const int8_t estado = alarmePtr->getEstado() == Alarme::Estado::ARMADO ? 1 : 0;
+    const int8_t modo = alarmePtr->getModo() == Alarme::Modo::AUTOMATICO ? 1 : 0;
+    char topico[96];
+
+    if (estado != estadoAlarmePublicado || modo != modoPublicado)
+    {
+        char payload[64];
+        snprintf(topico, sizeof(topico), "%s/status", base);
+        snprintf(payload, sizeof(payload), "{\"estado\":\"%s\",\"modo\":\"%s\"}",
+                 estado ? "ARMADO" : "DESARMADO", modo ? "AUTOMATICO" : "MANUAL");
+        if (!sessao.publicar(topico, payload, true, false, millis())) return;
+        estadoAlarmePublicado = estado;
+        modoPublicado = modo;
+    }
+
+    // config recarregada: republica todas as zonas
+    if (geracaoPublicada != poolModelo.getGeracao())
+    {
+        memset(zonaPublicada, -1, sizeof(zonaPublicada));
+        geracaoPublicada = poolModelo.getGeracao();
+    }
+
+    uint8_t i = 0;
+    for (const Zona &zona : alarmePtr->getZonas())
+    {
+        const int8_t violada = zona.estaViolada() ? 1 : 0;
+        if (violada != zonaPublicada[i])
+        {
+            snprintf(topico, sizeof(topico), "%s/zona/%s", base, zona.getNome());
+            if (!sessao.publicar(topico, violada ? "VIOLADA" : "OK", true, false, millis())) return;
+            zonaPublicada[i] = violada;
+        }
+        if (++i >= CONFIG_MAX_SENSORES) break;
+    }
+}
+
+// Publica um evento do outbox (o mais antigo ainda não confirmado). O offset
+// só avança no PUBACK, lido num loop seguinte; sessão caída = a linha volta.
+static void publicarProximoEvento()
+{
+    if (linhaEmVoo)
+    {
+        if (!sessao.confirmada()) return;
+        offsetOutbox += linhaEmVoo;
+        linhaEmVoo = 0;
+        contadores.mqttEventosPublicados++;
+    }
+    if (!outboxPendente) return;
+
+    // conectado: o que está no buffer de escrita precisa estar no arquivo
+    armazenamentoDescarregar(MQTT_OUTBOX_PATH);
+
+    File f = LittleFS.open(MQTT_OUTBOX_PATH, "r");
+    if (!f)
+    {
+        outboxPendente = false;
+        return;
+    }
+
+    if (offsetOutbox >= f.size())
+    {
+        // tudo confirmado pelo broker: esvazia a fila
+        f.close();
+        armazenamentoRemover(MQTT_OUTBOX_PATH);
+        offsetOutbox = 0;
+        outboxPendente = false;
+        return;
+    }
+
+    char linha[MQTT_LINHA_MAX];
+    f.setTimeout(0);
+    f.seek(offsetOutbox);
+    const size_t n = f.readBytesUntil('\n', linha, sizeof(linha) - 1);
+    f.close();
+    linha[n] = '\0';
+
+    if (n == 0)
+    {
+        offsetOutbox += 1;
+        return;
+    }
+
+    char topico[64];
+    snprintf(topico, sizeof(topico), "%s/eventos", base);
+    if (sessao.publicar(topico, linha, false, true, millis())) linhaEmVoo = n + 1;
+}
+
+// Abre o TCP e manda o CONNECT; o CONNACK chega num loop seguinte.
+// O connect() do WiFiClient é o único ponto que ainda espera: no máximo
+// MQTT_CONEXAO_TIMEOUT_MS, e só quando o broker não responde (recusa é imediata).
+static void conectar()
+{
+    if (!ipResolvido && !ipBroker.fromString(host))
+    {
+        if (WiFi.hostByName(host, ipBroker, MQTT_CONEXAO_TIMEOUT_MS) != 1)
+        {
+            Serial.printf("[MQTT] Não resolveu %s\n", host);
+            return;
+        }
+    }
+    ipResolvido = true;
+
+    if (!rede.connect(ipBroker, porta))
+    {
+        Serial.printf("[MQTT] Falha ao conectar em %s:%u\n", host, porta);
+        ipResolvido = false; // o IP pode ter mudado
+        return;
+    }
+    rede.setNoDelay(true);
+
+    char topico[64];
+    snprintf(topico, sizeof(topico), "%s/online", base);
+    SessaoMqtt::Opcoes opcoes = {identidadeDispositivo(), usuario, senha, topico, "0",
+                                 MQTT_KEEPALIVE_S, MQTT_PRAZO_RESPOSTA_MS};
+    sessaoIniciada = sessao.iniciar(opcoes, millis());
+}
+
+// CONNACK recebido: anuncia a central e força republicar todo o estado retido
+static void anunciarSessao()
+{
+    char topico[64];
+    snprintf(topico, sizeof(topico), "%s/online", base);
+    if (!sessao.publicar(topico, "1", true, false, millis())) return;
+
+    Serial.printf("[MQTT] Conectado em %s:%u\n", host, porta);
+    sessaoAnunciada = true;
+    esperaReconexaoMs = MQTT_RECONEXAO_MS;
+    estadoAlarmePublicado = -1;
+    modoPublicado = -1;
+    geracaoPublicada = 0;
+}
+
+void mqtt_setup(Alarme *alarme)
+{
+    alarmePtr = alarme;
+
+    adicionarObservadorEventos(enfileirarEvento);
+    outboxPendente = LittleFS.exists(MQTT_OUTBOX_PATH); // sobra de antes do reinício
+    mqtt_recarregar_config();
+}
+
+void mqtt_recarregar_config()
+{
+    sessao.encerrar("config alterada");
+    linhaEmVoo = 0;
+    sessaoIniciada = false;
+    sessaoAnunciada = false;
+    ipResolvido = false;
+
+    carregarConfig();
+    proximaConexaoMs = millis();
+    esperaReconexaoMs = MQTT_RECONEXAO_MS;
+    if (!habilitado) return;
+
+    rede.setTimeout(MQTT_CONEXAO_TIMEOUT_MS);
+    Serial.printf("[MQTT] Broker %s:%u, tópicos em %s/\n", host, porta, base);
+}
+
+void mqtt_loop(bool wifiConectado)
+{
+    if (!habilitado || !wifiConectado) return;
+
+    const unsigned long agora = millis();
+    if (sessao.getEstado() == SessaoMqtt::Estado::DESCONECTADA)
+    {
+        if (sessaoIniciada)
+        {
+            Serial.printf("[MQTT] Sessão encerrada: %s\n", sessao.getMotivo());
+            sessaoIniciada = false;
+            sessaoAnunciada = false;
+            linhaEmVoo = 0; // reenviada na próxima sessão
+        }
+        if ((int32_t)(agora - proximaConexaoMs) < 0) return;
+
+        // broker fora do ar: espaça as tentativas até MQTT_RECONEXAO_MAX_MS
+        proximaConexaoMs = agora + esperaReconexaoMs;
+        esperaReconexaoMs = esperaReconexaoMs * 2 > MQTT_RECONEXAO_MAX_MS ? MQTT_RECONEXAO_MAX_MS
+                                                                          : esperaReconexaoMs * 2;
+        conectar();
+        return;
+    }
+
+    sessao.processar(agora);
+    if (sessao.getEstado() != SessaoMqtt::Estado::CONECTADA) return;
+
+    if (!sessaoAnunciada)
+    {
+        anunciarSessao();
+        return;
+    }
+    publicarEstado();
+    publicarProximoEvento();
+}
+
+bool mqtt_conectado() { return habilitado && sessao.getEstado() == SessaoMqtt::Estado::CONECTADA; }
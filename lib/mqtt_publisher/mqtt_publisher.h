@@ -0,0 +1,31 @@
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <Arduino.h>
+
+class Alarme;
+
+// Publica estado e eventos do alarme num broker MQTT.
+// /mqtt.json: {"host":..,"porta":1883,"usuario":..,"senha":..,"id":..}
+// Tópicos (base = alarme/<id>; "id" do /mqtt.json ou identidadeDispositivo()):
+//   <base>/online        retido, "1"/"0" (LWT)
+//   <base>/status        retido, {"estado":..,"modo":..}
+//   <base>/zona/<nome>   retido, "OK" / "VIOLADA"
+//   <base>/eventos       QoS1, {"seq":..,"ts":..,"evento":..} na ordem em que foram registrados
+// Os eventos passam sempre pela fila em flash (MQTT_OUTBOX_PATH), o que garante
+// a ordem e sobrevive a quedas de WiFi/broker e a reinícios. Entrega "pelo menos
+// uma vez": após um reinício, eventos já confirmados e ainda na fila são reenviados.
+void mqtt_setup(Alarme *alarme);
+
+// Relê MQTT_CONFIG_PATH (após POST /mqtt.json) e reconecta
+void mqtt_recarregar_config();
+
+// Chamado do loop(). Nunca espera o broker: CONNACK e PUBACK são lidos em
+// chamadas seguintes (SessaoMqtt) e um evento da fila por vez aguarda a
+// confirmação. Só a abertura do TCP espera, até MQTT_CONEXAO_TIMEOUT_MS, com
+// as tentativas espaçadas de MQTT_RECONEXAO_MS até MQTT_RECONEXAO_MAX_MS.
+void mqtt_loop(bool wifiConectado);
+
+bool mqtt_conectado();
+
+#endif
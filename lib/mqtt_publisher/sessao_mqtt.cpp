@@ -0,0 +1,258 @@
+#include "sessao_mqtt.h"
+#include <string.h>
+
+// Tipos de pacote (MQTT 3.1.1, seção 2.2.1)
+static const uint8_t TIPO_CONNECT = 0x10;
+static const uint8_t TIPO_CONNACK = 0x20;
+static const uint8_t TIPO_PUBLISH = 0x30;
+static const uint8_t TIPO_PUBACK = 0x40;
+static const uint8_t TIPO_PINGREQ = 0xC0;
+static const uint8_t TIPO_PINGRESP = 0xD0;
+static const uint8_t TIPO_DISCONNECT = 0xE0;
+
+enum : uint8_t { LER_TIPO, LER_TAMANHO, LER_CORPO };
+
+// "Remaining length": 7 bits por byte, bit 7 = continua
+static size_t escreverTamanho(uint8_t *p, uint32_t n)
+{
+    size_t i = 0;
+    do
+    {
+        uint8_t b = n & 0x7F;
+        n >>= 7;
+        p[i++] = n ? (b | 0x80) : b;
+    } while (n);
+    return i;
+}
+
+static size_t tamanhoDoTamanho(uint32_t n) { return n < 128 ? 1 : n < 16384 ? 2 : 3; }
+
+static size_t escreverTexto(uint8_t *p, const char *s, size_t n)
+{
+    p[0] = n >> 8;
+    p[1] = n & 0xFF;
+    memcpy(p + 2, s, n);
+    return n + 2;
+}
+
+bool SessaoMqtt::iniciar(const Opcoes &opcoes, uint32_t agoraMs)
+{
+    agora = agoraMs;
+    const size_t id = strlen(opcoes.clientId);
+    const size_t wt = strlen(opcoes.willTopico), wp = strlen(opcoes.willPayload);
+    const size_t us = strlen(opcoes.usuario), se = us ? strlen(opcoes.senha) : 0;
+
+    const uint32_t resto = 10 + 2 + id + 2 + wt + 2 + wp + (us ? 2 + us + 2 + se : 0);
+    const size_t total = 1 + tamanhoDoTamanho(resto) + resto;
+    if (total > sizeof(pacote))
+    {
+        encerrar("CONNECT grande demais");
+        return false;
+    }
+
+    uint8_t *p = pacote;
+    *p++ = TIPO_CONNECT;
+    p += escreverTamanho(p, resto);
+    p += escreverTexto(p, "MQTT", 4);
+    *p++ = 4; // 3.1.1
+    // clean session, will QoS1 retido, usuário/senha
+    *p++ = 0x02 | 0x04 | 0x08 | 0x20 | (us ? 0xC0 : 0);
+    *p++ = opcoes.keepAliveS >> 8;
+    *p++ = opcoes.keepAliveS & 0xFF;
+    p += escreverTexto(p, opcoes.clientId, id);
+    p += escreverTexto(p, opcoes.willTopico, wt);
+    p += escreverTexto(p, opcoes.willPayload, wp);
+    if (us)
+    {
+        p += escreverTexto(p, opcoes.usuario, us);
+        p += escreverTexto(p, opcoes.senha, se);
+    }
+
+    prazoRespostaMs = opcoes.prazoRespostaMs;
+    keepAliveMs = opcoes.keepAliveS * 1000UL;
+    idAguardado = 0;
+    foiConfirmada = false;
+    pingPendente = false;
+    etapa = LER_TIPO;
+    codigoConnack = 0;
+    motivo = "";
+
+    estado = Estado::AGUARDANDO_CONNACK;
+    inicioMs = agoraMs;
+    return enviar(total);
+}
+
+void SessaoMqtt::processar(uint32_t agoraMs)
+{
+    agora = agoraMs;
+    if (estado == Estado::DESCONECTADA) return;
+
+    // só o que já está no buffer do TCP
+    int disponivel = rede.available();
+    while (disponivel-- > 0 && estado != Estado::DESCONECTADA)
+    {
+        const int c = rede.read();
+        if (c < 0) break;
+        consumir((uint8_t)c);
+    }
+    if (estado == Estado::DESCONECTADA) return;
+
+    if (!rede.connected())
+    {
+        encerrar("conexão fechada pelo broker");
+        return;
+    }
+
+    if (estado == Estado::AGUARDANDO_CONNACK)
+    {
+        if (agoraMs - inicioMs >= prazoRespostaMs) encerrar("sem CONNACK");
+        return;
+    }
+
+    if (idAguardado && agoraMs - publicadoMs >= prazoRespostaMs)
+    {
+        // a reconexão reenvia a mesma publicação
+        encerrar("sem PUBACK");
+        return;
+    }
+    if (pingPendente)
+    {
+        if (agoraMs - pingMs >= prazoRespostaMs) encerrar("sem PINGRESP");
+        return;
+    }
+    if (keepAliveMs && agoraMs - ultimoEnvioMs >= keepAliveMs / 2 && rede.availableForWrite() >= 2)
+    {
+        pacote[0] = TIPO_PINGREQ;
+        pacote[1] = 0;
+        if (!enviar(2)) return;
+        pingPendente = true;
+        pingMs = agoraMs;
+    }
+}
+
+bool SessaoMqtt::publicar(const char *topico, const char *payload, bool retido, bool acompanhar, uint32_t agoraMs)
+{
+    agora = agoraMs;
+    if (estado != Estado::CONECTADA || (acompanhar && idAguardado)) return false;
+
+    const size_t tt = strlen(topico), tp = strlen(payload);
+    const uint32_t resto = 2 + tt + 2 + tp;
+    const size_t total = 1 + tamanhoDoTamanho(resto) + resto;
+    if (total > sizeof(pacote) || rede.availableForWrite() < (int)total) return false;
+
+    const uint16_t id = proximoId;
+    proximoId = proximoId == 0xFFFF ? 1 : proximoId + 1;
+
+    uint8_t *p = pacote;
+    *p++ = TIPO_PUBLISH | 0x02 | (retido ? 0x01 : 0); // QoS1
+    p += escreverTamanho(p, resto);
+    p += escreverTexto(p, topico, tt);
+    *p++ = id >> 8;
+    *p++ = id & 0xFF;
+    memcpy(p, payload, tp);
+
+    if (!enviar(total)) return false;
+    if (acompanhar)
+    {
+        idAguardado = id;
+        publicadoMs = agoraMs;
+    }
+    return true;
+}
+
+bool SessaoMqtt::confirmada()
+{
+    const bool c = foiConfirmada;
+    foiConfirmada = false;
+    return c;
+}
+
+void SessaoMqtt::encerrar(const char *porque)
+{
+    if (estado == Estado::DESCONECTADA) return;
+    if (estado == Estado::CONECTADA && rede.connected() && rede.availableForWrite() >= 2)
+    {
+        const uint8_t disconnect[2] = {TIPO_DISCONNECT, 0};
+        rede.write(disconnect, sizeof(disconnect));
+    }
+    rede.stop();
+    estado = Estado::DESCONECTADA;
+    motivo = porque;
+    idAguardado = 0;
+    foiConfirmada = false;
+}
+
+bool SessaoMqtt::enviar(size_t n)
+{
+    if (rede.write(pacote, n) != n)
+    {
+        encerrar("falha ao escrever no TCP");
+        return false;
+    }
+    ultimoEnvioMs = agora;
+    return true;
+}
+
+void SessaoMqtt::consumir(uint8_t c)
+{
+    switch (etapa)
+    {
+    case LER_TIPO:
+        cabecalho = c;
+        restante = 0;
+        deslocamento = 0;
+        etapa = LER_TAMANHO;
+        break;
+
+    case LER_TAMANHO:
+        restante |= (uint32_t)(c & 0x7F) << deslocamento;
+        deslocamento += 7;
+        if (c & 0x80)
+        {
+            if (deslocamento > 21) encerrar("pacote malformado");
+            break;
+        }
+        lidos = 0;
+        if (restante == 0) tratarPacote();
+        else etapa = LER_CORPO;
+        break;
+
+    case LER_CORPO:
+        if (lidos < sizeof(corpo)) corpo[lidos] = c;
+        if (++lidos == restante) tratarPacote();
+        break;
+    }
+}
+
+void SessaoMqtt::tratarPacote()
+{
+    etapa = LER_TIPO;
+    switch (cabecalho & 0xF0)
+    {
+    case TIPO_CONNACK:
+        if (estado != Estado::AGUARDANDO_CONNACK || restante < 2) return;
+        codigoConnack = corpo[1];
+        if (codigoConnack != 0)
+        {
+            encerrar("CONNACK recusado");
+            return;
+        }
+        estado = Estado::CONECTADA;
+        break;
+
+    case TIPO_PUBACK:
+        if (restante >= 2 && idAguardado && ((corpo[0] << 8) | corpo[1]) == idAguardado)
+        {
+            idAguardado = 0;
+            foiConfirmada = true;
+        }
+        break;
+
+    case TIPO_PINGRESP:
+        pingPendente = false;
+        break;
+
+    default:
+        break; // sem assinaturas: nada mais interessa
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef SESSAO_MQTT_H
+#define SESSAO_MQTT_H
+
+#include <Client.h>
+#include <stdint.h>
+
+// Sessão MQTT 3.1.1 sobre um Client com o TCP já aberto, sem nenhuma espera:
+// CONNECT, CONNACK, PUBLISH QoS1, PUBACK, PINGREQ e DISCONNECT. As respostas
+// do broker são lidas em processar(), a cada loop, e cada etapa tem um prazo
+// (CONNACK, PUBACK, PINGRESP) depois do qual a sessão é encerrada.
+//
+// No máximo uma publicação fica "aguardando PUBACK" (a fila de eventos só
+// avança depois da confirmação); as demais vão em QoS1 sem acompanhamento.
+// Um pacote só é escrito se couber inteiro no buffer de envio do TCP, então
+// write() nunca espera o broker.
+//
+// Só usa a interface Client do Arduino: a mesma sessão roda no host contra o
+// broker de teste (tools/mqtt_teste).
+class SessaoMqtt
+{
+public:
+    static const size_t PACOTE_MAX = 384; // tópico + payload + cabeçalhos
+
+    enum class Estado : uint8_t
+    {
+        DESCONECTADA,
+        AGUARDANDO_CONNACK,
+        CONECTADA
+    };
+
+    struct Opcoes
+    {
+        const char *clientId;
+        const char *usuario;     // "" = sem usuário/senha
+        const char *senha;
+        const char *willTopico;  // retido, QoS1
+        const char *willPayload;
+        uint16_t keepAliveS;
+        uint32_t prazoRespostaMs;
+    };
+
+    explicit SessaoMqtt(Client &rede) : rede(rede) {}
+
+    // Envia o CONNECT (clean session). false = não coube ou o TCP caiu.
+    bool iniciar(const Opcoes &opcoes, uint32_t agoraMs);
+
+    // Lê o que chegou, trata as respostas e os prazos. Não bloqueia.
+    void processar(uint32_t agoraMs);
+
+    // QoS1. 'acompanhar' = esta é a publicação que aguarda o PUBACK (só uma
+    // por vez). false = agora não dá (sem sessão, ocupada ou sem espaço no TCP).
+    bool publicar(const char *topico, const char *payload, bool retido, bool acompanhar, uint32_t agoraMs);
+
+    // A publicação acompanhada recebeu o PUBACK (consome a confirmação)
+    bool confirmada();
+    bool aguardandoPuback() const { return idAguardado != 0; }
+
+    // DISCONNECT (se conectada) e fecha o TCP
+    void encerrar(const char *motivo);
+
+    Estado getEstado() const { return estado; }
+    uint8_t getCodigoConnack() const { return codigoConnack; }
+    // Por que a última sessão acabou (para o log)
+    const char *getMotivo() const { return motivo; }
+
+private:
+    bool enviar(size_t n);
+    void consumir(uint8_t c);
+    void tratarPacote();
+
+    Client &rede;
+    Estado estado = Estado::DESCONECTADA;
+    const char *motivo = "";
+    uint8_t codigoConnack = 0;
+
+    uint32_t agora = 0;
+    uint32_t prazoRespostaMs = 0;
+    uint32_t keepAliveMs = 0;
+    uint32_t inicioMs = 0;       // CONNECT enviado
+    uint32_t ultimoEnvioMs = 0;  // para o PINGREQ
+    uint32_t publicadoMs = 0;    // publicação acompanhada
+    uint32_t pingMs = 0;
+    bool pingPendente = false;
+
+    uint16_t proximoId = 1;
+    uint16_t idAguardado = 0;
+    bool foiConfirmada = false;
+
+    // Leitura incremental de um pacote recebido (só os 4 primeiros bytes do
+    // corpo interessam: CONNACK, PUBACK; o resto é descartado)
+    uint8_t etapa = 0;
+    uint8_t cabecalho = 0;
+    uint8_t deslocamento = 0;
+    uint32_t restante = 0;
+    uint32_t lidos = 0;
+    uint8_t corpo[4];
+
+    uint8_t pacote[PACOTE_MAX];
+};
+
+#endif
@@ -0,0 +1,602 @@
+#include "notificacoes.h"
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <time.h>
+
+#include "system_config.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "identidade.h"
+
+enum class TipoDestino : uint8_t
+{
+    WEBHOOK,
+    SMTP
+};
+
+struct Destino
+{
+    TipoDestino tipo;
+    char host[48];
+    uint16_t porta;
+    char caminho[64]; // webhook
+    char de[48];      // smtp
+    char para[48];
+    char usuario[32];
+    char senha[32];
+    char filtros[NOTIF_MAX_FILTROS][16];
+    uint8_t totalFiltros; // 0 = todos os eventos
+    IPAddress ip;
+    bool resolvido;
+    uint8_t falhasSeguidas;
+    bool circuitoAberto;
+    uint32_t abertoAteMs;
+};
+
+struct Notificacao
+{
+    uint32_t seq; // 0 = livre
+    time_t timestamp;
+    uint32_t criadaMs;
+    uint8_t pendentes; // bit por destino
+    uint8_t tentativas[NOTIF_MAX_DESTINOS];
+    uint32_t proximaMs[NOTIF_MAX_DESTINOS];
+    char mensagem[EVENTO_MAX_CHARS];
+};
+
+struct Recente
+{
+    uint32_t hash;
+    uint32_t ms;
+};
+
+enum class Etapa : uint8_t
+{
+    LIVRE,
+    HTTP_STATUS,
+    SMTP_SAUDACAO,
+    SMTP_EHLO,
+    SMTP_AUTH,
+    SMTP_AUTH_USUARIO,
+    SMTP_AUTH_SENHA,
+    SMTP_MAIL,
+    SMTP_RCPT,
+    SMTP_DATA,
+    SMTP_CORPO
+};
+
+enum class Resultado : uint8_t
+{
+    ENTREGUE,
+    FALHA_TEMPORARIA,
+    FALHA_DEFINITIVA
+};
+
+// Conversa em andamento (uma por vez)
+struct Sessao
+{
+    Etapa etapa;
+    uint8_t destino;
+    uint8_t indice; // em fila[]
+    uint32_t inicioMs;
+    char linha[128]; // resposta do servidor, linha a linha
+    uint8_t usados;
+};
+
+static Destino destinos[NOTIF_MAX_DESTINOS];
+static uint8_t totalDestinos = 0;
+static Notificacao fila[NOTIF_FILA];
+static Recente recentes[NOTIF_DEDUP_ENTRADAS];
+static uint8_t proximoRecente = 0;
+static Sessao sessao;
+static WiFiClient cliente;
+
+// ================== Configuração ==================
+static bool lerUrl(const char *url, Destino &d)
+{
+    if (strncmp(url, "http://", 7) != 0) return false;
+    const char *host = url + 7;
+    const char *caminho = strchr(host, '/');
+    const char *fimHost = caminho ? caminho : host + strlen(host);
+    const char *porta = (const char *)memchr(host, ':', fimHost - host);
+
+    const size_t tamanhoHost = (porta ? porta : fimHost) - host;
+    if (!tamanhoHost || tamanhoHost >= sizeof(d.host)) return false;
+    memcpy(d.host, host, tamanhoHost);
+    d.host[tamanhoHost] = '\0';
+    d.porta = porta ? atoi(porta + 1) : 80;
+    strlcpy(d.caminho, caminho ? caminho : "/", sizeof(d.caminho));
+    return d.porta != 0;
+}
+
+static bool lerDestino(JsonObjectConst o, Destino &d)
+{
+    d = Destino();
+    const char *tipo = o["tipo"] | "";
+    if (strcmp(tipo, "webhook") == 0)
+    {
+        d.tipo = TipoDestino::WEBHOOK;
+        if (!lerUrl(o["url"] | "", d)) return false;
+    }
+    else if (strcmp(tipo, "smtp") == 0)
+    {
+        d.tipo = TipoDestino::SMTP;
+        strlcpy(d.host, o["host"] | "", sizeof(d.host));
+        d.porta = o["porta"] | 25;
+        strlcpy(d.de, o["de"] | "", sizeof(d.de));
+        strlcpy(d.para, o["para"] | "", sizeof(d.para));
+        strlcpy(d.usuario, o["usuario"] | "", sizeof(d.usuario));
+        strlcpy(d.senha, o["senha"] | "", sizeof(d.senha));
+        if (!d.host[0] || !d.de[0] || !d.para[0]) return false;
+    }
+    else return false;
+
+    JsonArrayConst filtros = o["filtro"];
+    if (filtros.isNull())
+    {
+        strlcpy(d.filtros[0], "[ALERTA]", sizeof(d.filtros[0]));
+        d.totalFiltros = 1;
+    }
+    for (JsonVariantConst f : filtros)
+    {
+        if (d.totalFiltros >= NOTIF_MAX_FILTROS) break;
+        strlcpy(d.filtros[d.totalFiltros++], f | "", sizeof(d.filtros[0]));
+    }
+    return true;
+}
+
+static void carregarConfig()
+{
+    totalDestinos = 0;
+
+    File f = LittleFS.open(NOTIF_CONFIG_PATH, "r");
+    if (!f) return;
+
+    DynamicJsonDocument doc(NOTIF_CONFIG_MAX_BYTES);
+    const DeserializationError err = deserializeJson(doc, f);
+    f.close();
+    if (err)
+    {
+        Serial.println("[NOTIF] /notificacoes.json inválido: notificações desativadas");
+        return;
+    }
+
+    for (JsonObjectConst o : doc["destinos"].as<JsonArrayConst>())
+    {
+        if (totalDestinos >= NOTIF_MAX_DESTINOS) break;
+        if (lerDestino(o, destinos[totalDestinos]))
+        {
+            const Destino &d = destinos[totalDestinos++];
+            Serial.printf("[NOTIF] Destino %u: %s %s:%u\n", totalDestinos - 1,
+                          d.tipo == TipoDestino::WEBHOOK ? "webhook" : "smtp", d.host, d.porta);
+        }
+        else Serial.println("[NOTIF] Destino inválido ignorado");
+    }
+}
+
+// ================== Fila ==================
+static bool aceita(const Destino &d, const char *mensagem)
+{
+    if (!d.totalFiltros) return true;
+    for (uint8_t i = 0; i < d.totalFiltros; i++)
+        if (strncmp(mensagem, d.filtros[i], strlen(d.filtros[i])) == 0) return true;
+    return false;
+}
+
+static uint32_t hashTexto(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h ? h : 1;
+}
+
+// Mesmo texto há pouco tempo (sensor oscilando entre janelas de agrupamento,
+// placa P2P repetindo): não notifica de novo
+static bool repetida(const char *mensagem)
+{
+    const uint32_t h = hashTexto(mensagem);
+    const uint32_t agora = millis();
+    for (const Recente &r : recentes)
+        if (r.hash == h && agora - r.ms < NOTIF_DEDUP_MS) return true;
+
+    recentes[proximoRecente] = {h, agora};
+    proximoRecente = (proximoRecente + 1) % NOTIF_DEDUP_ENTRADAS;
+    return false;
+}
+
+static void liberar(Notificacao &n)
+{
+    if (n.pendentes) contadores.notificacoesDescartadas++;
+    n.seq = 0;
+    n.pendentes = 0;
+}
+
+// Observador do event_logger: só copia para a fila (roda dentro do tick)
+static void observarEvento(uint32_t seq, time_t timestamp, const char *mensagem)
+{
+    uint8_t pendentes = 0;
+    for (uint8_t i = 0; i < totalDestinos; i++)
+        if (aceita(destinos[i], mensagem)) pendentes |= 1 << i;
+    if (!pendentes) return;
+
+    if (repetida(mensagem))
+    {
+        contadores.notificacoesDuplicadas++;
+        return;
+    }
+
+    // vaga livre; senão sai a mais antiga (a da conversa em andamento fica)
+    Notificacao *vaga = nullptr;
+    for (uint8_t i = 0; i < NOTIF_FILA; i++)
+    {
+        Notificacao &n = fila[i];
+        if (!n.seq)
+        {
+            vaga = &n;
+            break;
+        }
+        if (sessao.etapa != Etapa::LIVRE && sessao.indice == i) continue;
+        if (!vaga || n.seq < vaga->seq) vaga = &n;
+    }
+    if (!vaga) return;
+    liberar(*vaga);
+
+    memset(vaga, 0, sizeof(*vaga));
+    vaga->seq = seq;
+    vaga->timestamp = timestamp;
+    vaga->criadaMs = millis();
+    vaga->pendentes = pendentes;
+    for (uint32_t &ms : vaga->proximaMs) ms = vaga->criadaMs;
+    strlcpy(vaga->mensagem, mensagem, sizeof(vaga->mensagem));
+}
+
+// ================== Entrega ==================
+static uint32_t espera(uint8_t tentativas)
+{
+    uint32_t ms = NOTIF_ESPERA_INICIAL_MS;
+    for (uint8_t i = 1; i < tentativas && ms < NOTIF_ESPERA_MAX_MS; i++) ms *= 2;
+    if (ms > NOTIF_ESPERA_MAX_MS) ms = NOTIF_ESPERA_MAX_MS;
+    // sorteio: destinos que caíram juntos não voltam todos no mesmo loop
+    return ms + random(ms / 4 + 1);
+}
+
+static void concluir(Resultado resultado, const char *motivo)
+{
+    cliente.stop();
+    sessao.etapa = Etapa::LIVRE;
+
+    Destino &d = destinos[sessao.destino];
+    Notificacao &n = fila[sessao.indice];
+    const uint8_t bit = 1 << sessao.destino;
+
+    if (resultado == Resultado::ENTREGUE)
+    {
+        n.pendentes &= ~bit;
+        d.falhasSeguidas = 0;
+        if (d.circuitoAberto) Serial.printf("[NOTIF] Destino %u: circuito fechado\n", sessao.destino);
+        d.circuitoAberto = false;
+        contadores.notificacoesEnviadas++;
+        Serial.printf("[NOTIF] Evento %lu entregue ao destino %u\n", (unsigned long)n.seq, sessao.destino);
+    }
+    else
+    {
+        contadores.notificacoesFalhas++;
+        Serial.printf("[NOTIF] Destino %u, evento %lu: %s\n", sessao.destino, (unsigned long)n.seq, motivo);
+
+        if (resultado == Resultado::FALHA_DEFINITIVA || ++n.tentativas[sessao.destino] >= NOTIF_MAX_TENTATIVAS)
+        {
+            n.pendentes &= ~bit;
+            contadores.notificacoesDescartadas++;
+        }
+        else n.proximaMs[sessao.destino] = millis() + espera(n.tentativas[sessao.destino]);
+
+        // só falha de rede/servidor fora do ar conta para o disjuntor
+        if (resultado == Resultado::FALHA_TEMPORARIA && ++d.falhasSeguidas >= NOTIF_DISJUNTOR_FALHAS)
+        {
+            if (!d.circuitoAberto) Serial.printf("[NOTIF] Destino %u: circuito aberto\n", sessao.destino);
+            d.circuitoAberto = true;
+            d.abertoAteMs = millis() + NOTIF_DISJUNTOR_ABERTO_MS;
+            d.resolvido = false; // o IP pode ter mudado
+        }
+    }
+
+    if (!n.pendentes) n.seq = 0;
+}
+
+static void enviarLinha(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+static void enviarLinha(const char *formato, ...)
+{
+    char linha[160];
+    va_list args;
+    va_start(args, formato);
+    size_t n = vsnprintf(linha, sizeof(linha) - 2, formato, args);
+    va_end(args);
+    if (n > sizeof(linha) - 3) n = sizeof(linha) - 3;
+    linha[n++] = '\r';
+    linha[n++] = '\n';
+    cliente.write((const uint8_t *)linha, n);
+}
+
+static void enviarBase64(const char *texto)
+{
+    static const char ALFABETO[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char saida[64];
+    size_t n = 0;
+    const size_t tamanho = strlen(texto);
+    for (size_t i = 0; i < tamanho && n + 4 < sizeof(saida); i += 3)
+    {
+        const uint32_t v = (uint8_t)texto[i] << 16 |
+                           (i + 1 < tamanho ? (uint8_t)texto[i + 1] << 8 : 0) |
+                           (i + 2 < tamanho ? (uint8_t)texto[i + 2] : 0);
+        saida[n++] = ALFABETO[v >> 18 & 63];
+        saida[n++] = ALFABETO[v >> 12 & 63];
+        saida[n++] = i + 1 < tamanho ? ALFABETO[v >> 6 & 63] : '=';
+        saida[n++] = i + 2 < tamanho ? ALFABETO[v & 63] : '=';
+    }
+    saida[n] = '\0';
+    enviarLinha("%s", saida);
+}
+
+static void enviarWebhook(const Destino &d, const Notificacao &n)
+{
+    StaticJsonDocument<256> doc;
+    doc["dispositivo"] = identidadeDispositivo();
+    doc["seq"] = n.seq;
+    doc["timestamp"] = (uint32_t)n.timestamp;
+    doc["evento"] = n.mensagem;
+    char corpo[EVENTO_MAX_CHARS + 96];
+    const size_t tamanho = serializeJson(doc, corpo, sizeof(corpo));
+
+    char cabecalho[256];
+    const int k = snprintf(cabecalho, sizeof(cabecalho),
+                           "POST %s HTTP/1.1\r\nHost: %s:%u\r\nContent-Type: application/json\r\n"
+                           "Idempotency-Key: %s-%lu\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+                           d.caminho, d.host, d.porta, identidadeDispositivo(), (unsigned long)n.seq, (unsigned)tamanho);
+    cliente.write((const uint8_t *)cabecalho, k);
+    cliente.write((const uint8_t *)corpo, tamanho);
+}
+
+static void enviarEmail(const Destino &d, const Notificacao &n)
+{
+    char quando[32];
+    const time_t t = n.timestamp;
+    strftime(quando, sizeof(quando), "%d/%m/%Y %H:%M:%S", localtime(&t));
+
+    enviarLinha("From: <%s>", d.de);
+    enviarLinha("To: <%s>", d.para);
+    // domínio do Message-ID: o do remetente (a placa não tem um próprio)
+    const char *arroba = strchr(d.de, '@');
+    enviarLinha("Subject: [%s] %s", identidadeDispositivo(), n.mensagem);
+    enviarLinha("Message-ID: <%s-%lu@%s>", identidadeDispositivo(), (unsigned long)n.seq,
+                arroba && arroba[1] ? arroba + 1 : identidadeDispositivo());
+    enviarLinha("MIME-Version: 1.0");
+    enviarLinha("Content-Type: text/plain; charset=UTF-8");
+    enviarLinha("Content-Transfer-Encoding: 8bit");
+    enviarLinha("%s", "");
+    // a mensagem é uma linha só; '.' no início seria lido como fim do DATA
+    enviarLinha("%s%s", n.mensagem[0] == '.' ? "." : "", n.mensagem);
+    enviarLinha("%s", "");
+    enviarLinha("Evento %lu em %s (%s)", (unsigned long)n.seq, quando, identidadeDispositivo());
+    enviarLinha(".");
+}
+
+static void enviarRemetente(const Destino &d)
+{
+    enviarLinha("MAIL FROM:<%s>", d.de);
+    sessao.etapa = Etapa::SMTP_MAIL;
+}
+
+// Próxima etapa da conversa SMTP; 'codigo' esperado em cada uma
+static void avancarSmtp(int codigo)
+{
+    const Destino &d = destinos[sessao.destino];
+    const Notificacao &n = fila[sessao.indice];
+
+    static const struct { Etapa etapa; int esperado; } ESPERADOS[] = {
+        {Etapa::SMTP_SAUDACAO, 220}, {Etapa::SMTP_EHLO, 250}, {Etapa::SMTP_AUTH, 334},
+        {Etapa::SMTP_AUTH_USUARIO, 334}, {Etapa::SMTP_AUTH_SENHA, 235}, {Etapa::SMTP_MAIL, 250},
+        {Etapa::SMTP_RCPT, 250}, {Etapa::SMTP_DATA, 354}, {Etapa::SMTP_CORPO, 250}};
+    for (const auto &e : ESPERADOS)
+    {
+        if (e.etapa != sessao.etapa) continue;
+        const bool ok = codigo == e.esperado || (e.etapa == Etapa::SMTP_RCPT && codigo == 251);
+        if (!ok)
+        {
+            char motivo[48];
+            snprintf(motivo, sizeof(motivo), "SMTP respondeu %d", codigo);
+            // 5xx: recusa definitiva (endereço, autenticação); 4xx: tentar depois
+            concluir(codigo >= 500 ? Resultado::FALHA_DEFINITIVA : Resultado::FALHA_TEMPORARIA, motivo);
+            return;
+        }
+        break;
+    }
+
+    switch (sessao.etapa)
+    {
+    case Etapa::SMTP_SAUDACAO:
+        enviarLinha("EHLO %s", identidadeDispositivo());
+        sessao.etapa = Etapa::SMTP_EHLO;
+        break;
+    case Etapa::SMTP_EHLO:
+        if (!d.usuario[0])
+        {
+            enviarRemetente(d);
+            break;
+        }
+        enviarLinha("AUTH LOGIN");
+        sessao.etapa = Etapa::SMTP_AUTH;
+        break;
+    case Etapa::SMTP_AUTH_SENHA:
+        enviarRemetente(d);
+        break;
+    case Etapa::SMTP_AUTH:
+        enviarBase64(d.usuario);
+        sessao.etapa = Etapa::SMTP_AUTH_USUARIO;
+        break;
+    case Etapa::SMTP_AUTH_USUARIO:
+        enviarBase64(d.senha);
+        sessao.etapa = Etapa::SMTP_AUTH_SENHA;
+        break;
+    case Etapa::SMTP_MAIL:
+        enviarLinha("RCPT TO:<%s>", d.para);
+        sessao.etapa = Etapa::SMTP_RCPT;
+        break;
+    case Etapa::SMTP_RCPT:
+        enviarLinha("DATA");
+        sessao.etapa = Etapa::SMTP_DATA;
+        break;
+    case Etapa::SMTP_DATA:
+        enviarEmail(d, n);
+        sessao.etapa = Etapa::SMTP_CORPO;
+        break;
+    case Etapa::SMTP_CORPO:
+        enviarLinha("QUIT");
+        concluir(Resultado::ENTREGUE, nullptr);
+        break;
+    default:
+        break;
+    }
+}
+
+static void processarLinha()
+{
+    const char *linha = sessao.linha;
+
+    if (sessao.etapa == Etapa::HTTP_STATUS)
+    {
+        // "HTTP/1.1 204 No Content": o resto da resposta não interessa
+        const char *espaco = strchr(linha, ' ');
+        const int status = strncmp(linha, "HTTP/", 5) == 0 && espaco ? atoi(espaco + 1) : 0;
+        char motivo[32];
+        snprintf(motivo, sizeof(motivo), "HTTP %d", status);
+        if (status >= 200 && status < 300) concluir(Resultado::ENTREGUE, nullptr);
+        else if (status == 0 || status == 408 || status == 429 || status >= 500) concluir(Resultado::FALHA_TEMPORARIA, motivo);
+        else concluir(Resultado::FALHA_DEFINITIVA, motivo);
+        return;
+    }
+
+    // "250-..." continua em outra linha; só a última ("250 ...") avança
+    if (sessao.usados < 3 || linha[0] < '0' || linha[0] > '9') return;
+    if (sessao.usados > 3 && linha[3] == '-') return;
+    avancarSmtp(atoi(linha));
+}
+
+static void avancarSessao()
+{
+    if (millis() - sessao.inicioMs > NOTIF_PRAZO_MS)
+    {
+        concluir(Resultado::FALHA_TEMPORARIA, "sem resposta no prazo");
+        return;
+    }
+
+    // só o que já chegou: nunca espera pelo servidor
+    while (sessao.etapa != Etapa::LIVRE && cliente.available())
+    {
+        const int c = cliente.read();
+        if (c < 0) break;
+        if (c == '\n')
+        {
+            if (sessao.usados && sessao.linha[sessao.usados - 1] == '\r') sessao.usados--;
+            sessao.linha[sessao.usados] = '\0';
+            processarLinha();
+            sessao.usados = 0;
+        }
+        else if (sessao.usados < sizeof(sessao.linha) - 1) sessao.linha[sessao.usados++] = c;
+    }
+
+    if (sessao.etapa != Etapa::LIVRE && !cliente.connected() && !cliente.available())
+        concluir(Resultado::FALHA_TEMPORARIA, "conexão fechada pelo servidor");
+}
+
+static void iniciarEntrega(uint8_t iDestino, uint8_t indice)
+{
+    Destino &d = destinos[iDestino];
+    sessao.destino = iDestino;
+    sessao.indice = indice;
+    sessao.usados = 0;
+    sessao.inicioMs = millis();
+    sessao.etapa = d.tipo == TipoDestino::WEBHOOK ? Etapa::HTTP_STATUS : Etapa::SMTP_SAUDACAO;
+
+    if (!d.resolvido)
+    {
+        d.resolvido = d.ip.fromString(d.host) || WiFi.hostByName(d.host, d.ip, NOTIF_CONEXAO_TIMEOUT_MS) == 1;
+        if (!d.resolvido)
+        {
+            concluir(Resultado::FALHA_TEMPORARIA, "DNS");
+            return;
+        }
+    }
+
+    cliente.setTimeout(NOTIF_CONEXAO_TIMEOUT_MS);
+    if (!cliente.connect(d.ip, d.porta))
+    {
+        concluir(Resultado::FALHA_TEMPORARIA, "sem conexão");
+        return;
+    }
+    cliente.setNoDelay(true);
+
+    // webhook: a requisição inteira cabe no buffer TCP; SMTP espera o 220
+    if (d.tipo == TipoDestino::WEBHOOK) enviarWebhook(d, fila[indice]);
+}
+
+// Notificação mais antiga com entrega vencida para um destino liberado
+static bool escolherProxima(uint8_t &iDestino, uint8_t &indice)
+{
+    const uint32_t agora = millis();
+    bool achou = false;
+    for (uint8_t i = 0; i < NOTIF_FILA; i++)
+    {
+        Notificacao &n = fila[i];
+        if (!n.seq) continue;
+        if (agora - n.criadaMs > NOTIF_VALIDADE_MS)
+        {
+            liberar(n);
+            continue;
+        }
+        if (achou && n.seq > fila[indice].seq) continue;
+
+        for (uint8_t j = 0; j < totalDestinos; j++)
+        {
+            const Destino &d = destinos[j];
+            if (!(n.pendentes & (1 << j))) continue;
+            if ((int32_t)(agora - n.proximaMs[j]) < 0) continue;
+            if (d.circuitoAberto && (int32_t)(agora - d.abertoAteMs) < 0) continue;
+            iDestino = j;
+            indice = i;
+            achou = true;
+            break;
+        }
+    }
+    return achou;
+}
+
+// ================== Ciclo ==================
+void notificacoesSetup()
+{
+    adicionarObservadorEventos(observarEvento);
+    notificacoesRecarregarConfig();
+}
+
+void notificacoesRecarregarConfig()
+{
+    if (sessao.etapa != Etapa::LIVRE) cliente.stop();
+    sessao.etapa = Etapa::LIVRE;
+    memset(fila, 0, sizeof(fila));
+    carregarConfig();
+}
+
+void notificacoesLoop(bool wifiConectado)
+{
+    if (!totalDestinos) return;
+
+    if (sessao.etapa != Etapa::LIVRE)
+    {
+        avancarSessao();
+        return;
+    }
+    if (!wifiConectado) return;
+
+    uint8_t iDestino, indice;
+    if (escolherProxima(iDestino, indice)) iniciarEntrega(iDestino, indice);
+}
@@ -0,0 +1,38 @@
+#ifndef NOTIFICACOES_H
+#define NOTIFICACOES_H
+
+#include <Arduino.h>
+
+// Avisos de eventos para fora do painel: webhooks HTTP e e-mail (SMTP).
+//
+// Observa o event_logger. Cada evento que passa no filtro de algum destino
+// entra numa fila em RAM (NOTIF_FILA, cheia = a mais antiga sai). Texto
+// repetido dentro de NOTIF_DEDUP_MS é ignorado. A entrega é uma conversa
+// por vez, avançada aos poucos a cada notificacoesLoop() sem esperar
+// resposta. Só o connect() (e o DNS, uma vez por destino) bloqueia, com
+// limite de NOTIF_CONEXAO_TIMEOUT_MS.
+//
+// Falha num destino: nova tentativa em NOTIF_ESPERA_INICIAL_MS, dobrando até
+// NOTIF_ESPERA_MAX_MS. Com NOTIF_DISJUNTOR_FALHAS falhas seguidas o destino
+// fica em pausa (circuito aberto) por NOTIF_DISJUNTOR_ABERTO_MS; depois, uma
+// tentativa decide se volta. Resposta 4xx/5xx definitiva descarta na hora.
+// O receptor pode deduplicar reenvios pelo Idempotency-Key / Message-ID
+// (<identidadeDispositivo()>-<seq>, único na frota; o Message-ID leva o
+// domínio de "de").
+//
+// /notificacoes.json (sem TLS: webhook http:// e SMTP sem STARTTLS):
+//   {"destinos":[
+//     {"tipo":"webhook","url":"http://192.168.0.10:8080/alarme"},
+//     {"tipo":"smtp","host":"192.168.0.10","porta":25,"de":"alarme@loja",
+//      "para":"dono@loja","usuario":"","senha":""}]}
+// Cada destino aceita "filtro": prefixos de evento; padrão ["[ALERTA]"],
+// [] = todos os eventos.
+void notificacoesSetup();
+
+// Relê NOTIF_CONFIG_PATH (após POST /notificacoes.json); esvazia a fila
+void notificacoesRecarregarConfig();
+
+// Chamado do loop(), depois do tick do alarme
+void notificacoesLoop(bool wifiConectado);
+
+#endif
@@ -0,0 +1,152 @@
+#include "delta_patch.h"
+#include <string.h>
+
+uint32_t deltaCrc32(uint32_t crc, const uint8_t *dados, size_t tamanho)
+{
+    // CRC-32 (IEEE) bit a bit: sem tabela de 1 KB na RAM do ESP
+    crc = ~crc;
+    while (tamanho--)
+    {
+        crc ^= *dados++;
+        for (uint8_t b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+AplicadorDelta::AplicadorDelta(LerBase ler, EscreverNovo escrever, ValidarCabecalho validar, void *ctx)
+    : ler(ler), escrever(escrever), validar(validar), ctx(ctx) {}
+
+uint32_t AplicadorDelta::lerU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool AplicadorDelta::falhar(const char *msg)
+{
+    erro = msg;
+    etapa = FALHOU;
+    return false;
+}
+
+bool AplicadorDelta::emitir(const uint8_t *buf, size_t tamanho)
+{
+    if (escritos + tamanho > cab.tamanhoNovo) return falhar("patch gera mais bytes que o declarado");
+    if (!escrever(ctx, buf, tamanho)) return falhar("falha ao gravar a imagem nova");
+    crcSaida = deltaCrc32(crcSaida, buf, tamanho);
+    escritos += tamanho;
+    return true;
+}
+
+bool AplicadorDelta::executarCopia(uint32_t offset, uint32_t tamanho)
+{
+    if (offset > cab.tamanhoBase || tamanho > cab.tamanhoBase - offset)
+        return falhar("cópia fora da imagem atual");
+
+    uint8_t buf[256];
+    while (tamanho)
+    {
+        const size_t n = tamanho < sizeof(buf) ? tamanho : sizeof(buf);
+        if (!ler(ctx, offset, buf, n)) return falhar("falha ao ler a imagem atual");
+        if (!emitir(buf, n)) return false;
+        offset += n;
+        tamanho -= n;
+    }
+    return true;
+}
+
+bool AplicadorDelta::alimentar(const uint8_t *dados, size_t tamanho)
+{
+    while (tamanho)
+    {
+        switch (etapa)
+        {
+        case CABECALHO:
+        {
+            const size_t falta = DELTA_CABECALHO_BYTES - usados;
+            const size_t n = falta < tamanho ? falta : tamanho;
+            memcpy(acumulado + usados, dados, n);
+            usados += n;
+            dados += n;
+            tamanho -= n;
+            if (usados < DELTA_CABECALHO_BYTES) break;
+
+            if (memcmp(acumulado, DELTA_MAGICA, 4) != 0) return falhar("não é um patch ALDF");
+            if (acumulado[4] != DELTA_VERSAO) return falhar("versão de patch não suportada");
+            cab.tamanhoBase = lerU32(acumulado + 8);
+            cab.crcBase = lerU32(acumulado + 12);
+            cab.tamanhoNovo = lerU32(acumulado + 16);
+            cab.crcNovo = lerU32(acumulado + 20);
+            if (validar && !validar(ctx, cab)) return falhar("patch gerado para outra imagem");
+            usados = 0;
+            etapa = OPERACAO;
+            break;
+        }
+
+        case OPERACAO:
+            op = *dados++;
+            tamanho--;
+            if (op == DELTA_OP_FIM)
+            {
+                if (escritos != cab.tamanhoNovo) return falhar("imagem nova incompleta");
+                if (crcSaida != cab.crcNovo) return falhar("CRC da imagem nova não confere");
+                etapa = TERMINADO;
+            }
+            else if (op == DELTA_OP_COPIAR || op == DELTA_OP_INSERIR)
+            {
+                etapa = ARGUMENTOS;
+            }
+            else
+            {
+                return falhar("operação desconhecida no patch");
+            }
+            break;
+
+        case ARGUMENTOS:
+        {
+            const uint8_t precisa = op == DELTA_OP_COPIAR ? 8 : 4;
+            while (usados < precisa && tamanho)
+            {
+                acumulado[usados++] = *dados++;
+                tamanho--;
+            }
+            if (usados < precisa) break;
+            usados = 0;
+
+            if (op == DELTA_OP_COPIAR)
+            {
+                if (!executarCopia(lerU32(acumulado), lerU32(acumulado + 4))) return false;
+                etapa = OPERACAO;
+            }
+            else
+            {
+                literalRestante = lerU32(acumulado);
+                etapa = literalRestante ? LITERAL : OPERACAO;
+            }
+            break;
+        }
+
+        case LITERAL:
+        {
+            const size_t n = literalRestante < tamanho ? literalRestante : tamanho;
+            if (!emitir(dados, n)) return false;
+            dados += n;
+            tamanho -= n;
+            literalRestante -= n;
+            if (!literalRestante) etapa = OPERACAO;
+            break;
+        }
+
+        case TERMINADO:
+            return falhar("dados após o fim do patch");
+
+        case FALHOU:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AplicadorDelta::concluido() const
+{
+    return etapa == TERMINADO;
+}
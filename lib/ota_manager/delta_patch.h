@@ -0,0 +1,92 @@
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+// Formato de patch binário (imagem nova = cópias da imagem atual + literais).
+// Sem dependência de Arduino: o mesmo código roda no ESP e na ferramenta de
+// host (tools/ota_delta), que gera e confere os patches.
+//
+// Cabeçalho (24 bytes, little-endian):
+//   "ALDF" | versao u8 | 3 bytes reservados
+//   tamanhoBase u32 | crcBase u32 | tamanhoNovo u32 | crcNovo u32
+// Seguido de operações:
+//   DELTA_OP_COPIAR   u32 offsetBase, u32 tamanho   (bytes da imagem atual)
+//   DELTA_OP_INSERIR  u32 tamanho, <tamanho bytes>  (bytes literais)
+//   DELTA_OP_FIM
+//
+// crcBase ignora os 4 primeiros bytes da imagem: o cabeçalho do ESP tem
+// modo/tamanho da flash, que a gravação serial pode reescrever.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_MAGICA "ALDF"
+#define DELTA_VERSAO 1
+#define DELTA_CABECALHO_BYTES 24
+#define DELTA_CRC_BASE_INICIO 4
+
+enum DeltaOp : uint8_t
+{
+    DELTA_OP_FIM = 0,
+    DELTA_OP_COPIAR = 1,
+    DELTA_OP_INSERIR = 2
+};
+
+uint32_t deltaCrc32(uint32_t crc, const uint8_t *dados, size_t tamanho);
+
+struct CabecalhoDelta
+{
+    uint32_t tamanhoBase;
+    uint32_t crcBase;
+    uint32_t tamanhoNovo;
+    uint32_t crcNovo;
+};
+
+// Aplicador incremental: recebe o patch em pedaços de qualquer tamanho
+// (ex.: chunks do upload HTTP) e entrega a imagem nova por callback.
+class AplicadorDelta
+{
+public:
+    // Lê 'tamanho' bytes da imagem atual a partir de 'offset'
+    typedef bool (*LerBase)(void *ctx, uint32_t offset, uint8_t *buf, size_t tamanho);
+    // Recebe o próximo trecho da imagem nova
+    typedef bool (*EscreverNovo)(void *ctx, const uint8_t *buf, size_t tamanho);
+    // Chamado com o cabeçalho antes da primeira escrita (ex.: conferir a base)
+    typedef bool (*ValidarCabecalho)(void *ctx, const CabecalhoDelta &cab);
+
+    AplicadorDelta(LerBase ler, EscreverNovo escrever, ValidarCabecalho validar, void *ctx);
+
+    // false em erro (ver getErro()); depois disso o aplicador para
+    bool alimentar(const uint8_t *dados, size_t tamanho);
+    // true se o patch terminou (DELTA_OP_FIM) e a saída confere com o cabeçalho
+    bool concluido() const;
+
+    const char *getErro() const { return erro; }
+    const CabecalhoDelta &getCabecalho() const { return cab; }
+    uint32_t getEscritos() const { return escritos; }
+
+private:
+    enum Etapa : uint8_t { CABECALHO, OPERACAO, ARGUMENTOS, LITERAL, TERMINADO, FALHOU };
+
+    bool falhar(const char *msg);
+    bool emitir(const uint8_t *buf, size_t tamanho);
+    bool executarCopia(uint32_t offset, uint32_t tamanho);
+    static uint32_t lerU32(const uint8_t *p);
+
+    LerBase ler;
+    EscreverNovo escrever;
+    ValidarCabecalho validar;
+    void *ctx;
+
+    Etapa etapa = CABECALHO;
+    uint8_t op = DELTA_OP_FIM;
+    uint8_t acumulado[DELTA_CABECALHO_BYTES];
+    uint8_t usados = 0;
+    uint32_t literalRestante = 0;
+
+    CabecalhoDelta cab = {};
+    uint32_t escritos = 0;
+    uint32_t crcSaida = 0;
+    const char *erro = nullptr;
+};
+
+#endif
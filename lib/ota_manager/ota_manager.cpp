@@ -1,14 +1,363 @@
 #include <ESP8266WiFi.h>
-#include <ESP8266WiFi.h>
 #include <ESP8266HTTPUpdateServer.h>
+#include <Updater.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
 #include "ota_manager.h"
+#include "delta_patch.h"
+#include "system_config.h"
+#include "event_logger.h"
+#include "resumo_historico.h"
+#include "metricas.h"
+#include "armazenamento.h"
 
 static ESP8266HTTPUpdateServer httpUpdater;
+static ESP8266WebServer* serverPtr = nullptr;
+static const char* otaUser = nullptr;
+static const char* otaPass = nullptr;
+static void (*tickDuranteUpload)() = nullptr;
+
+// ================== Upload em /ota/enviar ==================
+enum TipoUpload : uint8_t { UPLOAD_NENHUM, UPLOAD_IMAGEM, UPLOAD_DELTA };
+
+static TipoUpload tipoUpload = UPLOAD_NENHUM;
+static bool uploadNegado = false;
+static bool uploadOk = false;
+static const char* erroUpload = nullptr;
+static AplicadorDelta* aplicador = nullptr;
+
+// Lê a imagem em execução direto da flash (o sketch começa no endereço 0).
+// spi_flash_read exige endereço e tamanho alinhados em 4 bytes.
+static bool lerImagemAtual(void*, uint32_t offset, uint8_t* buf, size_t tamanho) {
+  uint32_t alinhado[65];
+  while (tamanho) {
+    const uint32_t inicio = offset & ~3u;
+    const uint32_t desloc = offset - inicio;
+    size_t n = sizeof(alinhado) - desloc;
+    if (n > tamanho) n = tamanho;
+    const size_t bytesLidos = (desloc + n + 3) & ~3u;
+    if (!ESP.flashRead(inicio, alinhado, bytesLidos)) return false;
+    memcpy(buf, (uint8_t*)alinhado + desloc, n);
+    buf += n;
+    offset += n;
+    tamanho -= n;
+  }
+  return true;
+}
+
+static uint32_t crcImagemAtual(uint32_t inicio, uint32_t fim) {
+  uint8_t buf[256];
+  uint32_t crc = 0;
+  for (uint32_t pos = inicio; pos < fim; pos += sizeof(buf)) {
+    const size_t n = fim - pos < sizeof(buf) ? fim - pos : sizeof(buf);
+    if (!lerImagemAtual(nullptr, pos, buf, n)) return 0;
+    crc = deltaCrc32(crc, buf, n);
+    yield();
+  }
+  return crc;
+}
+
+static bool validarBaseDelta(void*, const CabecalhoDelta& cab) {
+  if (cab.tamanhoBase != ESP.getSketchSize()) return false;
+  if (cab.crcBase != crcImagemAtual(DELTA_CRC_BASE_INICIO, cab.tamanhoBase)) return false;
+  if (!Update.begin(cab.tamanhoNovo, U_FLASH)) return false;
+  Serial.printf("[OTA] Patch confere com a imagem atual: %u -> %u bytes\n", cab.tamanhoBase, cab.tamanhoNovo);
+  return true;
+}
+
+static bool gravarImagemNova(void*, const uint8_t* buf, size_t tamanho) {
+  return Update.write(const_cast<uint8_t*>(buf), tamanho) == tamanho;
+}
+
+static void encerrarUpload(const char* erro) {
+  if (erro && !erroUpload) erroUpload = erro;
+  if (erro && Update.isRunning()) Update.end(); // descarta a gravação incompleta
+  delete aplicador;
+  aplicador = nullptr;
+  tipoUpload = UPLOAD_NENHUM;
+}
+
+static void iniciarTipoUpload(const uint8_t* dados, size_t tamanho) {
+  if (tamanho >= 4 && memcmp(dados, DELTA_MAGICA, 4) == 0) {
+    tipoUpload = UPLOAD_DELTA;
+    aplicador = new AplicadorDelta(lerImagemAtual, gravarImagemNova, validarBaseDelta, nullptr);
+    return;
+  }
+
+  // 0xE9: imagem do ESP; 0x1F 0x8B: gzip (o eboot descompacta ao aplicar)
+  if (tamanho >= 2 && (dados[0] == 0xE9 || (dados[0] == 0x1F && dados[1] == 0x8B))) {
+    const uint32_t espaco = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
+    if (Update.begin(espaco, U_FLASH)) {
+      tipoUpload = UPLOAD_IMAGEM;
+      return;
+    }
+    encerrarUpload("sem espaço para a imagem nova");
+    return;
+  }
+  encerrarUpload("arquivo não é imagem (.bin/.bin.gz) nem patch ALDF");
+}
+
+static void handleUploadOta() {
+  HTTPUpload& upload = serverPtr->upload();
+
+  if (upload.status == UPLOAD_FILE_START) {
+    uploadOk = false;
+    erroUpload = nullptr;
+    encerrarUpload(nullptr);
+    uploadNegado = !serverPtr->authenticate(otaUser, otaPass);
+    if (!uploadNegado) Serial.printf("[OTA] Recebendo %s\n", upload.filename.c_str());
+    return;
+  }
+  if (uploadNegado || erroUpload) return;
+
+  if (upload.status == UPLOAD_FILE_WRITE) {
+    if (tipoUpload == UPLOAD_NENHUM) iniciarTipoUpload(upload.buf, upload.currentSize);
+
+    if (tipoUpload == UPLOAD_DELTA && !aplicador->alimentar(upload.buf, upload.currentSize)) {
+      encerrarUpload(aplicador->getErro());
+    } else if (tipoUpload == UPLOAD_IMAGEM && Update.write(upload.buf, upload.currentSize) != upload.currentSize) {
+      encerrarUpload("falha ao gravar a imagem nova");
+    }
+
+    // o upload pode levar minutos: o alarme não pode parar
+    if (tickDuranteUpload) tickDuranteUpload();
+  } else if (upload.status == UPLOAD_FILE_END) {
+    if (tipoUpload == UPLOAD_DELTA && !aplicador->concluido()) {
+      encerrarUpload("patch incompleto");
+    } else if (tipoUpload != UPLOAD_NENHUM && !Update.end(true)) {
+      encerrarUpload("imagem nova rejeitada pelo Updater");
+    } else if (tipoUpload != UPLOAD_NENHUM) {
+      uploadOk = true;
+      Serial.printf("[OTA] %s recebido: %u bytes\n", tipoUpload == UPLOAD_DELTA ? "Patch" : "Imagem", upload.totalSize);
+      encerrarUpload(nullptr);
+    }
+  } else if (upload.status == UPLOAD_FILE_ABORTED) {
+    encerrarUpload("upload interrompido");
+  }
+}
+
+static void handleFimUploadOta() {
+  if (uploadNegado) return serverPtr->requestAuthentication();
+
+  if (!uploadOk) {
+    registrarEventoF("[OTA] Atualização recusada: %s", erroUpload ? erroUpload : "arquivo vazio");
+    serverPtr->send(400, "text/plain", erroUpload ? erroUpload : "arquivo vazio");
+    return;
+  }
+
+  registrarEvento("[OTA] Firmware novo gravado. Reiniciando para o autoteste.");
+  eventosAgrupadosFecharTodos();
+  resumoGravar();
+  armazenamentoDescarregarTudo();
+  serverPtr->send(200, "text/plain", "OK. Reiniciando...");
+  delay(200);
+  ESP.restart();
+}
+
+// ================== Autoteste e rollback ==================
+static String md5Atual;
+static char md5Confirmado[33];
+static char md5Copia[33]; // imagem guardada em OTA_ANTERIOR_PATH
+static uint8_t tentativas = 0;
+static bool pendente = false;
+static uint32_t saudavelDesdeMs = 0;
+
+static bool copiando = false;
+static bool copiaImpossivel = false;
+static uint32_t copiaOffset = 0;
+static File copiaArquivo;
+
+static void salvarEstado() {
+  StaticJsonDocument<192> doc;
+  doc["md5_confirmado"] = md5Confirmado;
+  doc["md5_copia"] = md5Copia;
+  doc["tentativas"] = tentativas;
+
+  armazenamentoGravarJson(OTA_ESTADO_PATH, doc.as<JsonVariantConst>());
+}
+
+static bool carregarEstado() {
+  File f = LittleFS.open(OTA_ESTADO_PATH, "r");
+  if (!f) return false;
+  StaticJsonDocument<192> doc;
+  const bool ok = !deserializeJson(doc, f);
+  f.close();
+  if (!ok) return false;
+
+  strlcpy(md5Confirmado, doc["md5_confirmado"] | "", sizeof(md5Confirmado));
+  strlcpy(md5Copia, doc["md5_copia"] | "", sizeof(md5Copia));
+  tentativas = doc["tentativas"] | 0;
+  return true;
+}
+
+// Regrava a última imagem confirmada (guardada no LittleFS) e reinicia
+static void restaurarImagemAnterior(const char* motivo) {
+  if (strcmp(md5Copia, md5Confirmado) != 0 || !LittleFS.exists(OTA_ANTERIOR_PATH)) {
+    Serial.printf("[OTA] Rollback impossível (%s): sem cópia da imagem anterior. Mantendo a atual.\n", motivo);
+    strlcpy(md5Confirmado, md5Atual.c_str(), sizeof(md5Confirmado));
+    tentativas = 0;
+    pendente = false;
+    salvarEstado();
+    return;
+  }
+
+  registrarEventoF("[OTA] Rollback (%s): restaurando a imagem anterior", motivo);
+  File f = LittleFS.open(OTA_ANTERIOR_PATH, "r");
+  if (!f || !Update.begin(f.size(), U_FLASH)) {
+    Serial.println("[OTA] Rollback falhou ao iniciar o Updater");
+    return;
+  }
+
+  uint8_t buf[512];
+  while (f.available()) {
+    const size_t n = f.read(buf, sizeof(buf));
+    if (Update.write(buf, n) != n) break;
+    yield();
+  }
+  f.close();
+
+  if (!Update.end(true)) {
+    Serial.println("[OTA] Rollback falhou ao gravar a imagem anterior");
+    return;
+  }
+  tentativas = 0;
+  salvarEstado();
+  armazenamentoDescarregarTudo();
+  delay(100);
+  ESP.restart();
+}
+
+void ota_verificarBoot() {
+  md5Atual = ESP.getSketchMD5();
+
+  if (!carregarEstado()) {
+    // primeiro boot com autoteste: a imagem atual vira a referência
+    strlcpy(md5Confirmado, md5Atual.c_str(), sizeof(md5Confirmado));
+    salvarEstado();
+    return;
+  }
+  if (md5Atual == md5Confirmado) return;
+
+  pendente = true;
+  tentativas++;
+  salvarEstado();
+  Serial.printf("[OTA] Imagem nova em autoteste (boot %u de %u)\n", tentativas, OTA_MAX_TENTATIVAS);
+
+  if (tentativas > OTA_MAX_TENTATIVAS) {
+    restaurarImagemAnterior("imagem nova reiniciou sem ficar saudável");
+  }
+}
+
+static void confirmarImagem() {
+  pendente = false;
+  tentativas = 0;
+  strlcpy(md5Confirmado, md5Atual.c_str(), sizeof(md5Confirmado));
+  salvarEstado();
+  registrarEventoF("[OTA] Imagem nova confirmada (%s)", md5Confirmado);
+}
+
+// Copia a imagem confirmada para o LittleFS, OTA_COPIA_BLOCO bytes por loop
+static void copiarImagemConfirmada() {
+  if (!copiando) {
+    if (copiaImpossivel || strcmp(md5Copia, md5Confirmado) == 0) return;
+
+    FSInfo info;
+    LittleFS.info(info);
+    const size_t livre = info.totalBytes - info.usedBytes + (md5Copia[0] ? ESP.getSketchSize() : 0);
+    if (livre < ESP.getSketchSize() + 16384) {
+      Serial.println("[OTA] LittleFS sem espaço para a cópia da imagem: rollback indisponível");
+      copiaImpossivel = true;
+      return;
+    }
+
+    // a cópia antiga não serve mais (a imagem atual foi confirmada)
+    LittleFS.remove(OTA_ANTERIOR_PATH);
+    md5Copia[0] = '\0';
+    copiaArquivo = LittleFS.open(OTA_ANTERIOR_TMP_PATH, "w");
+    if (!copiaArquivo) {
+      copiaImpossivel = true;
+      return;
+    }
+    metricasArquivoAberto();
+    copiaOffset = 0;
+    copiando = true;
+  }
+
+  uint8_t buf[OTA_COPIA_BLOCO];
+  const uint32_t total = ESP.getSketchSize();
+  const size_t n = total - copiaOffset < sizeof(buf) ? total - copiaOffset : sizeof(buf);
+  if (!lerImagemAtual(nullptr, copiaOffset, buf, n) || copiaArquivo.write(buf, n) != n) {
+    copiaArquivo.close();
+    LittleFS.remove(OTA_ANTERIOR_TMP_PATH);
+    copiando = false;
+    copiaImpossivel = true;
+    Serial.println("[OTA] Falha ao copiar a imagem para o LittleFS");
+    return;
+  }
+  armazenamentoContabilizar(OTA_ANTERIOR_PATH, copiaOffset, n);
+  copiaOffset += n;
+
+  if (copiaOffset >= total) {
+    copiaArquivo.close();
+    LittleFS.rename(OTA_ANTERIOR_TMP_PATH, OTA_ANTERIOR_PATH);
+    strlcpy(md5Copia, md5Confirmado, sizeof(md5Copia));
+    salvarEstado();
+    copiando = false;
+    Serial.printf("[OTA] Cópia da imagem confirmada salva (%u bytes)\n", total);
+  }
+}
+
+void ota_loop(bool saudavel) {
+  if (!pendente) {
+    copiarImagemConfirmada();
+    return;
+  }
+
+  const uint32_t agora = millis();
+  if (!saudavel) {
+    saudavelDesdeMs = 0;
+  } else if (!saudavelDesdeMs) {
+    saudavelDesdeMs = agora ? agora : 1;
+  } else if (agora - saudavelDesdeMs >= OTA_AUTOTESTE_MS) {
+    confirmarImagem();
+    return;
+  }
+
+  if (agora > OTA_PRAZO_CONFIRMACAO_MS) {
+    restaurarImagemAnterior("prazo de autoteste esgotado");
+  }
+}
+
+static void handleEstadoOta() {
+  StaticJsonDocument<384> doc;
+  doc["md5_atual"] = md5Atual;
+  doc["md5_confirmado"] = md5Confirmado;
+  doc["pendente"] = pendente;
+  doc["tentativas"] = tentativas;
+  doc["rollback_disponivel"] = md5Copia[0] && strcmp(md5Copia, md5Confirmado) == 0;
+  if (copiando) doc["copia_bytes"] = copiaOffset;
+  doc["tamanho_imagem"] = ESP.getSketchSize();
+  doc["espaco_livre"] = ESP.getFreeSketchSpace();
+
+  String out;
+  serializeJson(doc, out);
+  serverPtr->send(200, "application/json", out);
+}
+
+void ota_definirTickDuranteUpload(void (*tick)()) {
+  tickDuranteUpload = tick;
+}
 
 void setup_ota(ESP8266WebServer& server, const char* mdnsHost, const char* user, const char* password) {
   httpUpdater.setup(&server, "/update", user, password);
 
-  Serial.printf("[OTA] /update protegido por usuário/senha.\n");
+  serverPtr = &server;
+  otaUser = user;
+  otaPass = password;
+  server.on("/ota/enviar", HTTP_POST, handleFimUploadOta, handleUploadOta);
+  server.on("/ota/estado.json", HTTP_GET, handleEstadoOta);
+
+  Serial.printf("[OTA] /update e /ota/enviar protegidos por usuário/senha.\n");
   Serial.printf("[OTA] URL: http://%s.local/update\n", mdnsHost);
   Serial.printf("[OTA] URL: http://%s/update\n", WiFi.localIP().toString().c_str());
 }
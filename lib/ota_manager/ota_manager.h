@@ -3,6 +3,27 @@
 
 #include <ESP8266WebServer.h>
 
+// Rotas:
+//   /update            ESP8266HTTPUpdateServer (imagem completa, .bin ou .bin.gz)
+//   POST /ota/enviar   imagem completa (.bin / .bin.gz) ou patch ALDF gerado por
+//                      tools/ota_delta contra a imagem em execução; o alarme
+//                      continua em tick durante o upload
+//   GET /ota/estado.json
 void setup_ota(ESP8266WebServer& server, const char* mdnsHost, const char* user, const char* password);
 
+// Função chamada a cada chunk do upload em /ota/enviar (tick do alarme)
+void ota_definirTickDuranteUpload(void (*tick)());
+
+// Autoteste pós-atualização. Chamar logo após montar o LittleFS: se a imagem
+// em execução ainda não foi confirmada e já falhou OTA_MAX_TENTATIVAS boots,
+// regrava a última imagem confirmada e reinicia.
+void ota_verificarBoot();
+
+// A cada loop. 'saudavel' = modelo carregado e tick do alarme rodando (armado
+// ou não: a agenda automática pode desarmar no meio); após OTA_AUTOTESTE_MS
+// saudável a imagem nova é confirmada. Sem confirmação até
+// OTA_PRAZO_CONFIRMACAO_MS a imagem anterior é restaurada.
+// Também copia (aos poucos) a imagem confirmada para o LittleFS.
+void ota_loop(bool saudavel);
+
 #endif
@@ -0,0 +1,80 @@
+#include "ajustes_sensores.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include "system_config.h"
+#include "armazenamento.h"
+#include "config_sensores.h"
+
+Zona *ajustesBuscarZona(Faixa<Zona> zonas, const char *zona)
+{
+    for (Zona &z : zonas)
+        if (strcmp(z.getNome(), zona) == 0) return &z;
+    return nullptr;
+}
+
+Sensor *ajustesBuscarSensor(Faixa<Zona> zonas, const char *zona, const char *nome)
+{
+    Zona *z = ajustesBuscarZona(zonas, zona);
+    if (!z) return nullptr;
+    for (Sensor &s : z->getSensores())
+        if (strcmp(s.getNome(), nome) == 0) return &s;
+    return nullptr;
+}
+
+static bool lerAjustes(JsonDocument &doc)
+{
+    File f = LittleFS.open(AJUSTES_SENSORES_PATH, "r");
+    if (!f) return false;
+    const bool ok = !deserializeJson(doc, f) && doc.is<JsonObject>();
+    f.close();
+    return ok;
+}
+
+static void chave(char *buf, size_t tamanho, const Sensor &sensor)
+{
+    snprintf(buf, tamanho, "%s/%s", sensor.getZona(), sensor.getNome());
+}
+
+bool ajustesDefinirAtivo(Sensor &sensor, bool ativo)
+{
+    if (ativo) sensor.ativar();
+    else sensor.desativar();
+
+    StaticJsonDocument<AJUSTES_MAX_BYTES> doc;
+    if (!lerAjustes(doc)) doc.to<JsonObject>();
+
+    char k[2 * CONFIG_MAX_NOME + 2];
+    chave(k, sizeof(k), sensor);
+    doc[k] = ativo;
+    if (doc.overflowed())
+    {
+        Serial.println("[AJUSTES] Sem espaço para mais ajustes");
+        return false;
+    }
+    return armazenamentoGravarJson(AJUSTES_SENSORES_PATH, doc.as<JsonVariantConst>());
+}
+
+void ajustesAplicar(Faixa<Zona> zonas)
+{
+    StaticJsonDocument<AJUSTES_MAX_BYTES> doc;
+    if (!lerAjustes(doc)) return;
+
+    char k[2 * CONFIG_MAX_NOME + 2];
+    uint16_t aplicados = 0;
+    for (Zona &z : zonas)
+        for (Sensor &s : z.getSensores())
+        {
+            chave(k, sizeof(k), s);
+            JsonVariantConst v = doc[k];
+            if (!v.is<bool>()) continue;
+            if (v.as<bool>()) s.ativar();
+            else s.desativar();
+            aplicados++;
+        }
+    Serial.printf("[AJUSTES] %u ajuste(s) de sensor aplicado(s)\n", aplicados);
+}
+
+void ajustesDescartar()
+{
+    if (LittleFS.exists(AJUSTES_SENSORES_PATH)) armazenamentoRemover(AJUSTES_SENSORES_PATH);
+}
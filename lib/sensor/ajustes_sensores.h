@@ -0,0 +1,24 @@
+#ifndef AJUSTES_SENSORES_H
+#define AJUSTES_SENSORES_H
+
+#include <Arduino.h>
+#include "zona.h"
+#include "faixa.h"
+
+// Ajustes de operação aplicados no modelo vivo, sem recarregar a config:
+// ligar/desligar um sensor, limpar o isolamento e bypass temporário de zona.
+// Só ativo/inativo persiste, em AJUSTES_SENSORES_PATH ({"<zona>/<nome>":bool}),
+// reaplicado a cada montagem do modelo. Isolamento e bypass são estado de
+// execução. Uma config de sensores nova (POST/bundle) descarta os ajustes.
+
+Zona *ajustesBuscarZona(Faixa<Zona> zonas, const char *zona);
+Sensor *ajustesBuscarSensor(Faixa<Zona> zonas, const char *zona, const char *nome);
+
+// Aplica e persiste; false se não conseguiu gravar (o ajuste em RAM fica)
+bool ajustesDefinirAtivo(Sensor &sensor, bool ativo);
+
+// Depois de montar o modelo (configurarSistema)
+void ajustesAplicar(Faixa<Zona> zonas);
+void ajustesDescartar();
+
+#endif
@@ -0,0 +1,36 @@
+#include "arena_nomes.h"
+
+ArenaNomes arenaNomes;
+
+ArenaNomes::ArenaNomes() : usado(0) {}
+
+const char *ArenaNomes::internar(const char *nome)
+{
+    if (!nome) nome = "";
+
+    // Reaproveita se já existe (só roda na carga da config)
+    size_t pos = 0;
+    while (pos < usado)
+    {
+        const char *existente = buffer + pos;
+        if (strcmp(existente, nome) == 0) return existente;
+        pos += strlen(existente) + 1;
+    }
+
+    const size_t tam = strlen(nome) + 1;
+    if (usado + tam > CAPACIDADE)
+    {
+        Serial.printf("[ERRO] Arena de nomes cheia, '%s' descartado\n", nome);
+        return "";
+    }
+
+    char *destino = buffer + usado;
+    memcpy(destino, nome, tam);
+    usado += tam;
+    return destino;
+}
+
+void ArenaNomes::limpar()
+{
+    usado = 0;
+}
@@ -0,0 +1,27 @@
+#ifndef ARENA_NOMES_H
+#define ARENA_NOMES_H
+
+#include <Arduino.h>
+
+// Nomes de sensores e zonas são internados uma única vez na carga da config,
+// num buffer fixo. Os ponteiros devolvidos valem até o próximo limpar()
+// (feito na recarga da config) e podem ser comparados por igualdade direta.
+class ArenaNomes
+{
+public:
+    static const size_t CAPACIDADE = 1536;
+
+    ArenaNomes();
+
+    const char *internar(const char *nome);
+    void limpar();
+    size_t usados() const { return usado; }
+
+private:
+    char buffer[CAPACIDADE];
+    size_t usado;
+};
+
+extern ArenaNomes arenaNomes;
+
+#endif
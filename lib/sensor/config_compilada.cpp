@@ -0,0 +1,27 @@
+#include "config_compilada.h"
+
+#ifdef CONFIG_COMPILADA
+
+static_assert(TOTAL_SENSORES_COMPILADOS > 0, "config compilada sem sensores");
+
+// Sensores e zonas do modelo compilado: espaço reservado no .bss
+alignas(Sensor) alignas(Zona) static uint8_t blocoCompilado[PoolModelo::bytesPara(TOTAL_SENSORES_COMPILADOS)];
+
+bool configCompiladaDisponivel() { return true; }
+
+Faixa<Zona> configCompiladaMontar(PoolModelo &pool)
+{
+    pool.usarBlocoFixo(blocoCompilado, TOTAL_SENSORES_COMPILADOS);
+    return pool.montarOrdenado(SENSORES_COMPILADOS, TOTAL_SENSORES_COMPILADOS);
+}
+
+#else
+
+bool configCompiladaDisponivel() { return false; }
+
+Faixa<Zona> configCompiladaMontar(PoolModelo &)
+{
+    return Faixa<Zona>();
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef CONFIG_COMPILADA_H
+#define CONFIG_COMPILADA_H
+
+#include <Arduino.h>
+#include "pool_modelo.h"
+
+// Horários padrão (os de /horarios.json, quando existe, têm precedência)
+struct HorariosConfig
+{
+    int armarSemana;
+    int desarmarSemana;
+    int armarFimSemana;
+    int desarmarFimSemana;
+    int horaRestart;
+    bool restartConfig;
+};
+
+// Build com -DCONFIG_COMPILADA (env nodemcuv2_compilada): sensores, zonas e
+// horários vêm de tabelas constexpr geradas de sensores.json/horarios.json
+// por tools/config_compilada/gerar_config.py. O boot monta o modelo direto
+// delas, num bloco estático, sem ler nem interpretar JSON. /sensores.json no
+// LittleFS continua valendo como override (ex.: enviado pela tela de config).
+#ifdef CONFIG_COMPILADA
+#include "config_compilada_gerada.h"
+#else
+constexpr HorariosConfig HORARIOS_PADRAO = {18, 6, 0, 0, 23, false};
+#endif
+
+// true se este build trouxe tabelas compiladas
+bool configCompiladaDisponivel();
+
+// Modelo a partir das tabelas (sem parse, sem heap). Vazio sem CONFIG_COMPILADA.
+Faixa<Zona> configCompiladaMontar(PoolModelo &pool);
+
+#endif
@@ -0,0 +1,248 @@
+#include "config_sensores.h"
+#include <ArduinoJson.h>
+
+#include "system_config.h"
+#include "arena_nomes.h"
+
+// Conta linhas do que já foi consumido, para apontar onde está o erro
+class LeitorComLinhas : public Stream
+{
+public:
+    explicit LeitorComLinhas(Stream &origem) : origem(origem), linha(1) { setTimeout(0); }
+
+    int available() override { return origem.available(); }
+    int peek() override { return origem.peek(); }
+    int read() override
+    {
+        const int c = origem.read();
+        if (c == '\n') linha++;
+        return c;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+    uint16_t getLinha() const { return linha; }
+
+private:
+    Stream &origem;
+    uint16_t linha;
+};
+
+int resolverPino(const char *pinoStr)
+{
+    // D0..D8 -> GPIO da NodeMCU
+    static const int PINOS[] = {D0, D1, D2, D3, D4, D5, D6, D7, D8};
+
+    if (pinoStr[0] != 'D' || pinoStr[1] < '0' || pinoStr[1] > '8' || pinoStr[2] != '\0')
+        return -1;
+    return PINOS[pinoStr[1] - '0'];
+}
+
+static void anotar(ErroConfig *lista, uint8_t max, uint16_t &total,
+                   int16_t elemento, uint16_t linha, const char *formato, ...)
+{
+    if (total < max)
+    {
+        ErroConfig &e = lista[total];
+        e.elemento = elemento;
+        e.linha = linha;
+        va_list args;
+        va_start(args, formato);
+        vsnprintf(e.mensagem, sizeof(e.mensagem), formato, args);
+        va_end(args);
+    }
+    total++;
+}
+
+#define ERRO(...)  anotar(resultado.erros, CONFIG_MAX_ERROS, resultado.totalErros, __VA_ARGS__)
+#define AVISO(...) anotar(resultado.avisos, CONFIG_MAX_AVISOS, resultado.totalAvisos, __VA_ARGS__)
+
+// Bytes que o texto acrescenta na arena (0 se já está lá)
+static size_t bytesNovos(const char *texto, const char (*nomes)[CONFIG_MAX_NOME + 1],
+                         const char (*zonas)[CONFIG_MAX_NOME + 1], uint16_t total)
+{
+    for (uint16_t i = 0; i < total; i++)
+        if (strcmp(nomes[i], texto) == 0 || strcmp(zonas[i], texto) == 0) return 0;
+    return strlen(texto) + 1;
+}
+
+static int proximoUtil(Stream &in)
+{
+    int c;
+    while ((c = in.peek()) == ' ' || c == '\n' || c == '\r' || c == '\t') in.read();
+    return c;
+}
+
+static bool textoValido(JsonVariant v, size_t &tam)
+{
+    if (!v.is<const char *>()) return false;
+    tam = strlen(v.as<const char *>());
+    return tam > 0 && tam <= CONFIG_MAX_NOME;
+}
+
+bool lerConfigSensores(Stream &origem, std::vector<DefinicaoSensor> *saida, ResultadoValidacao &resultado)
+{
+    LeitorComLinhas in(origem);
+
+    // Estado para detectar repetidos, em memória fixa (7 sensores: os
+    // próprios nomes, comparados por inteiro)
+    uint32_t pinosUsados = 0;
+    char nomes[CONFIG_MAX_SENSORES][CONFIG_MAX_NOME + 1];
+    char zonas[CONFIG_MAX_SENSORES][CONFIG_MAX_NOME + 1];
+    uint16_t vistos = 0;
+    size_t bytesArena = 0; // nomes distintos, como a arenaNomes os guarda
+
+    if (proximoUtil(in) != '[')
+    {
+        ERRO(-1, in.getLinha(), "o arquivo deve ser um array JSON");
+        return false;
+    }
+    in.read();
+
+    if (proximoUtil(in) == ']') return resultado.ok(); // array vazio
+
+    for (int16_t idx = 0;; idx++)
+    {
+        proximoUtil(in);
+        const uint16_t linha = in.getLinha();
+
+        StaticJsonDocument<CONFIG_ELEMENTO_BYTES> doc;
+        DeserializationError err = deserializeJson(doc, in);
+        if (err)
+        {
+            // não há como ressincronizar o stream com segurança: para aqui
+            ERRO(idx, linha, "JSON inválido (%s)", err.c_str());
+            return false;
+        }
+
+        if (idx >= CONFIG_MAX_SENSORES)
+        {
+            ERRO(idx, linha, "máximo de %d sensores", CONFIG_MAX_SENSORES);
+        }
+        else if (!doc.is<JsonObject>())
+        {
+            ERRO(idx, linha, "elemento não é um objeto");
+        }
+        else
+        {
+            JsonObject obj = doc.as<JsonObject>();
+            size_t tam;
+            bool valido = true;
+
+            if (!textoValido(obj["nome"], tam))
+            {
+                ERRO(idx, linha, "\"nome\" ausente ou com mais de %d caracteres", CONFIG_MAX_NOME);
+                valido = false;
+            }
+            if (!textoValido(obj["zona"], tam))
+            {
+                ERRO(idx, linha, "\"zona\" ausente ou com mais de %d caracteres", CONFIG_MAX_NOME);
+                valido = false;
+            }
+
+            const char *tipoStr = obj["tipo"] | "";
+            if (strcmp(tipoStr, "PIR") != 0 && strcmp(tipoStr, "REED") != 0)
+            {
+                ERRO(idx, linha, "tipo \"%s\" desconhecido (use PIR ou REED)", tipoStr);
+                valido = false;
+            }
+
+            if (!obj["ativo"].isNull() && !obj["ativo"].is<bool>())
+            {
+                ERRO(idx, linha, "\"ativo\" deve ser true/false");
+                valido = false;
+            }
+
+            const char *pinoStr = obj["pino"] | "";
+            const int pino = resolverPino(pinoStr);
+            if (pino < 0)
+            {
+                ERRO(idx, linha, "pino \"%s\" desconhecido (use D0..D8)", pinoStr);
+                valido = false;
+            }
+            else if (pino == BTN_ARM_PIN || pino == BUZZER_PIN)
+            {
+                ERRO(idx, linha, "pino %s é reservado (botão/sirene)", pinoStr);
+                valido = false;
+            }
+            else if (pinosUsados & (1UL << pino))
+            {
+                ERRO(idx, linha, "pino %s já usado por outro sensor", pinoStr);
+                valido = false;
+            }
+
+            if (valido)
+            {
+                const char *nome = obj["nome"];
+                const char *zona = obj["zona"];
+
+                for (uint16_t i = 0; i < vistos && valido; i++)
+                {
+                    if (strcmp(nomes[i], nome) == 0 && strcmp(zonas[i], zona) == 0)
+                    {
+                        ERRO(idx, linha, "sensor \"%s\" repetido na zona \"%s\"", nome, zona);
+                        valido = false;
+                    }
+                }
+                if (valido)
+                {
+                    for (uint16_t i = 0; i < vistos; i++)
+                    {
+                        if (strcmp(nomes[i], nome) == 0)
+                        {
+                            AVISO(idx, linha, "nome \"%s\" também usado em outra zona", nome);
+                            break;
+                        }
+                    }
+                }
+
+                // a arena guarda nomes de sensor e de zona juntos, sem repetir
+                const size_t novos = !valido ? 0
+                                   : bytesNovos(nome, nomes, zonas, vistos) +
+                                         (strcmp(nome, zona) ? bytesNovos(zona, nomes, zonas, vistos) : 0);
+                if (valido && bytesArena + novos > ArenaNomes::CAPACIDADE)
+                {
+                    ERRO(idx, linha, "nomes excedem %u bytes", (unsigned)ArenaNomes::CAPACIDADE);
+                    valido = false;
+                }
+
+                DefinicaoSensor definicao = {nullptr, nullptr, Sensor::tipoFromString(tipoStr), pino,
+                                             obj["ativo"] | true};
+                if (valido && saida)
+                {
+                    definicao.nome = arenaNomes.internar(nome);
+                    definicao.zona = arenaNomes.internar(zona);
+                    if (!definicao.nome[0] || !definicao.zona[0])
+                    {
+                        ERRO(idx, linha, "arena de nomes cheia");
+                        valido = false;
+                    }
+                }
+
+                if (valido)
+                {
+                    pinosUsados |= (1UL << pino);
+                    bytesArena += novos;
+                    strlcpy(nomes[vistos], nome, sizeof(nomes[vistos]));
+                    strlcpy(zonas[vistos], zona, sizeof(zonas[vistos]));
+                    vistos++;
+                    resultado.totalSensores++;
+                    if (saida) saida->push_back(definicao);
+                }
+            }
+        }
+
+        // próximo elemento ou fim do array
+        const int c = proximoUtil(in);
+        if (c == ',')
+        {
+            in.read();
+            continue;
+        }
+        if (c == ']') break;
+
+        ERRO(idx, in.getLinha(), "esperado ',' ou ']' após o elemento");
+        return false;
+    }
+
+    return resultado.ok();
+}
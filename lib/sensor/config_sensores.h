@@ -0,0 +1,60 @@
+#ifndef CONFIG_SENSORES_H
+#define CONFIG_SENSORES_H
+
+#include <Arduino.h>
+#include <vector>
+#include "pool_modelo.h"
+
+// Limites da config de sensores (validados no POST e no boot). Um sensor
+// por pino, D0..D8 sem o botão (D3) e a sirene (D5): no máximo 7.
+#define CONFIG_MAX_SENSORES     7
+#define CONFIG_MAX_NOME         31
+#define CONFIG_MAX_ERROS        6
+#define CONFIG_MAX_AVISOS       3
+#define CONFIG_ELEMENTO_BYTES   384 // memória do parse de UM elemento do array
+
+struct ErroConfig
+{
+    int16_t elemento; // índice no array (-1 = erro geral do arquivo)
+    uint16_t linha;
+    char mensagem[64];
+};
+
+struct ResultadoValidacao
+{
+    uint16_t totalSensores = 0; // elementos válidos
+    uint16_t totalErros = 0;    // pode passar de CONFIG_MAX_ERROS (só os primeiros são guardados)
+    uint16_t totalAvisos = 0;
+    ErroConfig erros[CONFIG_MAX_ERROS];
+    ErroConfig avisos[CONFIG_MAX_AVISOS];
+
+    bool ok() const { return totalErros == 0; }
+};
+
+// Stream sobre um buffer em memória (ex.: corpo do POST), sem cópia
+class LeitorMemoria : public Stream
+{
+public:
+    LeitorMemoria(const char *dados, size_t tamanho) : dados(dados), tamanho(tamanho), pos(0) {}
+
+    int available() override { return tamanho - pos; }
+    int read() override { return pos < tamanho ? (uint8_t)dados[pos++] : -1; }
+    int peek() override { return pos < tamanho ? (uint8_t)dados[pos] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const char *dados;
+    size_t tamanho;
+    size_t pos;
+};
+
+// D0..D8 -> GPIO. Retorna -1 para texto desconhecido.
+int resolverPino(const char *pinoStr);
+
+// Lê o array de sensores um elemento por vez: a memória usada não depende
+// do tamanho do arquivo. Se "saida" não for nulo, os elementos válidos são
+// acrescentados nele (nomes internados na arenaNomes); os inválidos são pulados.
+// Retorna true se não houve nenhum erro.
+bool lerConfigSensores(Stream &entrada, std::vector<DefinicaoSensor> *saida, ResultadoValidacao &resultado);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef ENTRADAS_H
+#define ENTRADAS_H
+
+#include <Arduino.h>
+
+// Nível de todos os pinos de uma vez, direto dos registradores:
+// bits 0..15 = GPIO_IN (GPIO0..15), bit 16 = GPIO16 (D0, fica no bloco RTC).
+// Um acesso por tick no lugar de um digitalRead por sensor.
+inline uint32_t entradasLer()
+{
+    return (GPI & 0xFFFF) | ((GP16I & 1) << 16);
+}
+
+// Bit do pino na leitura acima (0 se o pino não couber)
+inline uint32_t entradasBit(int pino)
+{
+    return (pino >= 0 && pino <= 16) ? (1UL << pino) : 0;
+}
+
+#endif
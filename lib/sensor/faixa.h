@@ -0,0 +1,19 @@
+#ifndef FAIXA_H
+#define FAIXA_H
+
+#include <stddef.h>
+
+// Visão [inicio, fim) sobre objetos contíguos do PoolModelo (sem cópia)
+template <typename T>
+struct Faixa
+{
+    T *inicio = nullptr;
+    T *fim = nullptr;
+
+    T *begin() const { return inicio; }
+    T *end() const { return fim; }
+    size_t size() const { return fim - inicio; }
+    bool empty() const { return inicio == fim; }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "pool_modelo.h"
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+// resetar() não chama destrutores: os objetos precisam ser triviais
+static_assert(std::is_trivially_destructible<Sensor>::value, "Sensor deve ser trivialmente destrutível");
+static_assert(std::is_trivially_destructible<Zona>::value, "Zona deve ser trivialmente destrutível");
+
+PoolModelo poolModelo;
+
+static size_t alinhar(size_t n, size_t a) { return (n + a - 1) & ~(a - 1); }
+
+PoolModelo::PoolModelo()
+    : bloco(nullptr), blocoFixo(false), capSensores(0), sensores(nullptr), zonas(nullptr),
+      totalSensores(0), totalZonas(0), geracao(0)
+{
+}
+
+bool PoolModelo::reservar(size_t n)
+{
+    if (n <= capSensores) return true;
+
+    const size_t offsetZonas = alinhar(n * sizeof(Sensor), alignof(Zona));
+    uint8_t *novo = (uint8_t *)malloc(offsetZonas + n * sizeof(Zona));
+    if (!novo)
+    {
+        Serial.printf("[ERRO] Sem memória para %u sensores\n", (unsigned)n);
+        return false;
+    }
+
+    if (!blocoFixo) free(bloco);
+    bloco = novo;
+    blocoFixo = false;
+    capSensores = n;
+    sensores = reinterpret_cast<Sensor *>(bloco);
+    zonas = reinterpret_cast<Zona *>(bloco + offsetZonas);
+    return true;
+}
+
+void PoolModelo::usarBlocoFixo(uint8_t *blocoExterno, size_t capacidade)
+{
+    resetar();
+    if (!blocoFixo) free(bloco);
+    bloco = blocoExterno;
+    blocoFixo = true;
+    capSensores = capacidade;
+    sensores = reinterpret_cast<Sensor *>(bloco);
+    zonas = reinterpret_cast<Zona *>(bloco + alinhar(capacidade * sizeof(Sensor), alignof(Zona)));
+}
+
+Faixa<Zona> PoolModelo::montar(std::vector<DefinicaoSensor> &defs)
+{
+    // Sensores da mesma zona ficam vizinhos: a zona guarda só [primeiro, total)
+    std::stable_sort(defs.begin(), defs.end(),
+                     [](const DefinicaoSensor &a, const DefinicaoSensor &b)
+                     { return strcmp(a.zona, b.zona) < 0; });
+
+    return montarOrdenado(defs.data(), defs.size());
+}
+
+Faixa<Zona> PoolModelo::montarOrdenado(const DefinicaoSensor *defs, size_t total)
+{
+    resetar();
+    geracao++;
+    if (total == 0 || !reservar(total)) return getZonas();
+
+    size_t inicioZona = 0;
+    for (size_t i = 0; i < total; i++)
+    {
+        const DefinicaoSensor &d = defs[i];
+        new (&sensores[totalSensores++]) Sensor(d.nome, d.tipo, d.pino, d.zona, d.ativo);
+
+        const bool ultimoDaZona = (i + 1 == total) || (defs[i + 1].zona != d.zona);
+        if (ultimoDaZona)
+        {
+            new (&zonas[totalZonas++]) Zona(d.zona, &sensores[inicioZona], (uint16_t)(i + 1 - inicioZona));
+            inicioZona = i + 1;
+        }
+    }
+
+    return getZonas();
+}
+
+void PoolModelo::resetar()
+{
+    totalSensores = 0;
+    totalZonas = 0;
+}
+
+Faixa<Sensor> PoolModelo::getSensores() const
+{
+    Faixa<Sensor> faixa;
+    faixa.inicio = sensores;
+    faixa.fim = sensores + totalSensores;
+    return faixa;
+}
+
+Faixa<Zona> PoolModelo::getZonas() const
+{
+    Faixa<Zona> faixa;
+    faixa.inicio = zonas;
+    faixa.fim = zonas + totalZonas;
+    return faixa;
+}
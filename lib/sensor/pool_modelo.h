@@ -0,0 +1,63 @@
+#ifndef POOL_MODELO_H
+#define POOL_MODELO_H
+
+#include <Arduino.h>
+#include <vector>
+#include "sensor.h"
+#include "zona.h"
+#include "faixa.h"
+
+// Um sensor como lido da config, antes de virar objeto no pool
+struct DefinicaoSensor
+{
+    const char *nome; // já internado na arenaNomes (ou literal da config compilada)
+    const char *zona; // idem; sensores da mesma zona apontam para o mesmo texto
+    Sensor::Tipo tipo;
+    int pino;
+    bool ativo;
+};
+
+// Todos os Sensor e Zona do sistema num único bloco contíguo.
+// O bloco só é realocado quando a nova config precisa de mais espaço;
+// numa recarga os objetos são descartados de uma vez com resetar().
+class PoolModelo
+{
+public:
+    PoolModelo();
+
+    // Monta sensores agrupados por zona (zonas em ordem alfabética).
+    // Reordena "defs". Retorna as zonas criadas (vazia se faltar memória).
+    Faixa<Zona> montar(std::vector<DefinicaoSensor> &defs);
+    // Idem, com "defs" já agrupado por zona (tabelas da config compilada)
+    Faixa<Zona> montarOrdenado(const DefinicaoSensor *defs, size_t total);
+    void resetar();
+
+    // Bloco externo (estático) para até "capacidade" sensores: montar sem heap.
+    // Uma config maior depois disso volta a alocar normalmente.
+    void usarBlocoFixo(uint8_t *bloco, size_t capacidade);
+    static constexpr size_t bytesPara(size_t n)
+    {
+        return ((n * sizeof(Sensor) + alignof(Zona) - 1) & ~(alignof(Zona) - 1)) + n * sizeof(Zona);
+    }
+
+    Faixa<Sensor> getSensores() const;
+    Faixa<Zona> getZonas() const;
+    size_t capacidadeSensores() const { return capSensores; }
+    uint32_t getGeracao() const { return geracao; } // muda a cada montar()
+
+private:
+    bool reservar(size_t totalSensores);
+
+    uint8_t *bloco;
+    bool blocoFixo; // não é do heap: não liberar
+    size_t capSensores; // zonas <= sensores: mesma capacidade para ambos
+    Sensor *sensores;
+    Zona *zonas;
+    size_t totalSensores;
+    size_t totalZonas;
+    uint32_t geracao;
+};
+
+extern PoolModelo poolModelo;
+
+#endif
@@ -1,14 +1,22 @@
 #include "sensor.h"
-Sensor::Sensor(const String &nome, Tipo tipo, int pino, const String &zona, bool ativo)
+#include "zona.h"
+Sensor::Sensor(const char *nome, Tipo tipo, int pino, const char *zona, bool ativo)
     : nome(nome), tipo(tipo), pino(pino), zona(zona),
       estadoAtual(Estado::NAO_VIOLADO),
       situacaoAtual(ativo ? Situacao::ATIVO : Situacao::INATIVO),
-      tempoUltimoAlerta(0), tentativas(0), isolado(false), alertaEmitido(false)
+      tempoUltimoAlerta(0), tentativas(0), isolado(false), alertaEmitido(false), zonaDona(nullptr)
 {
     pinMode(pino, INPUT);
 }
 
 void Sensor::atualizar()
+{
+    if (situacaoAtual == Situacao::INATIVO || isolado)
+        return;
+    atualizar((digitalRead(pino) == LOW) == ativoEmNivelBaixo(tipo));
+}
+
+void Sensor::atualizar(bool acionado)
 {
     if (situacaoAtual == Situacao::INATIVO || isolado)
     {
@@ -19,19 +27,7 @@ void Sensor::atualizar()
         return; // ← agora sim, só retorna se for para ignorar
     }
 
-    bool violado = false;
-
-    if (tipo == Tipo::PIR)
-    {
-        violado = digitalRead(pino) == LOW;
-    }
-    else if (tipo == Tipo::REED)
-    {
-        violado = digitalRead(pino) == LOW;
-    }
-
-    // Serial.printf("[DEBUG] Leitura digital do sensor %s: %d => violado: %s\n",
-    //               nome.c_str(), digitalRead(pino), violado ? "SIM" : "NAO");
+    const bool violado = acionado;
 
     if (violado)
     {
@@ -50,6 +46,7 @@ void Sensor::atualizar()
         else if (tentativas >= 4)
         {
             isolado = true;
+            mascarasMudaram();
         }
     }
     else
@@ -75,18 +72,41 @@ void Sensor::resetarAlerta()
 {
     estadoAtual = Estado::NAO_VIOLADO;
     tentativas = 0;
-    isolado = false;
+    if (isolado)
+    {
+        isolado = false;
+        mascarasMudaram();
+    }
 }
 
 Sensor::Estado Sensor::getEstado() const { return estadoAtual; }
 Sensor::Situacao Sensor::getSituacao() const { return situacaoAtual; }
-String Sensor::getNome() const { return nome; }
-String Sensor::getZona() const { return zona; }
 int Sensor::getTentativas() const { return tentativas; }
 bool Sensor::estaIsolado() const { return isolado; }
 
-void Sensor::ativar() { situacaoAtual = Situacao::ATIVO; }
-void Sensor::desativar() { situacaoAtual = Situacao::INATIVO; }
+void Sensor::limparIsolamento()
+{
+    isolado = false;
+    tentativas = 0;
+    mascarasMudaram();
+}
+
+void Sensor::ativar()
+{
+    situacaoAtual = Situacao::ATIVO;
+    mascarasMudaram();
+}
+
+void Sensor::desativar()
+{
+    situacaoAtual = Situacao::INATIVO;
+    mascarasMudaram();
+}
+
+void Sensor::mascarasMudaram()
+{
+    if (zonaDona) zonaDona->recalcularMascaras();
+}
 
 bool Sensor::foiAlertaEmitido() const { return alertaEmitido; }
 void Sensor::setAlertaEmitido(bool valor) { alertaEmitido = valor; }
@@ -94,25 +114,40 @@ void Sensor::setAlertaEmitido(bool valor) { alertaEmitido = valor; }
 Sensor::Tipo Sensor::getTipo() const { return tipo; }
 int Sensor::getPino() const { return pino; }
 
-Sensor::Tipo Sensor::tipoFromString(const String &str)
+Sensor::Tipo Sensor::tipoFromString(const char *str)
 {
-    if (str == "REED")
+    if (strcmp(str, "REED") == 0)
         return Tipo::REED;
     return Tipo::PIR;
 }
 
-String Sensor::getStatusString() const
+// Formata direto no buffer do chamador (sem String intermediária)
+size_t Sensor::formatarStatus(char *buffer, size_t tamanho) const
 {
-    char buffer[150];
-    snprintf(buffer, sizeof(buffer),
+    return snprintf(buffer, tamanho,
              "Sensor: %-10s | Tipo: %-4s | Pino: %-2d | Zona: %-10s | "
              "Estado: %-12s | Situacao: %-8s | Alerta: %s",
-             nome.c_str(),
+             nome,
              (tipo == Tipo::PIR ? "PIR" : "REED"),
              pino,
-             zona.c_str(),
+             zona,
              (estadoAtual == Estado::VIOLADO ? "VIOLADO" : "NAO_VIOLADO"),
              (situacaoAtual == Situacao::ATIVO ? "ATIVO" : "INATIVO"),
              (alertaEmitido ? "SIM" : "NAO"));
-    return String(buffer);
-}
\ No newline at end of file
+}
+
+Sensor::Instantaneo Sensor::instantaneo() const
+{
+    return {estadoAtual == Estado::VIOLADO, alertaEmitido, isolado, tentativas,
+            (uint32_t)(millis() - tempoUltimoAlerta)};
+}
+
+void Sensor::restaurar(const Instantaneo &i)
+{
+    estadoAtual = i.violado ? Estado::VIOLADO : Estado::NAO_VIOLADO;
+    alertaEmitido = i.alertaEmitido;
+    isolado = i.isolado;
+    tentativas = i.tentativas;
+    tempoUltimoAlerta = millis() - i.msDesdeAlerta;
+    mascarasMudaram();
+}
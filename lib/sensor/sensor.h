@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 
+class Zona;
+
 class Sensor
 {
 public:
@@ -22,21 +24,31 @@ public:
         INATIVO
     };
 
-    Sensor(const String &nome, Tipo tipo, int pino, const String &zona);
-    Sensor(const String &nome, Tipo tipo, int pino, const String &zona, bool ativo); // novo construtor
+    // nome/zona devem vir da arenaNomes (o ponteiro é guardado, não copiado)
+    Sensor(const char *nome, Tipo tipo, int pino, const char *zona, bool ativo = true);
 
     void atualizar();     // Atualiza estado com base na leitura do pino
+    void atualizar(bool acionado); // idem, com o pino já lido e a polaridade aplicada
+
+    // Polaridade por tipo; constexpr para que tabelas/máscaras montadas a
+    // partir de tipos constantes (config compilada) resolvam isso no build
+    static constexpr bool ativoEmNivelBaixo(Tipo t) { return t == Tipo::PIR || t == Tipo::REED; }
     void resetarAlerta(); // Reseta todos os atributos de estado
 
     Estado getEstado() const;
     Situacao getSituacao() const;
-    String getNome() const;
-    String getZona() const;
+    const char *getNome() const { return nome; }
+    const char *getZona() const { return zona; }
     int getTentativas() const;
     bool estaIsolado() const;
 
     void ativar();
     void desativar();
+    void limparIsolamento(); // volta a vigiar sem esperar o desarme
+
+    // Zona que mantém as máscaras de ativos/isolados (Zona::recalcularMascaras);
+    // a zona se vincula no construtor, depois dos sensores montados no pool
+    void vincular(Zona *zona) { zonaDona = zona; }
 
     bool foiAlertaEmitido() const;
     void setAlertaEmitido(bool valor);
@@ -44,15 +56,30 @@ public:
     Tipo getTipo() const;
     int getPino() const;
 
-    static Tipo tipoFromString(const String& str); // nova função auxiliar
+    static Tipo tipoFromString(const char *str); // nova função auxiliar
     bool estaAtivo() const { return situacaoAtual == Situacao::ATIVO; }
-    String getStatusString() const;
+    // nada a fazer enquanto o pino ficar em repouso (ver Zona::atualizar)
+    bool estaOcioso() const { return estadoAtual == Estado::NAO_VIOLADO && tentativas == 0; }
+    size_t formatarStatus(char *buffer, size_t tamanho) const;
+
+    // Estado interno, para o rastro de GPIO (rastro_gpio.h) começar um
+    // segmento no meio de um alerta e o replay continuar dali
+    struct Instantaneo
+    {
+        bool violado;
+        bool alertaEmitido;
+        bool isolado;
+        int tentativas;
+        uint32_t msDesdeAlerta; // só vale com tentativas > 0
+    };
+    Instantaneo instantaneo() const;
+    void restaurar(const Instantaneo &i);
 
 private:
-    String nome;
+    const char *nome;
     Tipo tipo;
     int pino;
-    String zona;
+    const char *zona;
 
     Estado estadoAtual;
     Situacao situacaoAtual;
@@ -61,6 +88,9 @@ private:
     int tentativas;
     bool isolado;
     bool alertaEmitido;
+    Zona *zonaDona;
+
+    void mascarasMudaram(); // situação ou isolamento mudou
 };
 
 
@@ -1,68 +1,127 @@
 #include "zona.h"
 #include "sensor.h"
+#include "entradas.h"
 
-Zona::Zona(const String &nome)
-    : nome(nome), armada(true), estadoAtual(Estado::NAO_VIOLADA)
+Zona::Zona(const char *nome, Sensor *primeiroSensor, uint16_t totalSensores)
+    : nome(nome), primeiroSensor(primeiroSensor), totalSensores(totalSensores),
+      mascaraPinos(0), mascaraAtivoAlto(0), mascaraAtivos(0), mascaraIsolados(0), ociosa(false),
+      ignorada(false), ignoradaAteMs(0), armada(true), estadoAtual(Estado::NAO_VIOLADA)
 {
+    for (Sensor &sensor : getSensores())
+    {
+        mascaraPinos |= entradasBit(sensor.getPino());
+        if (!Sensor::ativoEmNivelBaixo(sensor.getTipo()))
+            mascaraAtivoAlto |= entradasBit(sensor.getPino());
+        sensor.vincular(this);
+    }
+    recalcularMascaras();
 }
 
-void Zona::adicionarSensor(Sensor *sensor)
+// Fora do tick (mudanças de situação/isolamento são raras): percorre a zona.
+// Pinos compartilhados: o bit só sai se nenhum sensor do pino puder violar.
+void Zona::recalcularMascaras()
 {
-    sensores.push_back(sensor);
+    uint32_t vigiados = 0;
+    mascaraAtivos = 0;
+    for (const Sensor &sensor : getSensores())
+    {
+        if (!sensor.estaAtivo()) continue;
+        mascaraAtivos |= entradasBit(sensor.getPino());
+        if (!sensor.estaIsolado()) vigiados |= entradasBit(sensor.getPino());
+    }
+    mascaraIsolados = mascaraAtivos & ~vigiados;
+    ociosa = false; // sensor que volta a vigiar precisa ser visitado
 }
 
 void Zona::armar() {
     armada = true;
-    for (auto sensor : sensores) {
+    ociosa = false;
+    for (Sensor &sensor : getSensores()) {
         // Mantém o estado original (não força ativação)
-        if (sensor->getSituacao() == Sensor::Situacao::ATIVO) {
+        if (sensor.getSituacao() == Sensor::Situacao::ATIVO) {
             // Apenas atualiza o estado do sensor (sem alterar ATIVO/INATIVO)
-            sensor->atualizar(); 
+            sensor.atualizar(); 
         }
     }
 }
 
 void Zona::desarmar() {
     armada = false;
-    for (auto sensor : sensores) {
+    ociosa = false;
+    for (Sensor &sensor : getSensores()) {
         // Não desativa completamente, apenas marca como não armado
-        sensor->resetarAlerta(); // Ou outro método apropriado
+        sensor.resetarAlerta(); // Ou outro método apropriado
     }
 }
-void Zona::atualizar()
+void Zona::atualizar(uint32_t leitura)
 {
     estadoAtual = Estado::NAO_VIOLADA;
     if (!armada)
         return;
 
-    for (auto sensor : sensores)
+    if (ignorada)
+    {
+        if ((int32_t)(millis() - ignoradaAteMs) < 0)
+            return;
+        ignorada = false;
+        ociosa = false; // sensores ficaram parados durante o bypass
+    }
+
+    // Caminho rápido: nenhum pino vigiado acionado e nenhum sensor com
+    // estado pendente (alerta, tentativas) -> nada muda, sem percorrer sensores.
+    // Sensor inativo ou isolado preso no nível de disparo fica de fora pelas
+    // máscaras (recalculadas pelo próprio Sensor quando isso muda).
+    const uint32_t acionados =
+        (~leitura ^ mascaraAtivoAlto) & mascaraPinos & mascaraAtivos & ~mascaraIsolados;
+    if (acionados == 0 && ociosa)
+        return;
+
+    ociosa = true;
+    for (Sensor &sensor : getSensores())
     {
-        sensor->atualizar();
+        sensor.atualizar((acionados & entradasBit(sensor.getPino())) != 0);
+        // inativo/isolado não muda de estado até recalcularMascaras
+        ociosa = ociosa && (sensor.estaOcioso() || !sensorPodeViolar(&sensor));
 
         // Verificação mais explícita
-        if (sensor->getSituacao() != Sensor::Situacao::ATIVO)
+        if (sensor.getSituacao() != Sensor::Situacao::ATIVO)
         {
             continue; // Pula sensores inativos
         }
 
-        if (sensor->getEstado() == Sensor::Estado::VIOLADO &&
-            sensor->estaAtivo() &&
-            !sensor->estaIsolado())
+        if (sensor.getEstado() == Sensor::Estado::VIOLADO &&
+            sensor.estaAtivo() &&
+            !sensor.estaIsolado())
         {
             estadoAtual = Estado::VIOLADA;
-            break;
         }
     }
 }
-Zona::~Zona()
+void Zona::ignorarPor(uint32_t ms)
 {
-    for (auto s : sensores)
-    {
-        delete s;
-    }
-    sensores.clear();
+    ignorada = ms > 0;
+    ignoradaAteMs = millis() + ms;
+    ociosa = false;
+}
+
+uint32_t Zona::segundosIgnorada() const
+{
+    return (msIgnorada() + 999) / 1000;
+}
+
+uint32_t Zona::msIgnorada() const
+{
+    if (!ignorada) return 0;
+    const int32_t falta = (int32_t)(ignoradaAteMs - millis());
+    return falta > 0 ? falta : 0;
 }
+
 Zona::Estado Zona::getEstado() const { return estadoAtual; }
 bool Zona::estaViolada() const { return estadoAtual == Estado::VIOLADA; }
-String Zona::getNome() const { return nome; }
-const std::vector<Sensor *> &Zona::getSensores() const { return sensores; }
+Faixa<Sensor> Zona::getSensores() const
+{
+    Faixa<Sensor> faixa;
+    faixa.inicio = primeiroSensor;
+    faixa.fim = primeiroSensor + totalSensores;
+    return faixa;
+}
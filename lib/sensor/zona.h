@@ -2,8 +2,8 @@
 #define ZONA_H
 
 #include <Arduino.h>
-#include <vector>
 #include "sensor.h"
+#include "faixa.h"
 
 class Zona
 {
@@ -14,27 +14,46 @@ public:
         VIOLADA
     };
 
-    Zona(const String &nome);
-    ~Zona(); 
-    void adicionarSensor(Sensor *sensor);
+    // nome vem da arenaNomes; os sensores da zona são contíguos no PoolModelo
+    Zona(const char *nome, Sensor *primeiroSensor, uint16_t totalSensores);
     void armar();
     void desarmar();
-    void atualizar();
+    void atualizar(uint32_t leitura); // leitura = entradasLer() do tick
 
     Estado getEstado() const;
-    String getNome() const;
+    const char *getNome() const { return nome; }
 
     bool estaViolada() const;
-    const std::vector<Sensor *> &getSensores() const;
+    bool estaArmada() const { return armada; }
+
+    // Bypass temporário: a zona não é avaliada até expirar (0 cancela).
+    // Não persiste: depois de um reinício a zona volta a ser vigiada.
+    void ignorarPor(uint32_t ms);
+    bool estaIgnorada() const { return ignorada; }
+    uint32_t segundosIgnorada() const;
+    uint32_t msIgnorada() const; // 0 = não ignorada ou vencendo neste tick
+    Faixa<Sensor> getSensores() const;
     bool sensorPodeViolar(const Sensor *sensor) const
     {
         return sensor->getSituacao() == Sensor::Situacao::ATIVO &&
                !sensor->estaIsolado();
     }
 
+    // Refaz mascaraAtivos/mascaraIsolados; o Sensor chama quando é
+    // ativado, desativado, isolado ou sai do isolamento
+    void recalcularMascaras();
+
 private:
-    String nome;
-    std::vector<Sensor *> sensores;
+    const char *nome;
+    Sensor *primeiroSensor;
+    uint16_t totalSensores;
+    uint32_t mascaraPinos;    // pinos de todos os sensores da zona (montada no construtor)
+    uint32_t mascaraAtivoAlto; // pinos cujo sensor viola em nível alto
+    uint32_t mascaraAtivos;   // pinos com algum sensor ATIVO
+    uint32_t mascaraIsolados; // pinos cujos sensores ATIVOS estão todos isolados
+    bool ociosa;           // todos os sensores em repouso na última passada completa
+    bool ignorada;
+    uint32_t ignoradaAteMs;
     bool armada;
     Estado estadoAtual;
 };
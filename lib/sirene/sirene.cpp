@@ -8,6 +8,7 @@ Sirene::Sirene(int pino, unsigned long tempoHigh, unsigned long tempoLow, int ci
       tempoLow(tempoLow),
       ciclosMaximos(ciclosMaximos),
       ativa(false),
+      silenciada(false),
       ultimaTroca(0),
       ciclosAtuais(0),
       emHigh(false),
@@ -19,7 +20,7 @@ Sirene::Sirene(int pino, unsigned long tempoHigh, unsigned long tempoLow, int ci
 
 void Sirene::ativar(Sensor *sensor)
 {
-    if (ativa)
+    if (ativa || silenciada)
         return;
     ativa = true;
     ciclosAtuais = 0;
@@ -31,7 +32,7 @@ void Sirene::ativar(Sensor *sensor)
 
 void Sirene::atualizar()
 {
-    if (!ativa || !sensorAlvo)
+    if (!ativa)
         return;
 
     unsigned long agora = millis();
@@ -47,17 +48,21 @@ void Sirene::atualizar()
         ciclosAtuais++;
         if (ciclosAtuais >= ciclosMaximos)
         {
-            if (sensorAlvo->getEstado() == Sensor::Estado::VIOLADO)
+            if (sensorAlvo && sensorAlvo->getEstado() == Sensor::Estado::VIOLADO)
             {
                 // 👉 REGISTRA o evento e DESATIVA o sensor
-                registrarEvento("[ALERTA] Sirene tocou 4 vezes seguidas. Sensor " + sensorAlvo->getNome() + " da zona " + sensorAlvo->getZona() + " foi desabilitado.");
+                char origem[80];
+                snprintf(origem, sizeof(origem), "desabilitado/%s/%s", sensorAlvo->getZona(), sensorAlvo->getNome());
+                registrarEventoAgrupado(origem, "[ALERTA] Sirene tocou 4 vezes seguidas. Sensor %s da zona %s foi desabilitado.",
+                                        sensorAlvo->getNome(), sensorAlvo->getZona());
                 sensorAlvo->desativar();
             }
             desativar();
             return;
         }
 
-        if (sensorAlvo->getEstado() == Sensor::Estado::VIOLADO)
+        // acionamento remoto (sem sensor local) toca os ciclos completos
+        if (!sensorAlvo || sensorAlvo->getEstado() == Sensor::Estado::VIOLADO)
         {
             digitalWrite(pino, HIGH);
             emHigh = true;
@@ -81,3 +86,24 @@ bool Sirene::estaAtiva() const
 {
     return ativa;
 }
+
+void Sirene::silenciar(bool valor)
+{
+    silenciada = valor;
+    if (valor) desativar();
+}
+
+Sirene::Instantaneo Sirene::instantaneo() const
+{
+    return {ativa, emHigh, ciclosAtuais, (uint32_t)(millis() - ultimaTroca), sensorAlvo};
+}
+
+void Sirene::restaurar(const Instantaneo &i)
+{
+    ativa = i.ativa;
+    emHigh = i.emHigh;
+    ciclosAtuais = i.ciclos;
+    ultimaTroca = millis() - i.msDesdeTroca;
+    sensorAlvo = i.alvo;
+    digitalWrite(pino, ativa && emHigh ? HIGH : LOW);
+}
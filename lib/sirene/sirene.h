@@ -9,11 +9,25 @@ class Sirene {
 public:
     Sirene(int pino, unsigned long tempoHigh, unsigned long tempoLow, int ciclosMaximos);
 
-    void ativar(Sensor* sensorAlvo);
+    void ativar(Sensor* sensorAlvo); // nullptr = acionamento remoto (P2P)
     void atualizar();
     void desativar();
     bool estaAtiva() const;
     bool ciclosEncerrados() const;
+    // Muda (teste de caminhada): ativar() não toca, nem por P2P
+    void silenciar(bool valor);
+
+    // Estado interno, para o rastro de GPIO (rastro_gpio.h); alvo nulo = remoto
+    struct Instantaneo
+    {
+        bool ativa;
+        bool emHigh;
+        int ciclos;
+        uint32_t msDesdeTroca;
+        Sensor *alvo;
+    };
+    Instantaneo instantaneo() const;
+    void restaurar(const Instantaneo &i);
 
 private:
     int pino;
@@ -22,6 +36,7 @@ private:
     int ciclosMaximos;
 
     bool ativa;
+    bool silenciada;
     unsigned long ultimaTroca;
     int ciclosAtuais;
     bool emHigh;
@@ -0,0 +1,138 @@
+#include "limitador.h"
+#include "system_config.h"
+#include "event_logger.h"
+#include "metricas.h"
+
+// Fichas em milésimos: recarga = ms decorridos * taxa (req/s), sem float
+struct Balde
+{
+    uint32_t fichasMil;
+    uint32_t atualizadoMs;
+
+    bool consumir(uint32_t custo, uint32_t capacidade, uint32_t taxa, uint32_t agora)
+    {
+        const uint32_t maximo = capacidade * 1000;
+        uint32_t decorrido = agora - atualizadoMs;
+        if (decorrido > maximo) decorrido = maximo; // evita overflow após muito tempo parado
+        const uint32_t recarga = decorrido * taxa;
+        fichasMil = (recarga >= maximo - fichasMil) ? maximo : fichasMil + recarga;
+        atualizadoMs = agora;
+
+        if (fichasMil < custo * 1000) return false;
+        fichasMil -= custo * 1000;
+        return true;
+    }
+};
+
+struct EntradaIp
+{
+    uint32_t ip;
+    uint32_t vistoMs;
+    Balde balde;
+    uint8_t falhasLogin;
+    uint32_t ultimaFalhaMs;
+    uint32_t bloqueadoAteMs; // 0 = livre
+};
+
+static EntradaIp tabela[WEB_TABELA_IPS];
+static Balde baldeGlobal = {WEB_BALDE_GLOBAL_CAPACIDADE * 1000, 0};
+// Login tem balde global próprio: IPs rotativos tentando senhas não
+// esvaziam o global das páginas (e a tabela perde os bloqueios deles)
+static Balde baldeLogin = {WEB_BALDE_LOGIN_CAPACIDADE * 1000, 0};
+
+static bool bloqueado(const EntradaIp &e, uint32_t agora)
+{
+    return e.bloqueadoAteMs && (int32_t)(e.bloqueadoAteMs - agora) > 0;
+}
+
+// Entrada do IP; se não existir, ocupa a menos recente (IP bloqueado só
+// sai se todos estiverem bloqueados)
+static EntradaIp &entrada(uint32_t ip, uint32_t agora)
+{
+    EntradaIp *alvo = nullptr;
+    for (EntradaIp &e : tabela)
+    {
+        if (e.ip == ip) return e;
+        const bool eLivre = !e.ip || !bloqueado(e, agora);
+        const bool alvoLivre = alvo && (!alvo->ip || !bloqueado(*alvo, agora));
+        if (!alvo || (eLivre && !alvoLivre) || (eLivre == alvoLivre && e.vistoMs < alvo->vistoMs)) alvo = &e;
+    }
+
+    memset(alvo, 0, sizeof(*alvo));
+    alvo->ip = ip;
+    alvo->vistoMs = agora;
+    alvo->balde = {WEB_BALDE_IP_CAPACIDADE * 1000, agora};
+    return *alvo;
+}
+
+static void responder429(WiFiClient *cliente, const char *retryAfter)
+{
+    cliente->printf("HTTP/1.1 429 Too Many Requests\r\nRetry-After: %s\r\n"
+                    "Content-Length: 0\r\nConnection: close\r\n\r\n", retryAfter);
+    contadores.httpRejeitadas++;
+}
+
+static ESP8266WebServer::ClientFuture admitir(const String &, const String &url, WiFiClient *cliente,
+                                              ESP8266WebServer::ContentTypeFunction)
+{
+    const uint32_t agora = millis();
+    EntradaIp &e = entrada(cliente->remoteIP(), agora);
+    e.vistoMs = agora;
+
+    const bool login = url.startsWith("/login") || url.startsWith("/verifica_login");
+    if (login && bloqueado(e, agora))
+    {
+        char segundos[12];
+        snprintf(segundos, sizeof(segundos), "%u", (e.bloqueadoAteMs - agora) / 1000 + 1);
+        responder429(cliente, segundos);
+        return ESP8266WebServer::CLIENT_MUST_STOP;
+    }
+
+    const uint32_t custo = login ? WEB_CUSTO_LOGIN : 1;
+    if (!e.balde.consumir(custo, WEB_BALDE_IP_CAPACIDADE, WEB_BALDE_IP_TAXA, agora) ||
+        !(login ? baldeLogin.consumir(custo, WEB_BALDE_LOGIN_CAPACIDADE, WEB_BALDE_LOGIN_TAXA, agora)
+                : baldeGlobal.consumir(1, WEB_BALDE_GLOBAL_CAPACIDADE, WEB_BALDE_GLOBAL_TAXA, agora)))
+    {
+        responder429(cliente, "1");
+        return ESP8266WebServer::CLIENT_MUST_STOP;
+    }
+    return ESP8266WebServer::CLIENT_REQUEST_CAN_CONTINUE;
+}
+
+void limitadorSetup(ESP8266WebServer &server)
+{
+    server.addHook(admitir);
+}
+
+bool limitadorLoginBloqueado(const IPAddress &ip)
+{
+    const uint32_t agora = millis();
+    return bloqueado(entrada(ip, agora), agora);
+}
+
+void limitadorFalhaLogin(const IPAddress &ip)
+{
+    const uint32_t agora = millis();
+    EntradaIp &e = entrada(ip, agora);
+
+    // falhas antigas (fora da janela) não somam
+    if (agora - e.ultimaFalhaMs > TEMPO_BLOQUEIO_LOGIN) e.falhasLogin = 0;
+    e.ultimaFalhaMs = agora;
+
+    if (++e.falhasLogin >= MAX_TENTATIVAS_LOGIN)
+    {
+        e.bloqueadoAteMs = (agora + TEMPO_BLOQUEIO_LOGIN) | 1; // nunca 0
+        e.falhasLogin = 0;
+        contadores.httpBloqueiosLogin++;
+        registrarEventoF("[SEGURANCA] IP %s bloqueado por %u min após %u senhas erradas",
+                         ip.toString().c_str(), TEMPO_BLOQUEIO_LOGIN / 60000, MAX_TENTATIVAS_LOGIN);
+    }
+}
+
+void limitadorSucessoLogin(const IPAddress &ip)
+{
+    const uint32_t agora = millis();
+    EntradaIp &e = entrada(ip, agora);
+    e.falhasLogin = 0;
+    e.bloqueadoAteMs = 0;
+}
@@ -0,0 +1,19 @@
+#ifndef LIMITADOR_H
+#define LIMITADOR_H
+
+#include <ESP8266WebServer.h>
+
+// Admissão de requisições em memória fixa (tabela de WEB_TABELA_IPS IPs).
+//
+// Um hook do servidor roda logo após a linha de requisição, antes de ler
+// cabeçalhos/corpo: sem fichas no balde do IP ou no global (o de login é
+// separado do das páginas), responde 429 direto no socket e fecha. O
+// bloqueio de login (MAX_TENTATIVAS_LOGIN falhas -> TEMPO_BLOQUEIO_LOGIN)
+// também é por IP e expira sozinho.
+void limitadorSetup(ESP8266WebServer &server);
+
+bool limitadorLoginBloqueado(const IPAddress &ip);
+void limitadorFalhaLogin(const IPAddress &ip);
+void limitadorSucessoLogin(const IPAddress &ip);
+
+#endif
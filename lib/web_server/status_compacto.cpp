@@ -0,0 +1,137 @@
+#include "status_compacto.h"
+#include <string.h>
+#include "alarme.h"
+#include "zona.h"
+#include "sensor.h"
+
+namespace
+{
+    // Escrita MessagePack num buffer fixo; estourou = descarta tudo
+    struct Escritor
+    {
+        uint8_t *buf;
+        size_t tamanho;
+        size_t pos;
+        bool estourou;
+
+        uint8_t *reservar(size_t n)
+        {
+            if (estourou || pos + n > tamanho)
+            {
+                estourou = true;
+                return nullptr;
+            }
+            uint8_t *p = buf + pos;
+            pos += n;
+            return p;
+        }
+
+        void byte(uint8_t b)
+        {
+            if (uint8_t *p = reservar(1)) *p = b;
+        }
+
+        void be(uint32_t v, uint8_t bytes)
+        {
+            if (uint8_t *p = reservar(bytes))
+                for (int8_t i = bytes - 1; i >= 0; i--, v >>= 8) p[i] = v & 0xFF;
+        }
+
+        void uint(uint32_t v)
+        {
+            if (v < 0x80) byte(v);
+            else if (v <= 0xFF) { byte(0xCC); be(v, 1); }
+            else if (v <= 0xFFFF) { byte(0xCD); be(v, 2); }
+            else { byte(0xCE); be(v, 4); }
+        }
+
+        void array(uint16_t n)
+        {
+            if (n < 16) byte(0x90 | n);
+            else { byte(0xDC); be(n, 2); }
+        }
+
+        void str(const char *s)
+        {
+            const size_t n = strlen(s);
+            if (n < 32) byte(0xA0 | n);
+            else if (n <= 0xFF) { byte(0xD9); be(n, 1); }
+            else { byte(0xDA); be(n, 2); }
+            if (uint8_t *p = reservar(n)) memcpy(p, s, n);
+        }
+
+        // bin zerado de 'planos' x ceil(n/8) bytes; devolve o início para marcar bits
+        uint8_t *bin(uint16_t n, uint8_t planos)
+        {
+            const uint16_t bytes = ((n + 7) / 8) * planos;
+            if (bytes <= 0xFF) { byte(0xC4); be(bytes, 1); }
+            else { byte(0xC5); be(bytes, 2); }
+            uint8_t *p = reservar(bytes);
+            if (p) memset(p, 0, bytes);
+            return p;
+        }
+    };
+
+    inline void marcar(uint8_t *plano, uint16_t i, bool v)
+    {
+        if (v) plano[i >> 3] |= 1 << (i & 7);
+    }
+}
+
+size_t statusCompactoGerar(const Alarme &alarme, uint8_t *buf, size_t tamanho)
+{
+    Escritor w = {buf, tamanho, 0, false};
+
+    uint16_t totalZonas = 0, totalSensores = 0;
+    for (const Zona &zona : alarme.getZonas())
+    {
+        totalZonas++;
+        totalSensores += zona.getSensores().size();
+    }
+
+    w.array(6);
+    w.uint(1);
+    w.uint((alarme.getEstado() == Alarme::Estado::ARMADO ? 1 : 0) |
+           (alarme.getModo() == Alarme::Modo::MANUAL ? 2 : 0));
+    w.uint(millis() / 1000);
+
+    w.array(totalZonas);
+    for (const Zona &zona : alarme.getZonas())
+    {
+        w.array(2);
+        w.str(zona.getNome());
+        w.uint(zona.getSensores().size());
+    }
+
+    const std::vector<String> &ativas = alarme.getZonasAtivas();
+    const uint16_t bytesZona = (totalZonas + 7) / 8;
+    if (uint8_t *planos = w.bin(totalZonas, 2))
+    {
+        uint16_t i = 0;
+        for (const Zona &zona : alarme.getZonas())
+        {
+            bool ativa = false;
+            for (const String &z : ativas)
+                if (z == zona.getNome()) { ativa = true; break; }
+            marcar(planos, i, ativa);
+            marcar(planos + bytesZona, i, zona.estaViolada());
+            i++;
+        }
+    }
+
+    const uint16_t bytesSensor = (totalSensores + 7) / 8;
+    if (uint8_t *planos = w.bin(totalSensores, 3))
+    {
+        uint16_t i = 0;
+        for (const Zona &zona : alarme.getZonas())
+            for (const Sensor &s : zona.getSensores())
+            {
+                marcar(planos, i, s.getEstado() == Sensor::Estado::VIOLADO);
+                marcar(planos + bytesSensor, i, s.getSituacao() == Sensor::Situacao::ATIVO);
+                marcar(planos + 2 * bytesSensor, i, s.estaIsolado());
+                i++;
+            }
+    }
+
+    return w.estourou ? 0 : w.pos;
+}
@@ -0,0 +1,23 @@
+#ifndef STATUS_COMPACTO_H
+#define STATUS_COMPACTO_H
+
+#include <Arduino.h>
+
+class Alarme;
+
+// /status.json em MessagePack (Accept: application/msgpack), gerado direto do
+// modelo vivo, sem montar JsonDocument. Versão 1, array de 6 itens:
+//
+//   [0] versão (1)
+//   [1] flags: bit0 armado, bit1 modo manual
+//   [2] tempo_online (s)
+//   [3] zonas: [[nome, nº de sensores], ...]
+//   [4] bin, 2 planos de bits por zona: ativa, violada
+//   [5] bin, 3 planos de bits por sensor (na ordem das zonas): violado, ativo, isolado
+//
+// Cada plano ocupa ceil(n/8) bytes, bit i de byte i/8 (LSB primeiro).
+// Os nomes de sensor ficam só no JSON; a ordem é a mesma de /status.json.
+// Retorna os bytes escritos ou 0 se não couber em 'tamanho'.
+size_t statusCompactoGerar(const Alarme &alarme, uint8_t *buf, size_t tamanho);
+
+#endif
@@ -0,0 +1,32 @@
+#include "status_json.h"
+#include "alarme.h"
+#include "zona.h"
+#include "sensor.h"
+
+void statusJsonMontar(const Alarme &alarme, JsonDocument &doc)
+{
+  doc["estado_alarme"] = alarme.getEstado() == Alarme::Estado::ARMADO ? "ARMADO" : "DESARMADO";
+  doc["modo_operacao"] = alarme.getModo() == Alarme::Modo::MANUAL ? "MANUAL" : "AUTOMATICO";
+  doc["teste_caminhada"] = alarme.emTesteCaminhada(); // ARMADO aqui é o do teste
+  doc["tempo_online"] = millis() / 1000;
+
+  JsonArray zonasAtivas = doc.createNestedArray("zonas_ativas");
+  for (const String &z : alarme.getZonasAtivas()) zonasAtivas.add(z);
+
+  JsonArray zonas = doc.createNestedArray("zonas");
+  for (const Zona &zona : alarme.getZonas()) {
+    JsonObject z = zonas.createNestedObject();
+    z["nome"] = zona.getNome();
+    z["estado"] = zona.estaViolada() ? "VIOLADA" : "OK";
+    if (zona.estaIgnorada()) z["ignorada_s"] = zona.segundosIgnorada();
+
+    JsonArray sensores = z.createNestedArray("sensores");
+    for (const Sensor &sensor : zona.getSensores()) {
+      JsonObject s = sensores.createNestedObject();
+      s["nome"] = sensor.getNome();
+      s["estado"] = sensor.getEstado() == Sensor::Estado::VIOLADO ? "VIOLADO" : "OK";
+      s["ativo"] = sensor.getSituacao() == Sensor::Situacao::ATIVO;
+      s["isolado"] = sensor.estaIsolado();
+    }
+  }
+}
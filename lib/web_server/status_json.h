@@ -0,0 +1,13 @@
+#ifndef STATUS_JSON_H
+#define STATUS_JSON_H
+
+#include <ArduinoJson.h>
+
+class Alarme;
+
+// /status.json em JSON: estado, modo, zonas ativas e, por zona, os sensores
+// com nome, estado, ativo e isolado. Separado de web_server.cpp para a
+// bancada medir o custo ao lado do formato compacto (status_compacto.h).
+void statusJsonMontar(const Alarme &alarme, JsonDocument &doc);
+
+#endif
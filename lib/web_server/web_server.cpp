@@ -9,6 +9,10 @@
 #include "sirene.h"
 #include "alarme.h"
 #include "zona.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "config_compilada.h"
+#include "status_json.h"
 
 ESP8266WebServer server(80);
 Alarme* alarmePtr = nullptr;
@@ -28,6 +32,7 @@ void salvarUltimoDiaReinicio(int diaId) {
   // 1) Lê o JSON atual
   File file = LittleFS.open("/horarios.json", "r");
   if (!file) return;
+  metricasArquivoAberto();
 
   StaticJsonDocument<512> doc;
   DeserializationError err = deserializeJson(doc, file);
@@ -38,27 +43,27 @@ void salvarUltimoDiaReinicio(int diaId) {
   doc["ultimoDiaReinicio"] = diaId;
 
   // 3) Escrita atômica
-  File tmp = LittleFS.open("/horarios.tmp", "w");
-  if (!tmp) return;
-
-  if (serializeJson(doc, tmp) == 0) {
-    tmp.close();
-    LittleFS.remove("/horarios.tmp");
-    return;
-  }
-  tmp.close();
-
-  LittleFS.remove("/horarios.json");
-  LittleFS.rename("/horarios.tmp", "/horarios.json");
+  armazenamentoGravarJson("/horarios.json", doc.as<JsonVariantConst>());
 }
 
 // ------------------------------------
 // Carrega horários do arquivo JSON
 // ------------------------------------
+// Padrão: HORARIOS_PADRAO (tabela compilada, se o build tiver uma)
+static void aplicarHorariosPadrao() {
+  ARM_HOUR_WEEKDAY = HORARIOS_PADRAO.armarSemana;
+  DISARM_HOUR_WEEKDAY = HORARIOS_PADRAO.desarmarSemana;
+  ARM_HOUR_WEEKEND = HORARIOS_PADRAO.armarFimSemana;
+  DISARM_HOUR_WEEKEND = HORARIOS_PADRAO.desarmarFimSemana;
+  HORA_RESTART = HORARIOS_PADRAO.horaRestart;
+  RESTART_CONFIG = HORARIOS_PADRAO.restartConfig;
+}
+
 void loadHorariosFromFS() {
   File file = LittleFS.open("/horarios.json", "r");
   if (!file) {
     Serial.println("[CONFIG] Arquivo de horários não encontrado. Usando valores padrão.");
+    aplicarHorariosPadrao();
     return;
   }
 
@@ -70,12 +75,12 @@ void loadHorariosFromFS() {
   }
   file.close();
 
-  ARM_HOUR_WEEKDAY = doc["ARM_HOUR_WEEKDAY"] | 18;
-  DISARM_HOUR_WEEKDAY = doc["DISARM_HOUR_WEEKDAY"] | 6;
-  ARM_HOUR_WEEKEND = doc["ARM_HOUR_WEEKEND"] | 0;
-  DISARM_HOUR_WEEKEND = doc["DISARM_HOUR_WEEKEND"] | 0;
-  HORA_RESTART = doc["horaRestart"] | 23;
-  RESTART_CONFIG = doc["restartConfig"] | false;
+  ARM_HOUR_WEEKDAY = doc["ARM_HOUR_WEEKDAY"] | HORARIOS_PADRAO.armarSemana;
+  DISARM_HOUR_WEEKDAY = doc["DISARM_HOUR_WEEKDAY"] | HORARIOS_PADRAO.desarmarSemana;
+  ARM_HOUR_WEEKEND = doc["ARM_HOUR_WEEKEND"] | HORARIOS_PADRAO.armarFimSemana;
+  DISARM_HOUR_WEEKEND = doc["DISARM_HOUR_WEEKEND"] | HORARIOS_PADRAO.desarmarFimSemana;
+  HORA_RESTART = doc["horaRestart"] | HORARIOS_PADRAO.horaRestart;
+  RESTART_CONFIG = doc["restartConfig"] | HORARIOS_PADRAO.restartConfig;
   ultimoDiaReinicio = doc["ultimoDiaReinicio"] | -1;
 
 /*   Serial.println("[CONFIG] Horários carregados da LittleFS:");
@@ -118,64 +123,12 @@ bool credenciais_validas(String usuario, String senha) {
   return false;
 }
 
-// ------------------------------------
-// Registra evento no histórico
-// ------------------------------------
-void registrarEvento(const String &mensagem) {
-  DynamicJsonDocument doc(4096);
-  File file = LittleFS.open(HISTORICO_PATH, "r");
-  if (file) {
-    if (deserializeJson(doc, file)) doc.clear();
-    file.close();
-  }
-
-  if (!doc.is<JsonArray>()) {
-    doc.clear();
-    doc.to<JsonArray>();
-  }
-
-  JsonArray arr = doc.as<JsonArray>();
-  JsonObject novo = arr.createNestedObject();
-  novo["timestamp"] = time(nullptr);
-  novo["evento"] = mensagem;
-
-  while (arr.size() > HISTORICO_MAX_REGISTROS) arr.remove(0);
-
-  file = LittleFS.open(HISTORICO_PATH, "w");
-  if (file) {
-    serializeJson(doc, file);
-    file.close();
-  }
-}
-
 // ------------------------------------
 // Retorna JSON com estado completo do sistema
 // ------------------------------------
 String getEstadoAtualJson() {
   StaticJsonDocument<2048> doc;
-
-  doc["estado_alarme"] = alarmePtr->getEstado() == Alarme::Estado::ARMADO ? "ARMADO" : "DESARMADO";
-  doc["modo_operacao"] = alarmePtr->getModo() == Alarme::Modo::MANUAL ? "MANUAL" : "AUTOMATICO";
-  doc["tempo_online"] = millis() / 1000;
-
-  JsonArray zonasAtivas = doc.createNestedArray("zonas_ativas");
-  for (const String &z : alarmePtr->getZonasAtivas()) zonasAtivas.add(z);
-
-  JsonArray zonas = doc.createNestedArray("zonas");
-  for (auto zona : alarmePtr->getZonas()) {
-    JsonObject z = zonas.createNestedObject();
-    z["nome"] = zona->getNome();
-    z["estado"] = zona->estaViolada() ? "VIOLADA" : "OK";
-
-    JsonArray sensores = z.createNestedArray("sensores");
-    for (auto sensor : zona->getSensores()) {
-      JsonObject s = sensores.createNestedObject();
-      s["nome"] = sensor->getNome();
-      s["estado"] = sensor->getEstado() == Sensor::Estado::VIOLADO ? "VIOLADO" : "OK";
-      s["ativo"] = sensor->getSituacao() == Sensor::Situacao::ATIVO;
-      s["isolado"] = sensor->estaIsolado();
-    }
-  }
+  statusJsonMontar(*alarmePtr, doc);
 
   String out;
   serializeJson(doc, out);
@@ -200,16 +153,28 @@ std::vector<String> splitZonas(const String &zonasStr) {
 // Setup das rotas HTTP
 // ------------------------------------
 #include "web_server_handlers.h"
+#include "limitador.h"
+#include "energia.h"
 
 void web_server_setup(Alarme *alarme) {
   alarmePtr = alarme;
 
+  // antes das rotas: requisição sem fichas nem chega aos handlers
+  limitadorSetup(server);
+
+  // páginas pedem vários arquivos em seguida: sem pausas do loop por um tempo
+  server.addHook([](const String &, const String &, WiFiClient *, ESP8266WebServer::ContentTypeFunction) {
+    energiaAtividade();
+    return ESP8266WebServer::CLIENT_REQUEST_CAN_CONTINUE;
+  });
+
   server.on("/", handleIndex);
   server.on("/index", handleIndex);
   server.on("/admin", handleAdmin);
 
   server.on("/status.json", HTTP_GET, handleStatus);
   server.on("/historico.json", HTTP_GET, handleHistorico);
+  server.on("/historico/resumo.json", HTTP_GET, handleResumoHistorico);
   server.on("/arma", HTTP_POST, handleArmar);
   server.on("/desarma", HTTP_POST, handleDesarmar);
   server.on("/modo", HTTP_POST, handleModo);
@@ -227,6 +192,27 @@ void web_server_setup(Alarme *alarme) {
   server.on("/config_sensores", HTTP_GET, handleConfigSensoresPage);
   server.on("/sensores.json", HTTP_GET, handleGetSensores);
   server.on("/sensores.json", HTTP_POST, handlePostSensores);
+  server.on("/sensores/ajuste", HTTP_PATCH, handlePatchSensor);
+  server.on("/zonas/bypass", HTTP_PATCH, handlePatchBypassZona);
+
+  server.on("/diag/boot.json", HTTP_GET, handleDiagBoot);
+  server.on("/diag/crash.json", HTTP_GET, handleDiagCrash);
+  server.on("/diag/energia.json", HTTP_GET, handleDiagEnergia);
+  server.on("/diag/walktest.json", HTTP_GET, handleGetTesteCaminhada);
+  server.on("/diag/walktest.json", HTTP_POST, handlePostTesteCaminhada);
+  server.on("/diag/rastro.json", HTTP_GET, handleGetRastro);
+  server.on("/diag/rastro.json", HTTP_POST, handlePostRastro);
+  server.on("/diag/rastro.bin", HTTP_GET, handleGetRastroBin);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/mqtt.json", HTTP_POST, handlePostMqtt);
+  server.on("/notificacoes.json", HTTP_POST, handlePostNotificacoes);
+  server.on("/config/bundle", HTTP_GET, handleGetConfigBundle);
+  server.on("/config/bundle", HTTP_POST, handlePostConfigBundle);
+
+  // senha e CRC do bundle vão em cabeçalhos (fora da URL e dos logs de acesso);
+  // Accept escolhe JSON ou MessagePack em /status.json
+  static const char *cabecalhos[] = {"X-Senha-Admin", "X-Bundle-CRC32", "Accept"};
+  server.collectHeaders(cabecalhos, sizeof(cabecalhos) / sizeof(cabecalhos[0]));
 
   server.serveStatic("/", LittleFS, "/");
 
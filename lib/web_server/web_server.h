@@ -10,7 +10,6 @@ extern ESP8266WebServer server;
 
 void web_server_setup(Alarme* alarme);
 bool credenciais_validas(String usuario, String senha);
-void registrarEvento(const String &mensagem);
 void loadHorariosFromFS();
 void salvarUltimoDiaReinicio(int dia);
 
@@ -14,6 +14,22 @@
 #include "sensor.h"
 #include "sirene.h"
 #include "alarme.h"
+#include "event_logger.h"
+#include "config_sensores.h"
+#include "config_bundle.h"
+#include "mqtt_publisher.h"
+#include "notificacoes.h"
+#include "boot_profiler.h"
+#include "vigia_loop.h"
+#include "energia.h"
+#include "teste_caminhada.h"
+#include "rastro_gpio.h"
+#include "metricas.h"
+#include "armazenamento.h"
+#include "limitador.h"
+#include "status_compacto.h"
+#include "ajustes_sensores.h"
+#include "resumo_historico.h"
 
 extern ESP8266WebServer server;
 extern Alarme *alarmePtr;
@@ -23,39 +39,54 @@ extern bool RESTART_CONFIG;
 extern int ultimoDiaReinicio;
 extern void configurarSistema();
 
-// Variáveis de estado do login
-int tentativasLogin = 0;
-unsigned long ultimaTentativa = 0;
-bool sistemaBloqueado = false;
-
 // Helpers
 namespace {
+    // Bloqueio por IP (limitador.cpp): um cliente errando a senha não trava os outros
     bool verificarSenhaAdmin(const String &senha) {
-        if (sistemaBloqueado) return false;
-        
-        // Verifica se excedeu tentativas
-        if (millis() - ultimaTentativa < TEMPO_BLOQUEIO_LOGIN && 
-            tentativasLogin >= MAX_TENTATIVAS_LOGIN) {
-            sistemaBloqueado = true;
-            return false;
-        }
+        const IPAddress ip = server.client().remoteIP();
+        if (limitadorLoginBloqueado(ip)) return false;
 
         bool senhaCorreta = (senha == SENHA_ADMIN_PADRAO); // Simples comparação
         // Em produção, substituir por: senhaCorreta = (hashSenha(senha) == SENHA_ADMIN_HASH_ARMAZENADA);
 
         if (!senhaCorreta) {
-            tentativasLogin++;
-            ultimaTentativa = millis();
             registrarEvento("Tentativa de login admin falhou");
+            limitadorFalhaLogin(ip);
             return false;
         }
 
-        // Reset contador se login bem sucedido
-        tentativasLogin = 0;
-        sistemaBloqueado = false;
+        limitadorSucessoLogin(ip);
         return true;
     }
 
+    // Senha pelo cabeçalho X-Senha-Admin (ferramenta da frota) ou ?senha=
+    bool requisicaoAdmin() {
+        if (server.hasHeader("X-Senha-Admin")) return verificarSenhaAdmin(server.header("X-Senha-Admin"));
+        return server.hasArg("senha") && verificarSenhaAdmin(server.arg("senha"));
+    }
+
+    // Print que envia a resposta em blocos (chunked), sem montar String grande
+    class SaidaChunked : public Print {
+    public:
+        ~SaidaChunked() { flush(); }
+
+        size_t write(uint8_t c) override {
+            buf[len++] = (char)c;
+            if (len == sizeof(buf)) flush();
+            return 1;
+        }
+
+        void flush() override {
+            if (len == 0) return;
+            server.sendContent(buf, len);
+            len = 0;
+        }
+
+    private:
+        char buf[256];
+        size_t len = 0;
+    };
+
 /*     bool validarDadosUsuarios(const String &jsonStr) {
         DynamicJsonDocument doc(1024);
         if (deserializeJson(doc, jsonStr) || !doc.is<JsonArray>()) {
@@ -89,44 +120,59 @@ namespace {
 }
 
 
-int resolverPino(const String &pinoStr)
+// Accept: application/msgpack -> versão compacta; X-Tempo-Geracao-us permite
+// comparar o custo dos dois formatos no próprio dispositivo
+void handleStatus()
 {
-  if (pinoStr == "D0")
-    return D0;
-  if (pinoStr == "D1")
-    return D1;
-  if (pinoStr == "D2")
-    return D2;
-  if (pinoStr == "D3")
-    return D3;
-  if (pinoStr == "D4")
-    return D4;
-  if (pinoStr == "D5")
-    return D5;
-  if (pinoStr == "D6")
-    return D6;
-  if (pinoStr == "D7")
-    return D7;
-  if (pinoStr == "D8")
-    return D8;
-  return -1;
+  server.sendHeader("Vary", "Accept");
+
+  const String accept = server.header("Accept");
+  if (accept.indexOf("application/msgpack") >= 0 || accept.indexOf("application/x-msgpack") >= 0)
+  {
+    static uint8_t buf[STATUS_COMPACTO_MAX];
+    const uint32_t inicio = micros();
+    const size_t n = statusCompactoGerar(*alarmePtr, buf, sizeof(buf));
+    if (n)
+    {
+      server.sendHeader("X-Tempo-Geracao-us", String(micros() - inicio));
+      server.send(200, "application/msgpack", (const char *)buf, n);
+      return;
+    }
+  }
+
+  const uint32_t inicio = micros();
+  const String json = getEstadoAtualJson();
+  server.sendHeader("X-Tempo-Geracao-us", String(micros() - inicio));
+  server.send(200, "application/json", json);
 }
 
-void handleStatus()
+void handleHistorico()
 {
-  server.send(200, "application/json", getEstadoAtualJson());
+  // ?desde=<seq>: só os eventos mais novos (consulta incremental do agregador)
+  const uint32_t desde = server.hasArg("desde") ? strtoul(server.arg("desde").c_str(), nullptr, 10) : 0;
+  // ?arquivo=1: inclui os eventos arquivados (descompactados aqui). Quem
+  // consulta com desde também os recebe, se ficou para trás do arquivo.
+  const bool arquivo = desde || server.arg("arquivo") == "1";
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  {
+    SaidaChunked saida;
+    historicoEscreverJson(saida, desde, arquivo);
+  }
+  server.sendContent("");
 }
 
-void handleHistorico()
+// Agregados por dia mantidos pelo logger: sem varrer o histórico
+void handleResumoHistorico()
 {
-  File file = LittleFS.open(HISTORICO_PATH, "r");
-  if (!file)
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
   {
-    server.send(500, "application/json", "[]");
-    return;
+    SaidaChunked saida;
+    resumoEscreverJson(saida, alarmePtr->getZonas());
   }
-  server.streamFile(file, "application/json");
-  file.close();
+  server.sendContent("");
 }
 
 void handleArmar()
@@ -138,16 +184,14 @@ void handleArmar()
   }
   std::vector<String> zonas = splitZonas(server.arg("zonas"));
   alarmePtr->armar(zonas);
-  String msg = "Alarme armado por: " + server.arg("usuario");
-  registrarEvento(msg);
+  registrarEventoF("Alarme armado por: %s", server.arg("usuario").c_str());
   server.send(200, "text/plain", "Alarme armado");
 }
 
 void handleDesarmar()
 {
   alarmePtr->desarmar();
-  String msg = "Alarme desarmado por: " + server.arg("usuario");
-  registrarEvento(msg);
+  registrarEventoF("Alarme desarmado por: %s", server.arg("usuario").c_str());
   server.send(200, "text/plain", "Alarme desarmado");
 }
 
@@ -160,8 +204,8 @@ void handleModo()
   }
   bool modoManual = server.arg("manual") == "true";
   alarmePtr->setModo(modoManual ? Alarme::Modo::MANUAL : Alarme::Modo::AUTOMATICO);
-  registrarEvento("[MODO] Modo alterado para " + String(modoManual ? "MANUAL" : "AUTOMATICO") +
-                  " por " + server.arg("usuario"));
+  registrarEventoF("[MODO] Modo alterado para %s por %s",
+                   modoManual ? "MANUAL" : "AUTOMATICO", server.arg("usuario").c_str());
   server.send(200, "text/plain", "Modo atualizado");
 }
 void handleLogin() {
@@ -176,7 +220,7 @@ void handleLogin() {
   if (valido) {
     server.send(200, "application/json", "{\"ok\":true, \"msg\":\"Login realizado\"}");
   } else {
-    String mensagem = sistemaBloqueado ? 
+    String mensagem = limitadorLoginBloqueado(server.client().remoteIP()) ?
       "Sistema temporariamente bloqueado" : "Senha incorreta";
     server.send(401, "application/json", 
       String("{\"erro\":\"") + mensagem + "\"}");
@@ -192,13 +236,21 @@ void handleVerificaLogin() {
     String usuario = server.arg("usuario");
     String senha = server.arg("senha");
 
+    const IPAddress ip = server.client().remoteIP();
+    if (limitadorLoginBloqueado(ip)) {
+        server.send(429, "application/json", "{\"erro\":\"Muitas tentativas. Aguarde.\"}");
+        return;
+    }
+
     if (credenciais_validas(usuario, senha)) {
+        limitadorSucessoLogin(ip);
         // Gera um token simples (em produção, use algo mais seguro)
         String token = String(millis());
         
         server.send(200, "application/json", 
             "{\"ok\":true, \"token\":\"" + token + "\"}");
     } else {
+        limitadorFalhaLogin(ip);
         server.send(401, "application/json", "{\"erro\":\"Credenciais inválidas\"}");
     }
 }
@@ -246,14 +298,10 @@ void handlePostUsuarios() {
     }
 
     // Salva os usuários
-    File file = LittleFS.open(USUARIOS_PATH, "w");
-    if (!file) {
+    if (!armazenamentoGravarJson(USUARIOS_PATH, doc.as<JsonVariantConst>())) {
         server.send(500, "application/json", "{\"erro\":\"Erro ao salvar\"}");
         return;
     }
-
-    serializeJson(doc, file);
-    file.close();
     server.send(200, "application/json", "{\"ok\":true, \"msg\":\"Usuários salvos\"}");
 }
 void handleGetHorarios()
@@ -270,14 +318,12 @@ void handleGetHorarios()
 
 void handlePostHorarios()
 {
-  File file = LittleFS.open("/horarios.json", "w");
-  if (!file)
+  const String corpo = server.arg("plain");
+  if (!armazenamentoGravar("/horarios.json", (const uint8_t *)corpo.c_str(), corpo.length()))
   {
     server.send(500, "text/plain", "Erro ao salvar horários");
     return;
   }
-  file.print(server.arg("plain"));
-  file.close();
   server.send(200, "text/plain", "Horários atualizados");
 }
 
@@ -336,15 +382,340 @@ void handleGetSensores()
   file.close();
 }
 
+// Resposta do POST /sensores.json: {"ok":..,"sensores":N,"erros":[..],"avisos":[..]}
+static String resultadoValidacaoJson(const ResultadoValidacao &r)
+{
+  StaticJsonDocument<1024> doc;
+  doc["ok"] = r.ok();
+  doc["sensores"] = r.totalSensores;
+  doc["total_erros"] = r.totalErros;
+
+  JsonArray erros = doc.createNestedArray("erros");
+  for (uint16_t i = 0; i < r.totalErros && i < CONFIG_MAX_ERROS; i++)
+  {
+    JsonObject e = erros.createNestedObject();
+    e["elemento"] = r.erros[i].elemento;
+    e["linha"] = r.erros[i].linha;
+    e["msg"] = (const char *)r.erros[i].mensagem;
+  }
+
+  JsonArray avisos = doc.createNestedArray("avisos");
+  for (uint16_t i = 0; i < r.totalAvisos && i < CONFIG_MAX_AVISOS; i++)
+  {
+    JsonObject a = avisos.createNestedObject();
+    a["elemento"] = r.avisos[i].elemento;
+    a["linha"] = r.avisos[i].linha;
+    a["msg"] = (const char *)r.avisos[i].mensagem;
+  }
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
 void handlePostSensores()
 {
-  File file = LittleFS.open("/sensores.json", "w");
-  if (!file)
+  const String &corpo = server.arg("plain");
+
+  // 1) Valida tudo antes de tocar no arquivo atual
+  ResultadoValidacao resultado;
+  LeitorMemoria leitor(corpo.c_str(), corpo.length());
+  if (!lerConfigSensores(leitor, nullptr, resultado))
   {
-    server.send(500, "text/plain", "Erro ao salvar sensores");
+    server.send(400, "application/json", resultadoValidacaoJson(resultado));
     return;
   }
-  file.print(server.arg("plain"));
-  file.close();
-  server.send(200, "text/plain", "Sensores atualizados");
+
+  // 2) Escrita atômica (tmp + rename)
+  if (!armazenamentoGravar("/sensores.json", (const uint8_t *)corpo.c_str(), corpo.length()))
+  {
+    server.send(500, "application/json", "{\"ok\":false,\"erros\":[{\"msg\":\"Erro ao salvar sensores (flash cheia?)\"}]}");
+    return;
+  }
+  ajustesDescartar(); // o "ativo" da config nova vale
+  server.send(200, "application/json", resultadoValidacaoJson(resultado));
+}
+
+// PATCH /sensores/ajuste: zona, nome, [ativo=true|false], [limpar_isolamento=1].
+// Aplicado direto no modelo vivo (entre ticks), sem recarregar a config.
+void handlePatchSensor()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  Sensor *sensor = ajustesBuscarSensor(alarmePtr->getZonas(), server.arg("zona").c_str(), server.arg("nome").c_str());
+  if (!sensor) {
+    server.send(404, "application/json", "{\"erro\":\"Sensor não encontrado\"}");
+    return;
+  }
+
+  const bool mudaAtivo = server.hasArg("ativo");
+  const bool limpar = server.arg("limpar_isolamento") == "1";
+  if (!mudaAtivo && !limpar) {
+    server.send(400, "application/json", "{\"erro\":\"Informe ativo e/ou limpar_isolamento\"}");
+    return;
+  }
+
+  bool gravado = true;
+  if (mudaAtivo) {
+    const bool ativo = server.arg("ativo") == "true";
+    gravado = ajustesDefinirAtivo(*sensor, ativo);
+    registrarEventoF("[AJUSTE] Sensor %s/%s %s", sensor->getZona(), sensor->getNome(),
+                     ativo ? "ativado" : "desativado");
+  }
+  if (limpar && sensor->estaIsolado()) {
+    sensor->limparIsolamento();
+    registrarEventoF("[AJUSTE] Isolamento do sensor %s/%s removido", sensor->getZona(), sensor->getNome());
+  }
+  rastroAjusteSensor(*sensor);
+
+  StaticJsonDocument<256> doc;
+  doc["ok"] = true;
+  doc["persistido"] = gravado;
+  doc["ativo"] = sensor->estaAtivo();
+  doc["isolado"] = sensor->estaIsolado();
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// PATCH /zonas/bypass: zona, segundos (0 cancela; até ZONA_BYPASS_MAX_S)
+void handlePatchBypassZona()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  Zona *zona = ajustesBuscarZona(alarmePtr->getZonas(), server.arg("zona").c_str());
+  if (!zona) {
+    server.send(404, "application/json", "{\"erro\":\"Zona não encontrada\"}");
+    return;
+  }
+
+  const long segundos = server.arg("segundos").toInt();
+  if (!server.hasArg("segundos") || segundos < 0 || segundos > ZONA_BYPASS_MAX_S) {
+    server.send(400, "application/json", "{\"erro\":\"segundos deve ir de 0 a " + String(ZONA_BYPASS_MAX_S) + "\"}");
+    return;
+  }
+
+  zona->ignorarPor((uint32_t)segundos * 1000);
+  rastroBypass(*zona);
+  if (segundos) registrarEventoF("[AJUSTE] Zona %s em bypass por %ld s", zona->getNome(), segundos);
+  else registrarEventoF("[AJUSTE] Bypass da zona %s cancelado", zona->getNome());
+
+  server.send(200, "application/json", "{\"ok\":true,\"ignorada_s\":" + String(zona->segundosIgnorada()) + "}");
+}
+
+void handleDiagBoot()
+{
+  server.send(200, "application/json", bootProfilerJson());
+}
+
+void handleDiagCrash()
+{
+  server.send(200, "application/json", vigiaCrashJson());
+}
+
+void handleDiagEnergia()
+{
+  server.send(200, "application/json", energiaJson());
+}
+
+void handleGetTesteCaminhada()
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  {
+    SaidaChunked saida;
+    testeCaminhadaEscreverJson(saida);
+  }
+  server.sendContent("");
+}
+
+// {"acao":"iniciar","duracao_s":N} ou {"acao":"parar"}
+void handlePostTesteCaminhada()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, server.arg("plain")) || !doc.is<JsonObject>()) {
+    server.send(400, "application/json", "{\"erro\":\"JSON inválido\"}");
+    return;
+  }
+
+  const char *acao = doc["acao"] | "";
+  if (strcmp(acao, "iniciar") == 0) {
+    const uint32_t duracao = doc["duracao_s"] | TESTE_CAMINHADA_DURACAO_S;
+    if (duracao == 0 || duracao > TESTE_CAMINHADA_MAX_S) {
+      server.send(400, "application/json", "{\"erro\":\"duracao_s fora do limite\"}");
+      return;
+    }
+    testeCaminhadaIniciar(*alarmePtr, duracao);
+  }
+  else if (strcmp(acao, "parar") == 0) {
+    alarmePtr->encerrarTesteCaminhada();
+  }
+  else {
+    server.send(400, "application/json", "{\"erro\":\"acao deve ser iniciar ou parar\"}");
+    return;
+  }
+  server.send(200, "application/json", "{\"ok\":true}");
+}
+
+void handleGetRastro()
+{
+  server.send(200, "application/json", rastroJson());
+}
+
+// Segmentos binários para o tools/replay_rastro (nomes e rotina dos sensores: só admin)
+void handleGetRastroBin()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  server.sendHeader("Content-Disposition", "attachment; filename=\"rastro.bin\"");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/octet-stream", "");
+  {
+    SaidaChunked saida;
+    rastroEscrever(saida);
+  }
+  server.sendContent("");
+}
+
+// {"acao":"ligar"|"desligar"|"limpar"}
+void handlePostRastro()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  StaticJsonDocument<64> doc;
+  if (deserializeJson(doc, server.arg("plain")) || !doc.is<JsonObject>()) {
+    server.send(400, "application/json", "{\"erro\":\"JSON inválido\"}");
+    return;
+  }
+
+  const char *acao = doc["acao"] | "";
+  if (strcmp(acao, "ligar") == 0) rastroLigar(true);
+  else if (strcmp(acao, "desligar") == 0) rastroLigar(false);
+  else if (strcmp(acao, "limpar") == 0) rastroLimpar();
+  else {
+    server.send(400, "application/json", "{\"erro\":\"acao deve ser ligar, desligar ou limpar\"}");
+    return;
+  }
+  server.send(200, "application/json", rastroJson());
+}
+
+void handleMetrics()
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; version=0.0.4", "");
+  {
+    SaidaChunked saida;
+    metricasEscreverPrometheus(saida);
+    armazenamentoEscreverPrometheus(saida);
+  }
+  server.sendContent("");
+}
+
+void handlePostMqtt()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, server.arg("plain")) || !doc.is<JsonObject>()) {
+    server.send(400, "application/json", "{\"erro\":\"JSON inválido\"}");
+    return;
+  }
+
+  // host vazio desativa a publicação
+  if (!armazenamentoGravarJson(MQTT_CONFIG_PATH, doc.as<JsonVariantConst>())) {
+    server.send(500, "application/json", "{\"erro\":\"Erro ao salvar\"}");
+    return;
+  }
+
+  mqtt_recarregar_config();
+  server.send(200, "application/json", "{\"ok\":true}");
+}
+
+void handlePostNotificacoes()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  DynamicJsonDocument doc(NOTIF_CONFIG_MAX_BYTES);
+  if (deserializeJson(doc, server.arg("plain")) || !doc["destinos"].is<JsonArray>()) {
+    server.send(400, "application/json", "{\"erro\":\"JSON inválido\"}");
+    return;
+  }
+
+  // "destinos":[] desativa as notificações
+  if (!armazenamentoGravarJson(NOTIF_CONFIG_PATH, doc.as<JsonVariantConst>())) {
+    server.send(500, "application/json", "{\"erro\":\"Erro ao salvar\"}");
+    return;
+  }
+
+  notificacoesRecarregarConfig();
+  server.send(200, "application/json", "{\"ok\":true}");
+}
+
+void handleGetConfigBundle()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  {
+    SaidaChunked saida;
+    configBundleEscrever(saida);
+  }
+  server.sendContent("");
+}
+
+void handlePostConfigBundle()
+{
+  if (!requisicaoAdmin()) {
+    server.send(401, "application/json", "{\"erro\":\"Acesso negado\"}");
+    return;
+  }
+
+  String corpo = server.arg("plain");
+  ResultadoBundle resultado;
+  const bool ok = configBundleAplicar(corpo, server.header("X-Bundle-CRC32"), server.arg("forcar") == "1", resultado);
+
+  // horários valem já; sensores só após /recarregar_dados (que rearma o alarme,
+  // como no painel). Usuários são lidos a cada login.
+  if (ok && (resultado.secoes & BUNDLE_SECAO_HORARIOS)) loadHorariosFromFS();
+  if (ok && resultado.mudou && (resultado.secoes & BUNDLE_SECAO_SENSORES)) ajustesDescartar();
+
+  StaticJsonDocument<256> doc;
+  doc["ok"] = ok;
+  doc["mudou"] = resultado.mudou;
+  doc["recarregar"] = (resultado.secoes & BUNDLE_SECAO_SENSORES) != 0;
+  doc["versao"] = resultado.versao;
+  doc["msg"] = (const char *)resultado.mensagem;
+  String out;
+  serializeJson(doc, out);
+
+  // erro nos sensores: mesmo formato de resposta do POST /sensores.json
+  if (!ok && !resultado.sensores.ok()) out = resultadoValidacaoJson(resultado.sensores);
+  server.send(resultado.codigoHttp, "application/json", out);
 }
@@ -9,6 +9,7 @@
 // Prototipagem dos handlers HTTP
 void handleStatus();
 void handleHistorico();
+void handleResumoHistorico();
 void handleArmar();
 void handleDesarmar();
 void handleModo();
@@ -24,7 +25,21 @@ void handleAdmin();
 void handleConfigSensoresPage();
 void handleGetSensores();
 void handlePostSensores();
-int resolverPino(const String& pinoStr);
+void handlePatchSensor();
+void handlePatchBypassZona();
+void handleDiagBoot();
+void handleDiagCrash();
+void handleDiagEnergia();
+void handleGetTesteCaminhada();
+void handlePostTesteCaminhada();
+void handleGetRastro();
+void handleGetRastroBin();
+void handlePostRastro();
+void handleMetrics();
+void handlePostMqtt();
+void handlePostNotificacoes();
+void handleGetConfigBundle();
+void handlePostConfigBundle();
 
 
 #endif
@@ -14,6 +14,26 @@
 #include "zona.h"
 #include "sensor.h"
 #include "sirene.h"
+#include "arena_nomes.h"
+#include "pool_modelo.h"
+#include "config_sensores.h"
+#include "config_compilada.h"
+#include "ajustes_sensores.h"
+#include "mqtt_publisher.h"
+#include "notificacoes.h"
+#include "alarme_p2p.h"
+#include "comandos_ws.h"
+#include "config_bundle.h"
+#include "armazenamento.h"
+#include "event_logger.h"
+#include "resumo_historico.h"
+#include "boot_profiler.h"
+#include "vigia_loop.h"
+#include "energia.h"
+#include "teste_caminhada.h"
+#include "rastro_gpio.h"
+#include "entradas.h"
+#include "metricas.h"
 
 // ================== CONFIGS ==================
 static const char *HOSTNAME = "alarme";
@@ -22,17 +42,19 @@ static const char *WIFI_AP_PASS = "12345678";
 static const char *OTA_USER = "admin";
 static const char *OTA_PASS = "1234";
 
-static const unsigned long INTERVALO_ALARME_MS = 100;
 static const unsigned long WIFI_RECONNECT_INTERVAL_MS = 10UL * 1000UL;  // 10s
 static const unsigned long WIFI_RESTART_AFTER_MS = 5UL * 60UL * 1000UL; // 5 min
 static const unsigned long NTP_RETRY_INTERVAL_MS = 5UL * 60UL * 1000UL; // 5 min
+static const unsigned long NTP_TIMEOUT_MS = 15UL * 1000UL;              // 15s
+static const unsigned long WIFI_PORTAL_APOS_MS = 30UL * 1000UL;         // portal se não conectar em 30s
+static const unsigned long WIFI_PORTAL_TIMEOUT_S = 180;
 
 // WiFi hardening (mínimo viável #2)
 static const uint8_t WIFI_RESET_SUAVE_APOS_FALHAS = 3; // após 3 tentativas, faz disconnect(false)
 
 // ================== GLOBAIS ==================
 Alarme alarme;
-Sirene sirene(BUZZER_PIN, 5000, 5000, 4);
+Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
 std::vector<String> todasZonas;
 
 // Controle WiFi/NTP
@@ -41,8 +63,15 @@ static unsigned long ultimoWifiOkMs = 0;
 static unsigned long proximaTentativaWifiMs = 0;
 
 static bool ntpOk = false;
+static bool ntpAguardando = false;
+static unsigned long ntpInicioMs = 0;
 static unsigned long proximaTentativaNtpMs = 0;
 
+// WiFiManager em modo não bloqueante (portal só se não houver rede)
+static WiFiManager wm;
+static bool portalIniciado = false;
+static bool portalJaAberto = false; // abre no máximo uma vez por boot
+
 // mDNS hardening (mínimo viável #1)
 static bool mdnsAtivo = false;
 
@@ -51,11 +80,12 @@ static uint8_t falhasReconexaoWiFi = 0;
 
 // ================== FUNÇÕES AUXILIARES ==================
 
-// Carrega sensores do arquivo JSON e retorna ponteiros
-// MELHORIA: faz parse direto do File (stream), sem buffer grande na RAM
-std::vector<Sensor *> carregarSensoresDeJSON(const char *path)
+// Lê as definições de sensores do arquivo JSON (os objetos são criados no PoolModelo)
+// Parse elemento a elemento: memória limitada qualquer que seja o tamanho do arquivo.
+// Elementos inválidos são pulados (o alarme sobe com os que sobraram).
+std::vector<DefinicaoSensor> carregarSensoresDeJSON(const char *path)
 {
-    std::vector<Sensor *> sensores;
+    std::vector<DefinicaoSensor> sensores;
 
     File file = LittleFS.open(path, "r");
     if (!file)
@@ -64,102 +94,33 @@ std::vector<Sensor *> carregarSensoresDeJSON(const char *path)
         return sensores;
     }
 
-    DynamicJsonDocument doc(4096);
-    DeserializationError error = deserializeJson(doc, file);
+    ResultadoValidacao resultado;
+    lerConfigSensores(file, &sensores, resultado);
     file.close();
 
-    if (error)
-    {
-        Serial.print("[ERRO] Falha ao fazer parse do JSON: ");
-        Serial.println(error.c_str());
-        return sensores;
-    }
-
-    if (!doc.is<JsonArray>())
+    for (uint16_t i = 0; i < resultado.totalErros && i < CONFIG_MAX_ERROS; i++)
     {
-        Serial.println("[ERRO] /sensores.json não é um array");
-        return sensores;
-    }
-
-    for (JsonObject obj : doc.as<JsonArray>())
-    {
-        String nome = obj["nome"] | "";
-        String tipoStr = obj["tipo"] | "";
-        String pinoStr = obj["pino"] | "";
-        String zona = obj["zona"] | "";
-        bool ativo = obj["ativo"] | true;
-
-        int pino = resolverPino(pinoStr);
-        Sensor::Tipo tipo = Sensor::tipoFromString(tipoStr);
-
-        Sensor *s = new Sensor(nome, tipo, pino, zona, ativo);
-        sensores.push_back(s);
+        const ErroConfig &e = resultado.erros[i];
+        Serial.printf("[ERRO] %s (elemento %d, linha %u): %s\n", path, e.elemento, e.linha, e.mensagem);
     }
+    Serial.printf("[CONFIG] %u sensores carregados, %u erros\n", resultado.totalSensores, resultado.totalErros);
 
     return sensores;
 }
 
-// Agrupa sensores por zona
-std::map<String, Zona *> agruparSensoresPorZona(const std::vector<Sensor *> &sensores)
+// NTP não bloqueante: dispara o SNTP e o loop verifica o resultado
+static void iniciarNtp()
 {
-    std::map<String, Zona *> zonas;
-
-    for (auto sensor : sensores)
-    {
-        String nomeZona = sensor->getZona();
-        if (zonas.find(nomeZona) == zonas.end())
-        {
-            zonas[nomeZona] = new Zona(nomeZona);
-            todasZonas.push_back(nomeZona);
-        }
-
-        zonas[nomeZona]->adicionarSensor(sensor);
-    }
-
-    return zonas;
+    configTime(-3 * 3600, 0, "br.pool.ntp.org", "pool.ntp.org", "time.google.com");
+    ntpAguardando = true;
+    ntpInicioMs = millis();
+    Serial.println("[NTP] Sincronizando em segundo plano...");
 }
 
-// Extrai os nomes das zonas
-std::vector<String> obterNomesZonas(const std::map<String, Zona *> &zonas)
+static bool horaValida()
 {
-    std::vector<String> nomes;
-    for (auto &par : zonas)
-        nomes.push_back(par.first);
-    return nomes;
-}
-
-// NTP com timeout (não trava o boot)
-// Retorna true se sincronizou, false se deu timeout/falha
-bool configurarHorarioComTimeout(uint32_t timeoutMs)
-{
-    if (WiFi.status() != WL_CONNECTED)
-    {
-        Serial.println("[NTP] WiFi não conectado, pulando NTP");
-        return false;
-    }
-
-    configTime(-3 * 3600, 0, "br.pool.ntp.org", "pool.ntp.org", "time.google.com");
-
-    const uint32_t t0 = millis();
-    Serial.print("[NTP] Sincronizando");
-
-    while ((uint32_t)(millis() - t0) < timeoutMs)
-    {
-        time_t agora = time(nullptr);
-
-        if (agora > 1700000000 && agora < 4000000000)
-        {
-            Serial.printf("\n[NTP] OK: %s", ctime(&agora));
-            return true;
-        }
-
-        delay(250);
-        Serial.print(".");
-        yield();
-    }
-
-    Serial.println("\n[NTP] Timeout. Continuando sem hora sincronizada.");
-    return false;
+    const time_t agora = time(nullptr);
+    return agora > 1700000000 && agora < 4000000000;
 }
 
 // ======= (1) mDNS hardening: usa flag mdnsAtivo =======
@@ -199,15 +160,18 @@ static void onWifiConectado()
     Serial.printf("[WIFI] RSSI: %d dBm\n", WiFi.RSSI());
 
     reiniciarMDNS();
+    bootMarcarFaseUmaVez("wifi_conectado");
 
     // força nova tentativa de NTP quando a rede volta
     ntpOk = false;
+    ntpAguardando = false;
     proximaTentativaNtpMs = millis();
 }
 
 static void onWifiDesconectado()
 {
     wifiEstavaConectado = false;
+    contadores.wifiDesconexoes++;
     Serial.println("[WIFI] Desconectado");
 }
 static void setHoraSentinela1970()
@@ -226,33 +190,97 @@ void configurarSistema()
 {
     Serial.println("[SISTEMA] Reconfigurando sensores, zonas e horários...");
 
+    // descarta o modelo anterior de uma vez (sem delete por objeto)
     alarme.limparZonas();
+    poolModelo.resetar();
     todasZonas.clear();
+    arenaNomes.limpar();
 
-    auto sensores = carregarSensoresDeJSON("/sensores.json");
-    auto zonas = agruparSensoresPorZona(sensores);
-
-    alarme.definirSirene(&sirene);
+    Faixa<Zona> zonas;
+    if (configCompiladaDisponivel() && !LittleFS.exists("/sensores.json"))
+    {
+        // tabelas do build: sem parse nem heap
+        zonas = configCompiladaMontar(poolModelo);
+        Serial.println("[SISTEMA] Sensores da config compilada");
+    }
+    else
+    {
+        auto definicoes = carregarSensoresDeJSON("/sensores.json");
+        zonas = poolModelo.montar(definicoes);
+    }
+    ajustesAplicar(zonas); // sensores ligados/desligados pela API de ajustes
 
-    for (auto &par : zonas)
+    for (const Zona &zona : zonas)
     {
-        alarme.adicionarZona(par.second);
+        todasZonas.push_back(zona.getNome());
     }
 
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(zonas);
+    energiaDefinirSensores(zonas);
+
     alarme.setModo(Alarme::Modo::AUTOMATICO);
-    alarme.armar(obterNomesZonas(zonas));
+    alarme.armar(todasZonas);
+    rastroDefinirModelo(alarme, sirene); // depois do armar: o cabeçalho já sai armado
 
     loadHorariosFromFS();
 
     Serial.println("[SISTEMA] Reconfiguração concluída");
 }
 
+// Abre o portal do WiFiManager sem bloquear: o alarme continua ticando
+static void iniciarPortalWiFi()
+{
+    Serial.println("[WIFI] Sem conexão: abrindo portal de configuração em segundo plano");
+    server.stop(); // o portal usa a porta 80
+    wm.setConfigPortalBlocking(false);
+    wm.setConfigPortalTimeout(WIFI_PORTAL_TIMEOUT_S);
+    wm.startConfigPortal(WIFI_AP_SSID, WIFI_AP_PASS);
+    portalIniciado = true;
+    portalJaAberto = true;
+}
+
+static void atualizarPortalWiFi()
+{
+    if (!portalIniciado) return;
+
+    wm.process();
+    if (!wm.getConfigPortalActive())
+    {
+        portalIniciado = false;
+        server.begin();
+        Serial.println("[WIFI] Portal encerrado, servidor HTTP retomado");
+    }
+}
+
+// Tick do alarme no ritmo do modo de energia (rápido armado/sirene tocando,
+// lento desarmado; ver energia.h). Também chamado durante uploads longos
+// (OTA), que seguram o loop dentro do handleClient.
+static uint32_t ultimoTickMs = 0;
+
+static bool tickAlarme()
+{
+    if (!energiaTickDevido()) return false;
+    ultimoTickMs = millis();
+
+    {
+        TemporizadorEscopo tempoTick(LAT_TICK_ALARME);
+        const uint32_t leitura = entradasLer();
+        rastroTick(leitura);
+        alarme.atualizar(leitura);
+    }
+    energiaTickConcluido(alarme.getEstado() == Alarme::Estado::ARMADO || sirene.estaAtiva());
+    return true;
+}
+
 // ================== SETUP ==================
+// Ordem pensada para o alarme ficar ativo em poucos ms após o reset:
+// config em cache (LittleFS) -> alarme armado -> serviços -> rede em segundo plano.
 void setup()
 {
     Serial.begin(115200);
-    delay(100);
     Serial.println("\n\n=== SISTEMA DE ALARME INICIANDO ===");
+    bootMarcarFase("inicio");
 
     // 1) LittleFS
     if (!LittleFS.begin())
@@ -262,43 +290,48 @@ void setup()
         ESP.restart();
     }
     Serial.println("[OK] LittleFS pronto");
+    armazenamentoSetup();
+    historicoSetup();
+    resumoSetup();
+    rastroSetup();
+    vigiaSetup(); // antes de tudo que pode travar: registra o motivo do último reset
+    bootMarcarFase("littlefs");
+
+    // Imagem recém-atualizada que não se confirmou: volta para a anterior
+    ota_verificarBoot();
+    bootMarcarFase("ota_autoteste");
+
+    // 2) Sensores/zonas da config em cache e alarme armado (sem esperar rede)
+    configBundleRecuperar();
+    setHoraSentinela1970();
+    configurarSistema();
+    bootMarcarFase("alarme_armado");
 
-    // 2) WiFi config
-    WiFi.setAutoReconnect(true);
-    WiFi.persistent(false);
-
-    // 3) WiFiManager (boot)
-    WiFiManager wm;
-    wm.setConnectTimeout(30);
-    wm.setConfigPortalTimeout(180);
-
-    bool res = wm.autoConnect(WIFI_AP_SSID, WIFI_AP_PASS);
-    if (!res)
-    {
-        Serial.println("[ERRO] WiFi não conectado no boot");
-        delay(2000);
-        ESP.restart();
-    }
-
-    // marca WiFi OK
-    onWifiConectado();
-    ultimoWifiOkMs = millis();
-    proximaTentativaWifiMs = millis() + WIFI_RECONNECT_INTERVAL_MS;
-
-    // 4) Sobe OTA + WebServer ANTES do NTP
+    // 3) OTA + WebServer (server.begin() não depende do WiFi estar conectado)
     setup_ota(server, HOSTNAME, OTA_USER, OTA_PASS);
+    ota_definirTickDuranteUpload([] { tickAlarme(); });
     web_server_setup(&alarme);
+    mqtt_setup(&alarme);
+    notificacoesSetup();
+    p2p_setup(&alarme, &sirene);
+    comandosWsSetup(&alarme);
+    bootMarcarFase("web");
 
-    // 5) Configura o sistema
-    configurarSistema();
+    // 4) WiFi em segundo plano com as credenciais salvas pelo WiFiManager
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(true);
+    WiFi.mode(WIFI_STA);
 
-    // 6) NTP inicial
-    ntpOk = configurarHorarioComTimeout(15000);
-    if (!ntpOk)
+    if (wm.getWiFiIsSaved())
+    {
+        WiFi.begin();
+    }
+    else
     {
-        setHoraSentinela1970();
+        iniciarPortalWiFi();
     }
-    proximaTentativaNtpMs = millis() + NTP_RETRY_INTERVAL_MS;
+    proximaTentativaWifiMs = millis() + WIFI_PORTAL_APOS_MS;
+    bootMarcarFase("wifi_iniciado");
 
     Serial.println("=== SETUP CONCLUÍDO ===");
 }
@@ -306,89 +339,150 @@ void setup()
 // ================== LOOP ==================
 void loop()
 {
-    const unsigned long now = millis();
+    // LAT_LOOP mede o trabalho do loop; a pausa final fica em pausa_ms (energia)
+    {
+        TemporizadorEscopo tempoLoop(LAT_LOOP);
+        const unsigned long now = millis();
 
-    // 1) WiFi watchdog
-    const bool wifiConectado = (WiFi.status() == WL_CONNECTED);
+        // 1) WiFi watchdog
+        vigiaFase(FASE_WIFI);
+        const bool wifiConectado = (WiFi.status() == WL_CONNECTED);
 
-    if (wifiConectado)
-    {
-        if (!wifiEstavaConectado)
-        {
-            onWifiConectado();
-        }
-        ultimoWifiOkMs = now;
-    }
-    else
-    {
-        if (wifiEstavaConectado)
+        if (wifiConectado)
         {
-            onWifiDesconectado();
+            if (!wifiEstavaConectado)
+            {
+                onWifiConectado();
+            }
+            ultimoWifiOkMs = now;
         }
-
-        // tenta reconectar periodicamente
-        if ((int32_t)(now - (uint32_t)proximaTentativaWifiMs) >= 0)
+        else
         {
-            proximaTentativaWifiMs = now + WIFI_RECONNECT_INTERVAL_MS;
+            if (wifiEstavaConectado)
+            {
+                onWifiDesconectado();
+            }
 
-            // ======= (2) WiFi hardening: reset suave após N falhas =======
-            falhasReconexaoWiFi++;
-            Serial.printf("[WIFI] Tentando reconnect... (falha %u)\n", falhasReconexaoWiFi);
+            // nunca conectou desde o boot: abre o portal (não bloqueante)
+            if (ultimoWifiOkMs == 0 && !portalJaAberto &&
+                (int32_t)(now - (uint32_t)proximaTentativaWifiMs) >= 0)
+            {
+                iniciarPortalWiFi();
+            }
 
-            if (falhasReconexaoWiFi >= WIFI_RESET_SUAVE_APOS_FALHAS)
+            // tenta reconectar periodicamente
+            if (!portalIniciado && (int32_t)(now - (uint32_t)proximaTentativaWifiMs) >= 0)
             {
-                Serial.println("[WIFI] Reset suave: WiFi.disconnect(false) + reconnect");
-                WiFi.disconnect(false); // não apaga credenciais
+                proximaTentativaWifiMs = now + WIFI_RECONNECT_INTERVAL_MS;
 
-                // pequenas pausas com yield (evita travar alarme/web)
-                for (int i = 0; i < 4; i++)
+                // ======= (2) WiFi hardening: reset suave após N falhas =======
+                falhasReconexaoWiFi++;
+                contadores.wifiTentativasReconexao++;
+                Serial.printf("[WIFI] Tentando reconnect... (falha %u)\n", falhasReconexaoWiFi);
+
+                if (falhasReconexaoWiFi >= WIFI_RESET_SUAVE_APOS_FALHAS)
                 {
-                    delay(50);
-                    yield();
+                    Serial.println("[WIFI] Reset suave: WiFi.disconnect(false) + reconnect");
+                    WiFi.disconnect(false); // não apaga credenciais
+
+                    // pequenas pausas com yield (evita travar alarme/web)
+                    for (int i = 0; i < 4; i++)
+                    {
+                        delay(50);
+                        yield();
+                    }
+
+                    falhasReconexaoWiFi = 0; // zera contador após reset suave
                 }
 
-                falhasReconexaoWiFi = 0; // zera contador após reset suave
+                WiFi.reconnect();
             }
 
-            WiFi.reconnect();
+            // se ficar muito tempo sem WiFi, reinicia (o boot volta a oferecer o portal)
+            if (!portalIniciado && (uint32_t)(now - (uint32_t)ultimoWifiOkMs) > WIFI_RESTART_AFTER_MS)
+            {
+                Serial.println("[WIFI] Muito tempo sem conexão. Reiniciando...");
+                eventosAgrupadosFecharTodos();
+                resumoGravar();
+                armazenamentoDescarregarTudo();
+                delay(200);
+                ESP.restart();
+            }
         }
 
-        // se ficar muito tempo sem WiFi, reinicia (para cair no WiFiManager no boot)
-        if ((uint32_t)(now - (uint32_t)ultimoWifiOkMs) > WIFI_RESTART_AFTER_MS)
+        // 2) Serviços de rede (OTA HTTP depende disso)
+        vigiaFase(FASE_HTTP);
+        if (wifiConectado && mdnsAtivo)
         {
-            Serial.println("[WIFI] Muito tempo sem conexão. Reiniciando...");
-            delay(200);
-            ESP.restart();
+            MDNS.update();
+        }
+        if (portalIniciado)
+        {
+            atualizarPortalWiFi();
+        }
+        else
+        {
+            TemporizadorEscopo tempoHttp(LAT_HTTP);
+            server.handleClient();
         }
-    }
-
-    // 2) Serviços de rede (OTA HTTP depende disso)
-    if (wifiConectado && mdnsAtivo)
-    {
-        MDNS.update();
-    }
-    server.handleClient();
-
-    // 3) Tick do alarme (100ms)
-    static unsigned long lastCheck = 0;
-    if ((uint32_t)(now - lastCheck) >= INTERVALO_ALARME_MS)
-    {
-        lastCheck = now;
-        alarme.atualizar();
-        checkAutoSchedule(alarme);
-        checkDailyRestart();
-    }
 
-    // 4) NTP periódico (não bloqueante)
-    if (wifiConectado && !ntpOk && (int32_t)(now - (uint32_t)proximaTentativaNtpMs) >= 0)
-    {
-        proximaTentativaNtpMs = now + NTP_RETRY_INTERVAL_MS;
-        ntpOk = configurarHorarioComTimeout(5000);
-        if (!ntpOk)
+        // 3) Tick do alarme (100 ms armado, 1 s desarmado)
+        vigiaFase(FASE_TICK_ALARME);
+        if (tickAlarme())
+        {
+            testeCaminhadaLoop(alarme);
+            checkAutoSchedule(alarme);
+            checkDailyRestart();
+        }
+        // Imagem nova saudável = modelo carregado e tick em dia, armado ou não: a
+        // agenda pode desarmar durante o autoteste sem provocar rollback
+        vigiaFase(FASE_OTA);
+        ota_loop(!alarme.getZonas().empty() && (uint32_t)(millis() - ultimoTickMs) <= 2 * ENERGIA_TICK_LENTO_MS);
+
+        // 4) P2P a cada loop (latência baixa entre placas) e MQTT
+        //    (depois do tick: conexão/publicação têm timeout curto)
+        vigiaFase(FASE_WS);
+        comandosWsLoop();
+        vigiaFase(FASE_P2P);
+        p2p_loop(wifiConectado);
+        vigiaFase(FASE_MQTT);
+        mqtt_loop(wifiConectado);
+        vigiaFase(FASE_NOTIFICACOES);
+        notificacoesLoop(wifiConectado);
+        vigiaFase(FASE_ARMAZENAMENTO);
+        eventosAgrupadosLoop();
+        historicoLoop();
+        resumoLoop(alarme.getEstado() == Alarme::Estado::ARMADO && !alarme.emTesteCaminhada());
+        armazenamentoLoop();
+
+        // 5) NTP periódico (não bloqueante)
+        vigiaFase(FASE_NTP);
+        if (ntpAguardando)
+        {
+            if (horaValida())
+            {
+                const time_t agora = time(nullptr);
+                Serial.printf("[NTP] OK: %s", ctime(&agora));
+                ntpOk = true;
+                ntpAguardando = false;
+                bootMarcarFaseUmaVez("ntp_ok");
+            }
+            else if ((uint32_t)(now - ntpInicioMs) > NTP_TIMEOUT_MS)
+            {
+                Serial.println("[NTP] Timeout. Continuando sem hora sincronizada.");
+                ntpAguardando = false;
+                contadores.ntpFalhas++;
+                setHoraSentinela1970();
+            }
+        }
+        else if (wifiConectado && !ntpOk && (int32_t)(now - (uint32_t)proximaTentativaNtpMs) >= 0)
         {
-            setHoraSentinela1970();
+            proximaTentativaNtpMs = now + NTP_RETRY_INTERVAL_MS;
+            iniciarNtp();
         }
     }
 
-    yield();
+    // 6) Desarmado: pausa até o próximo tick (light sleep); senão só yield()
+    vigiaFase(FASE_PAUSA);
+    energiaPausar(!portalIniciado);
 }
@@ -0,0 +1,53 @@
+#include "consolidado.h"
+#include "json_mini.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+static bool antes(const EventoConsolidado &a, const EventoConsolidado &b)
+{
+    return std::tie(a.timestamp, a.dispositivo, a.seq) < std::tie(b.timestamp, b.dispositivo, b.seq);
+}
+
+Consolidado::Consolidado(size_t maxEventos) : maxEventos(maxEventos) {}
+
+void Consolidado::adicionar(const std::string &dispositivo, uint32_t seq, int64_t timestamp, const std::string &evento)
+{
+    EventoConsolidado e{dispositivo, seq, timestamp, evento, proximoCursor++};
+
+    // quase sempre entra no fim: upper_bound a partir do fim é barato
+    auto pos = std::upper_bound(eventos.begin(), eventos.end(), e, antes);
+    eventos.insert(pos, std::move(e));
+
+    while (eventos.size() > maxEventos) eventos.pop_front();
+}
+
+std::string Consolidado::eventosJson(uint64_t desde, size_t limite) const
+{
+    std::vector<const EventoConsolidado *> sel;
+    for (const auto &e : eventos)
+        if (e.cursor > desde) sel.push_back(&e);
+
+    if (sel.size() > limite)
+    {
+        std::nth_element(sel.begin(), sel.begin() + limite, sel.end(),
+                         [](const EventoConsolidado *a, const EventoConsolidado *b) { return a->cursor < b->cursor; });
+        sel.resize(limite);
+        std::sort(sel.begin(), sel.end(), [](const EventoConsolidado *a, const EventoConsolidado *b) { return antes(*a, *b); });
+    }
+
+    uint64_t cursor = desde;
+    std::string out = "{\"eventos\":[";
+    for (size_t i = 0; i < sel.size(); i++)
+    {
+        const EventoConsolidado &e = *sel[i];
+        cursor = std::max(cursor, e.cursor);
+        if (i) out += ',';
+        out += "{\"dispositivo\":\"" + escaparJson(e.dispositivo) + "\",\"seq\":" + std::to_string(e.seq) +
+               ",\"timestamp\":" + std::to_string(e.timestamp) + ",\"evento\":\"" + escaparJson(e.evento) +
+               "\",\"cursor\":" + std::to_string(e.cursor) + "}";
+    }
+    out += "],\"cursor\":" + std::to_string(cursor) + "}";
+    return out;
+}
@@ -0,0 +1,40 @@
+#ifndef CONSOLIDADO_H
+#define CONSOLIDADO_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// Um evento de histórico vindo de um dispositivo
+struct EventoConsolidado
+{
+    std::string dispositivo;
+    uint32_t seq;       // sequência do próprio dispositivo
+    int64_t timestamp;  // relógio do dispositivo (1970 se estava sem NTP)
+    std::string evento;
+    uint64_t cursor;    // ordem de chegada no agregador (consulta incremental)
+};
+
+// Fluxo único de eventos de todos os dispositivos, ordenado por
+// (timestamp, dispositivo, seq). Janela limitada: descarta os mais antigos.
+class Consolidado
+{
+public:
+    explicit Consolidado(size_t maxEventos);
+
+    void adicionar(const std::string &dispositivo, uint32_t seq, int64_t timestamp, const std::string &evento);
+
+    // {"cursor":N,"eventos":[...]}: eventos com cursor > desde (até "limite",
+    // os que chegaram primeiro), devolvidos em ordem de timestamp
+    std::string eventosJson(uint64_t desde, size_t limite) const;
+
+    uint64_t ultimoCursor() const { return proximoCursor - 1; }
+    size_t tamanho() const { return eventos.size(); }
+
+private:
+    size_t maxEventos;
+    uint64_t proximoCursor = 1;
+    std::deque<EventoConsolidado> eventos;
+};
+
+#endif
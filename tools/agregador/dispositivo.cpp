@@ -0,0 +1,257 @@
+#include "dispositivo.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const int64_t TIMEOUT_MS = 5000;
+static const int64_t ONLINE_MS = 30000; // sem contato há mais que isso = offline
+
+Dispositivo::Dispositivo(std::string nome, std::string host, uint16_t porta)
+    : nome(std::move(nome)), host(std::move(host)), porta(porta)
+{
+}
+
+Dispositivo::~Dispositivo() { fechar(); }
+
+short Dispositivo::eventosPoll() const
+{
+    switch (fase)
+    {
+    case Fase::CONECTANDO:
+    case Fase::ENVIANDO: return POLLOUT;
+    case Fase::RECEBENDO: return POLLIN;
+    default: return 0;
+    }
+}
+
+bool Dispositivo::resolver()
+{
+    if (resolvido) return true;
+
+    addrinfo dica{}, *res = nullptr;
+    dica.ai_family = AF_INET;
+    dica.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), nullptr, &dica, &res) != 0 || !res)
+    {
+        falhar("host não resolvido");
+        return false;
+    }
+    endereco = *(sockaddr_in *)res->ai_addr;
+    endereco.sin_port = htons(porta);
+    freeaddrinfo(res);
+    resolvido = true;
+    return true;
+}
+
+void Dispositivo::agendar(int64_t agoraMs, int64_t intervaloMs)
+{
+    if (fase != Fase::OCIOSO || agoraMs < proximoCicloMs) return;
+    proximoCicloMs = agoraMs + intervaloMs;
+    iniciar(Consulta::STATUS, agoraMs);
+}
+
+void Dispositivo::iniciar(Consulta c, int64_t agoraMs)
+{
+    if (!resolver()) return;
+
+    consulta = c;
+    const std::string caminho = (c == Consulta::STATUS)
+                                    ? "/status.json"
+                                    : "/historico.json?desde=" + std::to_string(ultimoSeq);
+    requisicao = "GET " + caminho + " HTTP/1.0\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+    enviados = 0;
+    resposta.clear();
+    inicioMs = agoraMs;
+
+    sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+    {
+        falhar("socket()");
+        return;
+    }
+
+    if (connect(sock, (sockaddr *)&endereco, sizeof(endereco)) == 0) fase = Fase::ENVIANDO;
+    else if (errno == EINPROGRESS) fase = Fase::CONECTANDO;
+    else falhar(strerror(errno));
+}
+
+void Dispositivo::fechar()
+{
+    if (sock >= 0) close(sock);
+    sock = -1;
+    fase = Fase::OCIOSO;
+}
+
+void Dispositivo::falhar(const char *motivo)
+{
+    falhas++;
+    ultimoErro = motivo;
+    resolvido = false; // o IP pode ter mudado (DHCP)
+    fechar();
+}
+
+void Dispositivo::verificarTimeout(int64_t agoraMs)
+{
+    if (fase != Fase::OCIOSO && agoraMs - inicioMs > TIMEOUT_MS) falhar("timeout");
+}
+
+void Dispositivo::processar(short revents, int64_t agoraMs, Consolidado &consolidado)
+{
+    if (revents & (POLLERR | POLLNVAL))
+    {
+        falhar("erro de conexão");
+        return;
+    }
+
+    if (fase == Fase::CONECTANDO)
+    {
+        int erro = 0;
+        socklen_t tam = sizeof(erro);
+        getsockopt(sock, SOL_SOCKET, SO_ERROR, &erro, &tam);
+        if (erro)
+        {
+            falhar(strerror(erro));
+            return;
+        }
+        fase = Fase::ENVIANDO;
+    }
+
+    if (fase == Fase::ENVIANDO)
+    {
+        const ssize_t n = send(sock, requisicao.data() + enviados, requisicao.size() - enviados, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno != EAGAIN) falhar(strerror(errno));
+            return;
+        }
+        enviados += n;
+        if (enviados == requisicao.size()) fase = Fase::RECEBENDO;
+        return;
+    }
+
+    if (fase == Fase::RECEBENDO && (revents & (POLLIN | POLLHUP)))
+    {
+        char buf[4096];
+        for (;;)
+        {
+            const ssize_t n = recv(sock, buf, sizeof(buf), 0);
+            if (n > 0)
+            {
+                resposta.append(buf, n);
+                continue;
+            }
+            if (n == 0)
+            {
+                concluir(agoraMs, consolidado);
+                return;
+            }
+            if (errno != EAGAIN) falhar(strerror(errno));
+            return;
+        }
+    }
+}
+
+// Remove o "Transfer-Encoding: chunked" (o ESP pode responder assim)
+static bool decodificarChunked(const std::string &corpo, std::string &saida)
+{
+    size_t pos = 0;
+    for (;;)
+    {
+        const size_t fimLinha = corpo.find("\r\n", pos);
+        if (fimLinha == std::string::npos) return false;
+        const size_t tam = strtoul(corpo.c_str() + pos, nullptr, 16);
+        pos = fimLinha + 2;
+        if (tam == 0) return true;
+        if (pos + tam > corpo.size()) return false;
+        saida.append(corpo, pos, tam);
+        pos += tam + 2;
+    }
+}
+
+void Dispositivo::concluir(int64_t agoraMs, Consolidado &consolidado)
+{
+    const size_t fimCab = resposta.find("\r\n\r\n");
+    if (fimCab == std::string::npos || resposta.compare(0, 7, "HTTP/1.") != 0)
+    {
+        falhar("resposta HTTP inválida");
+        return;
+    }
+    if (resposta.compare(9, 3, "200") != 0)
+    {
+        falhar(("HTTP " + resposta.substr(9, 3)).c_str());
+        return;
+    }
+
+    std::string cabecalho = resposta.substr(0, fimCab);
+    for (auto &c : cabecalho) c = tolower(c);
+    std::string corpo = resposta.substr(fimCab + 4);
+    if (cabecalho.find("transfer-encoding: chunked") != std::string::npos)
+    {
+        std::string plano;
+        if (!decodificarChunked(corpo, plano))
+        {
+            falhar("chunked inválido");
+            return;
+        }
+        corpo.swap(plano);
+    }
+
+    ValorJson json;
+    if (!parseJson(corpo, json))
+    {
+        falhar("JSON inválido");
+        return;
+    }
+
+    ultimoContatoMs = agoraMs;
+    fechar();
+
+    if (consulta == Consulta::STATUS)
+    {
+        statusBruto = corpo;
+        status = std::move(json);
+        iniciar(Consulta::HISTORICO, agoraMs);
+        return;
+    }
+
+    if (json.tipo != ValorJson::Tipo::ARRAY) return;
+    for (const ValorJson &e : json.itens)
+    {
+        const uint32_t seq = (uint32_t)e.numeroOu("seq", 0);
+        if (seq <= ultimoSeq) continue; // firmware antigo ignora ?desde=
+        if (ultimoSeq && seq > ultimoSeq + 1) eventosPerdidos += seq - ultimoSeq - 1;
+        ultimoSeq = seq;
+        consolidado.adicionar(nome, seq, (int64_t)e.numeroOu("timestamp", 0), e.textoOu("evento", ""));
+    }
+}
+
+std::string Dispositivo::resumoJson(int64_t agoraMs) const
+{
+    const bool online = ultimoContatoMs >= 0 && agoraMs - ultimoContatoMs < ONLINE_MS;
+    return "{\"nome\":\"" + escaparJson(nome) + "\",\"host\":\"" + escaparJson(host) +
+           "\",\"online\":" + (online ? "true" : "false") +
+           ",\"ultimo_contato_ms\":" + std::to_string(ultimoContatoMs < 0 ? -1 : agoraMs - ultimoContatoMs) +
+           ",\"ultimo_seq\":" + std::to_string(ultimoSeq) +
+           ",\"eventos_perdidos\":" + std::to_string(eventosPerdidos) +
+           ",\"falhas\":" + std::to_string(falhas) +
+           ",\"ultimo_erro\":\"" + escaparJson(ultimoErro) + "\",\"status\":" + statusBruto + "}";
+}
+
+void Dispositivo::zonasJson(std::string &out, bool &primeiro) const
+{
+    const ValorJson *zonas = status.campo("zonas");
+    if (!zonas || zonas->tipo != ValorJson::Tipo::ARRAY) return;
+
+    for (const ValorJson &z : zonas->itens)
+    {
+        if (!primeiro) out += ',';
+        primeiro = false;
+        out += "{\"dispositivo\":\"" + escaparJson(nome) + "\",\"zona\":\"" + escaparJson(z.textoOu("nome", "")) +
+               "\",\"estado\":\"" + escaparJson(z.textoOu("estado", "")) + "\"}";
+    }
+}
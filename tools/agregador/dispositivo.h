@@ -0,0 +1,69 @@
+#ifndef DISPOSITIVO_H
+#define DISPOSITIVO_H
+
+#include <cstdint>
+#include <string>
+#include <netinet/in.h>
+
+#include "consolidado.h"
+#include "json_mini.h"
+
+// Consulta periódica de uma placa (HTTP/1.0 não bloqueante, um socket por vez):
+//   GET /status.json                -> guarda o último estado
+//   GET /historico.json?desde=<seq> -> só os eventos novos vão para o Consolidado
+class Dispositivo
+{
+public:
+    Dispositivo(std::string nome, std::string host, uint16_t porta);
+    ~Dispositivo();
+
+    // Socket em uso (-1 se ocioso) e eventos de poll() que interessam
+    int fd() const { return sock; }
+    short eventosPoll() const;
+
+    // Inicia um novo ciclo se estiver ocioso e o intervalo venceu
+    void agendar(int64_t agoraMs, int64_t intervaloMs);
+    void processar(short revents, int64_t agoraMs, Consolidado &consolidado);
+    void verificarTimeout(int64_t agoraMs);
+
+    const std::string &getNome() const { return nome; }
+    std::string resumoJson(int64_t agoraMs) const;
+    // Zonas do último status: [{"dispositivo":..,"zona":..,"estado":..},...]
+    void zonasJson(std::string &out, bool &primeiro) const;
+
+private:
+    enum class Fase { OCIOSO, CONECTANDO, ENVIANDO, RECEBENDO };
+    enum class Consulta { STATUS, HISTORICO };
+
+    bool resolver();
+    void iniciar(Consulta c, int64_t agoraMs);
+    void fechar();
+    void falhar(const char *motivo);
+    void concluir(int64_t agoraMs, Consolidado &consolidado);
+
+    std::string nome;
+    std::string host;
+    uint16_t porta;
+    bool resolvido = false;
+    sockaddr_in endereco{};
+
+    int sock = -1;
+    Fase fase = Fase::OCIOSO;
+    Consulta consulta = Consulta::STATUS;
+    std::string requisicao;
+    size_t enviados = 0;
+    std::string resposta;
+    int64_t inicioMs = 0;
+    int64_t proximoCicloMs = 0;
+
+    // estado visível na API
+    int64_t ultimoContatoMs = -1;
+    uint32_t ultimoSeq = 0;
+    uint32_t eventosPerdidos = 0; // saltos de seq (histórico do ESP já tinha girado)
+    uint32_t falhas = 0;
+    std::string ultimoErro;
+    std::string statusBruto = "null";
+    ValorJson status;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "json_mini.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    struct Parser
+    {
+        const char *p;
+        const char *fim;
+
+        void espacos()
+        {
+            while (p < fim && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+        }
+
+        bool literal(const char *lit)
+        {
+            const size_t n = strlen(lit);
+            if ((size_t)(fim - p) < n || strncmp(p, lit, n) != 0) return false;
+            p += n;
+            return true;
+        }
+
+        static void utf8(std::string &s, unsigned cp)
+        {
+            if (cp < 0x80) s += (char)cp;
+            else if (cp < 0x800) { s += (char)(0xC0 | (cp >> 6)); s += (char)(0x80 | (cp & 0x3F)); }
+            else { s += (char)(0xE0 | (cp >> 12)); s += (char)(0x80 | ((cp >> 6) & 0x3F)); s += (char)(0x80 | (cp & 0x3F)); }
+        }
+
+        bool texto(std::string &s)
+        {
+            if (p >= fim || *p != '"') return false;
+            p++;
+            while (p < fim && *p != '"')
+            {
+                if (*p != '\\') { s += *p++; continue; }
+                if (++p >= fim) return false;
+                switch (*p++)
+                {
+                case '"': s += '"'; break;
+                case '\\': s += '\\'; break;
+                case '/': s += '/'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u':
+                {
+                    if (fim - p < 4) return false;
+                    char hex[5] = {p[0], p[1], p[2], p[3], 0};
+                    utf8(s, (unsigned)strtoul(hex, nullptr, 16));
+                    p += 4;
+                    break;
+                }
+                default: return false;
+                }
+            }
+            if (p >= fim) return false;
+            p++;
+            return true;
+        }
+
+        bool valor(ValorJson &v, int profundidade)
+        {
+            if (profundidade > 32) return false;
+            espacos();
+            if (p >= fim) return false;
+
+            switch (*p)
+            {
+            case 'n': v.tipo = ValorJson::Tipo::NULO; return literal("null");
+            case 't': v.tipo = ValorJson::Tipo::BOOL; v.booleano = true; return literal("true");
+            case 'f': v.tipo = ValorJson::Tipo::BOOL; v.booleano = false; return literal("false");
+            case '"': v.tipo = ValorJson::Tipo::TEXTO; return texto(v.texto);
+            case '[':
+            {
+                v.tipo = ValorJson::Tipo::ARRAY;
+                p++;
+                espacos();
+                if (p < fim && *p == ']') { p++; return true; }
+                for (;;)
+                {
+                    v.itens.emplace_back();
+                    if (!valor(v.itens.back(), profundidade + 1)) return false;
+                    espacos();
+                    if (p < fim && *p == ',') { p++; continue; }
+                    if (p < fim && *p == ']') { p++; return true; }
+                    return false;
+                }
+            }
+            case '{':
+            {
+                v.tipo = ValorJson::Tipo::OBJETO;
+                p++;
+                espacos();
+                if (p < fim && *p == '}') { p++; return true; }
+                for (;;)
+                {
+                    espacos();
+                    std::string chave;
+                    if (!texto(chave)) return false;
+                    espacos();
+                    if (p >= fim || *p != ':') return false;
+                    p++;
+                    v.campos.emplace_back(std::move(chave), ValorJson());
+                    if (!valor(v.campos.back().second, profundidade + 1)) return false;
+                    espacos();
+                    if (p < fim && *p == ',') { p++; continue; }
+                    if (p < fim && *p == '}') { p++; return true; }
+                    return false;
+                }
+            }
+            default:
+            {
+                char *depois = nullptr;
+                std::string num(p, std::min<size_t>(fim - p, 32));
+                v.tipo = ValorJson::Tipo::NUMERO;
+                v.numero = strtod(num.c_str(), &depois);
+                if (depois == num.c_str()) return false;
+                p += depois - num.c_str();
+                return true;
+            }
+            }
+        }
+    };
+}
+
+const ValorJson *ValorJson::campo(const char *nome) const
+{
+    for (const auto &c : campos)
+        if (c.first == nome) return &c.second;
+    return nullptr;
+}
+
+double ValorJson::numeroOu(const char *nome, double padrao) const
+{
+    const ValorJson *c = campo(nome);
+    return (c && c->tipo == Tipo::NUMERO) ? c->numero : padrao;
+}
+
+std::string ValorJson::textoOu(const char *nome, const std::string &padrao) const
+{
+    const ValorJson *c = campo(nome);
+    return (c && c->tipo == Tipo::TEXTO) ? c->texto : padrao;
+}
+
+bool parseJson(const std::string &entrada, ValorJson &saida)
+{
+    Parser parser{entrada.data(), entrada.data() + entrada.size()};
+    saida = ValorJson();
+    if (!parser.valor(saida, 0)) return false;
+    parser.espacos();
+    return parser.p == parser.fim;
+}
+
+std::string escaparJson(const std::string &s)
+{
+    std::string out;
+    out.reserve(s.size() + 8);
+    for (unsigned char c : s)
+    {
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20)
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            }
+            else out += (char)c;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,29 @@
+#ifndef JSON_MINI_H
+#define JSON_MINI_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Parser JSON mínimo para o agregador (só o necessário para ler
+// /status.json e /historico.json dos dispositivos).
+struct ValorJson
+{
+    enum class Tipo { NULO, BOOL, NUMERO, TEXTO, ARRAY, OBJETO };
+
+    Tipo tipo = Tipo::NULO;
+    bool booleano = false;
+    double numero = 0;
+    std::string texto;
+    std::vector<ValorJson> itens;
+    std::vector<std::pair<std::string, ValorJson>> campos;
+
+    const ValorJson *campo(const char *nome) const;
+    double numeroOu(const char *nome, double padrao) const;
+    std::string textoOu(const char *nome, const std::string &padrao) const;
+};
+
+bool parseJson(const std::string &entrada, ValorJson &saida);
+std::string escaparJson(const std::string &s);
+
+#endif
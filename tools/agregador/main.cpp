@@ -0,0 +1,175 @@
+// Agregador de várias placas de alarme num só lugar.
+//
+// Uso: agregador <arquivo_dispositivos> [porta=8080] [intervalo_ms=2000]
+//
+// Arquivo de dispositivos: uma placa por linha, "nome host[:porta]"
+// (linhas vazias ou começando com # são ignoradas).
+//
+// Um único loop poll() consulta todas as placas (status + histórico
+// incremental via ?desde=<seq>) e serve:
+//   GET /dispositivos.json          estado de cada placa (com o /status.json dela)
+//   GET /zonas.json                 todas as zonas de todas as placas
+//   GET /eventos.json?desde=C&limite=N
+//                                   eventos de todas as placas em ordem de horário;
+//                                   "cursor" da resposta vai no próximo ?desde=
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "consolidado.h"
+#include "dispositivo.h"
+#include "servidor_http.h"
+
+static const size_t MAX_EVENTOS = 100000;
+
+static volatile sig_atomic_t rodando = 1;
+
+static int64_t agoraMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static std::string parametro(const std::string &query, const char *nome)
+{
+    const std::string chave = std::string(nome) + "=";
+    size_t pos = 0;
+    while (pos < query.size())
+    {
+        const size_t fim = query.find('&', pos);
+        const std::string par = query.substr(pos, fim == std::string::npos ? std::string::npos : fim - pos);
+        if (par.compare(0, chave.size(), chave) == 0) return par.substr(chave.size());
+        if (fim == std::string::npos) break;
+        pos = fim + 1;
+    }
+    return "";
+}
+
+static bool lerDispositivos(const char *caminho, std::vector<std::unique_ptr<Dispositivo>> &saida)
+{
+    std::ifstream arq(caminho);
+    if (!arq) return false;
+
+    std::string linha;
+    while (std::getline(arq, linha))
+    {
+        std::istringstream ss(linha);
+        std::string nome, host;
+        if (!(ss >> nome >> host) || nome[0] == '#') continue;
+
+        uint16_t porta = 80;
+        const size_t dp = host.find(':');
+        if (dp != std::string::npos)
+        {
+            porta = (uint16_t)atoi(host.c_str() + dp + 1);
+            host.resize(dp);
+        }
+        saida.emplace_back(new Dispositivo(nome, host, porta));
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "uso: %s <arquivo_dispositivos> [porta=8080] [intervalo_ms=2000]\n", argv[0]);
+        return 1;
+    }
+    const uint16_t porta = argc > 2 ? (uint16_t)atoi(argv[2]) : 8080;
+    const int64_t intervaloMs = argc > 3 ? atoll(argv[3]) : 2000;
+
+    std::vector<std::unique_ptr<Dispositivo>> dispositivos;
+    if (!lerDispositivos(argv[1], dispositivos))
+    {
+        fprintf(stderr, "[ERRO] não foi possível ler %s\n", argv[1]);
+        return 1;
+    }
+
+    Consolidado consolidado(MAX_EVENTOS);
+
+    ServidorHttp servidor([&](const std::string &caminho, const std::string &query, int &status) -> std::string
+    {
+        const int64_t agora = agoraMs();
+        if (caminho == "/dispositivos.json")
+        {
+            std::string out = "[";
+            for (size_t i = 0; i < dispositivos.size(); i++)
+            {
+                if (i) out += ',';
+                out += dispositivos[i]->resumoJson(agora);
+            }
+            return out + "]";
+        }
+        if (caminho == "/zonas.json")
+        {
+            std::string out = "[";
+            bool primeiro = true;
+            for (const auto &d : dispositivos) d->zonasJson(out, primeiro);
+            return out + "]";
+        }
+        if (caminho == "/eventos.json")
+        {
+            const std::string desde = parametro(query, "desde");
+            const std::string limite = parametro(query, "limite");
+            return consolidado.eventosJson(strtoull(desde.c_str(), nullptr, 10),
+                                           limite.empty() ? 1000 : strtoul(limite.c_str(), nullptr, 10));
+        }
+        status = 404;
+        return "{\"erro\":\"não encontrado\"}";
+    });
+
+    if (!servidor.iniciar(porta))
+    {
+        perror("[ERRO] servidor");
+        return 1;
+    }
+
+    signal(SIGINT, [](int) { rodando = 0; });
+    signal(SIGTERM, [](int) { rodando = 0; });
+    printf("[AGREGADOR] %zu dispositivos, API em http://0.0.0.0:%u\n", dispositivos.size(), porta);
+
+    // Espalha o primeiro ciclo para não consultar todas as placas no mesmo instante
+    for (size_t i = 0; i < dispositivos.size(); i++)
+        dispositivos[i]->agendar(agoraMs() - intervaloMs + (int64_t)(intervaloMs * i / dispositivos.size()), 0);
+
+    std::vector<pollfd> fds;
+    std::vector<Dispositivo *> donoFd;
+    while (rodando)
+    {
+        const int64_t agora = agoraMs();
+        fds.clear();
+        donoFd.clear();
+
+        for (auto &d : dispositivos)
+        {
+            d->verificarTimeout(agora);
+            d->agendar(agora, intervaloMs);
+            if (d->fd() >= 0)
+            {
+                fds.push_back({d->fd(), d->eventosPoll(), 0});
+                donoFd.push_back(d.get());
+            }
+        }
+        const size_t totalDispositivos = fds.size();
+        servidor.registrar(fds);
+
+        if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) break;
+
+        const int64_t depois = agoraMs();
+        for (size_t i = 0; i < totalDispositivos; i++)
+            if (fds[i].revents) donoFd[i]->processar(fds[i].revents, depois, consolidado);
+        servidor.processar(fds);
+    }
+
+    printf("[AGREGADOR] encerrando (%zu eventos na janela)\n", consolidado.tamanho());
+    return 0;
+}
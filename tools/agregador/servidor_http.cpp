@@ -0,0 +1,128 @@
+#include "servidor_http.h"
+
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t MAX_REQUISICAO = 8192;
+
+ServidorHttp::~ServidorHttp()
+{
+    for (auto &c : conexoes) close(c.fd);
+    if (escuta >= 0) close(escuta);
+}
+
+bool ServidorHttp::iniciar(uint16_t porta)
+{
+    escuta = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (escuta < 0) return false;
+
+    int um = 1;
+    setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_ANY);
+    end.sin_port = htons(porta);
+    if (bind(escuta, (sockaddr *)&end, sizeof(end)) < 0 || listen(escuta, 64) < 0) return false;
+    return true;
+}
+
+void ServidorHttp::registrar(std::vector<pollfd> &fds)
+{
+    indiceInicial = fds.size();
+    fds.push_back({escuta, POLLIN, 0});
+    for (const auto &c : conexoes) fds.push_back({c.fd, (short)(c.respondendo ? POLLOUT : POLLIN), 0});
+}
+
+void ServidorHttp::processar(const std::vector<pollfd> &fds)
+{
+    // conexões primeiro (os índices valem para o vetor atual de conexões)
+    for (size_t i = 0; i < conexoes.size(); i++)
+    {
+        Conexao &c = conexoes[i];
+        const short rev = fds[indiceInicial + 1 + i].revents;
+        if (!rev) continue;
+
+        if (rev & (POLLERR | POLLNVAL))
+        {
+            c.enviados = c.saida.size();
+            c.respondendo = true;
+            continue;
+        }
+
+        if (!c.respondendo && (rev & (POLLIN | POLLHUP)))
+        {
+            char buf[2048];
+            const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n <= 0)
+            {
+                c.respondendo = true; // cliente foi embora: marca para fechar
+                c.enviados = c.saida.size();
+                continue;
+            }
+            c.entrada.append(buf, n);
+            if (c.entrada.find("\r\n\r\n") != std::string::npos || c.entrada.size() > MAX_REQUISICAO)
+                responder(c);
+        }
+        else if (c.respondendo && (rev & POLLOUT))
+        {
+            const ssize_t n = send(c.fd, c.saida.data() + c.enviados, c.saida.size() - c.enviados, MSG_NOSIGNAL);
+            if (n > 0) c.enviados += n;
+            else if (errno != EAGAIN) c.enviados = c.saida.size();
+        }
+    }
+
+    // fecha as que terminaram
+    for (size_t i = 0; i < conexoes.size();)
+    {
+        if (conexoes[i].respondendo && conexoes[i].enviados >= conexoes[i].saida.size())
+        {
+            close(conexoes[i].fd);
+            conexoes[i] = std::move(conexoes.back());
+            conexoes.pop_back();
+        }
+        else i++;
+    }
+
+    if (fds[indiceInicial].revents & POLLIN) aceitar();
+}
+
+void ServidorHttp::aceitar()
+{
+    for (;;)
+    {
+        const int fd = accept4(escuta, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        conexoes.push_back({fd, {}, {}, 0, false});
+    }
+}
+
+void ServidorHttp::responder(Conexao &c)
+{
+    int status = 200;
+    std::string corpo;
+
+    // "GET /caminho?query HTTP/1.x"
+    const size_t esp1 = c.entrada.find(' ');
+    const size_t esp2 = c.entrada.find(' ', esp1 + 1);
+    if (esp1 == std::string::npos || esp2 == std::string::npos || c.entrada.compare(0, esp1, "GET") != 0)
+    {
+        status = 400;
+        corpo = "{\"erro\":\"requisição inválida\"}";
+    }
+    else
+    {
+        const std::string alvo = c.entrada.substr(esp1 + 1, esp2 - esp1 - 1);
+        const size_t q = alvo.find('?');
+        corpo = rota(alvo.substr(0, q), q == std::string::npos ? "" : alvo.substr(q + 1), status);
+    }
+
+    const char *texto = status == 200 ? "OK" : status == 404 ? "Not Found" : "Bad Request";
+    c.saida = "HTTP/1.0 " + std::to_string(status) + " " + texto +
+              "\r\nContent-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\nContent-Length: " +
+              std::to_string(corpo.size()) + "\r\nConnection: close\r\n\r\n" + corpo;
+    c.respondendo = true;
+}
@@ -0,0 +1,46 @@
+#ifndef SERVIDOR_HTTP_H
+#define SERVIDOR_HTTP_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <poll.h>
+
+// Servidor HTTP/1.0 mínimo, não bloqueante, integrado ao poll() do agregador.
+// Cada conexão recebe uma resposta e é fechada.
+class ServidorHttp
+{
+public:
+    // Recebe caminho e query string; devolve o corpo JSON e ajusta o status
+    typedef std::function<std::string(const std::string &caminho, const std::string &query, int &status)> Rota;
+
+    explicit ServidorHttp(Rota rota) : rota(std::move(rota)) {}
+    ~ServidorHttp();
+
+    bool iniciar(uint16_t porta);
+
+    // Acrescenta os fds ao vetor do poll() e depois trata os que ficaram prontos
+    void registrar(std::vector<pollfd> &fds);
+    void processar(const std::vector<pollfd> &fds);
+
+private:
+    struct Conexao
+    {
+        int fd;
+        std::string entrada;
+        std::string saida;
+        size_t enviados = 0;
+        bool respondendo = false;
+    };
+
+    void aceitar();
+    void responder(Conexao &c);
+
+    Rota rota;
+    int escuta = -1;
+    size_t indiceInicial = 0;
+    std::vector<Conexao> conexoes;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Arduino de mentira para compilar partes do firmware no host (bancada.h):
+// relógio virtual, registradores de entrada e o mínimo de String/Print/Serial
+// que os módulos medidos usam.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+#define INPUT  0
+#define OUTPUT 1
+#define LOW    0
+#define HIGH   1
+
+// NodeMCU D0..D8 -> GPIO (system_config.h usa os nomes)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+// Registradores de entrada lidos por entradas.h
+extern uint32_t GPI;
+extern uint32_t GP16I;
+
+// constantes em flash: no host, memória comum
+#define PROGMEM
+#define memcpy_P memcpy
+
+uint32_t millis();
+uint32_t micros();
+uint64_t micros64();
+void delay(unsigned long ms);
+void yield();
+void pinMode(int pino, int modo);
+int digitalRead(int pino);
+void digitalWrite(int pino, int valor);
+bool getLocalTime(struct tm *info);
+
+// newlib da placa tem; a glibc só a partir da 2.38
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char *destino, const char *origem, size_t tamanho)
+{
+    const size_t n = strlen(origem);
+    if (tamanho)
+    {
+        const size_t copia = n < tamanho - 1 ? n : tamanho - 1;
+        memcpy(destino, origem, copia);
+        destino[copia] = '\0';
+    }
+    return n;
+}
+#endif
+
+class String : public std::string
+{
+public:
+    using std::string::string;
+    String() = default;
+    String(const std::string &s) : std::string(s) {}
+    bool startsWith(const char *prefixo) const { return compare(0, strlen(prefixo), prefixo) == 0; }
+};
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *dados, size_t n)
+    {
+        size_t escritos = 0;
+        while (n-- && write(*dados++)) escritos++;
+        return escritos;
+    }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t println(const char *s) { return print(s) + print('\n'); }
+    size_t printf(const char *formato, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, formato);
+        const int n = vsnprintf(buffer, sizeof(buffer), formato, args);
+        va_end(args);
+        return n > 0 ? write((const uint8_t *)buffer, (size_t)n < sizeof(buffer) ? n : sizeof(buffer) - 1) : 0;
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long) {}
+    // como no core com timeout 0: para no primeiro byte que não chegou
+    size_t readBytes(char *buffer, size_t n)
+    {
+        size_t lidos = 0;
+        int c;
+        while (lidos < n && (c = read()) >= 0) buffer[lidos++] = (char)c;
+        return lidos;
+    }
+    // o terminador é consumido e não entra no buffer
+    size_t readBytesUntil(char terminador, char *buffer, size_t n)
+    {
+        size_t lidos = 0;
+        int c;
+        while (lidos < n && (c = read()) >= 0 && c != terminador) buffer[lidos++] = (char)c;
+        return lidos;
+    }
+};
+
+// Saída serial do firmware: descartada (as ferramentas imprimem o resultado)
+struct SerialHost
+{
+    template <typename... A> void print(const A &...) {}
+    template <typename... A> void println(const A &...) {}
+    void printf(const char *, ...) {}
+};
+extern SerialHost Serial;
+
+struct EspHost
+{
+    void restart();
+    uint32_t getFreeHeap();
+};
+extern EspHost ESP;
+
+#endif
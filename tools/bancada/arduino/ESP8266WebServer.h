@@ -0,0 +1,77 @@
+#ifndef ESP8266WEBSERVER_H
+#define ESP8266WEBSERVER_H
+
+// ESP8266WebServer no host: só o hook de admissão (addHook) que
+// limitador.cpp registra. Quem mede chama os hooks como o handleClient do
+// core, logo depois de ler a linha de requisição.
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+class IPAddress
+{
+public:
+    IPAddress(uint32_t ip = 0) : ip(ip) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : ip(a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+    operator uint32_t() const { return ip; }
+    String toString() const
+    {
+        char texto[16];
+        snprintf(texto, sizeof(texto), "%u.%u.%u.%u", ip & 0xFF, ip >> 8 & 0xFF, ip >> 16 & 0xFF, ip >> 24);
+        return texto;
+    }
+
+private:
+    uint32_t ip;
+};
+
+// Conexão aceita: o que o hook escreve é só contado
+class WiFiClient : public Print
+{
+public:
+    explicit WiFiClient(IPAddress ip = IPAddress()) : ip(ip) {}
+    IPAddress remoteIP() const { return ip; }
+    size_t write(uint8_t) override
+    {
+        enviados++;
+        return 1;
+    }
+    using Print::write;
+    size_t enviados = 0;
+
+private:
+    IPAddress ip;
+};
+
+class ESP8266WebServer
+{
+public:
+    enum ClientFuture
+    {
+        CLIENT_REQUEST_CAN_CONTINUE,
+        CLIENT_REQUEST_IS_HANDLED,
+        CLIENT_MUST_STOP,
+        CLIENT_IS_GIVEN
+    };
+    typedef String (*ContentTypeFunction)(const String &);
+    using HookFunction = std::function<ClientFuture(const String &metodo, const String &url, WiFiClient *cliente,
+                                                    ContentTypeFunction contentType)>;
+
+    void addHook(HookFunction hook) { hooks.push_back(hook); }
+
+    ClientFuture chamarHooks(const String &metodo, const String &url, WiFiClient *cliente)
+    {
+        for (const HookFunction &hook : hooks)
+        {
+            const ClientFuture r = hook(metodo, url, cliente, nullptr);
+            if (r != CLIENT_REQUEST_CAN_CONTINUE) return r;
+        }
+        return CLIENT_REQUEST_CAN_CONTINUE;
+    }
+
+private:
+    std::vector<HookFunction> hooks;
+};
+
+#endif
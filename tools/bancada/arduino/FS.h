@@ -0,0 +1,83 @@
+#ifndef FS_H
+#define FS_H
+
+// FS do core no host: arquivos em memória sobre a flash simulada de
+// flash_host.h, que conta os apagamentos de bloco de cada operação.
+
+#include <Arduino.h>
+#include <memory>
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct FSInfo
+{
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+struct SessaoArquivoHost; // flash_host.cpp
+
+class File : public Stream
+{
+public:
+    File() = default;
+    explicit File(std::shared_ptr<SessaoArquivoHost> sessao) : sessao(std::move(sessao)) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *dados, size_t n) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t *dados, size_t n);
+    bool seek(uint32_t pos, SeekMode modo = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    bool truncate(uint32_t tamanho);
+    void flush() {}
+    void close();
+    const char *name() const;
+    explicit operator bool() const { return sessao != nullptr; }
+
+private:
+    std::shared_ptr<SessaoArquivoHost> sessao;
+};
+
+class Dir
+{
+public:
+    explicit Dir(const char *caminho = "") : caminho(caminho) {}
+    bool next();
+    String fileName() const { return nome; }
+    size_t fileSize() const { return tamanho; }
+
+private:
+    std::string caminho;
+    std::string nome; // atual (sem o diretório)
+    size_t tamanho = 0;
+};
+
+class FS
+{
+public:
+    bool begin() { return true; }
+    File open(const char *caminho, const char *modo);
+    File open(const String &caminho, const char *modo) { return open(caminho.c_str(), modo); }
+    bool exists(const char *caminho);
+    bool remove(const char *caminho);
+    bool rename(const char *de, const char *para);
+    bool mkdir(const char *caminho);
+    Dir openDir(const char *caminho) { return Dir(caminho); }
+    bool info(FSInfo &info);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "bancada.h"
+
+#include <Arduino.h>
+#include <malloc.h>
+#include <chrono>
+
+uint32_t hostRelogioMs = 0;
+time_t hostEpochInicio = 0;
+uint32_t GPI = 0;
+uint32_t GP16I = 0;
+SerialHost Serial;
+EspHost ESP;
+
+static uint32_t leituraAtual = 0;
+
+void hostDefinirLeitura(uint32_t leitura)
+{
+    leituraAtual = leitura;
+    GPI = leitura & 0xFFFF;
+    GP16I = (leitura >> 16) & 1;
+}
+
+uint64_t hostAgoraNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// ================== Arduino ==================
+uint32_t millis() { return hostRelogioMs; }
+uint32_t micros() { return hostRelogioMs * 1000; }
+uint64_t micros64() { return (uint64_t)hostRelogioMs * 1000; }
+void delay(unsigned long) {}
+void yield() {}
+void pinMode(int, int) {}
+void digitalWrite(int, int) {}
+int digitalRead(int pino) { return (pino >= 0 && pino <= 16 && (leituraAtual >> pino) & 1) ? HIGH : LOW; }
+void EspHost::restart() {}
+
+uint32_t EspHost::getFreeHeap()
+{
+    const Alocacoes a = alocacoesLer();
+    return a.bytesVivos < 40000 ? 40000 - (uint32_t)a.bytesVivos : 0;
+}
+
+// Sem NTP até a medida definir hostEpochInicio; UTC para não depender do TZ do host
+bool getLocalTime(struct tm *info)
+{
+    if (!hostEpochInicio) return false;
+    const time_t agora = hostEpochInicio + hostRelogioMs / 1000;
+    gmtime_r(&agora, info);
+    return true;
+}
+
+// ================== Contagem de alocações ==================
+// O programa define malloc/free por cima dos da glibc (interposição), então
+// todo new/delete, std::string e vector passa por aqui.
+extern "C" void *__libc_malloc(size_t);
+extern "C" void *__libc_calloc(size_t, size_t);
+extern "C" void *__libc_realloc(void *, size_t);
+extern "C" void __libc_free(void *);
+
+static bool contando = false;
+static Alocacoes contagem;
+
+static void registrarAlocacao(void *p)
+{
+    if (!contando || !p) return;
+    contagem.alocacoes++;
+    contagem.bytesVivos += malloc_usable_size(p);
+    if (contagem.bytesVivos > contagem.picoBytes) contagem.picoBytes = contagem.bytesVivos;
+}
+
+static void registrarLiberacao(void *p)
+{
+    if (!contando || !p) return;
+    contagem.liberacoes++;
+    contagem.bytesVivos -= malloc_usable_size(p);
+}
+
+extern "C" void *malloc(size_t n)
+{
+    void *p = __libc_malloc(n);
+    registrarAlocacao(p);
+    return p;
+}
+
+extern "C" void *calloc(size_t n, size_t tamanho)
+{
+    void *p = __libc_calloc(n, tamanho);
+    registrarAlocacao(p);
+    return p;
+}
+
+extern "C" void *realloc(void *antigo, size_t n)
+{
+    registrarLiberacao(antigo);
+    void *p = __libc_realloc(antigo, n);
+    registrarAlocacao(p);
+    return p;
+}
+
+extern "C" void free(void *p)
+{
+    registrarLiberacao(p);
+    __libc_free(p);
+}
+
+void alocacoesContar(bool ligar) { contando = ligar; }
+Alocacoes alocacoesLer() { return contagem; }
+void alocacoesZerarPico() { contagem.picoBytes = contagem.bytesVivos; }
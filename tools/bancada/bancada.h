@@ -0,0 +1,33 @@
+#ifndef BANCADA_H
+#define BANCADA_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Hardware visto pelo firmware na bancada (implementação de arduino/).
+
+// Relógio virtual: a medida avança, millis()/micros() devolvem
+extern uint32_t hostRelogioMs;
+// Hora local de getLocalTime() em hostRelogioMs = 0 (0 = sem NTP)
+extern time_t hostEpochInicio;
+
+// Nível dos pinos no formato de entradasLer() (GPI, GP16I e digitalRead)
+void hostDefinirLeitura(uint32_t leitura);
+
+// Contagem de malloc/free (e portanto new/delete) do processo inteiro,
+// só enquanto ligada: o que a própria ferramenta imprime fica de fora
+struct Alocacoes
+{
+    uint64_t alocacoes = 0;
+    uint64_t liberacoes = 0;
+    int64_t bytesVivos = 0; // alocados - liberados (tamanho útil do bloco)
+    int64_t picoBytes = 0;  // maior bytesVivos desde o último zerar
+};
+void alocacoesContar(bool ligar);
+Alocacoes alocacoesLer();
+void alocacoesZerarPico();
+
+// Relógio real para as medidas de tempo (ns)
+uint64_t hostAgoraNs();
+
+#endif
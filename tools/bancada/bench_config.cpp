@@ -0,0 +1,193 @@
+// Parse de sensores.json: tempo e memória de pico conforme o número de sensores.
+//
+// Uso: bench_config [--max N]
+//
+// Para cada tamanho gera um sensores.json (mesmo formato do arquivo da
+// instalação, pinos D0..D8 em rodízio) e mede, com o lerConfigSensores do
+// firmware (lib/sensor/config_sensores.cpp):
+//   validar   lerConfigSensores(..., nullptr): o que o POST faz antes de gravar
+//   carregar  com a saída e a arenaNomes, como carregarSensoresDeJSON no boot
+// e, para comparação, o parse antigo (DynamicJsonDocument(4096) do arquivo
+// inteiro, com a mesma quantidade de slots da placa). Heap = pico de malloc durante o parse; pilha = medida numa
+// thread com pilha pintada, descontado o custo da própria thread.
+//
+// Acima de CONFIG_MAX_SENSORES (7, um por pino livre) os elementos ainda
+// são lidos e recusados um a um, o que é o caso que interessa para a
+// memória. Saída 1 se o heap ou a pilha do parse novo crescer com o arquivo.
+
+#include <pthread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "bancada.h"
+#include "arena_nomes.h"
+#include "config_sensores.h"
+
+static const char *const PINOS[] = {"D0", "D1", "D2", "D4", "D6", "D7", "D8"}; // sem D3/D5 (botão, sirene)
+
+static std::string gerarConfig(unsigned total)
+{
+    std::string json = "[\n";
+    char elemento[192];
+    for (unsigned i = 0; i < total; i++)
+    {
+        snprintf(elemento, sizeof(elemento),
+                 "  {\n    \"nome\": \"Sensor %u\",\n    \"tipo\": \"%s\",\n    \"pino\": \"%s\",\n"
+                 "    \"zona\": \"Zona %u\",\n    \"ativo\": true\n  }%s\n",
+                 i + 1, i % 3 ? "PIR" : "REED", PINOS[i % 7], i / 4 + 1, i + 1 < total ? "," : "");
+        json += elemento;
+    }
+    return json + "]\n";
+}
+
+enum class Modo { VALIDAR, CARREGAR, ANTIGO };
+
+struct Parse
+{
+    const std::string *json;
+    Modo modo;
+    bool ok;
+    const char *falha; // parse antigo: motivo
+    unsigned validos;
+    unsigned erros;
+};
+
+static void executar(Parse &p)
+{
+    LeitorMemoria entrada(p.json->data(), p.json->size());
+    if (p.modo == Modo::ANTIGO)
+    {
+        // 4096 B na placa = 256 slots de 16 B; no host (64 bits) o slot é maior
+        DynamicJsonDocument doc(JSON_ARRAY_SIZE(4096 / 16));
+        const DeserializationError err = deserializeJson(doc, entrada);
+        p.ok = !err && doc.is<JsonArray>();
+        p.falha = err ? err.c_str() : "não é um array";
+        p.validos = p.ok ? doc.as<JsonArray>().size() : 0;
+        p.erros = p.ok ? 0 : 1;
+        return;
+    }
+
+    ResultadoValidacao resultado;
+    std::vector<DefinicaoSensor> saida;
+    if (p.modo == Modo::CARREGAR) arenaNomes.limpar();
+    p.ok = lerConfigSensores(entrada, p.modo == Modo::CARREGAR ? &saida : nullptr, resultado);
+    p.validos = resultado.totalSensores;
+    p.erros = resultado.totalErros;
+}
+
+// ---- pilha: roda o parse numa thread com pilha própria, pintada ----
+static const size_t PILHA_BYTES = 256 * 1024;
+static const uint8_t TINTA = 0xA5;
+
+static void *rodarNaThread(void *arg)
+{
+    Parse *p = static_cast<Parse *>(arg);
+    if (p) executar(*p);
+    return nullptr;
+}
+
+static size_t pilhaUsada(Parse *p)
+{
+    std::vector<uint8_t> pilha(PILHA_BYTES, TINTA);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, pilha.data(), pilha.size());
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, rodarNaThread, p) != 0) return 0;
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+
+    size_t intocada = 0; // a pilha cresce para baixo
+    while (intocada < pilha.size() && pilha[intocada] == TINTA) intocada++;
+    return pilha.size() - intocada;
+}
+
+struct Medida
+{
+    Parse parse;
+    double us;
+    int64_t heap;
+    size_t pilha;
+};
+
+static Medida medir(const std::string &json, Modo modo, size_t pilhaThread)
+{
+    Medida m{{&json, modo, false, "", 0, 0}, 0, 0, 0};
+
+    alocacoesZerarPico();
+    const int64_t base = alocacoesLer().bytesVivos;
+    alocacoesContar(true);
+    executar(m.parse);
+    alocacoesContar(false);
+    m.heap = alocacoesLer().picoBytes - base;
+
+    Parse copia = m.parse;
+    const size_t total = pilhaUsada(&copia);
+    m.pilha = total > pilhaThread ? total - pilhaThread : 0;
+
+    // repete até ~50 ms para o tempo por parse
+    unsigned repeticoes = 0;
+    const uint64_t inicio = hostAgoraNs();
+    uint64_t agora;
+    do
+    {
+        Parse r = m.parse;
+        executar(r);
+        repeticoes++;
+        agora = hostAgoraNs();
+    } while (agora - inicio < 50000000ULL);
+    m.us = (agora - inicio) / 1000.0 / repeticoes;
+    return m;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned maximo = 2048;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) maximo = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Uso: %s [--max N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const size_t pilhaThread = pilhaUsada(nullptr);
+    printf("sensores  bytes   | validar: us  heap  pilha  válidos/erros | carregar: us  heap  pilha | antigo (4096): us  heap  resultado\n");
+
+    int64_t heapValidar = -1;
+    size_t pilhaValidar = 0;
+    bool limitado = true;
+    static const unsigned TAMANHOS[] = {1, 7, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192};
+    for (unsigned n : TAMANHOS)
+    {
+        if (n > maximo) break;
+        const std::string json = gerarConfig(n);
+        const Medida v = medir(json, Modo::VALIDAR, pilhaThread);
+        const Medida c = medir(json, Modo::CARREGAR, pilhaThread);
+        const Medida a = medir(json, Modo::ANTIGO, pilhaThread);
+
+        printf("%8u %7zu   | %11.1f %5lld %6zu  %6u/%-6u | %12.1f %5lld %6zu | %17.1f %5lld  %s%s\n", n, json.size(),
+               v.us, (long long)v.heap, v.pilha, v.parse.validos, v.parse.erros, c.us, (long long)c.heap, c.pilha,
+               a.us, (long long)a.heap, a.parse.ok ? "ok" : "FALHOU: ", a.parse.ok ? "" : a.parse.falha);
+
+        // o parse novo não pode depender do tamanho do arquivo
+        if (heapValidar < 0)
+        {
+            heapValidar = v.heap;
+            pilhaValidar = v.pilha;
+        }
+        else if (v.heap > heapValidar || v.pilha > pilhaValidar + 256)
+            limitado = false;
+    }
+
+    printf("== validar: heap %lld B e pilha ~%zu B %s\n", (long long)heapValidar, pilhaValidar,
+           limitado ? "constantes para qualquer tamanho" : "CRESCENDO com o arquivo");
+    return limitado ? 0 : 1;
+}
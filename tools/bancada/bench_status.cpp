@@ -0,0 +1,140 @@
+// /status.json: tamanho e tempo de geração, MessagePack x JSON.
+//
+// Uso: bench_status [--vezes N]
+//
+// Modelo com 8, 32 e 64 sensores em 4 zonas (nomes do tamanho dos da
+// instalação, pinos D0..D8 em rodízio), alarme armado e o D1 preso no nível
+// de disparo (zonas e sensores violados no meio). Para cada tamanho, N
+// gerações (padrão 2000) de cada formato, com o código do firmware:
+//   msgpack  statusCompactoGerar no buffer de STATUS_COMPACTO_MAX
+//   json     StaticJsonDocument<2048> + statusJsonMontar + serializeJson,
+//            como getEstadoAtualJson (aqui num buffer em vez de String)
+// Tempos do host; na placa, X-Tempo-Geracao-us de /status.json dá o mesmo
+// par. Saída 1 se o MessagePack não couber ou não for menor que o JSON.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "bancada.h"
+#include "modelo_host.h"
+#include "alarme.h"
+#include "arena_nomes.h"
+#include "entradas.h"
+#include "pool_modelo.h"
+#include "status_compacto.h"
+#include "status_json.h"
+#include "system_config.h"
+
+extern std::vector<String> todasZonas;
+
+static const int PINOS[] = {D0, D1, D2, D3, D4, D5, D6, D7, D8};
+static const size_t TOTAL_PINOS = sizeof(PINOS) / sizeof(PINOS[0]);
+static const int PINO_PRESO = D1;
+static const size_t TOTAL_ZONAS = 4;
+
+static Alarme alarme;
+static Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
+
+static void configurar(size_t totalSensores)
+{
+    alarme.limparZonas();
+    poolModelo.resetar();
+    todasZonas.clear();
+    arenaNomes.limpar();
+
+    static const char *const ZONAS[TOTAL_ZONAS] = {"Administração Central", "Pátio de Descarga", "Triagem",
+                                                   "Reciclagem"};
+    std::vector<DefinicaoSensor> defs;
+    for (size_t i = 0; i < totalSensores; i++)
+    {
+        char nome[32];
+        snprintf(nome, sizeof(nome), "Sensor Porta Fundos %02u", (unsigned)i);
+        defs.push_back({arenaNomes.internar(nome), arenaNomes.internar(ZONAS[i % TOTAL_ZONAS]),
+                        i % 3 ? Sensor::Tipo::PIR : Sensor::Tipo::REED, PINOS[i % TOTAL_PINOS], true});
+    }
+    const Faixa<Zona> zonas = poolModelo.montar(defs);
+    for (const Zona &zona : zonas) todasZonas.push_back(zona.getNome());
+
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(zonas);
+    alarme.armar(todasZonas);
+
+    // repouso em nível alto (PIR e REED disparam em nível baixo); o D1 dispara
+    uint32_t repouso = 0;
+    for (const Sensor &sensor : poolModelo.getSensores()) repouso |= entradasBit(sensor.getPino());
+    hostDefinirLeitura(repouso ^ entradasBit(PINO_PRESO));
+    for (int i = 0; i < 10; i++)
+    {
+        hostRelogioMs++;
+        alarme.atualizar(entradasLer());
+    }
+}
+
+struct Medida
+{
+    size_t bytes;
+    double us;
+    bool ok;
+};
+
+static Medida medirMsgpack(unsigned vezes)
+{
+    static uint8_t buf[STATUS_COMPACTO_MAX];
+    size_t n = 0;
+    const uint64_t t0 = hostAgoraNs();
+    for (unsigned i = 0; i < vezes; i++) n = statusCompactoGerar(alarme, buf, sizeof(buf));
+    return {n, (hostAgoraNs() - t0) / 1000.0 / vezes, n > 0};
+}
+
+static Medida medirJson(unsigned vezes)
+{
+    static char buf[8192];
+    size_t n = 0;
+    bool cheio = false;
+    const uint64_t t0 = hostAgoraNs();
+    for (unsigned i = 0; i < vezes; i++)
+    {
+        StaticJsonDocument<2048> doc;
+        statusJsonMontar(alarme, doc);
+        cheio = doc.overflowed();
+        n = serializeJson(doc, buf, sizeof(buf));
+    }
+    return {n, (hostAgoraNs() - t0) / 1000.0 / vezes, !cheio};
+}
+
+int main(int argc, char **argv)
+{
+    unsigned vezes = 2000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--vezes") == 0 && i + 1 < argc) vezes = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            fprintf(stderr, "Uso: %s [--vezes N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    hostEpochInicio = 1767571200;
+    static const size_t TOTAIS[] = {8, 32, 64};
+
+    printf("sensores   msgpack        json            (us por geração, host)\n");
+    bool ok = true;
+    for (size_t total : TOTAIS)
+    {
+        configurar(total);
+        const Medida m = medirMsgpack(vezes);
+        const Medida j = medirJson(vezes);
+        const bool linhaOk = m.ok && m.bytes < j.bytes;
+        printf("%8zu %6zu B %5.1f us %6zu B %6.1f us%s%s\n", total, m.bytes, m.us, j.bytes, j.us,
+               j.ok ? "" : "  (JSON truncado: documento de 2048 B cheio)", linhaOk ? "" : "  <- FALHOU");
+        ok = ok && linhaOk;
+    }
+    printf("== %s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,392 @@
+// Gerador de carga HTTP contra o limitador do servidor web (limitador.cpp)
+// com o núcleo do alarme armado, no relógio virtual.
+//
+// Uso: carga_http [--segundos N] [--enxurrada N] [--ips N] [--vazao KB/s] [--semente S]
+//
+// O servidor da placa atende uma conexão por volta do loop() e deixa até
+// FILA_CONEXOES esperando (MAX_PENDING_CLIENTS_PER_PORT do platformio.ini;
+// o resto o lwIP recusa). Cada volta aqui: uma conexão da fila (linha de
+// requisição -> hooks do limitador -> 429 ou a rota), o tick do alarme se
+// devido ou se houve borda num sensor (energiaTickDevido) e o resto do
+// loop. O tempo de cada etapa vem da tabela CUSTOS: estimativas para a
+// placa a 80 MHz, com o corpo das respostas a --vazao KB/s.
+//
+// Clientes:
+//   navegador     /status.json a cada 5 s (index.html); conexão recusada:
+//                 SYN de novo em 1, 2 e 4 s, depois desiste da consulta
+//   enxurrada     N IPs (padrão 3) pedindo /status.json?t=... sem parar
+//   força bruta   um IP tentando senhas em /login sem parar
+//   IPs rotativos /login, cada tentativa de um IP de um conjunto de N (64)
+// Cada cenário roda com e sem o hook do limitador (o bloqueio de login dos
+// handlers vale nos dois). A cada 20 s um PIR dispara por 3 s.
+//
+// Saída 1 se, com o limitador, em algum cenário: o tick atrasar um período
+// inteiro (ENERGIA_TICK_RAPIDO_MS), um alerta demorar mais que o do cenário
+// ocioso + ENERGIA_TICK_RAPIDO_MS, o navegador perder consultas ou o IP da
+// força bruta testar mais que MAX_TENTATIVAS_LOGIN senhas por
+// TEMPO_BLOQUEIO_LOGIN, ou os IPs rotativos passarem do balde de login
+// (WEB_BALDE_LOGIN_*). A linha de requisição lenta (slowloris) fica de
+// fora: o hook só vê linhas completas.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bancada.h"
+#include "modelo_host.h"
+#include "alarme.h"
+#include "arena_nomes.h"
+#include "entradas.h"
+#include "limitador.h"
+#include "metricas.h"
+#include "pool_modelo.h"
+#include "system_config.h"
+
+ContadoresSistema contadores;
+extern std::vector<String> todasZonas;
+
+static const size_t FILA_CONEXOES = 4; // MAX_PENDING_CLIENTS_PER_PORT
+
+// Tempo de CPU na placa (µs); o corpo da resposta soma bytes / vazão
+struct Custos
+{
+    uint32_t linhaUs = 600;       // accept + linha de requisição (até o hook)
+    uint32_t resposta429Us = 400; // 429 escrito pelo hook + close
+    uint32_t statusUs = 6000;     // /status.json (formatação + cabeçalhos)
+    uint32_t loginUs = 4000;      // /login: args, comparação, evento
+    uint32_t tickUs = 800;        // entradasLer + alarme.atualizar
+    uint32_t restoLoopUs = 1500;  // WS, P2P, MQTT, notificações, armazenamento
+    size_t statusBytes = 1200;
+    size_t loginBytes = 120;
+    uint32_t vazaoKBs = 400;
+};
+static Custos CUSTOS;
+
+enum Perfil : uint8_t
+{
+    NAVEGADOR,
+    ENXURRADA,
+    FORCA_BRUTA,
+    IPS_ROTATIVOS
+};
+
+struct Cliente
+{
+    Perfil perfil;
+    uint32_t ip;
+    uint64_t proximoUs = 0; // próxima tentativa de conexão
+    uint64_t inicioUs = 0;  // primeira tentativa da consulta atual
+    uint8_t syns = 0;
+    bool naFila = false;
+    uint32_t rotacao = 0;
+
+    unsigned pedidos = 0, atendidas = 0, rejeitadas = 0, recusadas = 0, desistencias = 0, senhas = 0;
+    uint64_t maxEsperaUs = 0;
+};
+
+struct Resultado
+{
+    double httpFracao = 0;
+    uint32_t maxAtrasoTickUs = 0;
+    uint32_t maxAlertaUs = 0;
+    unsigned alertasPerdidos = 0;
+    unsigned navegadorConsultas = 0, navegadorOk = 0;
+    uint64_t navegadorMaxEsperaUs = 0;
+    unsigned senhasForcaBruta = 0, senhasRotativas = 0;
+    unsigned rejeitadas = 0, recusadas = 0;
+};
+
+// ================== Alarme ==================
+static Alarme alarme;
+static Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
+static const int PIRS[] = {D1, D2, D6};
+
+static void configurarAlarme()
+{
+    std::vector<DefinicaoSensor> defs;
+    const char *zonas[] = {"Triagem", "Reciclagem", "Pátio de Descarga"};
+    for (size_t i = 0; i < 3; i++)
+        defs.push_back({arenaNomes.internar("Ambiente"), arenaNomes.internar(zonas[i]), Sensor::tipoFromString("PIR"),
+                        PIRS[i], true});
+    const Faixa<Zona> faixa = poolModelo.montar(defs);
+    for (const Zona &zona : faixa) todasZonas.push_back(zona.getNome());
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(faixa);
+    alarme.armar(todasZonas);
+}
+
+// ================== Simulação ==================
+static ESP8266WebServer servidor;
+static uint64_t agoraUs = 0;
+static unsigned totalIps = 64; // IPs do atacante rotativo
+
+static void avancar(uint64_t us)
+{
+    agoraUs += us;
+    hostRelogioMs = (uint32_t)(agoraUs / 1000);
+}
+
+static uint64_t corpoUs(size_t bytes) { return (uint64_t)bytes * 1000 / CUSTOS.vazaoKBs; }
+
+static uint32_t ipLan(uint32_t final) { return IPAddress(192, 168, 0, (uint8_t)final); }
+
+static void proximaConsulta(Cliente &c)
+{
+    c.syns = 0;
+    if (c.perfil == NAVEGADOR)
+    {
+        c.proximoUs = c.inicioUs + 5000000;
+        if (c.proximoUs <= agoraUs) c.proximoUs = agoraUs + 1;
+    }
+    else c.proximoUs = agoraUs + 2000; // ida e volta na rede local
+    c.inicioUs = c.proximoUs;
+}
+
+static void tentarConectar(Cliente &c, std::deque<Cliente *> &fila)
+{
+    if (c.syns == 0)
+    {
+        c.pedidos++;
+        if (c.perfil == IPS_ROTATIVOS)
+        {
+            const uint32_t n = c.rotacao++ % totalIps;
+            c.ip = IPAddress(10, 0, (uint8_t)(n / 250), (uint8_t)(1 + n % 250));
+        }
+    }
+    if (fila.size() < FILA_CONEXOES)
+    {
+        fila.push_back(&c);
+        c.naFila = true;
+        return;
+    }
+    c.recusadas++;
+    if (c.perfil != NAVEGADOR)
+    {
+        c.proximoUs = agoraUs + 10000;
+        c.syns = 1;
+        return;
+    }
+    // retransmissão do SYN; depois da terceira o fetch() falha
+    static const uint32_t ESPERA_SYN_US[] = {1000000, 2000000, 4000000};
+    if (c.syns < 3) c.proximoUs = agoraUs + ESPERA_SYN_US[c.syns++];
+    else
+    {
+        c.desistencias++;
+        proximaConsulta(c);
+    }
+}
+
+// handleClient com uma conexão: hook do limitador e, se passou, a rota
+static void atender(Cliente &c, bool comLimitador, uint64_t &httpUs)
+{
+    const uint64_t inicio = agoraUs;
+    c.naFila = false;
+    avancar(CUSTOS.linhaUs);
+
+    char url[48];
+    const bool login = c.perfil == FORCA_BRUTA || c.perfil == IPS_ROTATIVOS;
+    if (login) snprintf(url, sizeof(url), "/login");
+    else snprintf(url, sizeof(url), "/status.json?t=%llu", (unsigned long long)(agoraUs / 1000));
+
+    WiFiClient cliente{IPAddress(c.ip)};
+    const ESP8266WebServer::ClientFuture futuro =
+        comLimitador ? servidor.chamarHooks(login ? "POST" : "GET", url, &cliente)
+                     : ESP8266WebServer::CLIENT_REQUEST_CAN_CONTINUE;
+
+    if (futuro == ESP8266WebServer::CLIENT_MUST_STOP)
+    {
+        avancar(CUSTOS.resposta429Us + corpoUs(cliente.enviados));
+        c.rejeitadas++;
+    }
+    else if (login)
+    {
+        // verificarSenhaAdmin: IP bloqueado nem compara a senha
+        const IPAddress ip(c.ip);
+        if (!limitadorLoginBloqueado(ip))
+        {
+            c.senhas++;
+            limitadorFalhaLogin(ip);
+        }
+        avancar(CUSTOS.loginUs + corpoUs(CUSTOS.loginBytes));
+        c.atendidas++;
+    }
+    else
+    {
+        avancar(CUSTOS.statusUs + corpoUs(CUSTOS.statusBytes));
+        c.atendidas++;
+    }
+
+    if (c.perfil == NAVEGADOR && futuro != ESP8266WebServer::CLIENT_MUST_STOP)
+        c.maxEsperaUs = std::max(c.maxEsperaUs, agoraUs - c.inicioUs);
+    httpUs += agoraUs - inicio;
+    proximaConsulta(c);
+}
+
+struct Cenario
+{
+    const char *nome;
+    unsigned enxurrada;
+    bool forcaBruta;
+    bool rotativos;
+};
+
+static Resultado rodarCenario(const Cenario &cenario, bool comLimitador, unsigned segundos, std::mt19937 &rng)
+{
+    std::vector<Cliente> clientes;
+    clientes.push_back({NAVEGADOR, ipLan(10)});
+    for (unsigned i = 0; i < cenario.enxurrada; i++) clientes.push_back({ENXURRADA, ipLan(100 + i)});
+    if (cenario.forcaBruta) clientes.push_back({FORCA_BRUTA, ipLan(66)});
+    if (cenario.rotativos) clientes.push_back({IPS_ROTATIVOS, 0});
+    for (Cliente &c : clientes) c.proximoUs = c.inicioUs = agoraUs + rng() % 5000000;
+
+    std::deque<Cliente *> fila;
+    Resultado r;
+    uint64_t httpUs = 0;
+    const uint64_t inicioUs = agoraUs, fimUs = agoraUs + (uint64_t)segundos * 1000000;
+
+    uint32_t ultimoTickMs = hostRelogioMs;
+    bool borda = false;
+    uint64_t disparoUs = agoraUs + 20000000, bordaUs = 0;
+    int disparoPino = -1;
+    unsigned proximoPir = 0;
+    uint32_t alertasAntes = hostAlertas;
+    uint32_t leitura = 0;
+    for (int pino : PIRS) leitura |= entradasBit(pino);
+    hostDefinirLeitura(leitura);
+
+    while (agoraUs < fimUs)
+    {
+        // disparo do PIR (borda = interrupção) e fim do disparo
+        if (disparoPino < 0 && agoraUs >= disparoUs)
+        {
+            disparoPino = PIRS[proximoPir++ % 3];
+            hostDefinirLeitura(leitura & ~entradasBit(disparoPino));
+            borda = true;
+            bordaUs = agoraUs;
+            alertasAntes = hostAlertas;
+        }
+        else if (disparoPino >= 0 && agoraUs >= disparoUs + 3000000)
+        {
+            if (hostAlertas == alertasAntes) r.alertasPerdidos++;
+            hostDefinirLeitura(leitura);
+            disparoPino = -1;
+            disparoUs += 20000000;
+        }
+
+        for (Cliente &c : clientes)
+        {
+            if (!c.naFila && c.proximoUs <= agoraUs) tentarConectar(c, fila);
+        }
+
+        // 1) servidor HTTP: uma conexão por volta
+        if (!fila.empty())
+        {
+            Cliente &c = *fila.front();
+            fila.pop_front();
+            atender(c, comLimitador, httpUs);
+        }
+
+        // 2) tick: no prazo ou já, se houve borda
+        const uint32_t agoraMs = hostRelogioMs;
+        if (agoraMs - ultimoTickMs >= ENERGIA_TICK_RAPIDO_MS || borda)
+        {
+            if (!borda) r.maxAtrasoTickUs = std::max<uint32_t>(r.maxAtrasoTickUs, (agoraMs - ultimoTickMs - ENERGIA_TICK_RAPIDO_MS) * 1000);
+            ultimoTickMs = agoraMs;
+            const uint32_t antes = hostAlertas;
+            alarme.atualizar(entradasLer());
+            avancar(CUSTOS.tickUs);
+            if (borda && hostAlertas != antes) r.maxAlertaUs = std::max<uint32_t>(r.maxAlertaUs, agoraUs - bordaUs);
+            borda = false;
+        }
+
+        // 3) resto do loop
+        avancar(CUSTOS.restoLoopUs);
+    }
+
+    r.httpFracao = (double)httpUs / (agoraUs - inicioUs);
+    for (const Cliente &c : clientes)
+    {
+        r.rejeitadas += c.rejeitadas;
+        r.recusadas += c.recusadas;
+        if (c.perfil == NAVEGADOR)
+        {
+            r.navegadorConsultas = c.pedidos - (c.naFila || c.syns ? 1 : 0);
+            r.navegadorOk = c.atendidas;
+            r.navegadorMaxEsperaUs = c.maxEsperaUs;
+        }
+        if (c.perfil == FORCA_BRUTA) r.senhasForcaBruta = c.senhas;
+        if (c.perfil == IPS_ROTATIVOS) r.senhasRotativas = c.senhas;
+    }
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned segundos = 600, enxurrada = 3, semente = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--segundos")) segundos = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--enxurrada")) enxurrada = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--ips")) totalIps = std::max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--vazao")) CUSTOS.vazaoKBs = std::max(1, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--semente")) semente = atoi(argv[i + 1]);
+        else
+        {
+            fprintf(stderr, "uso: %s [--segundos N] [--enxurrada N] [--ips N] [--vazao KB/s] [--semente S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(semente);
+    hostEpochInicio = 1767571200;
+    configurarAlarme();
+    limitadorSetup(servidor);
+
+    const Cenario cenarios[] = {
+        {"ocioso", 0, false, false},
+        {"enxurrada", enxurrada, false, false},
+        {"forca_bruta", 0, true, false},
+        {"ips_rotativos", 0, false, true},
+        {"tudo", enxurrada, true, true},
+    };
+
+    printf("%-14s %-4s %6s %9s %9s %10s %10s %9s %9s %8s %8s\n", "cenario", "lim", "http%", "atraso_ms",
+           "alerta_ms", "navegador", "espera_ms", "senhas_ip", "senhas_n", "429", "recusas");
+
+    bool ok = true;
+    uint32_t alertaOciosoUs = 0;
+    for (const Cenario &cenario : cenarios)
+    {
+        for (int comLimitador = 1; comLimitador >= 0; comLimitador--)
+        {
+            const Resultado r = rodarCenario(cenario, comLimitador, segundos, rng);
+            // intervalo entre cenários: bloqueios de login vencem, baldes enchem
+            avancar((uint64_t)2 * TEMPO_BLOQUEIO_LOGIN * 1000);
+
+            printf("%-14s %-4s %5.1f%% %9.1f %9.1f %5u/%-4u %10.0f %9u %9u %8u %8u\n", cenario.nome,
+                   comLimitador ? "sim" : "nao", r.httpFracao * 100, r.maxAtrasoTickUs / 1000.0, r.maxAlertaUs / 1000.0,
+                   r.navegadorOk, r.navegadorConsultas, r.navegadorMaxEsperaUs / 1000.0, r.senhasForcaBruta,
+                   r.senhasRotativas, r.rejeitadas, r.recusadas);
+
+            if (!comLimitador) continue;
+            if (!strcmp(cenario.nome, "ocioso")) alertaOciosoUs = r.maxAlertaUs;
+            const double janelas = (double)segundos * 1000 / TEMPO_BLOQUEIO_LOGIN;
+            const double senhasRotativasMax =
+                (WEB_BALDE_LOGIN_CAPACIDADE + (double)segundos * WEB_BALDE_LOGIN_TAXA) / WEB_CUSTO_LOGIN;
+            const bool cenarioOk = r.maxAtrasoTickUs < ENERGIA_TICK_RAPIDO_MS * 1000 && !r.alertasPerdidos &&
+                                   r.maxAlertaUs <= alertaOciosoUs + ENERGIA_TICK_RAPIDO_MS * 1000 &&
+                                   r.navegadorOk == r.navegadorConsultas &&
+                                   r.senhasForcaBruta <= MAX_TENTATIVAS_LOGIN * (janelas + 1) &&
+                                   r.senhasRotativas <= senhasRotativasMax;
+            if (!cenarioOk) printf("   ^ FORA DO ORÇAMENTO\n");
+            ok = ok && cenarioOk;
+        }
+    }
+    printf("== %s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
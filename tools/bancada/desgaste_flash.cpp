@@ -0,0 +1,249 @@
+// Desgaste da flash pelo histórico de eventos, num mês simulado.
+//
+// Uso: desgaste_flash [--dias N] [--eventos-dia N] [--falhas N] [--semente S]
+//
+// event_logger + arquivo_historico + armazenamento do firmware sobre a flash
+// de flash_host.h, no relógio virtual, com o loop() a cada segundo
+// (eventosAgrupadosLoop, historicoLoop, armazenamentoLoop). Por dia,
+// --eventos-dia registros (padrão 400): 3/4 disparos de sensor em rajadas
+// (registrarEventoAgrupado) e 1/4 avulsos (registrarEvento). Os --falhas
+// primeiros rename (padrão 3) falham: a compactação tem de esperar e
+// tentar de novo sem duplicar linhas no arquivo compactado. Há resumos de
+// mais de 200 B e eventos cheios de aspas, que só cabem encurtados.
+//
+// Imprime os apagamentos contados pelo modelo, por origem, ao lado da
+// estimativa que o firmware expõe em /metrics, e a vida útil do bloco mais
+// apagado com ARMAZ_CICLOS_BLOCO ciclos. Saída 1 se o histórico lido de
+// volta tiver seq repetido ou faltando, ou se alguma compactação rodou
+// dentro de registrarEvento (isto é, dentro do tick).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bancada.h"
+#include "flash_host.h"
+#include "armazenamento.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "system_config.h"
+
+// metricas.cpp fica de fora: só os contadores que os módulos incrementam
+HistogramaLatencia histogramas[LAT_TOTAL];
+ContadoresSistema contadores;
+void HistogramaLatencia::registrar(uint32_t) {}
+
+// time() do firmware na hora virtual
+extern "C" time_t time(time_t *t)
+{
+    const time_t agora = hostEpochInicio + hostRelogioMs / 1000;
+    if (t) *t = agora;
+    return agora;
+}
+
+class SaidaTexto : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        texto += (char)c;
+        return 1;
+    }
+    using Print::write;
+    std::string texto;
+};
+
+static const char *SENSORES[][2] = {
+    {"Ambiente", "Reciclagem"},      {"Porta&Janela", "Triagem"},
+    {"Portão", "Pátio de Descarga"}, {"Galpão Norte", "Pátio de Descarga"},
+    {"Escritório", "Administração Central"}, {"Janela Fundos", "Administração Central"},
+    // nome longo: o resumo da rajada passa de 200 B por linha
+    {"Janela Basculante do Depósito de Resíduos", "Administração Central - Ala Norte"},
+};
+static const char *AVULSOS[] = {
+    "Sistema ARMADO (agenda automática)",
+    "Sistema DESARMADO (agenda automática)",
+    "WiFi reconectado (RSSI -71 dBm)",
+    "Usuário admin entrou pelo painel web",
+    "Sensor Portão isolado após 20 disparos em 5 min",
+};
+
+// aspas viram \" no JSON: com o texto cheio delas a linha não cabe e o
+// evento tem de ser encurtado (nunca a linha cortada)
+static const std::string ASPAS = "Config importada: " + std::string(EVENTO_MAX_CHARS, '"');
+
+static uint32_t ultimoGravado = 0;
+static void observar(uint32_t seq, time_t, const char *) { ultimoGravado = seq; }
+
+// Valor de uma série de /metrics (0 se não houver)
+static double metrica(const std::string &texto, const std::string &serie)
+{
+    size_t pos = 0;
+    while ((pos = texto.find(serie, pos)) != std::string::npos)
+    {
+        if (pos == 0 || texto[pos - 1] == '\n')
+        {
+            const size_t fim = pos + serie.size();
+            if (texto[fim] == ' ') return atof(texto.c_str() + fim + 1);
+        }
+        pos += serie.size();
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned dias = 30, eventosDia = 400, falhas = 3;
+    unsigned semente = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--dias")) dias = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--eventos-dia")) eventosDia = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--falhas")) falhas = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--semente")) semente = atoi(argv[i + 1]);
+        else
+        {
+            fprintf(stderr, "uso: %s [--dias N] [--eventos-dia N] [--falhas N] [--semente S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (dias > 45) dias = 45; // millis() do firmware dá a volta em 49 dias
+
+    flashHostFormatar();
+    hostEpochInicio = 1767571200; // 2026-01-05 00:00 UTC
+    hostRelogioMs = 0;
+    armazenamentoSetup();
+    historicoSetup();
+    adicionarObservadorEventos(observar);
+    flashHostFalharRename(falhas);
+
+    std::mt19937 rng(semente);
+    std::uniform_real_distribution<double> sorteio(0, 1);
+    // rajada média de 6.5 disparos: 3/4 dos registros em eventosDia*3/4/6.5 rajadas
+    const double pRajada = eventosDia * 0.75 / 6.5 / 86400.0;
+    const double pAvulso = eventosDia * 0.25 / 86400.0;
+
+    int rajadaSensor = -1;
+    unsigned rajadaRestante = 0;
+    uint32_t proximoDisparoMs = 0;
+    uint32_t pedidos = 0, compactacoesNoRegistro = 0;
+    uint64_t maxRegistroNs = 0, maxLoopNs = 0;
+
+    auto registrar = [&](auto &&chamada) {
+        const uint32_t antes = flashHostDesgaste().renames + flashHostDesgaste().renamesFalhos;
+        const uint64_t t0 = hostAgoraNs();
+        chamada();
+        maxRegistroNs = std::max(maxRegistroNs, hostAgoraNs() - t0);
+        const DesgasteFlashHost d = flashHostDesgaste();
+        if (d.renames + d.renamesFalhos != antes) compactacoesNoRegistro++;
+        pedidos++;
+    };
+
+    for (uint32_t s = 0; s < dias * 86400u; s++)
+    {
+        hostRelogioMs = s * 1000;
+
+        if (rajadaRestante == 0 && sorteio(rng) < pRajada)
+        {
+            rajadaSensor = rng() % (sizeof(SENSORES) / sizeof(SENSORES[0]));
+            rajadaRestante = 1 + rng() % 12;
+            proximoDisparoMs = hostRelogioMs;
+        }
+        if (rajadaRestante && hostRelogioMs >= proximoDisparoMs)
+        {
+            registrar([&] {
+                registrarEventoAgrupado(SENSORES[rajadaSensor][0], "Sensor %s disparou (zona %s)",
+                                        SENSORES[rajadaSensor][0], SENSORES[rajadaSensor][1]);
+            });
+            rajadaRestante--;
+            proximoDisparoMs = hostRelogioMs + 5000 + rng() % 15000;
+        }
+        if (sorteio(rng) < pAvulso)
+        {
+            const size_t i = rng() % (sizeof(AVULSOS) / sizeof(AVULSOS[0]) + 1);
+            const char *texto = i < sizeof(AVULSOS) / sizeof(AVULSOS[0]) ? AVULSOS[i] : ASPAS.c_str();
+            registrar([&] { registrarEvento(texto); });
+        }
+
+        const uint64_t t0 = hostAgoraNs();
+        eventosAgrupadosLoop();
+        historicoLoop();
+        armazenamentoLoop();
+        maxLoopNs = std::max(maxLoopNs, hostAgoraNs() - t0);
+    }
+    eventosAgrupadosFecharTodos();
+    armazenamentoDescarregarTudo();
+
+    // histórico completo lido de volta (arquivo compactado + vivo)
+    SaidaTexto historico;
+    historicoEscreverJson(historico, 0, true);
+    std::vector<uint32_t> seqs;
+    for (size_t pos = 0; (pos = historico.texto.find("{\"seq\":", pos)) != std::string::npos; pos += 7)
+        seqs.push_back(strtoul(historico.texto.c_str() + pos + 7, nullptr, 10));
+    unsigned repetidos = 0, faltando = 0;
+    for (size_t i = 1; i < seqs.size(); i++)
+    {
+        if (seqs[i] <= seqs[i - 1]) repetidos++;
+        else faltando += seqs[i] - seqs[i - 1] - 1;
+    }
+    if (seqs.empty() || seqs.back() < ultimoGravado) faltando += ultimoGravado - (seqs.empty() ? 0 : seqs.back());
+
+    SaidaTexto metricas;
+    armazenamentoEscreverPrometheus(metricas);
+    const DesgasteFlashHost d = flashHostDesgaste();
+
+    printf("== %u dias, %u registros pedidos, %u gravados (%u agrupados), %u arquivados\n", dias, pedidos,
+           ultimoGravado, contadores.eventosAgrupados, contadores.eventosArquivados);
+    printf("== histórico lido de volta: seq %u..%u, %zu linhas, %u repetidas, %u faltando\n",
+           seqs.empty() ? 0 : seqs.front(), seqs.empty() ? 0 : seqs.back(), seqs.size(), repetidos, faltando);
+    printf("== compactações: %u, %u falharam (rename); dentro do registro: %u\n", d.renames, d.renamesFalhos,
+           compactacoesNoRegistro);
+    printf("== maior registrarEvento: %.1f us; maior passada do loop: %.1f us (host)\n", maxRegistroNs / 1000.0,
+           maxLoopNs / 1000.0);
+
+    // agrupado como o firmware contabiliza: <arquivo>.tmp no arquivo, os
+    // segmentos no diretório do arquivo compactado
+    std::map<std::string, uint64_t> porArquivo;
+    for (const auto &o : d.porOrigem)
+    {
+        std::string caminho = o.first;
+        if (caminho.size() > 4 && caminho.compare(caminho.size() - 4, 4, ".tmp") == 0) caminho.resize(caminho.size() - 4);
+        if (caminho.compare(0, strlen(HISTORICO_ARQUIVO_DIR) + 1, HISTORICO_ARQUIVO_DIR "/") == 0) caminho = HISTORICO_ARQUIVO_DIR;
+        porArquivo[caminho] += o.second;
+    }
+
+    printf("\n%-20s %10s %12s\n", "origem", "modelo", "firmware");
+    for (const auto &o : porArquivo)
+    {
+        if (o.first.compare(0, 5, "meta:") == 0)
+        {
+            printf("%-20s %10llu %12s\n", o.first.c_str(), (unsigned long long)o.second, "-");
+            continue;
+        }
+        const double estimado =
+            metrica(metricas.texto, "alarme_flash_arquivo_apagamentos_estimados{arquivo=\"" + o.first + "\"}");
+        printf("%-20s %10llu %12.1f\n", o.first.c_str(), (unsigned long long)o.second, estimado);
+    }
+    const double estimadoTotal = metrica(metricas.texto, "alarme_flash_apagamentos_estimados_total");
+    printf("%-20s %10llu %12.1f\n", "total", (unsigned long long)d.apagamentos, estimadoTotal);
+
+    const double porDia = (double)d.apagamentos / dias;
+    const double piorPorDia = (double)d.maxBloco / dias;
+    printf("\n== %.1f apagamentos/dia em %zu blocos (%zu ocupados): média %.1f, pior bloco %u no período\n", porDia,
+           (size_t)FLASH_HOST_BLOCOS, d.blocosOcupados, d.mediaBloco, d.maxBloco);
+    printf("== vida útil com %lu ciclos/bloco: pior bloco %.0f anos, média %.0f anos\n",
+           (unsigned long)ARMAZ_CICLOS_BLOCO, piorPorDia > 0 ? ARMAZ_CICLOS_BLOCO / piorPorDia / 365 : 0.0,
+           porDia > 0 ? ARMAZ_CICLOS_BLOCO * (double)FLASH_HOST_BLOCOS / porDia / 365 : 0.0);
+
+    const bool ok = !repetidos && !faltando && !compactacoesNoRegistro && d.renamesFalhos == falhas;
+    printf("== %s\n", ok                       ? "OK"
+                      : repetidos || faltando  ? "FALHOU: histórico com seq repetido ou faltando"
+                      : compactacoesNoRegistro ? "FALHOU: compactação dentro de registrarEvento"
+                                               : "FALHOU: falhas de rename não exercitadas");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+#include "flash_host.h"
+
+#include <FS.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <vector>
+
+FS LittleFS;
+
+static const size_t PROG = 64;         // prog_size/cache_size do core
+static const size_t INLINE_MAX = 64;   // arquivo até isso fica nos metadados
+static const size_t COMMIT_BASE = 32;  // tags de struct/CRC de um commit
+static const size_t ENTRADA_BASE = 24; // por arquivo na compactação
+static const uint32_t CICLOS_METADADOS = 16;
+
+struct ArquivoHost
+{
+    std::vector<uint8_t> dados;
+    std::vector<int> blocos; // vazio = inline
+};
+
+struct DiretorioHost
+{
+    int par[2];
+    size_t usados = 0; // bytes de commits no bloco ativo
+    uint32_t compactacoes = 0;
+};
+
+static std::map<std::string, ArquivoHost> arquivos;
+static std::map<std::string, DiretorioHost> diretorios; // "" = raiz
+static std::vector<uint32_t> apagamentos;
+static std::vector<bool> ocupado;
+static size_t proximoLivre = 0;
+static unsigned renamesAFalhar = 0;
+static DesgasteFlashHost totais;
+
+// ================== Blocos ==================
+static void apagar(int bloco, const std::string &origem)
+{
+    apagamentos[bloco]++;
+    totais.apagamentos++;
+    totais.porOrigem[origem]++;
+}
+
+// Próximo bloco livre em rodízio, já apagado
+static int alocar(const std::string &origem)
+{
+    for (size_t i = 0; i < ocupado.size(); i++)
+    {
+        const size_t b = (proximoLivre + i) % ocupado.size();
+        if (ocupado[b]) continue;
+        ocupado[b] = true;
+        proximoLivre = b + 1;
+        apagar((int)b, origem);
+        return (int)b;
+    }
+    fprintf(stderr, "[FLASH] sem bloco livre (%s)\n", origem.c_str());
+    abort();
+}
+
+static void liberar(std::vector<int> &blocos, size_t aPartirDe = 0)
+{
+    for (size_t i = aPartirDe; i < blocos.size(); i++) ocupado[blocos[i]] = false;
+    blocos.resize(std::min(blocos.size(), aPartirDe));
+}
+
+static std::string diretorioDe(const std::string &caminho)
+{
+    const size_t barra = caminho.rfind('/');
+    return barra == std::string::npos || barra == 0 ? "" : caminho.substr(0, barra);
+}
+
+static std::string nomeDe(const std::string &caminho)
+{
+    const size_t barra = caminho.rfind('/');
+    return barra == std::string::npos ? caminho : caminho.substr(barra + 1);
+}
+
+// ================== Metadados ==================
+static size_t tamanhoCompactado(const std::string &dir)
+{
+    size_t total = COMMIT_BASE;
+    for (const auto &a : arquivos)
+    {
+        if (diretorioDe(a.first) != dir) continue;
+        total += ENTRADA_BASE + nomeDe(a.first).size() + (a.second.blocos.empty() ? a.second.dados.size() : 0);
+    }
+    for (const auto &d : diretorios)
+    {
+        if (!d.first.empty() && diretorioDe(d.first) == dir) total += ENTRADA_BASE + nomeDe(d.first).size();
+    }
+    return (total + PROG - 1) / PROG * PROG;
+}
+
+static void commit(const std::string &dir, size_t bytes)
+{
+    DiretorioHost &d = diretorios[dir];
+    const std::string origem = "meta:" + (dir.empty() ? std::string("/") : dir);
+    bytes = (COMMIT_BASE + bytes + PROG - 1) / PROG * PROG;
+
+    if (d.usados + bytes > FLASH_HOST_BLOCO)
+    {
+        // compactação no outro bloco do par
+        d.compactacoes++;
+        if (d.compactacoes % CICLOS_METADADOS == 0)
+        {
+            ocupado[d.par[1]] = false;
+            d.par[1] = alocar(origem);
+        }
+        else apagar(d.par[1], origem);
+        std::swap(d.par[0], d.par[1]);
+        d.usados = tamanhoCompactado(dir);
+    }
+    d.usados += bytes;
+}
+
+// ================== Sessões ==================
+struct SessaoArquivoHost
+{
+    std::string caminho;
+    bool escrita = false;
+    bool criado = false;
+    bool alterado = false;
+    size_t pos = 0;
+    size_t inicioEscrita = SIZE_MAX; // menor offset gravado nesta sessão
+
+    ~SessaoArquivoHost() { fechar(); }
+
+    ArquivoHost *arquivo()
+    {
+        auto it = arquivos.find(caminho);
+        return it == arquivos.end() ? nullptr : &it->second;
+    }
+
+    // O que o littlefs faz no sync: blocos novos a partir do primeiro tocado
+    void fechar()
+    {
+        ArquivoHost *a = arquivo();
+        if (!alterado || !a)
+        {
+            alterado = false;
+            return;
+        }
+        alterado = false;
+
+        size_t bytesCommit = criado ? nomeDe(caminho).size() + 8 : 0;
+        const size_t tamanho = a->dados.size();
+        if (tamanho <= INLINE_MAX)
+        {
+            liberar(a->blocos);
+            bytesCommit += tamanho;
+        }
+        else if (inicioEscrita != SIZE_MAX)
+        {
+            const size_t primeiro = std::min(inicioEscrita / FLASH_HOST_BLOCO, a->blocos.size());
+            const size_t ultimo = (tamanho - 1) / FLASH_HOST_BLOCO;
+            liberar(a->blocos, primeiro);
+            for (size_t i = primeiro; i <= ultimo; i++) a->blocos.push_back(alocar(caminho));
+        }
+        else liberar(a->blocos, (tamanho + FLASH_HOST_BLOCO - 1) / FLASH_HOST_BLOCO); // só truncate
+        commit(diretorioDe(caminho), bytesCommit);
+        criado = false;
+        inicioEscrita = SIZE_MAX;
+    }
+};
+
+size_t File::write(const uint8_t *dados, size_t n)
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    if (!a || !sessao->escrita) return 0;
+    if (a->dados.size() < sessao->pos + n) a->dados.resize(sessao->pos + n);
+    memcpy(a->dados.data() + sessao->pos, dados, n);
+    sessao->inicioEscrita = std::min(sessao->inicioEscrita, sessao->pos);
+    sessao->pos += n;
+    sessao->alterado = true;
+    return n;
+}
+
+int File::available()
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    return a && sessao->pos < a->dados.size() ? (int)(a->dados.size() - sessao->pos) : 0;
+}
+
+int File::read()
+{
+    const int c = peek();
+    if (c >= 0) sessao->pos++;
+    return c;
+}
+
+int File::peek()
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    return a && sessao->pos < a->dados.size() ? a->dados[sessao->pos] : -1;
+}
+
+size_t File::read(uint8_t *dados, size_t n)
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    if (!a || sessao->pos >= a->dados.size()) return 0;
+    n = std::min(n, a->dados.size() - sessao->pos);
+    memcpy(dados, a->dados.data() + sessao->pos, n);
+    sessao->pos += n;
+    return n;
+}
+
+bool File::seek(uint32_t pos, SeekMode modo)
+{
+    if (!sessao) return false;
+    const size_t base = modo == SeekSet ? 0 : modo == SeekCur ? sessao->pos : size();
+    sessao->pos = base + pos;
+    return sessao->pos <= size();
+}
+
+size_t File::position() const { return sessao ? sessao->pos : 0; }
+
+size_t File::size() const
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    return a ? a->dados.size() : 0;
+}
+
+bool File::truncate(uint32_t tamanho)
+{
+    ArquivoHost *a = sessao ? sessao->arquivo() : nullptr;
+    if (!a || !sessao->escrita || tamanho > a->dados.size()) return false;
+    a->dados.resize(tamanho);
+    sessao->alterado = true;
+    return true;
+}
+
+void File::close()
+{
+    if (sessao) sessao->fechar();
+    sessao.reset();
+}
+
+const char *File::name() const { return sessao ? sessao->caminho.c_str() : ""; }
+
+// ================== FS ==================
+File FS::open(const char *caminho, const char *modo)
+{
+    auto sessao = std::make_shared<SessaoArquivoHost>();
+    sessao->caminho = caminho;
+    ArquivoHost *a = sessao->arquivo();
+    const char m = modo[0];
+    sessao->escrita = m != 'r' || modo[1] == '+';
+
+    if (m == 'r')
+    {
+        if (!a) return File();
+        return File(sessao);
+    }
+    if (!diretorios.count(diretorioDe(caminho))) return File();
+    if (!a)
+    {
+        a = &arquivos[caminho];
+        sessao->criado = true;
+        sessao->alterado = true;
+    }
+    if (m == 'w')
+    {
+        a->dados.clear();
+        liberar(a->blocos);
+        sessao->alterado = true;
+    }
+    if (m == 'a') sessao->pos = a->dados.size();
+    return File(sessao);
+}
+
+bool FS::exists(const char *caminho) { return arquivos.count(caminho) || diretorios.count(caminho); }
+
+bool FS::remove(const char *caminho)
+{
+    auto it = arquivos.find(caminho);
+    if (it == arquivos.end()) return false;
+    liberar(it->second.blocos);
+    arquivos.erase(it);
+    commit(diretorioDe(caminho), 0);
+    return true;
+}
+
+bool FS::rename(const char *de, const char *para)
+{
+    auto it = arquivos.find(de);
+    if (it == arquivos.end()) return false;
+    if (renamesAFalhar)
+    {
+        renamesAFalhar--;
+        totais.renamesFalhos++;
+        return false;
+    }
+    totais.renames++;
+    auto destino = arquivos.find(para);
+    if (destino != arquivos.end())
+    {
+        liberar(destino->second.blocos);
+        arquivos.erase(destino);
+    }
+    ArquivoHost a = std::move(it->second);
+    arquivos.erase(it);
+    arquivos[para] = std::move(a);
+    commit(diretorioDe(para), nomeDe(para).size());
+    return true;
+}
+
+bool FS::mkdir(const char *caminho)
+{
+    if (diretorios.count(caminho)) return true;
+    DiretorioHost d;
+    d.par[0] = alocar(std::string("meta:") + caminho);
+    d.par[1] = alocar(std::string("meta:") + caminho);
+    diretorios[caminho] = d;
+    commit(diretorioDe(caminho), nomeDe(caminho).size());
+    return true;
+}
+
+bool FS::info(FSInfo &info)
+{
+    info = {};
+    info.blockSize = FLASH_HOST_BLOCO;
+    info.pageSize = FLASH_HOST_PAGINA;
+    info.totalBytes = ocupado.size() * FLASH_HOST_BLOCO;
+    info.usedBytes = std::count(ocupado.begin(), ocupado.end(), true) * FLASH_HOST_BLOCO;
+    info.maxOpenFiles = 5;
+    info.maxPathLength = 32;
+    return true;
+}
+
+bool Dir::next()
+{
+    const std::string prefixo = caminho + "/";
+    auto it = nome.empty() ? arquivos.lower_bound(prefixo) : arquivos.upper_bound(prefixo + nome);
+    for (; it != arquivos.end() && it->first.compare(0, prefixo.size(), prefixo) == 0; ++it)
+    {
+        if (diretorioDe(it->first) != caminho) continue;
+        nome = nomeDe(it->first);
+        tamanho = it->second.dados.size();
+        return true;
+    }
+    return false;
+}
+
+// ================== Controle ==================
+void flashHostFormatar(size_t blocos)
+{
+    arquivos.clear();
+    diretorios.clear();
+    apagamentos.assign(blocos, 0);
+    ocupado.assign(blocos, false);
+    proximoLivre = 0;
+    renamesAFalhar = 0;
+    totais = DesgasteFlashHost();
+
+    // superbloco + raiz nos blocos 0 e 1
+    DiretorioHost raiz;
+    raiz.par[0] = alocar("meta:/");
+    raiz.par[1] = alocar("meta:/");
+    diretorios[""] = raiz;
+}
+
+DesgasteFlashHost flashHostDesgaste()
+{
+    DesgasteFlashHost d = totais;
+    for (uint32_t a : apagamentos) d.maxBloco = std::max(d.maxBloco, a);
+    d.mediaBloco = apagamentos.empty() ? 0 : (double)d.apagamentos / apagamentos.size();
+    d.blocosOcupados = std::count(ocupado.begin(), ocupado.end(), true);
+    return d;
+}
+
+void flashHostFalharRename(unsigned n) { renamesAFalhar = n; }
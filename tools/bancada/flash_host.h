@@ -0,0 +1,47 @@
+#ifndef FLASH_HOST_H
+#define FLASH_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+// Flash do LittleFS no host (implementação de arduino/FS.h). Modela onde o
+// littlefs v2 do core apaga blocos, com a geometria da placa (blocos de
+// 8 KB, prog de 64 B, block_cycles 16):
+//  - dados: cada sessão de escrita (open .. close) copia o bloco final
+//    incompleto para um bloco novo e aloca outro a cada bloco cheio, então
+//    custa um apagamento por bloco tocado, mesmo que só anexe 1 byte;
+//    arquivos de até 64 B ficam inline nos metadados;
+//  - metadados: cada close/remove/rename é um commit (múltiplo de 64 B)
+//    no par de blocos do diretório; bloco cheio = compactação (apaga o
+//    outro do par) e a cada 16 compactações o par muda de bloco;
+//  - alocação em rodízio pelos blocos livres (o wear leveling dinâmico do
+//    littlefs); blocos ocupados por arquivos que não mudam ficam parados.
+// Aproximações: tamanho dos commits fixo por operação, sem cache de
+// leitura/escrita e sem os blocos da cadeia CTZ.
+
+static const size_t FLASH_HOST_BLOCO = 8192;
+static const size_t FLASH_HOST_PAGINA = 256;
+static const size_t FLASH_HOST_BLOCOS = 125; // eagle.flash.4m1m.ld (1000 KB)
+
+// Apaga tudo e zera os contadores
+void flashHostFormatar(size_t blocos = FLASH_HOST_BLOCOS);
+
+struct DesgasteFlashHost
+{
+    uint64_t apagamentos = 0; // total
+    uint32_t maxBloco = 0;    // bloco mais apagado
+    double mediaBloco = 0;
+    size_t blocosOcupados = 0;
+    uint32_t renames = 0;
+    uint32_t renamesFalhos = 0;
+    // por arquivo (dados) e "meta:<dir>" (pares de metadados)
+    std::map<std::string, uint64_t> porOrigem;
+};
+DesgasteFlashHost flashHostDesgaste();
+
+// Os próximos n rename() falham (flash cheia no meio de uma regravação)
+void flashHostFalharRename(unsigned n);
+
+#endif
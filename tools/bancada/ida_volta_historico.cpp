@@ -0,0 +1,254 @@
+// Ida e volta do arquivo compactado do histórico (arquivo_historico.cpp +
+// lz_historico.cpp) sobre a flash de flash_host.h.
+//
+// Uso: ida_volta_historico [--eventos N] [--semente S]
+//
+// Gera N eventos (padrão 20000) no formato de gravarEvento, com as mensagens
+// do firmware: alertas de zona, resumos de agrupamento (repeticoes,
+// primeiro, ultimo), armar/desarmar, login, P2P, bypass. Arquiva em blocos
+// de HISTORICO_MAX_REGISTROS, como compactarHistorico, e lê tudo de volta.
+// Depois corta o fim do segmento mais novo (queda de energia no meio de um
+// anexo), roda arquivoHistoricoSetup e lê de novo.
+//
+// Imprime a razão JSON/compactado e quantos eventos cabem no orçamento
+// (HISTORICO_ARQUIVO_MAX_BYTES). Saída 1 se alguma linha lida não for
+// idêntica à gravada, se faltar linha depois do último segmento apagado,
+// se o corte deixar lixo ou se a razão ficar abaixo de RAZAO_MINIMA.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <LittleFS.h>
+
+#include "bancada.h"
+#include "flash_host.h"
+#include "armazenamento.h"
+#include "arquivo_historico.h"
+#include "event_logger.h"
+#include "metricas.h"
+#include "system_config.h"
+
+// metricas.cpp e armazenamento.cpp ficam de fora (o armazenamento precisa
+// do ArduinoJson; modelo/armazenamento.h declara só o que é usado aqui)
+ContadoresSistema contadores;
+void armazenamentoContabilizar(const char *, uint32_t, size_t) {}
+
+static const double RAZAO_MINIMA = 10.0;
+
+class SaidaLinhas : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        if (c == '\n')
+        {
+            linhas.push_back(atual);
+            atual.clear();
+        }
+        else atual += (char)c;
+        return 1;
+    }
+    using Print::write;
+    std::vector<std::string> linhas;
+
+private:
+    std::string atual;
+};
+
+// ================== Gerador ==================
+static const char *ZONAS[][2] = {
+    {"Reciclagem", "Ambiente"},          {"Triagem", "Ambiente"},
+    {"Triagem", "Porta&Janela"},         {"Pátio de Descarga", "Portão"},
+    {"Pátio de Descarga", "Galpão Norte"}, {"Administração Central", "Escritório"},
+    {"Administração Central", "Janela Fundos"},
+};
+static const size_t TOTAL_ZONAS = sizeof(ZONAS) / sizeof(ZONAS[0]);
+
+struct Gerador
+{
+    std::mt19937 rng;
+    uint32_t seq = 0;
+    long long agora = 1767571200; // 2026-01-05 00:00 UTC
+
+    // rajada aberta (registrarEventoAgrupado): o resumo sai EVENTOS_JANELA_AGRUPAR_MS
+    // depois da última repetição
+    const char *const *rajada = nullptr;
+    long long rajadaInicio = 0, rajadaFim = 0;
+    unsigned repeticoes = 0;
+
+    explicit Gerador(unsigned semente) : rng(semente) {}
+
+    unsigned sortear(unsigned n) { return rng() % n; }
+
+    std::string linha(const char *evento, bool resumo)
+    {
+        char texto[HISTORICO_LINHA_MAX];
+        int n = snprintf(texto, sizeof(texto), "{\"seq\":%u,\"timestamp\":%lld,\"evento\":\"%s\"", ++seq, agora, evento);
+        if (resumo)
+            n += snprintf(texto + n, sizeof(texto) - n, ",\"repeticoes\":%u,\"primeiro\":%lld,\"ultimo\":%lld",
+                          repeticoes, rajadaInicio, rajadaFim);
+        snprintf(texto + n, sizeof(texto) - n, "}");
+        return texto;
+    }
+
+    std::string proxima()
+    {
+        char evento[EVENTO_MAX_CHARS];
+        const long long proximo = agora + 1 + sortear(sortear(4) ? 300 : 3600);
+        const long long fimRajada = rajadaFim + EVENTOS_JANELA_AGRUPAR_MS / 1000;
+        if (rajada && fimRajada <= proximo)
+        {
+            agora = fimRajada;
+            snprintf(evento, sizeof(evento), "[ALERTA] Zona %s violada (%s). (+%u repetições)", rajada[0], rajada[1],
+                     repeticoes);
+            rajada = nullptr;
+            return linha(evento, true);
+        }
+        agora = proximo;
+
+        const char *const *z = ZONAS[sortear(TOTAL_ZONAS)];
+        const unsigned tipo = sortear(100);
+        if (tipo < 55)
+        {
+            snprintf(evento, sizeof(evento), "[ALERTA] Zona %s violada (%s).", z[0], z[1]);
+            if (!rajada && sortear(2))
+            {
+                // PIR oscilando: repetições nos próximos minutos, só contadas
+                rajada = z;
+                repeticoes = 1 + sortear(40);
+                rajadaInicio = agora + 1 + sortear(20);
+                rajadaFim = rajadaInicio + sortear(EVENTOS_AGRUPAR_MAX_MS / 1000);
+            }
+        }
+        else if (tipo < 65) snprintf(evento, sizeof(evento), "[INFO] Alarme %s automaticamente (por horário)",
+                                     sortear(2) ? "armado" : "desarmado");
+        else if (tipo < 75) snprintf(evento, sizeof(evento), "Alarme %s por: %s", sortear(2) ? "armado" : "desarmado",
+                                     sortear(3) ? "admin" : "P2P");
+        else if (tipo < 81) snprintf(evento, sizeof(evento), "Tentativa de login admin falhou");
+        else if (tipo < 84)
+            snprintf(evento, sizeof(evento), "[SEGURANCA] IP 192.168.0.%u bloqueado por 5 min após 3 senhas erradas",
+                     2 + sortear(250));
+        else if (tipo < 89) snprintf(evento, sizeof(evento), "[MODO] Modo alterado para %s por %s",
+                                     sortear(2) ? "AUTOMATICO" : "MANUAL", sortear(2) ? "admin" : "web");
+        else if (tipo < 95) snprintf(evento, sizeof(evento), "[P2P] Zona %s violada na placa alarme-%06x: sirene acionada",
+                                     z[0], 0x3a41c0 + sortear(3));
+        else snprintf(evento, sizeof(evento), "[AJUSTE] Zona %s em bypass por %u s", z[0], 60 * (1 + sortear(60)));
+        return linha(evento, false);
+    }
+};
+
+// Tamanho de cada segmento (caminho -> bytes)
+static std::map<std::string, size_t> segmentos()
+{
+    std::map<std::string, size_t> tamanhos;
+    Dir dir = LittleFS.openDir(HISTORICO_ARQUIVO_DIR);
+    while (dir.next()) tamanhos[dir.fileName().c_str()] = dir.fileSize();
+    return tamanhos;
+}
+
+// Linhas lidas de volta x geradas: idênticas, em ordem, sem buraco até a última
+static bool conferir(const std::vector<std::string> &lidas, const std::vector<std::string> &geradas, uint32_t ultimo,
+                     uint32_t &primeiroLido)
+{
+    primeiroLido = lidas.empty() ? 0 : strtoul(lidas.front().c_str() + 7, nullptr, 10);
+    if (lidas.empty() || primeiroLido == 0 || primeiroLido + lidas.size() - 1 != ultimo) return false;
+    for (size_t i = 0; i < lidas.size(); i++)
+    {
+        if (lidas[i] != geradas[primeiroLido - 1 + i])
+        {
+            fprintf(stderr, "diferente no seq %zu:\n  gravada %s\n  lida    %s\n", primeiroLido + i,
+                    geradas[primeiroLido - 1 + i].c_str(), lidas[i].c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned eventos = 20000, semente = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--eventos")) eventos = std::max(2 * HISTORICO_MAX_REGISTROS, atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "--semente")) semente = atoi(argv[i + 1]);
+        else
+        {
+            fprintf(stderr, "uso: %s [--eventos N] [--semente S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    flashHostFormatar();
+    arquivoHistoricoSetup();
+
+    Gerador gerador(semente);
+    std::vector<std::string> geradas;
+    uint64_t bytesJson = 0, bytesCompactados = 0, maiorBlocoNs = 0;
+    for (unsigned i = 0; i < eventos; i += HISTORICO_MAX_REGISTROS)
+    {
+        const std::map<std::string, size_t> antes = segmentos();
+        const uint64_t t0 = hostAgoraNs();
+        {
+            ArquivamentoHistorico arquivo;
+            for (unsigned j = 0; j < HISTORICO_MAX_REGISTROS && i + j < eventos; j++)
+            {
+                geradas.push_back(gerador.proxima());
+                arquivo.adicionar(geradas.back().c_str(), geradas.back().size());
+                bytesJson += geradas.back().size() + 1;
+            }
+        }
+        maiorBlocoNs = std::max(maiorBlocoNs, hostAgoraNs() - t0);
+        // o orçamento só apaga segmentos antigos: o que cresceu foi gravado agora
+        for (const auto &s : segmentos())
+        {
+            const auto anterior = antes.find(s.first);
+            bytesCompactados += s.second - (anterior == antes.end() ? 0 : anterior->second);
+        }
+    }
+
+    SaidaLinhas lidas;
+    arquivoHistoricoLer(lidas, 0);
+    uint32_t primeiro = 0;
+    const bool idaVolta = conferir(lidas.linhas, geradas, gerador.seq, primeiro);
+
+    size_t ocupados = 0;
+    const std::map<std::string, size_t> finais = segmentos();
+    for (const auto &s : finais) ocupados += s.second;
+    const double razao = (double)bytesJson / bytesCompactados;
+    const double mediaJson = (double)bytesJson / eventos;
+
+    printf("== %u eventos, %.1f B por linha JSON, %llu B JSON -> %llu B compactados: %.2fx\n", eventos, mediaJson,
+           (unsigned long long)bytesJson, (unsigned long long)bytesCompactados, razao);
+    printf("== no orçamento (%u B): %zu segmentos, %zu B, eventos %u..%u (%zu); só JSON caberiam %.0f\n",
+           (unsigned)HISTORICO_ARQUIVO_MAX_BYTES, finais.size(), ocupados, primeiro, gerador.seq, lidas.linhas.size(),
+           HISTORICO_ARQUIVO_MAX_BYTES / mediaJson);
+    printf("== ida e volta: %s; maior bloco de %u eventos: %.1f us (host)\n", idaVolta ? "idêntico" : "DIFERENTE",
+           (unsigned)HISTORICO_MAX_REGISTROS, maiorBlocoNs / 1000.0);
+
+    // queda de energia no meio do último anexo: o bloco inteiro sai
+    const std::string &ultimoSegmento = std::string(HISTORICO_ARQUIVO_DIR) + "/" + finais.rbegin()->first;
+    File f = LittleFS.open(ultimoSegmento.c_str(), "r+");
+    const bool cortou = f && f.truncate(f.size() - 7);
+    f.close();
+    arquivoHistoricoSetup();
+    SaidaLinhas depois;
+    arquivoHistoricoLer(depois, 0);
+    uint32_t primeiroDepois = 0;
+    const uint32_t ultimoDepois = arquivoHistoricoUltimoSeq();
+    const bool corteOk = cortou && ultimoDepois == gerador.seq - HISTORICO_MAX_REGISTROS &&
+                         conferir(depois.linhas, geradas, ultimoDepois, primeiroDepois) && primeiroDepois == primeiro;
+    printf("== anexo interrompido: arquivo volta até o seq %u, %s\n", ultimoDepois, corteOk ? "sem lixo" : "ERRADO");
+
+    const bool ok = idaVolta && corteOk && razao >= RAZAO_MINIMA;
+    printf("== %s\n", ok            ? "OK"
+                      : !idaVolta   ? "FALHOU: linhas lidas diferentes das gravadas"
+                      : !corteOk    ? "FALHOU: corte do bloco interrompido"
+                                    : "FALHOU: razão abaixo da mínima");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#ifndef ARMAZENAMENTO_H
+#define ARMAZENAMENTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Só o que alarme.cpp e arquivo_historico.cpp usam da camada de
+// armazenamento (a verdadeira inclui o ArduinoJson)
+void armazenamentoDescarregarTudo();
+void armazenamentoContabilizar(const char *caminho, uint32_t offset, size_t tamanho);
+
+#endif
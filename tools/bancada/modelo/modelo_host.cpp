@@ -0,0 +1,58 @@
+#include "modelo_host.h"
+
+#include <Arduino.h>
+#include "alarme.h"
+#include "event_logger.h"
+#include "resumo_historico.h"
+#include "rastro_gpio.h"
+#include "web_server.h"
+#include "armazenamento.h"
+
+uint32_t hostEventos = 0;
+uint32_t hostAlertas = 0;
+
+// Globais que o firmware define em main.cpp / web_server.cpp
+std::vector<String> todasZonas;
+int ARM_HOUR_WEEKDAY = 18;
+int DISARM_HOUR_WEEKDAY = 6;
+int ARM_HOUR_WEEKEND = 0;
+int DISARM_HOUR_WEEKEND = 0;
+
+static void formatar(const char *formato, va_list args)
+{
+    char buf[EVENTO_MAX_CHARS];
+    vsnprintf(buf, sizeof(buf), formato, args);
+    hostEventos++;
+}
+
+void registrarEvento(const char *) { hostEventos++; }
+
+void registrarEventoF(const char *formato, ...)
+{
+    va_list args;
+    va_start(args, formato);
+    formatar(formato, args);
+    va_end(args);
+}
+
+void registrarEventoAgrupado(const char *, const char *formato, ...)
+{
+    va_list args;
+    va_start(args, formato);
+    formatar(formato, args);
+    va_end(args);
+}
+
+void eventosAgrupadosFecharTodos() {}
+void resumoAlerta(const Sensor &) {}
+void resumoArmado() {}
+void resumoDesarmado() {}
+void resumoGravar() {}
+void salvarUltimoDiaReinicio(int) {}
+void armazenamentoDescarregarTudo() {}
+
+void rastroModeloDescartado() {}
+void rastroArmado() {}
+void rastroDesarmado() {}
+void rastroTesteCaminhada(bool) {}
+void rastroAlerta(const Sensor &) { hostAlertas++; }
@@ -0,0 +1,12 @@
+#ifndef MODELO_HOST_H
+#define MODELO_HOST_H
+
+#include <stdint.h>
+
+// Serviços que Sensor/Zona/Alarme/Sirene chamam, no lugar do resto do
+// firmware (histórico, resumo, rastro...). As mensagens são formatadas como
+// em event_logger.cpp (buffer fixo de EVENTO_MAX_CHARS na pilha) e contadas.
+extern uint32_t hostEventos;
+extern uint32_t hostAlertas; // alertas que o Alarme emitiu (rastroAlerta)
+
+#endif
@@ -0,0 +1,7 @@
+// Relatório do teste de caminhada fora do modelo: o Alarme só avisa.
+// relatorio_caminhada compila o teste_caminhada.cpp do firmware no lugar.
+#include "teste_caminhada.h"
+
+void testeCaminhadaDetectado(const Zona &, const Sensor &) {}
+void testeCaminhadaFim() {}
+void testeCaminhadaDescartar() {}
@@ -0,0 +1,7 @@
+#ifndef WEB_SERVER_H
+#define WEB_SERVER_H
+
+// Só o que alarme.cpp usa do servidor web
+void salvarUltimoDiaReinicio(int dia);
+
+#endif
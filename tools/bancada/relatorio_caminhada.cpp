@@ -0,0 +1,280 @@
+// Teste de caminhada (Alarme::iniciarTesteCaminhada/encerrarTesteCaminhada e
+// o relatório de lib/diagnostico/teste_caminhada.cpp) no relógio virtual.
+//
+// Uso: relatorio_caminhada
+//
+// Três zonas, cinco sensores (Frente: Porta REED D1, Sala PIR D2; Fundos:
+// Cozinha PIR D5, Lavanderia REED D6; Garagem: Portão REED D7), tick de
+// 100 ms. Dois casos:
+//   armado     armado só na Frente; a Sala dispara duas vezes e a Cozinha
+//              (zona desarmada) uma, com borda de interrupção 700 us antes do
+//              tick; o teste acaba pela duração (testeCaminhadaLoop)
+//   desarmado  desarmado com Fundos escolhida; Portão e Porta disparam e o
+//              teste é parado antes da duração
+// Confere o estado e as zonas ativas depois do teste, as zonas armadas, os
+// disparos, "nunca_disparados" e a fonte do tempo no relatório, e que nenhum
+// alerta saiu nem a sirene tocou. Depois do teste o alarme volta a alertar
+// como antes. Saída 1 se algo diferir.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "bancada.h"
+#include "modelo_host.h"
+#include "alarme.h"
+#include "arena_nomes.h"
+#include "energia.h"
+#include "entradas.h"
+#include "pool_modelo.h"
+#include "system_config.h"
+#include "teste_caminhada.h"
+
+extern std::vector<String> todasZonas;
+
+static const uint32_t TICK_MS = 100;
+static const uint32_t PIPELINE_US = 700;
+
+static Alarme alarme;
+static Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
+static uint32_t repouso = 0;
+static unsigned falhas = 0;
+
+// Borda de interrupção vista pelo teste (no firmware, energia.cpp)
+static int bordaPino = -1;
+static uint32_t bordaUs = 0;
+
+bool energiaBordaPendente(int pino, uint32_t &us)
+{
+    const bool pendente = pino == bordaPino;
+    us = pendente ? bordaUs : 0;
+    return pendente;
+}
+
+class SaidaTexto : public Print
+{
+public:
+    String texto;
+    size_t write(uint8_t c) override
+    {
+        texto += (char)c;
+        return 1;
+    }
+};
+
+static void verificar(bool condicao, const char *oque)
+{
+    printf("  %-58s %s\n", oque, condicao ? "ok" : "FALHOU");
+    if (!condicao) falhas++;
+}
+
+static void configurar()
+{
+    alarme.limparZonas();
+    poolModelo.resetar();
+    todasZonas.clear();
+    arenaNomes.limpar();
+
+    struct
+    {
+        const char *nome, *zona;
+        Sensor::Tipo tipo;
+        int pino;
+    } const SENSORES[] = {
+        {"Porta", "Frente", Sensor::Tipo::REED, D1},   {"Sala", "Frente", Sensor::Tipo::PIR, D2},
+        {"Cozinha", "Fundos", Sensor::Tipo::PIR, D5},  {"Lavanderia", "Fundos", Sensor::Tipo::REED, D6},
+        {"Portão", "Garagem", Sensor::Tipo::REED, D7},
+    };
+    std::vector<DefinicaoSensor> defs;
+    repouso = 0;
+    for (const auto &s : SENSORES)
+    {
+        defs.push_back({arenaNomes.internar(s.nome), arenaNomes.internar(s.zona), s.tipo, s.pino, true});
+        repouso |= entradasBit(s.pino); // PIR e REED disparam em nível baixo
+    }
+    const Faixa<Zona> zonas = poolModelo.montar(defs);
+    for (const Zona &zona : zonas) todasZonas.push_back(zona.getNome());
+
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(zonas);
+    hostDefinirLeitura(repouso);
+}
+
+static void ticks(unsigned n)
+{
+    while (n--)
+    {
+        hostRelogioMs += TICK_MS;
+        alarme.atualizar(entradasLer());
+    }
+}
+
+// Aciona o pino por 3 ticks e volta ao repouso por 2; devolve o ms do tick
+// que viu o acionamento
+static uint32_t pulso(int pino, bool comBorda)
+{
+    hostDefinirLeitura(repouso ^ entradasBit(pino));
+    if (comBorda)
+    {
+        bordaPino = pino;
+        bordaUs = (hostRelogioMs + TICK_MS) * 1000 - PIPELINE_US;
+    }
+    ticks(1);
+    bordaPino = -1;
+    const uint32_t visto = hostRelogioMs;
+    ticks(2);
+    hostDefinirLeitura(repouso);
+    ticks(2);
+    return visto;
+}
+
+static bool zonasArmadas(const char *esperadas)
+{
+    String armadas;
+    for (const Zona &zona : alarme.getZonas())
+    {
+        if (!zona.estaArmada()) continue;
+        if (!armadas.empty()) armadas += ",";
+        armadas += zona.getNome();
+    }
+    printf("    zonas armadas: [%s]\n", armadas.c_str());
+    return armadas == esperadas;
+}
+
+static bool zonasAtivas(const char *esperadas)
+{
+    String ativas;
+    for (const String &zona : alarme.getZonasAtivas())
+    {
+        if (!ativas.empty()) ativas += ",";
+        ativas += zona;
+    }
+    return ativas == esperadas;
+}
+
+static String relatorio()
+{
+    SaidaTexto saida;
+    testeCaminhadaEscreverJson(saida);
+    return saida.texto;
+}
+
+static bool contem(const String &texto, const char *trecho)
+{
+    if (texto.find(trecho) != String::npos) return true;
+    printf("    falta no relatório: %s\n", trecho);
+    return false;
+}
+
+// "sensor":"<nome>" ... "disparos":N,"primeiro_ms":<ms>.000 + fonte
+static bool resultado(const String &json, const char *sensor, unsigned disparos, uint32_t primeiroMs, bool porBorda)
+{
+    char trecho[192];
+    const size_t inicio = json.find(String("\"sensor\":\"") + sensor + "\"");
+    const String registro = inicio == String::npos ? String() : json.substr(inicio, json.find('}', inicio) - inicio + 1);
+    if (porBorda)
+        snprintf(trecho, sizeof(trecho), "\"disparos\":%u,\"primeiro_ms\":%lu.%03u,\"pipeline_us\":%u,\"fonte\":\"borda\"}",
+                 disparos, (unsigned long)(primeiroMs - 1), 1000 - PIPELINE_US, PIPELINE_US);
+    else
+        snprintf(trecho, sizeof(trecho), "\"disparos\":%u,\"primeiro_ms\":%lu.000,\"pipeline_us\":null,\"fonte\":\"tick\"}",
+                 disparos, (unsigned long)primeiroMs);
+    printf("    %s: %s\n", sensor, registro.c_str());
+    return registro.find(trecho) != String::npos;
+}
+
+static void casoArmado()
+{
+    printf("armado (Frente)\n");
+    configurar();
+    alarme.armar({"Frente"});
+    ticks(5);
+
+    const uint32_t alertasAntes = hostAlertas;
+    const uint32_t inicioMs = hostRelogioMs;
+    testeCaminhadaIniciar(alarme, 60);
+    verificar(alarme.emTesteCaminhada(), "em teste");
+    verificar(zonasArmadas("Frente,Fundos,Garagem"), "todas as zonas vigiando durante o teste");
+
+    ticks(10);
+    const uint32_t sala = pulso(D2, false);
+    ticks(10);
+    pulso(D2, false);
+    ticks(10);
+    const uint32_t cozinha = pulso(D5, true);
+    verificar(hostAlertas == alertasAntes && !sirene.estaAtiva(), "nenhum alerta nem sirene durante o teste");
+
+    hostRelogioMs = inicioMs + 60000;
+    testeCaminhadaLoop(alarme);
+    verificar(!alarme.emTesteCaminhada(), "encerrado pela duração");
+    verificar(alarme.getEstado() == Alarme::Estado::ARMADO, "estado de volta: ARMADO");
+    verificar(zonasAtivas("Frente"), "zonas ativas de volta: [Frente]");
+    verificar(zonasArmadas("Frente"), "só a Frente armada");
+
+    const String json = relatorio();
+    verificar(contem(json, "\"ativo\":false") && contem(json, "\"sensores\":5,\"disparados\":2"), "2 de 5 dispararam");
+    verificar(resultado(json, "Sala", 2, sala - inicioMs, false), "Sala: 2 disparos, tempo do tick");
+    verificar(resultado(json, "Cozinha", 1, cozinha - inicioMs, true), "Cozinha: 1 disparo, tempo da borda");
+    verificar(contem(json, "\"nunca_disparados\":[\"Frente/Porta\",\"Fundos/Lavanderia\",\"Garagem/Portão\"]"),
+              "nunca_disparados: Porta, Lavanderia, Portão");
+    verificar(hostAlertas == alertasAntes && !sirene.estaAtiva(), "nenhum alerta nem sirene no teste");
+
+    // de volta ao normal: a Cozinha (Fundos desarmada) não alerta, a Sala sim
+    pulso(D5, false);
+    verificar(hostAlertas == alertasAntes, "depois: Fundos desarmada não alerta");
+    pulso(D2, false);
+    verificar(hostAlertas == alertasAntes + 1 && sirene.estaAtiva(), "depois: Frente alerta e toca a sirene");
+    alarme.desarmar();
+}
+
+static void casoDesarmado()
+{
+    printf("desarmado (Fundos escolhida)\n");
+    configurar();
+    alarme.armar({"Fundos"});
+    alarme.desarmar();
+    ticks(5);
+
+    const uint32_t alertasAntes = hostAlertas;
+    const uint32_t inicioMs = hostRelogioMs;
+    testeCaminhadaIniciar(alarme, 60);
+    verificar(alarme.getEstado() == Alarme::Estado::ARMADO && zonasArmadas("Frente,Fundos,Garagem"),
+              "todas as zonas vigiando durante o teste");
+
+    ticks(10);
+    const uint32_t portao = pulso(D7, false);
+    const uint32_t porta = pulso(D1, false);
+    verificar(hostAlertas == alertasAntes && !sirene.estaAtiva(), "nenhum alerta nem sirene durante o teste");
+
+    ticks(10);
+    alarme.encerrarTesteCaminhada(); // "parar" antes da duração
+    verificar(!alarme.emTesteCaminhada(), "parado antes da duração");
+    verificar(alarme.getEstado() == Alarme::Estado::DESARMADO, "estado de volta: DESARMADO");
+    verificar(zonasAtivas("Fundos"), "zonas ativas mantidas: [Fundos]");
+    verificar(zonasArmadas(""), "nenhuma zona armada");
+
+    const String json = relatorio();
+    verificar(contem(json, "\"ativo\":false") && contem(json, "\"sensores\":5,\"disparados\":2"), "2 de 5 dispararam");
+    verificar(resultado(json, "Portão", 1, portao - inicioMs, false), "Portão: 1 disparo");
+    verificar(resultado(json, "Porta", 1, porta - inicioMs, false), "Porta: 1 disparo");
+    verificar(contem(json, "\"nunca_disparados\":[\"Frente/Sala\",\"Fundos/Cozinha\",\"Fundos/Lavanderia\"]"),
+              "nunca_disparados: Sala, Cozinha, Lavanderia");
+
+    // desarmado de novo: acionar não alerta
+    pulso(D1, false);
+    pulso(D5, false);
+    verificar(hostAlertas == alertasAntes && !sirene.estaAtiva(), "nenhum alerta no teste nem depois");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "Uso: %s\n", argv[0]);
+        return 2;
+    }
+
+    casoArmado();
+    casoDesarmado();
+    printf("== %s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
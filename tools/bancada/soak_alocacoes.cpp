@@ -0,0 +1,204 @@
+// Soak de alocações do núcleo do alarme (nomes na arenaNomes, sem String).
+//
+// Uso: soak_alocacoes [--dias N] [--semente S]
+//
+// Monta o modelo como configurarSistema (arenaNomes + PoolModelo) e roda N
+// dias simulados (padrão 30) no relógio virtual: tick a cada
+// ENERGIA_TICK_RAPIDO_MS armado / ENERGIA_TICK_LENTO_MS desarmado, agenda
+// automática com a hora virtual (checkAutoSchedule), sensores disparando ao
+// acaso (alguns ficam presos e vão até o isolamento), /status.json
+// formatando todos os sensores a cada 5 s e uma recarga da config por dia.
+//
+// Conta malloc/free do processo por dia. Saída 1 se algum tick (ou
+// formatação de status) alocar, ou se os blocos vivos no fim de um dia
+// passarem dos do primeiro dia.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bancada.h"
+#include "modelo_host.h"
+#include "alarme.h"
+#include "arena_nomes.h"
+#include "entradas.h"
+#include "pool_modelo.h"
+#include "system_config.h"
+
+extern std::vector<String> todasZonas;
+
+struct SensorSoak
+{
+    const char *nome;
+    const char *zona;
+    const char *tipo;
+    int pino;
+};
+
+// sensores.json da instalação, mais sensores para ocupar os pinos livres
+static const SensorSoak CONFIG[] = {
+    {"Ambiente", "Reciclagem", "PIR", D0},
+    {"Ambiente", "Triagem", "PIR", D1},
+    {"Porta&Janela", "Triagem", "PIR", D2},
+    {"Portão", "Pátio de Descarga", "REED", D4},
+    {"Galpão Norte", "Pátio de Descarga", "PIR", D6},
+    {"Escritório", "Administração Central", "PIR", D7},
+    {"Janela Fundos", "Administração Central", "REED", D8},
+};
+static const size_t TOTAL = sizeof(CONFIG) / sizeof(CONFIG[0]);
+
+static Alarme alarme;
+static Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
+
+// Mesma sequência de configurarSistema (o parse do JSON fica de fora:
+// carregarSensoresDeJSON devolve o mesmo vetor de definições)
+static void configurar()
+{
+    alarme.limparZonas();
+    poolModelo.resetar();
+    todasZonas.clear();
+    arenaNomes.limpar();
+
+    std::vector<DefinicaoSensor> defs;
+    for (const SensorSoak &s : CONFIG)
+        defs.push_back({arenaNomes.internar(s.nome), arenaNomes.internar(s.zona),
+                        Sensor::tipoFromString(s.tipo), s.pino, true});
+    const Faixa<Zona> zonas = poolModelo.montar(defs);
+    for (const Zona &zona : zonas) todasZonas.push_back(zona.getNome());
+
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(zonas);
+    alarme.setModo(Alarme::Modo::AUTOMATICO);
+    alarme.armar(todasZonas);
+}
+
+// Pinos em repouso: PIR e REED violam em nível baixo
+static uint32_t leituraRepouso()
+{
+    uint32_t leitura = 0;
+    for (const SensorSoak &s : CONFIG) leitura |= entradasBit(s.pino);
+    return leitura;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned dias = 30;
+    unsigned semente = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dias") == 0 && i + 1 < argc) dias = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) semente = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Uso: %s [--dias N] [--semente S]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(semente);
+    auto uniforme = [&](double a, double b) { return std::uniform_real_distribution<double>(a, b)(rng); };
+
+    hostEpochInicio = 1767571200; // 2026-01-05 00:00 (segunda-feira), hora virtual
+    const uint32_t repouso = leituraRepouso();
+    uint32_t leitura = repouso;
+    hostDefinirLeitura(leitura);
+
+    // próximo disparo e fim do disparo de cada sensor (ms virtuais)
+    std::vector<double> proximo(TOTAL), fim(TOTAL, -1);
+    for (size_t i = 0; i < TOTAL; i++) proximo[i] = uniforme(1e3, 2.4e6);
+
+    printf("dia   ticks     eventos alertas  alocações liberações  blocos vivos  bytes vivos  pico\n");
+
+    alocacoesContar(true);
+    configurar();
+
+    uint64_t ticksTotal = 0, ticksComAlocacao = 0;
+    int64_t blocosPrimeiroDia = -1;
+    bool estavel = true;
+    uint32_t ultimoTick = 0, ultimoStatus = 0;
+
+    for (unsigned dia = 1; dia <= dias; dia++)
+    {
+        const Alocacoes inicio = alocacoesLer();
+        alocacoesZerarPico();
+        const uint32_t eventosInicio = hostEventos, alertasInicio = hostAlertas;
+        uint32_t ticks = 0;
+
+        // recarga da config (POST /config/sensores ou reinício) no meio da tarde
+        const uint32_t recarga = hostRelogioMs + 15u * 3600 * 1000;
+        bool recarregou = false;
+        const uint32_t fimDoDia = hostRelogioMs + 86400u * 1000;
+
+        while ((int32_t)(hostRelogioMs - fimDoDia) < 0)
+        {
+            hostRelogioMs += 10; // disparos com resolução de 10 ms bastam para ticks de 100 ms
+
+            for (size_t i = 0; i < TOTAL; i++)
+            {
+                const uint32_t bit = entradasBit(CONFIG[i].pino);
+                if (fim[i] >= 0 && hostRelogioMs >= fim[i])
+                {
+                    leitura |= bit;
+                    fim[i] = -1;
+                }
+                if (fim[i] < 0 && hostRelogioMs >= proximo[i])
+                {
+                    leitura &= ~bit;
+                    // de vez em quando fica preso (sirene, tentativas, isolamento)
+                    fim[i] = hostRelogioMs + (uniforme(0, 1) < 0.03 ? uniforme(1.2e5, 3.6e5) : uniforme(50, 8000));
+                    proximo[i] = fim[i] + uniforme(1e4, 4.8e6);
+                }
+            }
+            hostDefinirLeitura(leitura);
+
+            if (!recarregou && (int32_t)(hostRelogioMs - recarga) >= 0)
+            {
+                configurar();
+                recarregou = true;
+            }
+
+            const bool vigiando = alarme.getEstado() == Alarme::Estado::ARMADO || sirene.estaAtiva();
+            const uint32_t intervalo = vigiando ? ENERGIA_TICK_RAPIDO_MS : ENERGIA_TICK_LENTO_MS;
+            if (hostRelogioMs - ultimoTick < intervalo) continue;
+            ultimoTick = hostRelogioMs;
+
+            // o tick e a formatação do status não podem alocar
+            const uint64_t antes = alocacoesLer().alocacoes;
+            alarme.atualizar(entradasLer());
+            if (hostRelogioMs - ultimoStatus >= 5000)
+            {
+                ultimoStatus = hostRelogioMs;
+                char linha[160];
+                for (const Zona &zona : alarme.getZonas())
+                    for (const Sensor &sensor : zona.getSensores()) sensor.formatarStatus(linha, sizeof(linha));
+            }
+            if (alocacoesLer().alocacoes != antes) ticksComAlocacao++;
+            ticks++;
+
+            // agenda e reinício diário rodam depois do tick, como no loop()
+            checkAutoSchedule(alarme);
+            checkDailyRestart();
+        }
+
+        const Alocacoes a = alocacoesLer();
+        const int64_t blocos = (int64_t)(a.alocacoes - a.liberacoes);
+        if (blocosPrimeiroDia < 0) blocosPrimeiroDia = blocos;
+        else if (blocos > blocosPrimeiroDia) estavel = false;
+        ticksTotal += ticks;
+
+        alocacoesContar(false);
+        printf("%3u %8u %8u %7u %10llu %10llu %12lld %12lld %6lld\n", dia, ticks, hostEventos - eventosInicio,
+               hostAlertas - alertasInicio, (unsigned long long)(a.alocacoes - inicio.alocacoes),
+               (unsigned long long)(a.liberacoes - inicio.liberacoes), (long long)blocos, (long long)a.bytesVivos,
+               (long long)a.picoBytes);
+        alocacoesContar(true);
+    }
+    alocacoesContar(false);
+
+    printf("== %llu ticks, %llu com alocação; blocos vivos %s (primeiro dia: %lld)\n",
+           (unsigned long long)ticksTotal, (unsigned long long)ticksComAlocacao,
+           estavel ? "estáveis" : "CRESCENDO", (long long)blocosPrimeiroDia);
+    return ticksComAlocacao == 0 && estavel ? 0 : 1;
+}
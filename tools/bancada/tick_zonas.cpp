@@ -0,0 +1,147 @@
+// Custo do tick do alarme (Alarme::atualizar) com 9 a 64 entradas.
+//
+// Uso: tick_zonas [--ticks N]
+//
+// Zonas de até 8 sensores, pinos D0..D8 em rodízio (a partir de 10 sensores
+// um pino atende mais de um sensor). Para cada total de sensores, N ticks
+// (padrão 20000) do alarme armado em quatro situações:
+//   repouso   todos os pinos em repouso (caminho rápido em todas as zonas)
+//   isolado   sensores do D5 isolados e o pino preso no nível de disparo
+//   inativo   sensores do D5 desativados e o pino preso
+//   disparo   sensores do D5 ativos e o pino preso (caminho completo)
+// O relógio virtual anda 1 ms por tick: o disparo não chega ao isolamento.
+//
+// Saída 1 se isolado/inativo emitirem alerta ou custarem mais que o dobro do
+// repouso (as máscaras de ativos/isolados da zona deixam o pino de fora).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "bancada.h"
+#include "modelo_host.h"
+#include "alarme.h"
+#include "arena_nomes.h"
+#include "entradas.h"
+#include "pool_modelo.h"
+#include "system_config.h"
+
+extern std::vector<String> todasZonas;
+
+static const int PINOS[] = {D0, D1, D2, D3, D4, D5, D6, D7, D8};
+static const size_t TOTAL_PINOS = sizeof(PINOS) / sizeof(PINOS[0]);
+static const int PINO_PRESO = D5;
+
+static Alarme alarme;
+static Sirene sirene(BUZZER_PIN, SIRENE_TEMPO_ALTO_MS, SIRENE_TEMPO_BAIXO_MS, SIRENE_CICLOS);
+
+enum Situacao
+{
+    REPOUSO,
+    ISOLADO,
+    INATIVO,
+    DISPARO,
+    TOTAL_SITUACOES
+};
+
+static void configurar(size_t totalSensores)
+{
+    alarme.limparZonas();
+    poolModelo.resetar();
+    todasZonas.clear();
+    arenaNomes.limpar();
+
+    std::vector<DefinicaoSensor> defs;
+    for (size_t i = 0; i < totalSensores; i++)
+    {
+        char nome[16], zona[16];
+        snprintf(nome, sizeof(nome), "S%02u", (unsigned)i);
+        snprintf(zona, sizeof(zona), "Zona %02u", (unsigned)(i / 8));
+        defs.push_back({arenaNomes.internar(nome), arenaNomes.internar(zona), Sensor::Tipo::PIR,
+                        PINOS[i % TOTAL_PINOS], true});
+    }
+    const Faixa<Zona> zonas = poolModelo.montar(defs);
+    for (const Zona &zona : zonas) todasZonas.push_back(zona.getNome());
+
+    alarme.definirSirene(&sirene);
+    alarme.definirZonas(zonas);
+    alarme.armar(todasZonas);
+}
+
+struct Medida
+{
+    double nsPorTick;
+    uint32_t alertas;
+};
+
+static Medida medir(size_t totalSensores, Situacao situacao, unsigned ticks)
+{
+    configurar(totalSensores);
+    uint32_t repouso = 0;
+    for (int pino : PINOS) repouso |= entradasBit(pino); // PIR dispara em nível baixo
+
+    for (Sensor &sensor : poolModelo.getSensores())
+    {
+        if (sensor.getPino() != PINO_PRESO) continue;
+        if (situacao == ISOLADO) sensor.restaurar({true, false, true, 4, 0});
+        if (situacao == INATIVO) sensor.desativar();
+    }
+    hostDefinirLeitura(situacao == REPOUSO ? repouso : repouso & ~entradasBit(PINO_PRESO));
+
+    // primeiros ticks fora da medida: a zona faz a passada completa que
+    // confirma os sensores ociosos
+    for (int i = 0; i < 10; i++)
+    {
+        hostRelogioMs++;
+        alarme.atualizar(entradasLer());
+    }
+
+    const uint32_t alertasAntes = hostAlertas;
+    uint64_t total = 0;
+    for (unsigned i = 0; i < ticks; i++)
+    {
+        hostRelogioMs++;
+        const uint32_t leitura = entradasLer();
+        const uint64_t t0 = hostAgoraNs();
+        alarme.atualizar(leitura);
+        total += hostAgoraNs() - t0;
+    }
+    return {(double)total / ticks, hostAlertas - alertasAntes};
+}
+
+int main(int argc, char **argv)
+{
+    unsigned ticks = 20000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) ticks = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            fprintf(stderr, "Uso: %s [--ticks N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    hostEpochInicio = 1767571200;
+    static const size_t TOTAIS[] = {9, 16, 24, 32, 48, 64};
+
+    printf("sensores  zonas   repouso   isolado   inativo   disparo  (ns/tick, host)  alertas iso/ina\n");
+    bool ok = true;
+    for (size_t total : TOTAIS)
+    {
+        Medida m[TOTAL_SITUACOES];
+        for (int s = 0; s < TOTAL_SITUACOES; s++) m[s] = medir(total, (Situacao)s, ticks);
+
+        const bool linhaOk = !m[ISOLADO].alertas && !m[INATIVO].alertas &&
+                             m[ISOLADO].nsPorTick <= 2 * m[REPOUSO].nsPorTick &&
+                             m[INATIVO].nsPorTick <= 2 * m[REPOUSO].nsPorTick;
+        printf("%8zu %6zu %9.0f %9.0f %9.0f %9.0f %26u/%u%s\n", total, (total + 7) / 8, m[REPOUSO].nsPorTick,
+               m[ISOLADO].nsPorTick, m[INATIVO].nsPorTick, m[DISPARO].nsPorTick, m[ISOLADO].alertas,
+               m[INATIVO].alertas, linhaOk ? "" : "  <- FALHOU");
+        ok = ok && linhaOk;
+    }
+    printf("== %s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
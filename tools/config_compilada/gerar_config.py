@@ -0,0 +1,183 @@
+"""Gera config_compilada_gerada.h (tabelas constexpr) de sensores.json/horarios.json.
+
+Usado pelo env nodemcuv2_compilada do platformio.ini como script "pre:": o
+header vai para <build>/gerado e o build recebe -DCONFIG_COMPILADA. A pasta
+com os JSON vem de custom_config_compilada (relativa ao projeto).
+
+Também roda sozinho, para conferir a saída:
+  python gerar_config.py <pasta_config> <saida.h>
+
+<pasta_config>: sensores.json (obrigatório, mesmo formato de /sensores.json)
+e horarios.json (opcional). As regras são as de lerConfigSensores: pinos
+D0..D8, sem repetir e fora dos reservados (botão/sirene em system_config.h).
+"""
+
+import json
+import os
+import re
+import sys
+
+PINOS = ("D0", "D1", "D2", "D3", "D4", "D5", "D6", "D7", "D8")
+TIPOS = ("PIR", "REED")
+MAX_NOME = 31  # CONFIG_MAX_NOME
+
+HORARIOS = (  # campo em HorariosConfig, chave em horarios.json, padrão
+    ("armarSemana", "ARM_HOUR_WEEKDAY", 18),
+    ("desarmarSemana", "DISARM_HOUR_WEEKDAY", 6),
+    ("armarFimSemana", "ARM_HOUR_WEEKEND", 0),
+    ("desarmarFimSemana", "DISARM_HOUR_WEEKEND", 0),
+    ("horaRestart", "horaRestart", 23),
+    ("restartConfig", "restartConfig", False),
+)
+
+
+class ErroConfig(Exception):
+    pass
+
+
+def pinos_reservados(system_config):
+    """Pinos de BTN_ARM_PIN/BUZZER_PIN, lidos de include/system_config.h."""
+    if not system_config or not os.path.exists(system_config):
+        return set()
+    with open(system_config, encoding="utf-8") as f:
+        texto = f.read()
+    return set(re.findall(r"#define\s+(?:BTN_ARM_PIN|BUZZER_PIN)\s+(D\d)", texto))
+
+
+def literal_c(texto):
+    return json.dumps(texto, ensure_ascii=False)
+
+
+def ler_sensores(caminho, reservados):
+    with open(caminho, encoding="utf-8") as f:
+        sensores = json.load(f)
+    if not isinstance(sensores, list) or not sensores:
+        raise ErroConfig(f"{caminho}: deve ser um array JSON não vazio")
+
+    usados, vistos, erros = set(), set(), []
+    for i, s in enumerate(sensores):
+        onde = f"{caminho}[{i}]"
+        if not isinstance(s, dict):
+            erros.append(f"{onde}: elemento não é um objeto")
+            continue
+        for campo in ("nome", "zona"):
+            v = s.get(campo)
+            if not isinstance(v, str) or not v or len(v.encode()) > MAX_NOME:
+                erros.append(f"{onde}: \"{campo}\" ausente ou com mais de {MAX_NOME} caracteres")
+        if s.get("tipo") not in TIPOS:
+            erros.append(f"{onde}: tipo \"{s.get('tipo')}\" desconhecido (use PIR ou REED)")
+        if not isinstance(s.get("ativo", True), bool):
+            erros.append(f"{onde}: \"ativo\" deve ser true/false")
+        pino = s.get("pino")
+        if pino not in PINOS:
+            erros.append(f"{onde}: pino \"{pino}\" desconhecido (use D0..D8)")
+        elif pino in reservados:
+            erros.append(f"{onde}: pino {pino} é reservado (botão/sirene)")
+        elif pino in usados:
+            erros.append(f"{onde}: pino {pino} já usado por outro sensor")
+        usados.add(pino)
+        chave = (s.get("nome"), s.get("zona"))
+        if chave in vistos:
+            erros.append(f"{onde}: sensor \"{chave[0]}\" repetido na zona \"{chave[1]}\"")
+        vistos.add(chave)
+    if erros:
+        raise ErroConfig("\n".join(erros))
+
+    # mesma ordem do PoolModelo::montar (strcmp nos bytes, estável)
+    return sorted(sensores, key=lambda s: s["zona"].encode())
+
+
+def ler_horarios(caminho):
+    if not os.path.exists(caminho):
+        return {}
+    with open(caminho, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def gerar(pasta, system_config=None):
+    """Texto do header a partir da pasta de config."""
+    sensores = ler_sensores(os.path.join(pasta, "sensores.json"), pinos_reservados(system_config))
+    horarios = ler_horarios(os.path.join(pasta, "horarios.json"))
+
+    zonas = list(dict.fromkeys(s["zona"] for s in sensores))
+    linhas = [
+        "// Gerado por tools/config_compilada/gerar_config.py - não editar.",
+        f"// Origem: {os.path.basename(os.path.abspath(pasta))}/sensores.json, horarios.json",
+        "#ifndef CONFIG_COMPILADA_GERADA_H",
+        "#define CONFIG_COMPILADA_GERADA_H",
+        "",
+        "// Um texto por zona: o PoolModelo agrupa sensores comparando ponteiros",
+        "namespace config_compilada",
+        "{",
+    ]
+    for i, z in enumerate(zonas):
+        linhas.append(f"inline constexpr char ZONA_{i}[] = {literal_c(z)};")
+    for i, s in enumerate(sensores):
+        linhas.append(f"inline constexpr char SENSOR_{i}[] = {literal_c(s['nome'])};")
+    linhas += ["}", "", "constexpr DefinicaoSensor SENSORES_COMPILADOS[] = {"]
+    for i, s in enumerate(sensores):
+        ativo = "true" if s.get("ativo", True) else "false"
+        linhas.append(
+            f"    {{config_compilada::SENSOR_{i}, config_compilada::ZONA_{zonas.index(s['zona'])}, "
+            f"Sensor::Tipo::{s['tipo']}, {s['pino']}, {ativo}}},"
+        )
+    linhas += [
+        "};",
+        "constexpr size_t TOTAL_SENSORES_COMPILADOS = sizeof(SENSORES_COMPILADOS) / sizeof(SENSORES_COMPILADOS[0]);",
+        "",
+        "constexpr HorariosConfig HORARIOS_PADRAO = {",
+    ]
+    for campo, chave, padrao in HORARIOS:
+        v = horarios.get(chave, padrao)
+        v = ("true" if v else "false") if isinstance(padrao, bool) else int(v)
+        linhas.append(f"    {v}, // {campo}")
+    linhas += ["};", "", "#endif", ""]
+    return "\n".join(linhas)
+
+
+def escrever_se_mudou(caminho, texto):
+    """Só reescreve se mudou: não força recompilar tudo a cada build."""
+    if os.path.exists(caminho):
+        with open(caminho, encoding="utf-8") as f:
+            if f.read() == texto:
+                return
+    os.makedirs(os.path.dirname(caminho) or ".", exist_ok=True)
+    with open(caminho, "w", encoding="utf-8") as f:
+        f.write(texto)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__)
+        return 2
+    raiz = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+    try:
+        escrever_se_mudou(argv[2], gerar(argv[1], os.path.join(raiz, "include", "system_config.h")))
+    except (ErroConfig, OSError, ValueError) as e:
+        print(f"[config_compilada] {e}", file=sys.stderr)
+        return 1
+    print(f"[config_compilada] {argv[2]} gerado")
+    return 0
+
+
+def integrar_platformio(env):
+    projeto = env.subst("$PROJECT_DIR")
+    pasta = os.path.join(projeto, env.GetProjectOption("custom_config_compilada", "config_compilada"))
+    saida = os.path.join(env.subst("$BUILD_DIR"), "gerado")
+    try:
+        texto = gerar(pasta, os.path.join(projeto, "include", "system_config.h"))
+    except (ErroConfig, OSError, ValueError) as e:
+        sys.stderr.write(f"[config_compilada] {e}\n")
+        env.Exit(1)
+    escrever_se_mudou(os.path.join(saida, "config_compilada_gerada.h"), texto)
+    env.Append(CPPDEFINES=["CONFIG_COMPILADA"], CPPPATH=[saida])
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
+else:
+    try:
+        Import("env")  # noqa: F821 (definido pelo SCons do PlatformIO)
+        integrar_platformio(env)  # noqa: F821
+    except NameError:
+        pass
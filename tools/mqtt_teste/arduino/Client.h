@@ -0,0 +1,20 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+// Só a parte do Client do Arduino que a SessaoMqtt usa
+#include <stddef.h>
+#include <stdint.h>
+
+class Client
+{
+public:
+    virtual ~Client() = default;
+    virtual size_t write(const uint8_t *dados, size_t n) = 0;
+    virtual int availableForWrite() = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+};
+
+#endif
@@ -0,0 +1,341 @@
+#include "broker.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t MAX_ENTRADA = 16384;
+
+// Campo de texto do MQTT (2 bytes de tamanho + bytes); false se faltar dado
+static bool lerTexto(const std::string &corpo, size_t &pos, std::string &saida)
+{
+    if (pos + 2 > corpo.size()) return false;
+    const size_t n = (uint8_t)corpo[pos] << 8 | (uint8_t)corpo[pos + 1];
+    if (pos + 2 + n > corpo.size()) return false;
+    saida = corpo.substr(pos + 2, n);
+    pos += 2 + n;
+    return true;
+}
+
+static std::string pacoteCurto(uint8_t tipo, uint8_t a, uint8_t b)
+{
+    return std::string{(char)tipo, 2, (char)a, (char)b};
+}
+
+BrokerTeste::~BrokerTeste()
+{
+    for (auto &c : conexoes) close(c.fd);
+    if (escuta >= 0) close(escuta);
+}
+
+void BrokerTeste::imprimir(const std::string &texto, bool sempre)
+{
+    if (!verboso && !sempre) return;
+    char hora[16];
+    const time_t agora = time(nullptr);
+    strftime(hora, sizeof(hora), "%H:%M:%S", localtime(&agora));
+    printf("%s [BROKER] %s\n", hora, texto.c_str());
+    fflush(stdout);
+}
+
+bool BrokerTeste::iniciar(uint16_t porta)
+{
+    escuta = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (escuta < 0) return false;
+
+    int um = 1;
+    setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_ANY);
+    end.sin_port = htons(porta);
+    if (bind(escuta, (sockaddr *)&end, sizeof(end)) < 0 || listen(escuta, 16) < 0) return false;
+
+    socklen_t tamanho = sizeof(end);
+    getsockname(escuta, (sockaddr *)&end, &tamanho);
+    portaEscuta = ntohs(end.sin_port);
+    return true;
+}
+
+void BrokerTeste::executar(int esperaMs)
+{
+    std::vector<pollfd> fds;
+    fds.push_back({escuta, POLLIN, 0});
+    for (const auto &c : conexoes)
+        fds.push_back({c.fd, (short)(POLLIN | (c.enviados < c.saida.size() ? POLLOUT : 0)), 0});
+    if (poll(fds.data(), fds.size(), esperaMs) < 0) return;
+
+    for (size_t i = 0; i < conexoes.size(); i++)
+    {
+        Conexao &c = conexoes[i];
+        const short rev = fds[1 + i].revents;
+        if (rev & (POLLERR | POLLNVAL)) c.fechar = true;
+
+        if (!c.fechar && (rev & (POLLIN | POLLHUP)))
+        {
+            char buf[2048];
+            const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n <= 0) c.fechar = true;
+            else if (!c.muda)
+            {
+                c.entrada.append(buf, n);
+                receber(c);
+                if (c.entrada.size() > MAX_ENTRADA) c.fechar = true;
+            }
+        }
+
+        if (!c.fechar && c.enviados < c.saida.size())
+        {
+            const ssize_t n = send(c.fd, c.saida.data() + c.enviados, c.saida.size() - c.enviados, MSG_NOSIGNAL);
+            if (n > 0) c.enviados += n;
+            else if (errno != EAGAIN) c.fechar = true;
+        }
+    }
+
+    for (size_t i = 0; i < conexoes.size();)
+    {
+        if (conexoes[i].fechar)
+        {
+            encerrada(conexoes[i]);
+            close(conexoes[i].fd);
+            conexoes[i] = std::move(conexoes.back());
+            conexoes.pop_back();
+        }
+        else i++;
+    }
+
+    if (fds[0].revents & POLLIN) aceitar();
+}
+
+void BrokerTeste::aceitar()
+{
+    for (;;)
+    {
+        const int fd = accept4(escuta, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        conexoes.push_back({});
+        Conexao &c = conexoes.back();
+        c.fd = fd;
+        if (falhas.mudo > 0)
+        {
+            falhas.mudo--;
+            c.muda = true;
+            imprimir("conexão aceita e deixada sem CONNACK", true);
+        }
+    }
+}
+
+void BrokerTeste::receber(Conexao &c)
+{
+    while (!c.fechar && !c.muda && c.entrada.size() >= 2)
+    {
+        // tamanho restante: até 4 bytes de 7 bits
+        uint32_t restante = 0;
+        size_t pos = 1;
+        int deslocamento = 0;
+        bool completo = false;
+        while (pos < c.entrada.size() && pos <= 4)
+        {
+            const uint8_t b = c.entrada[pos++];
+            restante |= (uint32_t)(b & 0x7F) << deslocamento;
+            deslocamento += 7;
+            if (!(b & 0x80))
+            {
+                completo = true;
+                break;
+            }
+        }
+        if (!completo)
+        {
+            if (pos > 4) c.fechar = true; // malformado
+            return;
+        }
+        if (c.entrada.size() < pos + restante) return;
+
+        const uint8_t cabecalho = c.entrada[0];
+        const std::string corpo = c.entrada.substr(pos, restante);
+        c.entrada.erase(0, pos + restante);
+        pacote(c, cabecalho, corpo);
+    }
+}
+
+void BrokerTeste::pacote(Conexao &c, uint8_t cabecalho, const std::string &corpo)
+{
+    const uint8_t tipo = cabecalho & 0xF0;
+    if (tipo != 0x10 && !c.conectada)
+    {
+        imprimir("pacote antes do CONNECT: conexão fechada", true);
+        c.fechar = true;
+        return;
+    }
+
+    switch (tipo)
+    {
+    case 0x10: // CONNECT
+    {
+        size_t pos = 0;
+        std::string protocolo, id, usr, pwd;
+        if (!lerTexto(corpo, pos, protocolo) || pos + 4 > corpo.size())
+        {
+            c.fechar = true;
+            return;
+        }
+        const uint8_t nivel = corpo[pos], flags = corpo[pos + 1];
+        const unsigned keepAlive = (uint8_t)corpo[pos + 2] << 8 | (uint8_t)corpo[pos + 3];
+        pos += 4;
+        bool ok = lerTexto(corpo, pos, id);
+        if (ok && (flags & 0x04)) ok = lerTexto(corpo, pos, c.willTopico) && lerTexto(corpo, pos, c.willPayload);
+        if (ok && (flags & 0x80)) ok = lerTexto(corpo, pos, usr);
+        if (ok && (flags & 0x40)) ok = lerTexto(corpo, pos, pwd);
+        if (!ok || protocolo != "MQTT" || nivel != 4)
+        {
+            imprimir("CONNECT inválido", true);
+            c.fechar = true;
+            return;
+        }
+        c.clientId = id;
+
+        uint8_t codigo = 0;
+        if (falhas.recusar > 0)
+        {
+            falhas.recusar--;
+            codigo = 5;
+        }
+        else if (!usuario.empty() && (usr != usuario || pwd != senha)) codigo = 4;
+
+        imprimir("CONNECT " + id + " keepalive " + std::to_string(keepAlive) + "s" +
+                     (flags & 0x04 ? ", will " + c.willTopico + "=" + c.willPayload : std::string()) +
+                     (codigo ? ", recusado com " + std::to_string(codigo) : std::string()),
+                 codigo != 0);
+        c.saida += pacoteCurto(0x20, 0, codigo);
+        if (codigo)
+        {
+            c.muda = true; // responde e espera a placa fechar
+            return;
+        }
+        c.conectada = true;
+        totalSessoes++;
+        break;
+    }
+
+    case 0x30: // PUBLISH
+        publicacao(c, cabecalho, corpo);
+        break;
+
+    case 0xC0: // PINGREQ
+        totalPings++;
+        c.saida += std::string{(char)0xD0, 0};
+        break;
+
+    case 0xE0: // DISCONNECT
+        c.limpa = true;
+        c.fechar = true;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void BrokerTeste::publicacao(Conexao &c, uint8_t cabecalho, const std::string &corpo)
+{
+    const int qos = (cabecalho >> 1) & 3;
+    const bool retido = cabecalho & 1;
+    size_t pos = 0;
+    std::string topico;
+    if (!lerTexto(corpo, pos, topico) || (qos && pos + 2 > corpo.size()))
+    {
+        c.fechar = true;
+        return;
+    }
+    uint16_t id = 0;
+    if (qos)
+    {
+        id = (uint8_t)corpo[pos] << 8 | (uint8_t)corpo[pos + 1];
+        pos += 2;
+    }
+    const std::string payload = corpo.substr(pos);
+
+    if (retido)
+    {
+        if (payload.empty()) retidosPorTopico.erase(topico);
+        else retidosPorTopico[topico] = payload;
+    }
+
+    const bool evento = topico.size() > 8 && topico.compare(topico.size() - 8, 8, "/eventos") == 0;
+    if (!evento) imprimir(topico + (retido ? " (retido) " : " ") + payload);
+    if (evento)
+    {
+        registrarEvento(payload);
+        eventosRecebidos++;
+        if (falhas.derrubarCada && eventosRecebidos % falhas.derrubarCada == 0)
+        {
+            imprimir("derrubando a conexão antes do PUBACK", true);
+            c.limpa = true; // queda do broker: o will não vale
+            c.fechar = true;
+            return;
+        }
+        if (falhas.engolirCada && eventosRecebidos % falhas.engolirCada == 0)
+        {
+            imprimir("PUBACK " + std::to_string(id) + " engolido", true);
+            return;
+        }
+    }
+    if (qos == 1) c.saida += pacoteCurto(0x40, id >> 8, id & 0xFF);
+}
+
+void BrokerTeste::registrarEvento(const std::string &payload)
+{
+    const size_t pos = payload.find("\"seq\":");
+    if (pos == std::string::npos)
+    {
+        imprimir("evento sem seq: " + payload, true);
+        return;
+    }
+    const uint32_t seq = strtoul(payload.c_str() + pos + 6, nullptr, 10);
+
+    if (contagem.novos == 0)
+    {
+        contagem.primeiro = contagem.ultimo = seq;
+        contagem.novos = 1;
+        imprimir("evento " + payload);
+        return;
+    }
+    if (seq <= contagem.ultimo)
+    {
+        contagem.repetidos++;
+        imprimir("evento REPETIDO " + payload, true);
+        return;
+    }
+    if (seq != contagem.ultimo + 1)
+    {
+        contagem.lacunas++;
+        imprimir("LACUNA: esperava seq " + std::to_string(contagem.ultimo + 1) + ", veio " + payload, true);
+    }
+    else imprimir("evento " + payload);
+    contagem.ultimo = seq;
+    contagem.novos++;
+}
+
+void BrokerTeste::encerrada(Conexao &c)
+{
+    if (!c.conectada) return;
+    if (c.limpa)
+    {
+        imprimir("sessão " + c.clientId + " encerrada");
+        return;
+    }
+    // queda da placa: o broker publica o will
+    if (!c.willTopico.empty())
+    {
+        retidosPorTopico[c.willTopico] = c.willPayload;
+        imprimir("sessão " + c.clientId + " caiu: will " + c.willTopico + "=" + c.willPayload, true);
+    }
+}
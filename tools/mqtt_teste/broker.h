@@ -0,0 +1,88 @@
+#ifndef BROKER_H
+#define BROKER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Falhas provocadas pelo broker, para ver a placa reconectar e reenviar
+struct FalhasBroker
+{
+    int mudo = 0;         // quantas conexões não recebem CONNACK
+    int recusar = 0;      // quantos CONNECT recebem CONNACK 5 (não autorizado)
+    int derrubarCada = 0; // fecha a conexão a cada N eventos, antes do PUBACK
+    int engolirCada = 0;  // a cada N eventos, não manda o PUBACK
+};
+
+// Broker MQTT 3.1.1 mínimo, no estilo do Mosquitto para o que a placa usa:
+// CONNECT (will, usuário/senha), PUBLISH QoS0/1 com retidos, PINGREQ e
+// DISCONNECT. Sem assinaturas: só registra o que chega. Os eventos
+// (<base>/eventos) são conferidos pelo "seq": repetido (reenvio depois de
+// PUBACK perdido, esperado) ou lacuna (evento perdido, erro).
+class BrokerTeste
+{
+public:
+    struct Eventos
+    {
+        uint32_t primeiro = 0;
+        uint32_t ultimo = 0;
+        unsigned novos = 0;
+        unsigned repetidos = 0;
+        unsigned lacunas = 0;
+    };
+
+    BrokerTeste(const FalhasBroker &falhas, const std::string &usuario, const std::string &senha, bool verboso)
+        : falhas(falhas), usuario(usuario), senha(senha), verboso(verboso) {}
+    ~BrokerTeste();
+
+    // porta 0 = escolhida pelo sistema (ver porta())
+    bool iniciar(uint16_t porta);
+    uint16_t porta() const { return portaEscuta; }
+
+    // Um poll() de até esperaMs: aceita, lê, responde
+    void executar(int esperaMs);
+
+    const Eventos &eventos() const { return contagem; }
+    const std::map<std::string, std::string> &retidos() const { return retidosPorTopico; }
+    unsigned sessoes() const { return totalSessoes; }
+    unsigned pings() const { return totalPings; }
+
+private:
+    struct Conexao
+    {
+        int fd;
+        std::string entrada;
+        std::string saida;
+        size_t enviados = 0;
+        bool conectada = false;
+        bool muda = false;
+        bool fechar = false;
+        bool limpa = false; // DISCONNECT recebido: sem will
+        std::string clientId, willTopico, willPayload;
+    };
+
+    void aceitar();
+    // Trata os pacotes completos em c.entrada
+    void receber(Conexao &c);
+    void pacote(Conexao &c, uint8_t cabecalho, const std::string &corpo);
+    void publicacao(Conexao &c, uint8_t cabecalho, const std::string &corpo);
+    void registrarEvento(const std::string &payload);
+    void encerrada(Conexao &c);
+    void imprimir(const std::string &texto, bool sempre = false);
+
+    FalhasBroker falhas;
+    std::string usuario, senha;
+    bool verboso;
+
+    int escuta = -1;
+    uint16_t portaEscuta = 0;
+    std::vector<Conexao> conexoes;
+    std::map<std::string, std::string> retidosPorTopico;
+    Eventos contagem;
+    unsigned eventosRecebidos = 0;
+    unsigned totalSessoes = 0;
+    unsigned totalPings = 0;
+};
+
+#endif
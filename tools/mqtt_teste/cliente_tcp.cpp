@@ -0,0 +1,78 @@
+#include "cliente_tcp.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool ClienteTcp::connect(const char *host, uint16_t porta)
+{
+    stop();
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_port = htons(porta);
+    if (inet_pton(AF_INET, host, &end.sin_addr) != 1) return false;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, (sockaddr *)&end, sizeof(end)) < 0)
+    {
+        stop();
+        return false;
+    }
+    int um = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof(um));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+size_t ClienteTcp::write(const uint8_t *dados, size_t n)
+{
+    if (fd < 0) return 0;
+    const ssize_t enviados = send(fd, dados, n, MSG_NOSIGNAL);
+    return enviados > 0 ? (size_t)enviados : 0;
+}
+
+int ClienteTcp::availableForWrite()
+{
+    if (fd < 0) return 0;
+    int buffer = 0, naFila = 0;
+    socklen_t tamanho = sizeof(buffer);
+    getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer, &tamanho);
+    ioctl(fd, SIOCOUTQ, &naFila);
+    return buffer > naFila ? buffer - naFila : 0;
+}
+
+int ClienteTcp::available()
+{
+    int n = 0;
+    if (fd < 0 || ioctl(fd, FIONREAD, &n) < 0) return 0;
+    return n;
+}
+
+int ClienteTcp::read()
+{
+    uint8_t c;
+    if (fd < 0 || recv(fd, &c, 1, 0) != 1) return -1;
+    return c;
+}
+
+uint8_t ClienteTcp::connected()
+{
+    if (fd < 0) return 0;
+    if (available() > 0) return 1;
+    uint8_t c;
+    const ssize_t n = recv(fd, &c, 1, MSG_PEEK);
+    return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void ClienteTcp::stop()
+{
+    if (fd >= 0) close(fd);
+    fd = -1;
+}
@@ -0,0 +1,27 @@
+#ifndef CLIENTE_TCP_H
+#define CLIENTE_TCP_H
+
+#include <Client.h>
+
+// WiFiClient de mentira: socket TCP não bloqueante depois do connect(),
+// com o mesmo contrato que a SessaoMqtt espera da placa (availableForWrite
+// = espaço livre no buffer de envio; connected() enquanto houver o que ler)
+class ClienteTcp : public Client
+{
+public:
+    ~ClienteTcp() override { stop(); }
+
+    bool connect(const char *host, uint16_t porta);
+
+    size_t write(const uint8_t *dados, size_t n) override;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    uint8_t connected() override;
+    void stop() override;
+
+private:
+    int fd = -1;
+};
+
+#endif
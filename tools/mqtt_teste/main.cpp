@@ -0,0 +1,218 @@
+// Broker MQTT de teste para o mqtt_publisher da placa (lib/mqtt_publisher),
+// e a SessaoMqtt do firmware rodando contra ele no host.
+//
+// Uso: mqtt_teste broker [opções]          broker para a placa
+//      mqtt_teste sessao [--eventos N]     teste da sessão, com as falhas abaixo
+//   --porta P            porta do broker (padrão 1883; sessao: qualquer livre)
+//   --auth USUARIO:SENHA CONNECT exige usuário e senha
+//   --mudo N             as N primeiras conexões ficam sem CONNACK
+//   --recusar N          os N primeiros CONNECT recebem CONNACK 5
+//   --derrubar N         fecha a conexão a cada N eventos, antes do PUBACK
+//   --engolir N          a cada N eventos, o PUBACK não é enviado
+//
+// Na placa, /mqtt.json apontando para esta máquina:
+//   {"host":"<ip>","porta":1883,"id":"portaria"}
+// O broker imprime CONNECT/will, retidos e eventos; um seq já recebido é
+// marcado REPETIDO (reenvio depois de PUBACK perdido: esperado) e um seq
+// pulado é LACUNA (evento perdido: erro).
+//
+// "sessao" publica N eventos como o mqtt_publisher (um por vez, a fila só
+// anda no PUBACK; sessão caída = reenvia) com falhas em todas as etapas
+// (padrão: --mudo 1 --recusar 1 --derrubar 37 --engolir 23) e confere que o
+// broker recebeu todos, em ordem, e que nenhuma chamada da sessão esperou a
+// rede. Saída 0 = ok, 1 = evento perdido/fora de ordem ou chamada lenta.
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "broker.h"
+#include "cliente_tcp.h"
+#include "sessao_mqtt.h"
+
+static volatile sig_atomic_t rodando = 1;
+
+static uint32_t agoraMs()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static uint64_t agoraUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static int rodarBroker(BrokerTeste &broker)
+{
+    signal(SIGINT, [](int) { rodando = 0; });
+    signal(SIGTERM, [](int) { rodando = 0; });
+    printf("[MQTT_TESTE] broker na porta %u\n", broker.porta());
+    fflush(stdout);
+    while (rodando) broker.executar(500);
+    return 0;
+}
+
+// Mesmo fluxo do mqtt_loop: conecta, anuncia "online", publica um evento
+// por vez e só avança no PUBACK
+static int rodarSessao(BrokerTeste &broker, unsigned totalEventos, const std::string &usuario,
+                       const std::string &senha)
+{
+    static const uint32_t PRAZO_MS = 200;
+    static const uint32_t RECONEXAO_MS = 50;
+    static const uint32_t LIMITE_CHAMADA_US = 20000; // bem abaixo do PRAZO_MS
+
+    ClienteTcp rede;
+    SessaoMqtt sessao(rede);
+    const SessaoMqtt::Opcoes opcoes = {"alarme-00c0ff", usuario.c_str(), senha.c_str(), "alarme/teste/online", "0",
+                                       1, PRAZO_MS};
+
+    unsigned proximo = 1; // próximo seq a publicar
+    bool iniciada = false, emVoo = false, anunciada = false, pausou = false;
+    unsigned quedas = 0;
+    uint32_t proximaConexao = 0;
+    uint64_t maxChamadaUs = 0, maxConexaoUs = 0;
+    const uint32_t inicio = agoraMs();
+
+    while (proximo <= totalEventos && agoraMs() - inicio < 60000)
+    {
+        broker.executar(1);
+        const uint32_t agora = agoraMs();
+
+        if (sessao.getEstado() == SessaoMqtt::Estado::DESCONECTADA)
+        {
+            if (iniciada)
+            {
+                if (anunciada) quedas++;
+                printf("[MQTT_TESTE] sessão encerrada: %s\n", sessao.getMotivo());
+            }
+            iniciada = anunciada = emVoo = false;
+            if ((int32_t)(agora - proximaConexao) < 0) continue;
+            proximaConexao = agora + RECONEXAO_MS;
+
+            const uint64_t t0 = agoraUs();
+            if (rede.connect("127.0.0.1", broker.porta())) iniciada = sessao.iniciar(opcoes, agora);
+            maxConexaoUs = std::max(maxConexaoUs, agoraUs() - t0);
+            continue;
+        }
+
+        const uint64_t t0 = agoraUs();
+        sessao.processar(agora);
+        if (sessao.getEstado() == SessaoMqtt::Estado::CONECTADA)
+        {
+            if (!anunciada)
+            {
+                anunciada = sessao.publicar("alarme/teste/online", "1", true, false, agora);
+                sessao.publicar("alarme/teste/status", "{\"estado\":\"ARMADO\",\"modo\":\"AUTOMATICO\"}", true,
+                                false, agora);
+            }
+            else
+            {
+                if (emVoo && sessao.confirmada())
+                {
+                    emVoo = false;
+                    proximo++;
+                }
+                // no meio do teste a fila fica parada: keepalive (PINGREQ/PINGRESP)
+                const bool pausa = !pausou && proximo == totalEventos / 2;
+                if (pausa && !emVoo)
+                {
+                    static uint32_t inicioPausa = agora;
+                    pausou = agora - inicioPausa >= 1500;
+                }
+                else if (!emVoo && proximo <= totalEventos)
+                {
+                    char linha[96];
+                    snprintf(linha, sizeof(linha), "{\"seq\":%u,\"ts\":%u,\"evento\":\"Evento de teste %u\"}",
+                             proximo, 1767571200 + proximo, proximo);
+                    emVoo = sessao.publicar("alarme/teste/eventos", linha, false, true, agora);
+                }
+            }
+        }
+        maxChamadaUs = std::max(maxChamadaUs, agoraUs() - t0);
+    }
+    sessao.encerrar("fim do teste");
+    for (int i = 0; i < 20; i++) broker.executar(5);
+
+    const BrokerTeste::Eventos &e = broker.eventos();
+    const auto online = broker.retidos().find("alarme/teste/online");
+    const bool completo = e.novos == totalEventos && e.primeiro == 1 && e.ultimo == totalEventos;
+    const bool emOrdem = e.lacunas == 0;
+    const bool rapido = maxChamadaUs < LIMITE_CHAMADA_US;
+
+    printf("== %u eventos: %u recebidos (seq %u..%u), %u repetidos, %u lacunas\n", totalEventos, e.novos, e.primeiro,
+           e.ultimo, e.repetidos, e.lacunas);
+    printf("== %u sessões, %u quedas, %u PINGREQ; online retido = %s\n", broker.sessoes(), quedas, broker.pings(),
+           online == broker.retidos().end() ? "(nada)" : online->second.c_str());
+    printf("== maior chamada processar/publicar: %llu us; maior connect (localhost): %llu us\n",
+           (unsigned long long)maxChamadaUs, (unsigned long long)maxConexaoUs);
+    printf("== %s\n", completo && emOrdem && rapido ? "OK"
+                      : !completo                  ? "FALHOU: eventos faltando"
+                      : !emOrdem                   ? "FALHOU: eventos fora de ordem"
+                                                   : "FALHOU: chamada da sessão esperou a rede");
+    return completo && emOrdem && rapido ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const std::string modo = argc > 1 ? argv[1] : "";
+    if (modo != "broker" && modo != "sessao")
+    {
+        fprintf(stderr, "uso: %s broker|sessao [--porta P] [--auth USUARIO:SENHA] [--mudo N] [--recusar N]\n"
+                        "       [--derrubar N] [--engolir N] [--eventos N]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const bool sessao = modo == "sessao";
+    uint16_t porta = sessao ? 0 : 1883;
+    unsigned eventos = 500;
+    std::string usuario, senha;
+    FalhasBroker falhas;
+    if (sessao) falhas = {1, 1, 37, 23};
+
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string opcao = argv[i];
+        const char *valor = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!valor)
+        {
+            fprintf(stderr, "[ERRO] %s sem valor\n", opcao.c_str());
+            return 1;
+        }
+        i++;
+
+        if (opcao == "--porta") porta = (uint16_t)atoi(valor);
+        else if (opcao == "--auth")
+        {
+            const char *dp = strchr(valor, ':');
+            usuario.assign(valor, dp ? dp - valor : strlen(valor));
+            senha = dp ? dp + 1 : "";
+        }
+        else if (opcao == "--mudo") falhas.mudo = atoi(valor);
+        else if (opcao == "--recusar") falhas.recusar = atoi(valor);
+        else if (opcao == "--derrubar") falhas.derrubarCada = atoi(valor);
+        else if (opcao == "--engolir") falhas.engolirCada = atoi(valor);
+        else if (opcao == "--eventos") eventos = strtoul(valor, nullptr, 10);
+        else
+        {
+            fprintf(stderr, "[ERRO] opção desconhecida: %s\n", opcao.c_str());
+            return 1;
+        }
+    }
+
+    BrokerTeste broker(falhas, usuario, senha, !sessao);
+    if (!broker.iniciar(porta))
+    {
+        perror("[ERRO] broker");
+        return 1;
+    }
+    return sessao ? rodarSessao(broker, eventos, usuario, senha) : rodarBroker(broker);
+}
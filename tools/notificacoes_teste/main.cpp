@@ -0,0 +1,113 @@
+// Receptores de teste para as notificações da placa (lib/notificacoes).
+//
+// Uso: notificacoes_teste [opções]
+//   --http PORTA            webhook (padrão 8080; 0 = desligado)
+//   --smtp PORTA            SMTP (padrão 2525; 0 = desligado)
+//   --auth USUARIO:SENHA    SMTP exige AUTH LOGIN
+//   --http-falhas N[:COD]   as N primeiras entregas do webhook recebem COD (503)
+//   --smtp-falhas N[:COD]   as N primeiras entregas SMTP recebem COD (451) no RCPT
+//   --http-mudo N           as N primeiras conexões HTTP ficam sem resposta
+//   --smtp-mudo N           idem para SMTP (nem a saudação 220)
+//
+// Na placa, /notificacoes.json apontando para esta máquina:
+//   {"destinos":[{"tipo":"webhook","url":"http://<ip>:8080/alarme","filtro":[]},
+//                {"tipo":"smtp","host":"<ip>","porta":2525,"de":"a@b","para":"c@d"}]}
+// Cada entrega aparece com a Idempotency-Key / Message-ID; uma chave já
+// recebida é marcada REPETIDA (reenvio depois de resposta perdida).
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "receptores.h"
+
+static volatile sig_atomic_t rodando = 1;
+
+// "N" ou "N:COD"
+static void lerFalhas(const char *texto, int &quantas, int &codigo)
+{
+    quantas = atoi(texto);
+    const char *dp = strchr(texto, ':');
+    if (dp) codigo = atoi(dp + 1);
+}
+
+int main(int argc, char **argv)
+{
+    uint16_t portaHttp = 8080, portaSmtp = 2525;
+    std::string usuario, senha;
+    Falhas falhasHttp{0, 503, 0}, falhasSmtp{0, 451, 0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string opcao = argv[i];
+        const char *valor = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!valor || opcao.compare(0, 2, "--") != 0)
+        {
+            fprintf(stderr, "uso: %s [--http PORTA] [--smtp PORTA] [--auth USUARIO:SENHA]\n"
+                            "       [--http-falhas N[:COD]] [--smtp-falhas N[:COD]] [--http-mudo N] [--smtp-mudo N]\n",
+                    argv[0]);
+            return 1;
+        }
+        i++;
+
+        if (opcao == "--http") portaHttp = (uint16_t)atoi(valor);
+        else if (opcao == "--smtp") portaSmtp = (uint16_t)atoi(valor);
+        else if (opcao == "--auth")
+        {
+            const char *dp = strchr(valor, ':');
+            usuario.assign(valor, dp ? dp - valor : strlen(valor));
+            senha = dp ? dp + 1 : "";
+        }
+        else if (opcao == "--http-falhas") lerFalhas(valor, falhasHttp.recusar, falhasHttp.codigo);
+        else if (opcao == "--smtp-falhas") lerFalhas(valor, falhasSmtp.recusar, falhasSmtp.codigo);
+        else if (opcao == "--http-mudo") falhasHttp.mudo = atoi(valor);
+        else if (opcao == "--smtp-mudo") falhasSmtp.mudo = atoi(valor);
+        else
+        {
+            fprintf(stderr, "[ERRO] opção desconhecida: %s\n", opcao.c_str());
+            return 1;
+        }
+    }
+
+    ReceptorWebhook webhook(falhasHttp);
+    ReceptorSmtp smtp(falhasSmtp, usuario, senha);
+    std::vector<Receptor *> ativos;
+    if (portaHttp)
+    {
+        if (!webhook.iniciar(portaHttp))
+        {
+            perror("[ERRO] webhook");
+            return 1;
+        }
+        ativos.push_back(&webhook);
+    }
+    if (portaSmtp)
+    {
+        if (!smtp.iniciar(portaSmtp))
+        {
+            perror("[ERRO] smtp");
+            return 1;
+        }
+        ativos.push_back(&smtp);
+    }
+
+    signal(SIGINT, [](int) { rodando = 0; });
+    signal(SIGTERM, [](int) { rodando = 0; });
+    printf("[NOTIF_TESTE] webhook na porta %u, SMTP na porta %u%s\n", portaHttp, portaSmtp,
+           usuario.empty() ? "" : " (com AUTH)");
+    fflush(stdout);
+
+    std::vector<pollfd> fds;
+    while (rodando)
+    {
+        fds.clear();
+        for (Receptor *r : ativos) r->registrar(fds);
+        if (poll(fds.data(), fds.size(), 500) < 0 && errno != EINTR) break;
+        for (Receptor *r : ativos) r->processar(fds);
+    }
+    return 0;
+}
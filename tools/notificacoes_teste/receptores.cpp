@@ -0,0 +1,323 @@
+#include "receptores.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t MAX_ENTRADA = 16384;
+
+static void imprimir(const char *nome, const std::string &texto)
+{
+    char hora[16];
+    const time_t agora = time(nullptr);
+    strftime(hora, sizeof(hora), "%H:%M:%S", localtime(&agora));
+    printf("%s [%s] %s\n", hora, nome, texto.c_str());
+    fflush(stdout);
+}
+
+// ================== Receptor ==================
+Receptor::~Receptor()
+{
+    for (auto &c : conexoes) close(c.fd);
+    if (escuta >= 0) close(escuta);
+}
+
+bool Receptor::iniciar(uint16_t porta)
+{
+    escuta = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (escuta < 0) return false;
+
+    int um = 1;
+    setsockopt(escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_ANY);
+    end.sin_port = htons(porta);
+    if (bind(escuta, (sockaddr *)&end, sizeof(end)) < 0 || listen(escuta, 16) < 0) return false;
+    return true;
+}
+
+void Receptor::registrar(std::vector<pollfd> &fds)
+{
+    indiceInicial = fds.size();
+    fds.push_back({escuta, POLLIN, 0});
+    for (const auto &c : conexoes)
+        fds.push_back({c.fd, (short)(POLLIN | (c.enviados < c.saida.size() ? POLLOUT : 0)), 0});
+}
+
+void Receptor::processar(const std::vector<pollfd> &fds)
+{
+    for (size_t i = 0; i < conexoes.size(); i++)
+    {
+        Conexao &c = conexoes[i];
+        const short rev = fds[indiceInicial + 1 + i].revents;
+        if (!rev) continue;
+
+        if (rev & (POLLERR | POLLNVAL))
+        {
+            c.saida.clear();
+            c.enviados = 0;
+            c.fechar = true;
+            continue;
+        }
+
+        if (rev & (POLLIN | POLLHUP))
+        {
+            char buf[2048];
+            const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n <= 0)
+            {
+                // a placa desistiu (ou terminou): nada mais a enviar
+                if (c.muda) imprimir(nome, "conexão muda encerrada pela placa");
+                c.saida.clear();
+                c.enviados = 0;
+                c.fechar = true;
+                continue;
+            }
+            if (!c.muda && !c.fechar)
+            {
+                c.entrada.append(buf, n);
+                recebeu(c);
+                if (c.entrada.size() > MAX_ENTRADA) c.fechar = true;
+            }
+        }
+
+        if (c.enviados < c.saida.size() && (rev & POLLOUT))
+        {
+            const ssize_t n = send(c.fd, c.saida.data() + c.enviados, c.saida.size() - c.enviados, MSG_NOSIGNAL);
+            if (n > 0) c.enviados += n;
+            else if (errno != EAGAIN)
+            {
+                c.saida.clear();
+                c.enviados = 0;
+                c.fechar = true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < conexoes.size();)
+    {
+        if (conexoes[i].fechar && conexoes[i].enviados >= conexoes[i].saida.size())
+        {
+            close(conexoes[i].fd);
+            conexoes[i] = std::move(conexoes.back());
+            conexoes.pop_back();
+        }
+        else i++;
+    }
+
+    if (fds[indiceInicial].revents & POLLIN) aceitar();
+}
+
+void Receptor::aceitar()
+{
+    for (;;)
+    {
+        const int fd = accept4(escuta, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        conexoes.push_back({});
+        Conexao &c = conexoes.back();
+        c.fd = fd;
+        if (falhas.mudo > 0)
+        {
+            falhas.mudo--;
+            c.muda = true;
+            imprimir(nome, "conexão aceita e deixada sem resposta");
+            continue;
+        }
+        conectou(c);
+    }
+}
+
+bool Receptor::falharAgora()
+{
+    if (falhas.recusar <= 0) return false;
+    falhas.recusar--;
+    return true;
+}
+
+void Receptor::registrarEntrega(const std::string &chave, const std::string &resumo)
+{
+    const bool repetida = !chave.empty() && !chaves.insert(chave).second;
+    entregas++;
+    imprimir(nome, "#" + std::to_string(entregas) + " " + (chave.empty() ? "(sem chave)" : chave) +
+                       (repetida ? " REPETIDA" : "") + ": " + resumo);
+}
+
+// ================== Webhook ==================
+static std::string cabecalho(const std::string &requisicao, const char *campo)
+{
+    const std::string procura = std::string("\r\n") + campo + ":";
+    size_t pos = 0;
+    for (;;)
+    {
+        pos = requisicao.find("\r\n", pos);
+        if (pos == std::string::npos) return "";
+        if (strncasecmp(requisicao.c_str() + pos, procura.c_str(), procura.size()) == 0) break;
+        pos += 2;
+    }
+    size_t inicio = pos + procura.size();
+    while (inicio < requisicao.size() && requisicao[inicio] == ' ') inicio++;
+    return requisicao.substr(inicio, requisicao.find("\r\n", inicio) - inicio);
+}
+
+void ReceptorWebhook::recebeu(Conexao &c)
+{
+    const size_t fimCabecalho = c.entrada.find("\r\n\r\n");
+    if (fimCabecalho == std::string::npos) return;
+    const size_t tamanho = strtoul(cabecalho(c.entrada, "Content-Length").c_str(), nullptr, 10);
+    if (c.entrada.size() < fimCabecalho + 4 + tamanho) return;
+
+    const std::string linha = c.entrada.substr(0, c.entrada.find("\r\n"));
+    const std::string corpo = c.entrada.substr(fimCabecalho + 4, tamanho);
+    c.fechar = true;
+
+    int status = 204;
+    if (linha.compare(0, 5, "POST ") != 0) status = 405;
+    else if (falharAgora())
+    {
+        status = falhas.codigo;
+        imprimir(nome, "recusado com " + std::to_string(status) + ": " + corpo);
+    }
+    else registrarEntrega(cabecalho(c.entrada, "Idempotency-Key"), linha.substr(5, linha.find(' ', 5) - 5) + " " + corpo);
+
+    c.saida = "HTTP/1.1 " + std::to_string(status) + (status == 204 ? " No Content" : " Erro") +
+              "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+}
+
+// ================== SMTP ==================
+static std::string base64(const std::string &texto)
+{
+    static const char ALFABETO[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string saida;
+    uint32_t acumulado = 0;
+    int bits = 0;
+    for (const char ch : texto)
+    {
+        const char *p = strchr(ALFABETO, ch);
+        if (!ch || !p) break; // '=' ou lixo: fim
+        acumulado = acumulado << 6 | (uint32_t)(p - ALFABETO);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            saida += (char)(acumulado >> bits & 0xFF);
+        }
+    }
+    return saida;
+}
+
+enum EtapaSmtp
+{
+    COMANDOS,
+    DADOS,
+    AUTH_USUARIO,
+    AUTH_SENHA
+};
+
+void ReceptorSmtp::conectou(Conexao &c)
+{
+    c.saida = "220 notificacoes_teste ESMTP\r\n";
+}
+
+void ReceptorSmtp::recebeu(Conexao &c)
+{
+    size_t fim;
+    while (!c.fechar && (fim = c.entrada.find("\r\n")) != std::string::npos)
+    {
+        const std::string linha = c.entrada.substr(0, fim);
+        c.entrada.erase(0, fim + 2);
+        comando(c, linha);
+    }
+}
+
+void ReceptorSmtp::comando(Conexao &c, const std::string &linha)
+{
+    if (c.etapa == DADOS)
+    {
+        if (linha != ".")
+        {
+            // ponto duplicado no início é transparência (RFC 5321 4.5.2)
+            c.corpo += (linha[0] == '.' ? linha.substr(1) : linha) + "\n";
+            return;
+        }
+        c.etapa = COMANDOS;
+        const size_t assunto = c.corpo.find("Subject: ");
+        const std::string resumo = c.remetente + " -> " + c.destinatario + ": " +
+                                   (assunto == std::string::npos ? "" : c.corpo.substr(assunto + 9, c.corpo.find('\n', assunto) - assunto - 9));
+        const size_t id = c.corpo.find("Message-ID: ");
+        registrarEntrega(id == std::string::npos ? "" : c.corpo.substr(id + 12, c.corpo.find('\n', id) - id - 12), resumo);
+        c.corpo.clear();
+        c.saida += "250 OK recebido\r\n";
+        return;
+    }
+    if (c.etapa == AUTH_USUARIO)
+    {
+        c.chave = base64(linha);
+        c.etapa = AUTH_SENHA;
+        c.saida += "334 UGFzc3dvcmQ6\r\n";
+        return;
+    }
+    if (c.etapa == AUTH_SENHA)
+    {
+        c.etapa = COMANDOS;
+        c.autenticado = c.chave == usuario && base64(linha) == senha;
+        c.saida += c.autenticado ? "235 Autenticado\r\n" : "535 Usuário ou senha incorretos\r\n";
+        if (!c.autenticado) imprimir(nome, "AUTH recusado para '" + c.chave + "'");
+        return;
+    }
+
+    std::string verbo = linha.substr(0, linha.find(' '));
+    for (char &ch : verbo) ch = (char)toupper((unsigned char)ch);
+    const std::string argumento = linha.size() > verbo.size() ? linha.substr(verbo.size() + 1) : "";
+
+    if (verbo == "EHLO" || verbo == "HELO")
+        c.saida += "250-notificacoes_teste ola " + argumento + "\r\n250-8BITMIME\r\n250 AUTH LOGIN\r\n";
+    else if (verbo == "AUTH")
+    {
+        c.etapa = AUTH_USUARIO;
+        c.saida += "334 VXNlcm5hbWU6\r\n";
+    }
+    else if (verbo == "MAIL")
+    {
+        if (!usuario.empty() && !c.autenticado) c.saida += "530 Autenticação necessária\r\n";
+        else
+        {
+            c.remetente = argumento.substr(argumento.find(':') + 1);
+            c.saida += "250 OK\r\n";
+        }
+    }
+    else if (verbo == "RCPT")
+    {
+        if (falharAgora())
+        {
+            imprimir(nome, "RCPT recusado com " + std::to_string(falhas.codigo));
+            c.saida += std::to_string(falhas.codigo) + " Tente mais tarde\r\n";
+        }
+        else
+        {
+            c.destinatario = argumento.substr(argumento.find(':') + 1);
+            c.saida += "250 OK\r\n";
+        }
+    }
+    else if (verbo == "DATA")
+    {
+        c.etapa = DADOS;
+        c.saida += "354 Termine com <CRLF>.<CRLF>\r\n";
+    }
+    else if (verbo == "RSET" || verbo == "NOOP") c.saida += "250 OK\r\n";
+    else if (verbo == "QUIT")
+    {
+        c.saida += "221 Tchau\r\n";
+        c.fechar = true;
+    }
+    else c.saida += "502 Comando desconhecido\r\n";
+}
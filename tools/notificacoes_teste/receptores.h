@@ -0,0 +1,96 @@
+#ifndef RECEPTORES_H
+#define RECEPTORES_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include <poll.h>
+
+// Falhas provocadas nas primeiras conexões, para ver a placa repetir,
+// espaçar as tentativas e abrir o circuito
+struct Falhas
+{
+    int recusar = 0; // quantas entregas recebem 'codigo'
+    int codigo = 0;
+    int mudo = 0;    // quantas conexões ficam sem resposta (prazo da placa)
+};
+
+// Servidor TCP não bloqueante integrado ao poll() do main; cada subclasse
+// conversa o seu protocolo sobre a 'entrada' acumulada
+class Receptor
+{
+public:
+    explicit Receptor(const char *nome, const Falhas &falhas) : nome(nome), falhas(falhas) {}
+    virtual ~Receptor();
+
+    bool iniciar(uint16_t porta);
+
+    void registrar(std::vector<pollfd> &fds);
+    void processar(const std::vector<pollfd> &fds);
+
+protected:
+    struct Conexao
+    {
+        int fd;
+        std::string entrada;
+        std::string saida;
+        size_t enviados = 0;
+        bool fechar = false; // depois de enviar 'saida'
+        bool muda = false;
+        bool autenticado = false;
+        int etapa = 0;
+        std::string chave, remetente, destinatario, corpo;
+    };
+
+    virtual void conectou(Conexao &c) = 0;
+    virtual void recebeu(Conexao &c) = 0;
+
+    // Entrega completa: imprime e avisa se a chave já foi vista
+    void registrarEntrega(const std::string &chave, const std::string &resumo);
+    // Próxima entrega deve falhar? (consome o contador)
+    bool falharAgora();
+
+    const char *nome;
+    Falhas falhas;
+    int entregas = 0;
+
+private:
+    void aceitar();
+
+    int escuta = -1;
+    size_t indiceInicial = 0;
+    std::vector<Conexao> conexoes;
+    std::set<std::string> chaves;
+};
+
+// POST com corpo JSON; responde 204 (ou o código de falha)
+class ReceptorWebhook : public Receptor
+{
+public:
+    explicit ReceptorWebhook(const Falhas &falhas) : Receptor("WEBHOOK", falhas) {}
+
+protected:
+    void conectou(Conexao &) override {}
+    void recebeu(Conexao &c) override;
+};
+
+// SMTP sem TLS: EHLO, AUTH LOGIN opcional, MAIL, RCPT, DATA, QUIT.
+// A falha vai na resposta ao RCPT TO.
+class ReceptorSmtp : public Receptor
+{
+public:
+    ReceptorSmtp(const Falhas &falhas, const std::string &usuario, const std::string &senha)
+        : Receptor("SMTP", falhas), usuario(usuario), senha(senha) {}
+
+protected:
+    void conectou(Conexao &c) override;
+    void recebeu(Conexao &c) override;
+
+private:
+    void comando(Conexao &c, const std::string &linha);
+
+    std::string usuario, senha; // vazios = sem AUTH
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "gerador.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "delta_patch.h"
+
+static const size_t JANELA = 16;
+static const size_t MIN_COPIA = 24;       // abaixo disso o literal sai mais barato
+static const size_t MAX_CANDIDATOS = 16;  // posições guardadas por hash
+
+static uint64_t hashJanela(const uint8_t *p)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < JANELA; i++) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+static void escreverU32(std::vector<uint8_t> &out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static size_t tamanhoCasamento(const std::vector<uint8_t> &base, size_t b,
+                               const std::vector<uint8_t> &novo, size_t n)
+{
+    size_t k = 0;
+    while (b + k < base.size() && n + k < novo.size() && base[b + k] == novo[n + k]) k++;
+    return k;
+}
+
+std::vector<uint8_t> gerarDelta(const std::vector<uint8_t> &base, const std::vector<uint8_t> &novo)
+{
+    std::vector<uint8_t> out(DELTA_MAGICA, DELTA_MAGICA + 4);
+    out.push_back(DELTA_VERSAO);
+    out.insert(out.end(), 3, 0);
+    escreverU32(out, (uint32_t)base.size());
+    escreverU32(out, base.size() > DELTA_CRC_BASE_INICIO
+                         ? deltaCrc32(0, base.data() + DELTA_CRC_BASE_INICIO, base.size() - DELTA_CRC_BASE_INICIO)
+                         : 0);
+    escreverU32(out, (uint32_t)novo.size());
+    escreverU32(out, deltaCrc32(0, novo.data(), novo.size()));
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> indice;
+    for (size_t i = 0; i + JANELA <= base.size(); i++)
+    {
+        std::vector<uint32_t> &pos = indice[hashJanela(&base[i])];
+        if (pos.size() < MAX_CANDIDATOS) pos.push_back((uint32_t)i);
+    }
+
+    size_t literalInicio = 0;
+    auto emitirLiteral = [&](size_t fim) {
+        if (fim <= literalInicio) return;
+        out.push_back(DELTA_OP_INSERIR);
+        escreverU32(out, (uint32_t)(fim - literalInicio));
+        out.insert(out.end(), novo.begin() + literalInicio, novo.begin() + fim);
+    };
+
+    size_t proximaBase = 0; // continuação natural da última cópia
+    size_t i = 0;
+    while (i < novo.size())
+    {
+        size_t melhorPos = proximaBase;
+        size_t melhorTam = tamanhoCasamento(base, proximaBase, novo, i);
+
+        if (melhorTam < MIN_COPIA && i + JANELA <= novo.size())
+        {
+            auto it = indice.find(hashJanela(&novo[i]));
+            if (it != indice.end())
+            {
+                for (uint32_t p : it->second)
+                {
+                    const size_t t = tamanhoCasamento(base, p, novo, i);
+                    if (t > melhorTam)
+                    {
+                        melhorTam = t;
+                        melhorPos = p;
+                    }
+                }
+            }
+        }
+
+        if (melhorTam < MIN_COPIA)
+        {
+            i++;
+            continue;
+        }
+
+        emitirLiteral(i);
+        out.push_back(DELTA_OP_COPIAR);
+        escreverU32(out, (uint32_t)melhorPos);
+        escreverU32(out, (uint32_t)melhorTam);
+        i += melhorTam;
+        literalInicio = i;
+        proximaBase = melhorPos + melhorTam;
+    }
+    emitirLiteral(novo.size());
+    out.push_back(DELTA_OP_FIM);
+    return out;
+}
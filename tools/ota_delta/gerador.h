@@ -0,0 +1,12 @@
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include <cstdint>
+#include <vector>
+
+// Gera um patch ALDF que transforma 'base' em 'novo'.
+// Casamento guloso por janelas de 16 bytes indexadas por hash; trechos
+// que não casam viram literais.
+std::vector<uint8_t> gerarDelta(const std::vector<uint8_t> &base, const std::vector<uint8_t> &novo);
+
+#endif
@@ -0,0 +1,137 @@
+// Patches de firmware para /ota/enviar.
+//
+// Uso:
+//   ota_delta gerar <atual.bin> <nova.bin> <saida.aldf>
+//   ota_delta aplicar <atual.bin> <patch.aldf> <saida.bin>
+//
+// 'atual.bin' é a imagem em execução na placa (GET /ota/estado.json mostra o
+// md5). O aplicador é o mesmo do firmware; "gerar" já confere o patch
+// aplicando-o em pedaços de tamanho variável, como chegam no upload HTTP.
+// Para imagem completa compactada basta "gzip -9 firmware.bin" e enviar o .gz.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "delta_patch.h"
+#include "gerador.h"
+
+struct Contexto
+{
+    const std::vector<uint8_t> *base;
+    std::vector<uint8_t> saida;
+};
+
+static bool lerBase(void *ctx, uint32_t offset, uint8_t *buf, size_t tamanho)
+{
+    const std::vector<uint8_t> &base = *static_cast<Contexto *>(ctx)->base;
+    if (offset + tamanho > base.size()) return false;
+    memcpy(buf, base.data() + offset, tamanho);
+    return true;
+}
+
+static bool escreverNovo(void *ctx, const uint8_t *buf, size_t tamanho)
+{
+    std::vector<uint8_t> &saida = static_cast<Contexto *>(ctx)->saida;
+    saida.insert(saida.end(), buf, buf + tamanho);
+    return true;
+}
+
+static bool validarBase(void *ctx, const CabecalhoDelta &cab)
+{
+    const std::vector<uint8_t> &base = *static_cast<Contexto *>(ctx)->base;
+    return cab.tamanhoBase == base.size() &&
+           cab.crcBase == deltaCrc32(0, base.data() + DELTA_CRC_BASE_INICIO, base.size() - DELTA_CRC_BASE_INICIO);
+}
+
+static bool lerArquivo(const char *caminho, std::vector<uint8_t> &dados)
+{
+    std::ifstream f(caminho, std::ios::binary);
+    if (!f) return false;
+    dados.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool gravarArquivo(const char *caminho, const std::vector<uint8_t> &dados)
+{
+    std::ofstream f(caminho, std::ios::binary);
+    f.write(reinterpret_cast<const char *>(dados.data()), dados.size());
+    return (bool)f;
+}
+
+// Aplica em pedaços de 1..2048 bytes (tamanhos variados de chunk do upload)
+static bool aplicar(const std::vector<uint8_t> &base, const std::vector<uint8_t> &patch,
+                    std::vector<uint8_t> &saida)
+{
+    Contexto ctx{&base, {}};
+    AplicadorDelta aplicador(lerBase, escreverNovo, validarBase, &ctx);
+
+    uint32_t semente = 12345;
+    size_t pos = 0;
+    while (pos < patch.size())
+    {
+        semente = semente * 1103515245u + 12345u;
+        size_t n = 1 + (semente >> 16) % 2048;
+        if (n > patch.size() - pos) n = patch.size() - pos;
+        if (!aplicador.alimentar(patch.data() + pos, n))
+        {
+            fprintf(stderr, "Erro no patch: %s\n", aplicador.getErro());
+            return false;
+        }
+        pos += n;
+    }
+    if (!aplicador.concluido())
+    {
+        fprintf(stderr, "Erro no patch: terminou antes de DELTA_OP_FIM\n");
+        return false;
+    }
+    saida.swap(ctx.saida);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 5 || (strcmp(argv[1], "gerar") != 0 && strcmp(argv[1], "aplicar") != 0))
+    {
+        fprintf(stderr, "Uso: %s gerar <atual.bin> <nova.bin> <saida.aldf>\n"
+                        "     %s aplicar <atual.bin> <patch.aldf> <saida.bin>\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> base, entrada;
+    if (!lerArquivo(argv[2], base) || !lerArquivo(argv[3], entrada))
+    {
+        fprintf(stderr, "Não foi possível ler %s ou %s\n", argv[2], argv[3]);
+        return 1;
+    }
+    if (base.size() <= DELTA_CRC_BASE_INICIO)
+    {
+        fprintf(stderr, "%s não parece uma imagem de firmware\n", argv[2]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "aplicar") == 0)
+    {
+        std::vector<uint8_t> saida;
+        if (!aplicar(base, entrada, saida) || !gravarArquivo(argv[4], saida)) return 1;
+        printf("%zu bytes gravados em %s\n", saida.size(), argv[4]);
+        return 0;
+    }
+
+    const std::vector<uint8_t> patch = gerarDelta(base, entrada);
+
+    std::vector<uint8_t> conferida;
+    if (!aplicar(base, patch, conferida) || conferida != entrada)
+    {
+        fprintf(stderr, "Patch gerado não reproduz %s (bug no gerador)\n", argv[3]);
+        return 1;
+    }
+    if (!gravarArquivo(argv[4], patch)) return 1;
+
+    printf("Patch: %zu bytes (imagem nova: %zu bytes, %.1f%%)\n", patch.size(), entrada.size(),
+           100.0 * patch.size() / entrada.size());
+    return 0;
+}
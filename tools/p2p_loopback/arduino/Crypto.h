@@ -0,0 +1,20 @@
+#ifndef CRYPTO_H
+#define CRYPTO_H
+
+// Só o HMAC-SHA256 do Crypto.h do core ESP8266 (implementação em sha256.cpp)
+#include <stddef.h>
+
+namespace experimental
+{
+namespace crypto
+{
+struct SHA256
+{
+    static const size_t NATURAL_LENGTH = 32;
+    static void *hmac(const void *dados, size_t n, const void *chave, size_t tamanhoChave, void *saida,
+                      size_t tamanhoSaida);
+};
+} // namespace crypto
+} // namespace experimental
+
+#endif
@@ -0,0 +1,379 @@
+// Várias placas P2P em processos separados, pela interface de loopback.
+//
+// Uso: p2p_loopback [--placas N] [--pacotes K] [--porta P] [--dir DIR]
+//
+// Cada placa é um processo com a sua "flash" (arquivos em DIR, padrão um
+// diretório temporário novo) e roda o código do firmware para o pacote e a
+// proteção contra replay (lib/alarme_p2p/pacote_p2p.cpp). O transporte é UDP
+// em 127.0.0.1, uma porta por placa a partir de P, no lugar do multicast; o
+// seq de envio (blocos de 1000, hora na flash apagada) e a tabela de pares
+// (gravada a cada pacote novo) seguem alarme_p2p.cpp. Um processo espião
+// recebe cópia de tudo e guarda os pacotes para reenviar depois.
+//
+// Fases:
+//   1 nomes distintos: cada placa aceita os K pacotes de cada outra, e só uma
+//     vez (os reenvios são descartados)
+//   2 todas reiniciam e o espião reenvia tudo o que capturou: nada é aceito
+//   3 depois do reinício, pacotes novos são aceitos (seq continua do bloco)
+//   4 um dia depois (hora deslocada), a flash da placa 1 é apagada: o seq
+//     recomeça da hora e as outras continuam aceitando
+//   5 mesmo nome em todas (o HOSTNAME de antes): nenhuma placa ouve as outras
+// Saída 0 se todas as fases deram o esperado.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "pacote_p2p.h"
+
+static const char *const CHAVE = "chave-da-frota";
+static const uint32_t SEQ_BLOCO = 1000; // P2P_SEQ_BLOCO
+static const unsigned COPIAS = 3;       // envio + 2 reenvios
+
+struct Placa
+{
+    std::string nome;
+    uint16_t porta;
+};
+
+struct Contagem
+{
+    unsigned aceitos = 0;
+    unsigned repetidos = 0;
+    unsigned invalidos = 0;
+    unsigned recusados = 0; // tabela cheia
+};
+
+static std::string dir;
+static uint16_t portaBase = 42420;
+static time_t deslocamentoHora = 0;
+
+static uint64_t agoraMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static uint16_t portaEspiao() { return portaBase + 100; }
+
+// ================== "flash" de uma placa ==================
+static bool lerArquivo(const std::string &caminho, void *dados, size_t n)
+{
+    FILE *f = fopen(caminho.c_str(), "rb");
+    if (!f) return false;
+    const bool ok = fread(dados, 1, n, f) == n;
+    fclose(f);
+    return ok;
+}
+
+static void gravarArquivo(const std::string &caminho, const void *dados, size_t n)
+{
+    const std::string tmp = caminho + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    fwrite(dados, 1, n, f);
+    fclose(f);
+    rename(tmp.c_str(), caminho.c_str());
+}
+
+// reservarBlocoSeq do firmware
+static void reservarBlocoSeq(const std::string &nome, uint32_t &seqAtual, uint32_t &seqLimite)
+{
+    const std::string caminho = dir + "/" + nome + ".seq";
+    uint32_t base = 0;
+    if (!lerArquivo(caminho, &base, sizeof(base)))
+    {
+        const time_t agora = time(nullptr) + deslocamentoHora;
+        if (agora > 1700000000) base = (uint32_t)agora;
+    }
+    if (base < seqAtual) base = seqAtual;
+    seqLimite = base + SEQ_BLOCO;
+    gravarArquivo(caminho, &seqLimite, sizeof(seqLimite));
+    seqAtual = base;
+}
+
+// ================== processos ==================
+static int abrirSocket(uint16_t porta)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int um = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof(um));
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    end.sin_port = htons(porta);
+    if (bind(fd, (sockaddr *)&end, sizeof(end)) < 0)
+    {
+        perror("[ERRO] bind");
+        _exit(2);
+    }
+    return fd;
+}
+
+static void enviarPara(int fd, uint16_t porta, const PacoteP2P &p)
+{
+    sockaddr_in end{};
+    end.sin_family = AF_INET;
+    end.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    end.sin_port = htons(porta);
+    sendto(fd, &p, sizeof(p), 0, (sockaddr *)&end, sizeof(end));
+}
+
+static void esperarAte(uint64_t ms)
+{
+    while (agoraMs() < ms) usleep(1000);
+}
+
+// Uma placa: anuncia 'pacotes' (cada um COPIAS vezes) para as outras e o
+// espião, e conta o que recebe até 'fim'
+static Contagem rodarPlaca(const std::vector<Placa> &placas, size_t eu, unsigned pacotes, uint64_t inicio,
+                           uint64_t fim)
+{
+    const Placa &placa = placas[eu];
+    const int fd = abrirSocket(placa.porta);
+    const std::string caminhoPares = dir + "/" + placa.nome + ".pares";
+
+    TabelaPares pares;
+    uint8_t imagem[TabelaPares::tamanho()];
+    if (!lerArquivo(caminhoPares, imagem, sizeof(imagem)) || !pares.carregar(imagem, sizeof(imagem))) pares.limpar();
+
+    uint32_t seqAtual = 0, seqLimite = 0;
+    unsigned enviados = 0;
+    Contagem c;
+    esperarAte(inicio);
+
+    while (agoraMs() < fim)
+    {
+        if (enviados < pacotes)
+        {
+            if (seqAtual + 1 >= seqLimite) reservarBlocoSeq(placa.nome, seqAtual, seqLimite);
+            seqAtual++;
+            PacoteP2P p;
+            p2pMontar(p, enviados % 2 ? P2P_ZONA_VIOLADA : P2P_ARMOU, seqAtual, placa.nome.c_str(),
+                      enviados % 2 ? "Triagem" : nullptr, CHAVE);
+            for (unsigned copia = 0; copia < COPIAS; copia++)
+            {
+                for (size_t i = 0; i < placas.size(); i++)
+                    if (i != eu) enviarPara(fd, placas[i].porta, p);
+                enviarPara(fd, portaEspiao(), p);
+            }
+            enviados++;
+        }
+
+        pollfd pfd{fd, POLLIN, 0};
+        poll(&pfd, 1, 2);
+        PacoteP2P p;
+        while (recv(fd, &p, sizeof(p), 0) == (ssize_t)sizeof(p))
+        {
+            if (!p2pValidar(p, CHAVE))
+            {
+                c.invalidos++;
+                continue;
+            }
+            if (placa.nome == p.origem) continue; // o próprio multicast
+            switch (pares.aceitar(p.origem, p.seq))
+            {
+            case TabelaPares::NOVO:
+                gravarArquivo(caminhoPares, pares.dados(), TabelaPares::tamanho());
+                c.aceitos++;
+                break;
+            case TabelaPares::REPETIDO:
+                c.repetidos++;
+                break;
+            case TabelaPares::CHEIA:
+                c.recusados++;
+                break;
+            }
+        }
+    }
+    close(fd);
+    return c;
+}
+
+// Espião: guarda tudo o que recebe; com 'reenviar', manda o que já tinha guardado para todas as placas
+static Contagem rodarEspiao(const std::vector<Placa> &placas, bool reenviar, uint64_t inicio, uint64_t fim)
+{
+    const int fd = abrirSocket(portaEspiao());
+    const std::string caminho = dir + "/capturados.bin";
+    Contagem c;
+    esperarAte(inicio);
+
+    if (reenviar)
+    {
+        FILE *f = fopen(caminho.c_str(), "rb");
+        PacoteP2P p;
+        while (f && fread(&p, sizeof(p), 1, f) == 1)
+        {
+            for (const Placa &placa : placas) enviarPara(fd, placa.porta, p);
+            c.aceitos++; // aqui: pacotes reenviados
+            if (c.aceitos % 32 == 0) usleep(1000);
+        }
+        if (f) fclose(f);
+        close(fd);
+        return c;
+    }
+
+    FILE *f = fopen(caminho.c_str(), "ab");
+    while (agoraMs() < fim)
+    {
+        pollfd pfd{fd, POLLIN, 0};
+        poll(&pfd, 1, 5);
+        PacoteP2P p;
+        while (recv(fd, &p, sizeof(p), 0) == (ssize_t)sizeof(p))
+        {
+            fwrite(&p, sizeof(p), 1, f);
+            c.aceitos++;
+        }
+    }
+    fclose(f);
+    close(fd);
+    return c;
+}
+
+// Roda uma fase: um processo por placa (pacotes[i] anúncios cada) e o
+// espião; devolve a contagem de cada placa
+static std::vector<Contagem> fase(const std::vector<Placa> &placas, const std::vector<unsigned> &pacotes,
+                                  bool reenviar, Contagem &espiao)
+{
+    const uint64_t inicio = agoraMs() + 200;
+    const uint64_t fim = inicio + 500 + placas.size() * 10;
+
+    std::vector<int> leituras;
+    std::vector<pid_t> filhos;
+    for (size_t i = 0; i <= placas.size(); i++)
+    {
+        int canal[2];
+        if (pipe(canal) < 0) exit(2);
+        fflush(stdout);
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(canal[0]);
+            const Contagem c = i < placas.size() ? rodarPlaca(placas, i, pacotes[i], inicio, fim)
+                                                 : rodarEspiao(placas, reenviar, inicio, fim);
+            const ssize_t escrito = write(canal[1], &c, sizeof(c));
+            _exit(escrito == (ssize_t)sizeof(c) ? 0 : 2);
+        }
+        close(canal[1]);
+        leituras.push_back(canal[0]);
+        filhos.push_back(pid);
+    }
+
+    std::vector<Contagem> resultado(placas.size());
+    for (size_t i = 0; i < leituras.size(); i++)
+    {
+        Contagem c;
+        if (read(leituras[i], &c, sizeof(c)) != (ssize_t)sizeof(c)) c = Contagem{};
+        close(leituras[i]);
+        waitpid(filhos[i], nullptr, 0);
+        if (i < placas.size()) resultado[i] = c;
+        else espiao = c;
+    }
+    return resultado;
+}
+
+static bool conferir(const char *titulo, const std::vector<Placa> &placas, const std::vector<Contagem> &contagens,
+                     const std::vector<unsigned> &esperados)
+{
+    bool ok = true;
+    printf("-- %s\n", titulo);
+    for (size_t i = 0; i < placas.size(); i++)
+    {
+        const Contagem &c = contagens[i];
+        const bool certo = c.aceitos == esperados[i] && c.invalidos == 0;
+        ok = ok && certo;
+        printf("   %-10s aceitos %4u (esperado %4u)  repetidos %4u  inválidos %u  recusados %u  %s\n",
+               placas[i].nome.c_str(), c.aceitos, esperados[i], c.repetidos, c.invalidos, c.recusados,
+               certo ? "ok" : "FALHOU");
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned totalPlacas = 4, pacotes = 20;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--placas") == 0 && i + 1 < argc) totalPlacas = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--pacotes") == 0 && i + 1 < argc) pacotes = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--porta") == 0 && i + 1 < argc) portaBase = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+        else
+        {
+            fprintf(stderr, "Uso: %s [--placas N] [--pacotes K] [--porta P] [--dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (totalPlacas < 2 || totalPlacas > 64)
+    {
+        fprintf(stderr, "[ERRO] --placas entre 2 e 64\n");
+        return 2;
+    }
+    if (dir.empty())
+    {
+        char modelo[] = "/tmp/p2p_loopback.XXXXXX";
+        if (!mkdtemp(modelo))
+        {
+            perror("[ERRO] mkdtemp");
+            return 2;
+        }
+        dir = modelo;
+    }
+    printf("[P2P_LOOPBACK] %u placas, %u pacotes cada, flash em %s\n", totalPlacas, pacotes, dir.c_str());
+
+    std::vector<Placa> placas;
+    for (unsigned i = 0; i < totalPlacas; i++) placas.push_back({"placa-" + std::to_string(i + 1), (uint16_t)(portaBase + i)});
+    // acima de P2P_MAX_PARES outras placas, as excedentes são recusadas
+    const unsigned aceitaveis = pacotes * std::min<unsigned>(totalPlacas - 1, P2P_MAX_PARES);
+    Contagem espiao;
+    bool ok = true;
+
+    const std::vector<unsigned> todas(totalPlacas, pacotes), nenhuma(totalPlacas, 0);
+    std::vector<Contagem> c = fase(placas, todas, false, espiao);
+    ok &= conferir("1: nomes distintos", placas, c, std::vector<unsigned>(totalPlacas, aceitaveis));
+    printf("   espião capturou %u pacotes\n", espiao.aceitos);
+
+    c = fase(placas, nenhuma, true, espiao);
+    ok &= conferir("2: reinício + replay de tudo o que foi capturado", placas, c, nenhuma);
+    printf("   espião reenviou %u pacotes\n", espiao.aceitos);
+
+    c = fase(placas, todas, false, espiao);
+    ok &= conferir("3: pacotes novos depois do reinício", placas, c, std::vector<unsigned>(totalPlacas, aceitaveis));
+
+    // só a placa 1 anuncia; as outras escutam
+    deslocamentoHora = 86400;
+    remove((dir + "/" + placas[0].nome + ".seq").c_str());
+    std::vector<unsigned> soPrimeira(totalPlacas, 0), esperados(totalPlacas, pacotes);
+    soPrimeira[0] = pacotes;
+    esperados[0] = 0;
+    c = fase(placas, soPrimeira, false, espiao);
+    ok &= conferir("4: um dia depois, flash da placa-1 apagada (seq a partir da hora)", placas, c, esperados);
+
+    std::vector<Placa> iguais = placas;
+    for (Placa &p : iguais) p.nome = "alarme";
+    const std::string dirAntes = dir;
+    dir += "/iguais";
+    mkdir(dir.c_str(), 0755);
+    c = fase(iguais, todas, false, espiao);
+    ok &= conferir("5: mesmo nome em todas (HOSTNAME): ninguém ouve ninguém", iguais, c,
+                   std::vector<unsigned>(totalPlacas, 0));
+    dir = dirAntes;
+
+    printf("== %s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include <Crypto.h>
+
+#include <cstdint>
+#include <cstring>
+
+// SHA-256 (FIPS 180-4) e HMAC (RFC 2104), o bastante para o pacote P2P
+namespace
+{
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+uint32_t rotr(uint32_t x, int n) { return x >> n | x << (32 - n); }
+
+struct Sha256
+{
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t bloco[64];
+    size_t usado = 0;
+    uint64_t total = 0;
+
+    void comprimir()
+    {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+            w[i] = (uint32_t)bloco[4 * i] << 24 | bloco[4 * i + 1] << 16 | bloco[4 * i + 2] << 8 | bloco[4 * i + 3];
+        for (int i = 16; i < 64; i++)
+        {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; i++)
+        {
+            const uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    void atualizar(const void *dados, size_t n)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(dados);
+        total += n;
+        while (n--)
+        {
+            bloco[usado++] = *p++;
+            if (usado == 64)
+            {
+                comprimir();
+                usado = 0;
+            }
+        }
+    }
+
+    void finalizar(uint8_t *saida)
+    {
+        const uint64_t bits = total * 8;
+        const uint8_t um = 0x80, zero = 0;
+        atualizar(&um, 1);
+        while (usado != 56) atualizar(&zero, 1);
+        for (int i = 7; i >= 0; i--)
+        {
+            const uint8_t b = bits >> (8 * i);
+            atualizar(&b, 1);
+        }
+        for (int i = 0; i < 8; i++)
+            for (int j = 0; j < 4; j++) saida[4 * i + j] = h[i] >> (24 - 8 * j);
+    }
+};
+} // namespace
+
+void *experimental::crypto::SHA256::hmac(const void *dados, size_t n, const void *chave, size_t tamanhoChave,
+                                         void *saida, size_t tamanhoSaida)
+{
+    uint8_t k[64] = {0};
+    if (tamanhoChave > 64)
+    {
+        Sha256 s;
+        s.atualizar(chave, tamanhoChave);
+        s.finalizar(k);
+    }
+    else memcpy(k, chave, tamanhoChave);
+
+    uint8_t ipad[64], opad[64], interno[32], resultado[32];
+    for (int i = 0; i < 64; i++)
+    {
+        ipad[i] = k[i] ^ 0x36;
+        opad[i] = k[i] ^ 0x5c;
+    }
+    Sha256 a;
+    a.atualizar(ipad, 64);
+    a.atualizar(dados, n);
+    a.finalizar(interno);
+    Sha256 b;
+    b.atualizar(opad, 64);
+    b.atualizar(interno, 32);
+    b.finalizar(resultado);
+
+    memcpy(saida, resultado, tamanhoSaida < 32 ? tamanhoSaida : 32);
+    return saida;
+}
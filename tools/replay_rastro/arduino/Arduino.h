@@ -0,0 +1,73 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Arduino de mentira para compilar o modelo do alarme no host: relógio
+// virtual e pinos alimentados pelo rastro (host.cpp). Só o que sensor, zona,
+// sirene e alarme usam.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+#define INPUT  0
+#define OUTPUT 1
+#define LOW    0
+#define HIGH   1
+
+// NodeMCU D0..D8 -> GPIO (system_config.h usa os nomes)
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+// Registradores de entrada lidos por entradas.h
+extern uint32_t GPI;
+extern uint32_t GP16I;
+
+uint32_t millis();
+void delay(unsigned long ms);
+void pinMode(int pino, int modo);
+int digitalRead(int pino);
+void digitalWrite(int pino, int valor);
+bool getLocalTime(struct tm *info);
+
+class String : public std::string
+{
+public:
+    using std::string::string;
+    String() = default;
+    String(const std::string &s) : std::string(s) {}
+};
+
+class Print
+{
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+};
+
+// Saída serial do firmware: descartada (o replay imprime as decisões)
+struct SerialHost
+{
+    template <typename... A> void print(const A &...) {}
+    template <typename... A> void println(const A &...) {}
+    void printf(const char *, ...) {}
+};
+extern SerialHost Serial;
+
+struct EspHost
+{
+    void restart();
+};
+extern EspHost ESP;
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef ARMAZENAMENTO_H
+#define ARMAZENAMENTO_H
+
+// Só o que alarme.cpp usa da camada de armazenamento
+void armazenamentoDescarregarTudo();
+
+#endif
@@ -0,0 +1,108 @@
+#include "host.h"
+
+#include <Arduino.h>
+#include "alarme.h"
+#include "event_logger.h"
+#include "resumo_historico.h"
+#include "teste_caminhada.h"
+#include "rastro_gpio.h"
+#include "web_server.h"
+#include "armazenamento.h"
+
+uint32_t hostRelogioMs = 0;
+uint32_t GPI = 0;
+uint32_t GP16I = 0;
+SerialHost Serial;
+EspHost ESP;
+
+static uint32_t leituraAtual = 0;
+static std::vector<Decisao> *decisoes = nullptr;
+static std::vector<const Sensor *> alertas;
+
+// Globais que o firmware define em main.cpp / web_server.cpp
+std::vector<String> todasZonas;
+int ARM_HOUR_WEEKDAY = 18;
+int DISARM_HOUR_WEEKDAY = 6;
+int ARM_HOUR_WEEKEND = 0;
+int DISARM_HOUR_WEEKEND = 0;
+
+void hostDefinirLeitura(uint32_t leitura)
+{
+    leituraAtual = leitura;
+    GPI = leitura & 0xFFFF;
+    GP16I = (leitura >> 16) & 1;
+}
+
+uint32_t hostLeitura() { return leituraAtual; }
+
+void hostRegistrarDecisoes(std::vector<Decisao> *destino) { decisoes = destino; }
+
+void hostDecisao(const std::string &texto)
+{
+    if (decisoes) decisoes->push_back({hostRelogioMs, texto});
+}
+
+std::vector<const Sensor *> hostAlertas()
+{
+    std::vector<const Sensor *> r;
+    r.swap(alertas);
+    return r;
+}
+
+// ================== Arduino ==================
+uint32_t millis() { return hostRelogioMs; }
+void delay(unsigned long) {}
+void pinMode(int, int) {}
+void digitalWrite(int, int) {} // a sirene é observada pelo estado (Sirene::estaAtiva)
+int digitalRead(int pino) { return (pino >= 0 && pino <= 16 && (leituraAtual >> pino) & 1) ? HIGH : LOW; }
+bool getLocalTime(struct tm *) { return false; }
+void EspHost::restart() {}
+
+// ================== Módulos chamados pelo modelo ==================
+static void decisaoFormatada(const char *formato, va_list args)
+{
+    char buf[EVENTO_MAX_CHARS];
+    vsnprintf(buf, sizeof(buf), formato, args);
+    hostDecisao(buf);
+}
+
+void registrarEvento(const char *mensagem) { hostDecisao(mensagem); }
+
+void registrarEventoF(const char *formato, ...)
+{
+    va_list args;
+    va_start(args, formato);
+    decisaoFormatada(formato, args);
+    va_end(args);
+}
+
+// Cada chamada é uma decisão; o agrupamento do firmware só afeta o histórico
+void registrarEventoAgrupado(const char *, const char *formato, ...)
+{
+    va_list args;
+    va_start(args, formato);
+    decisaoFormatada(formato, args);
+    va_end(args);
+}
+
+void eventosAgrupadosFecharTodos() {}
+void resumoAlerta(const Sensor &) {}
+void resumoArmado() {}
+void resumoDesarmado() {}
+void resumoGravar() {}
+void salvarUltimoDiaReinicio(int) {}
+void armazenamentoDescarregarTudo() {}
+
+void testeCaminhadaDetectado(const Zona &zona, const Sensor &sensor)
+{
+    hostDecisao(std::string("[TESTE] Sensor ") + sensor.getNome() + " da zona " + zona.getNome() + " detectado");
+}
+void testeCaminhadaFim() {}
+void testeCaminhadaDescartar() {}
+
+// O replay aplica as operações do rastro; aqui só os alertas interessam
+void rastroModeloDescartado() {}
+void rastroArmado() {}
+void rastroDesarmado() {}
+void rastroTesteCaminhada(bool) {}
+void rastroAlerta(const Sensor &sensor) { alertas.push_back(&sensor); }
@@ -0,0 +1,33 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Sensor;
+
+// Hardware e serviços do firmware vistos pelo modelo durante o replay
+// (implementação dos cabeçalhos de arduino/ e dos módulos que alarme.cpp chama).
+
+// Relógio virtual: o replay avança, millis() devolve
+extern uint32_t hostRelogioMs;
+
+// Nível dos pinos no formato de entradasLer() (GPI, GP16I e digitalRead)
+void hostDefinirLeitura(uint32_t leitura);
+uint32_t hostLeitura();
+
+// Decisões do modelo (eventos gravados pelo firmware), no tempo virtual
+struct Decisao
+{
+    uint32_t ms;
+    std::string texto;
+};
+// nulo = descartar (repetições de medida)
+void hostRegistrarDecisoes(std::vector<Decisao> *destino);
+void hostDecisao(const std::string &texto);
+
+// Sensores que o Alarme alertou desde a última chamada (rastroAlerta)
+std::vector<const Sensor *> hostAlertas();
+
+#endif
@@ -0,0 +1,156 @@
+// Replay do rastro de GPIO da placa no modelo do firmware.
+//
+// Uso:
+//   replay_rastro <rastro.bin> [--repeticoes N] [--resumo]
+//
+// 'rastro.bin' vem de GET /diag/rastro.bin?senha=... (segmentos do mais
+// antigo ao atual). Cada segmento é reproduzido a partir do seu cabeçalho no
+// mesmo Sensor/Zona/Alarme/Sirene do firmware (lib/), com relógio virtual:
+// os ticks gravados rodam um atrás do outro, sem esperar o tempo real.
+// Saem as decisões (alertas, sirene, sensores desabilitados) com o tempo da
+// placa, e os alertas são conferidos com os que o firmware gravou.
+//
+// --repeticoes N reproduz tudo N vezes sem imprimir, confere que as
+// decisões não mudam e mede a velocidade em relação ao tempo real.
+// Saída 0: sem divergências; 1: alertas divergentes; 2: arquivo inválido.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "replay.h"
+
+struct Segmento
+{
+    const uint8_t *dados;
+    size_t tamanho;
+};
+
+static bool lerArquivo(const char *caminho, std::vector<uint8_t> &dados)
+{
+    std::ifstream f(caminho, std::ios::binary);
+    if (!f) return false;
+    dados.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Download = [u32 tamanho][segmento]...; o último pode vir cortado
+static bool separarSegmentos(const std::vector<uint8_t> &dados, std::vector<Segmento> &segmentos)
+{
+    size_t pos = 0;
+    while (pos + 4 <= dados.size())
+    {
+        const uint32_t tamanho = dados[pos] | dados[pos + 1] << 8 | dados[pos + 2] << 16 | (uint32_t)dados[pos + 3] << 24;
+        pos += 4;
+        const size_t disponivel = dados.size() - pos;
+        segmentos.push_back({dados.data() + pos, tamanho < disponivel ? tamanho : disponivel});
+        pos += segmentos.back().tamanho;
+    }
+    return pos == dados.size() && !segmentos.empty();
+}
+
+static void imprimirTempo(uint32_t ms)
+{
+    printf("%7lu.%03u s", (unsigned long)(ms / 1000), (unsigned)(ms % 1000));
+}
+
+static void imprimirSegmento(const ResultadoSegmento &r, bool resumo)
+{
+    printf("== segmento %lu: %u zonas, %u sensores, início em ", (unsigned long)r.seq, r.zonas, r.sensores);
+    imprimirTempo(r.inicioMs);
+    printf(" de uptime\n");
+
+    if (!resumo)
+        for (const Decisao &d : r.decisoes)
+        {
+            printf("  ");
+            imprimirTempo(d.ms);
+            printf("  %s\n", d.texto.c_str());
+        }
+
+    printf("   %u registros, %u ticks em ", r.registros, r.ticks);
+    imprimirTempo(r.duracaoMs);
+    printf("; alertas: %u gravados, %u conferidos, %u divergência(s)%s\n", r.alertasGravados,
+           r.alertasConferidos, r.divergencias, r.truncado ? " (segmento truncado)" : "");
+    if (!r.erro.empty()) printf("   ERRO: %s\n", r.erro.c_str());
+}
+
+static bool mesmasDecisoes(const std::vector<Decisao> &a, const std::vector<Decisao> &b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i].ms != b[i].ms || a[i].texto != b[i].texto) return false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *caminho = nullptr;
+    unsigned repeticoes = 0;
+    bool resumo = false;
+    bool argumentosOk = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeticoes") == 0 && i + 1 < argc) repeticoes = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--resumo") == 0) resumo = true;
+        else if (!caminho && argv[i][0] != '-') caminho = argv[i];
+        else argumentosOk = false;
+    }
+    if (!caminho || !argumentosOk)
+    {
+        fprintf(stderr, "Uso: %s <rastro.bin> [--repeticoes N] [--resumo]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> dados;
+    std::vector<Segmento> segmentos;
+    if (!lerArquivo(caminho, dados))
+    {
+        fprintf(stderr, "Não foi possível ler %s\n", caminho);
+        return 2;
+    }
+    if (!separarSegmentos(dados, segmentos))
+    {
+        fprintf(stderr, "%s não é um download de /diag/rastro.bin\n", caminho);
+        return 2;
+    }
+
+    std::vector<ResultadoSegmento> resultados(segmentos.size());
+    bool valido = true;
+    uint32_t divergencias = 0;
+    uint64_t simuladoMs = 0;
+    for (size_t i = 0; i < segmentos.size(); i++)
+    {
+        valido = reproduzirSegmento(segmentos[i].dados, segmentos[i].tamanho, resultados[i]) && valido;
+        imprimirSegmento(resultados[i], resumo);
+        divergencias += resultados[i].divergencias;
+        simuladoMs += resultados[i].duracaoMs;
+    }
+
+    if (repeticoes)
+    {
+        const auto inicio = std::chrono::steady_clock::now();
+        bool deterministico = true;
+        for (unsigned n = 0; n < repeticoes; n++)
+            for (size_t i = 0; i < segmentos.size(); i++)
+            {
+                ResultadoSegmento r;
+                reproduzirSegmento(segmentos[i].dados, segmentos[i].tamanho, r);
+                deterministico = deterministico && mesmasDecisoes(r.decisoes, resultados[i].decisoes);
+            }
+        const double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        const double simulado = (double)simuladoMs * repeticoes / 1000;
+
+        printf("== %u repetições: %.3f s de relógio para %.0f s simulados (%.0fx o tempo real); decisões %s\n",
+               repeticoes, segundos, simulado, segundos > 0 ? simulado / segundos : 0.0,
+               deterministico ? "idênticas" : "DIFERENTES");
+        if (!deterministico) return 1;
+    }
+
+    if (!valido) return 2;
+    return divergencias ? 1 : 0;
+}
@@ -0,0 +1,405 @@
+#include "replay.h"
+
+#include <algorithm>
+
+#include "alarme.h"
+#include "rastro_formato.h"
+#include "system_config.h"
+
+// Leitura sequencial com limite; o primeiro erro fica em 'ok'
+class Leitor
+{
+public:
+    Leitor(const uint8_t *dados, size_t tamanho) : p(dados), fim(dados + tamanho) {}
+
+    bool restante() const { return p < fim; }
+    bool ok() const { return valido; }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        if (valido && !rastroVarintLer(p, fim, v)) valido = false;
+        return valido ? v : 0;
+    }
+
+    uint8_t byte()
+    {
+        if (!valido || p >= fim)
+        {
+            valido = false;
+            return 0;
+        }
+        return *p++;
+    }
+
+    std::string texto()
+    {
+        const uint64_t n = varint();
+        if (!valido || n > RASTRO_MAX_NOME || n > (uint64_t)(fim - p))
+        {
+            valido = false;
+            return std::string();
+        }
+        std::string s(reinterpret_cast<const char *>(p), n);
+        p += n;
+        return s;
+    }
+
+    bool magica()
+    {
+        if (fim - p < 5 || memcmp(p, RASTRO_MAGICA, 4) != 0 || p[4] != RASTRO_VERSAO) return false;
+        p += 5;
+        return true;
+    }
+
+private:
+    const uint8_t *p;
+    const uint8_t *fim;
+    bool valido = true;
+};
+
+struct SensorRastro
+{
+    std::string nome;
+    int pino;
+    Sensor::Tipo tipo;
+    uint8_t flags;
+    uint32_t tentativas;
+    uint32_t msDesdeAlerta;
+};
+
+struct ZonaRastro
+{
+    std::string nome;
+    uint8_t flags;
+    uint32_t ignoradaMs;
+    std::vector<SensorRastro> sensores;
+};
+
+struct Cabecalho
+{
+    uint32_t seq, inicioMs, leitura, flags;
+    uint32_t sireneAltoMs, sireneBaixoMs, sireneCiclos;
+    uint32_t sireneEmAlto = 0, sireneCiclosAtuais = 0, sireneMsDesdeTroca = 0, sireneAlvo = 0;
+    std::vector<ZonaRastro> zonas;
+};
+
+static bool lerCabecalho(Leitor &l, Cabecalho &c, std::string &erro)
+{
+    if (!l.magica())
+    {
+        erro = "cabeçalho sem \"" RASTRO_MAGICA "\" versão " + std::to_string(RASTRO_VERSAO);
+        return false;
+    }
+    c.seq = l.varint();
+    c.inicioMs = l.varint();
+    c.leitura = l.varint();
+    c.flags = l.varint();
+    c.sireneAltoMs = l.varint();
+    c.sireneBaixoMs = l.varint();
+    c.sireneCiclos = l.varint();
+    if (c.flags & RASTRO_F_SIRENE)
+    {
+        c.sireneEmAlto = l.varint();
+        c.sireneCiclosAtuais = l.varint();
+        c.sireneMsDesdeTroca = l.varint();
+        c.sireneAlvo = l.varint();
+    }
+
+    const uint64_t totalZonas = l.varint();
+    for (uint64_t z = 0; l.ok() && z < totalZonas; z++)
+    {
+        ZonaRastro zona;
+        zona.nome = l.texto();
+        const uint64_t totalSensores = l.varint();
+        zona.flags = l.byte();
+        zona.ignoradaMs = l.varint();
+        for (uint64_t s = 0; l.ok() && s < totalSensores; s++)
+        {
+            SensorRastro sensor;
+            sensor.nome = l.texto();
+            sensor.pino = (int)l.varint();
+            sensor.tipo = l.byte() ? Sensor::Tipo::REED : Sensor::Tipo::PIR;
+            sensor.flags = l.byte();
+            sensor.tentativas = l.varint();
+            sensor.msDesdeAlerta = sensor.tentativas ? l.varint() : 0;
+            zona.sensores.push_back(sensor);
+        }
+        c.zonas.push_back(zona);
+    }
+    if (!l.ok()) erro = "cabeçalho truncado";
+    return l.ok();
+}
+
+// Modelo do firmware montado a partir do cabeçalho, como o PoolModelo faz:
+// sensores contíguos por zona, na mesma ordem (os índices do rastro valem)
+class Modelo
+{
+public:
+    explicit Modelo(const Cabecalho &c)
+        : sirene(BUZZER_PIN, c.sireneAltoMs, c.sireneBaixoMs, (int)c.sireneCiclos)
+    {
+        size_t total = 0;
+        for (const ZonaRastro &z : c.zonas) total += z.sensores.size();
+        sensores.reserve(total);
+        zonas.reserve(c.zonas.size());
+
+        for (const ZonaRastro &z : c.zonas)
+        {
+            Sensor *primeiro = sensores.data() + sensores.size();
+            for (const SensorRastro &s : z.sensores)
+                sensores.emplace_back(s.nome.c_str(), s.tipo, s.pino, z.nome.c_str(), (s.flags & RASTRO_S_ATIVO) != 0);
+            zonas.emplace_back(z.nome.c_str(), primeiro, (uint16_t)z.sensores.size());
+        }
+
+        Faixa<Zona> faixa;
+        faixa.inicio = zonas.data();
+        faixa.fim = zonas.data() + zonas.size();
+        alarme.definirSirene(&sirene);
+        alarme.definirZonas(faixa);
+    }
+
+    // Estado do cabeçalho: primeiro as operações que o levaram até ali
+    // (armar, teste), depois o estado interno de sensores e sirene por cima
+    void restaurar(const Cabecalho &c)
+    {
+        const bool teste = c.flags & RASTRO_F_TESTE;
+        const uint32_t armado = teste ? RASTRO_F_ARMADO_ANTES_TESTE : RASTRO_F_ARMADO;
+        const uint8_t armada = teste ? RASTRO_Z_ARMADA_ANTES_TESTE : RASTRO_Z_ARMADA;
+        if (c.flags & armado)
+        {
+            uint64_t mascara = 0;
+            for (size_t i = 0; i < c.zonas.size() && i < 64; i++)
+                if (c.zonas[i].flags & armada) mascara |= 1ULL << i;
+            armar(mascara);
+        }
+        else alarme.desarmar();
+        if (teste) alarme.iniciarTesteCaminhada();
+
+        size_t i = 0;
+        for (const ZonaRastro &z : c.zonas)
+            for (const SensorRastro &s : z.sensores)
+                sensores[i++].restaurar({(s.flags & RASTRO_S_VIOLADO) != 0, (s.flags & RASTRO_S_ALERTADO) != 0,
+                                         (s.flags & RASTRO_S_ISOLADO) != 0, (int)s.tentativas, s.msDesdeAlerta});
+
+        for (size_t j = 0; j < c.zonas.size(); j++)
+            if (c.zonas[j].ignoradaMs) zonas[j].ignorarPor(c.zonas[j].ignoradaMs);
+
+        if (c.flags & RASTRO_F_SIRENE)
+            sirene.restaurar({true, c.sireneEmAlto != 0, (int)c.sireneCiclosAtuais, c.sireneMsDesdeTroca,
+                              c.sireneAlvo && c.sireneAlvo <= sensores.size() ? &sensores[c.sireneAlvo - 1] : nullptr});
+    }
+
+    void armar(uint64_t mascara)
+    {
+        std::vector<String> nomes;
+        for (size_t i = 0; i < zonas.size() && i < 64; i++)
+            if (mascara & (1ULL << i)) nomes.push_back(zonas[i].getNome());
+        alarme.armar(nomes);
+    }
+
+    Alarme alarme;
+    Sirene sirene;
+    std::vector<Sensor> sensores;
+    std::vector<Zona> zonas;
+};
+
+// Alertas de um tick: os que o replay emitiu x os que o firmware gravou
+class Conferencia
+{
+public:
+    Conferencia(const Modelo &m, ResultadoSegmento &r) : modelo(m), resultado(r) {}
+
+    void replay(const std::vector<const Sensor *> &alertas)
+    {
+        for (const Sensor *s : alertas) emitidos.push_back((uint32_t)(s - modelo.sensores.data()));
+    }
+
+    void gravado(uint32_t indice)
+    {
+        gravados.push_back(indice);
+        resultado.alertasGravados++;
+    }
+
+    void fechar()
+    {
+        std::sort(emitidos.begin(), emitidos.end());
+        std::sort(gravados.begin(), gravados.end());
+        if (emitidos == gravados) resultado.alertasConferidos += gravados.size();
+        else
+        {
+            resultado.divergencias++;
+            hostDecisao("!! DIVERGENCIA: firmware alertou [" + nomes(gravados) + "], replay [" + nomes(emitidos) + "]");
+        }
+        emitidos.clear();
+        gravados.clear();
+    }
+
+private:
+    std::string nomes(const std::vector<uint32_t> &indices) const
+    {
+        std::string s;
+        for (uint32_t i : indices)
+        {
+            if (!s.empty()) s += ", ";
+            const Sensor &sensor = modelo.sensores[i];
+            s += std::string(sensor.getZona()) + "/" + sensor.getNome();
+        }
+        return s;
+    }
+
+    const Modelo &modelo;
+    ResultadoSegmento &resultado;
+    std::vector<uint32_t> emitidos;
+    std::vector<uint32_t> gravados;
+};
+
+static std::string nomesZonas(const Modelo &m, uint64_t mascara)
+{
+    std::string s;
+    for (size_t i = 0; i < m.zonas.size() && i < 64; i++)
+    {
+        if (!(mascara & (1ULL << i))) continue;
+        if (!s.empty()) s += ",";
+        s += m.zonas[i].getNome();
+    }
+    return s.empty() ? "-" : s;
+}
+
+// Aplica uma operação gravada entre ticks; false se o índice não existir
+static bool aplicarOperacao(Leitor &l, uint8_t op, Modelo &m, Conferencia &conferencia, bool decisoes)
+{
+    switch (op)
+    {
+    case RASTRO_OP_ARMAR:
+    {
+        const uint64_t mascara = l.varint();
+        if (decisoes) hostDecisao("> armar: " + nomesZonas(m, mascara));
+        m.armar(mascara);
+        return true;
+    }
+    case RASTRO_OP_DESARMAR:
+        if (decisoes) hostDecisao("> desarmar");
+        m.alarme.desarmar();
+        return true;
+    case RASTRO_OP_TESTE_INICIAR:
+        if (decisoes) hostDecisao("> teste de caminhada iniciado");
+        m.alarme.iniciarTesteCaminhada();
+        return true;
+    case RASTRO_OP_TESTE_ENCERRAR:
+        if (decisoes) hostDecisao("> teste de caminhada encerrado");
+        m.alarme.encerrarTesteCaminhada();
+        return true;
+    case RASTRO_OP_SENSOR:
+    {
+        const uint64_t i = l.varint();
+        const uint8_t flags = l.byte();
+        if (i >= m.sensores.size()) return false;
+        Sensor &s = m.sensores[i];
+        if (decisoes)
+            hostDecisao(std::string("> ajuste ") + s.getZona() + "/" + s.getNome() +
+                        ((flags & RASTRO_S_ATIVO) ? ": ativo" : ": inativo"));
+        if (flags & RASTRO_S_ATIVO) s.ativar();
+        else s.desativar();
+        if (!(flags & RASTRO_S_ISOLADO) && s.estaIsolado()) s.limparIsolamento();
+        return true;
+    }
+    case RASTRO_OP_BYPASS:
+    {
+        const uint64_t i = l.varint();
+        const uint32_t ms = (uint32_t)l.varint();
+        if (i >= m.zonas.size()) return false;
+        if (decisoes) hostDecisao(std::string("> bypass ") + m.zonas[i].getNome() + ": " + std::to_string(ms) + " ms");
+        m.zonas[i].ignorarPor(ms);
+        return true;
+    }
+    case RASTRO_OP_SIRENE_REMOTA:
+        if (decisoes) hostDecisao("> sirene acionada por outra placa (P2P)");
+        m.sirene.ativar(nullptr);
+        return true;
+    case RASTRO_OP_ALERTA:
+    {
+        const uint64_t i = l.varint();
+        if (i >= m.sensores.size()) return false;
+        conferencia.gravado((uint32_t)i);
+        return true;
+    }
+    }
+    return false;
+}
+
+bool reproduzirSegmento(const uint8_t *dados, size_t tamanho, ResultadoSegmento &r, bool decisoes)
+{
+    Leitor l(dados, tamanho);
+    Cabecalho c;
+    if (!lerCabecalho(l, c, r.erro)) return false;
+
+    r.seq = c.seq;
+    r.inicioMs = c.inicioMs;
+    r.zonas = c.zonas.size();
+    for (const ZonaRastro &z : c.zonas) r.sensores += z.sensores.size();
+
+    hostRegistrarDecisoes(decisoes ? &r.decisoes : nullptr);
+    hostRelogioMs = c.inicioMs;
+    hostDefinirLeitura(c.leitura);
+
+    Modelo m(c);
+    m.restaurar(c);
+    Conferencia conferencia(m, r);
+    bool sireneAtiva = m.sirene.estaAtiva();
+    bool alertasAbertos = false; // tick reproduzido, esperando os RASTRO_OP_ALERTA dele
+
+    while (l.restante())
+    {
+        const uint64_t h = l.varint();
+        const uint8_t tipo = h & 3;
+        const uint8_t op = tipo == RASTRO_OPERACAO ? l.byte() : 0;
+        if (!l.ok())
+        {
+            r.truncado = true;
+            break;
+        }
+        hostRelogioMs += (uint32_t)(h >> 2);
+        r.registros++;
+
+        // alertas do firmware vêm logo depois do tick que os emitiu
+        if (alertasAbertos && op != RASTRO_OP_ALERTA)
+        {
+            conferencia.fechar();
+            alertasAbertos = false;
+        }
+
+        if (tipo == RASTRO_LEITURA || tipo == RASTRO_TICK_LEITURA)
+        {
+            const uint64_t mudou = l.varint();
+            hostDefinirLeitura(hostLeitura() ^ (uint32_t)mudou);
+        }
+        if (tipo == RASTRO_TICK || tipo == RASTRO_TICK_LEITURA)
+        {
+            m.alarme.atualizar(hostLeitura());
+            conferencia.replay(hostAlertas());
+            alertasAbertos = true;
+            r.ticks++;
+        }
+        if (tipo == RASTRO_OPERACAO && !aplicarOperacao(l, op, m, conferencia, decisoes))
+        {
+            if (!l.ok()) r.truncado = true;
+            else r.erro = "operação " + std::to_string(op) + " inválida";
+            break;
+        }
+        if (!l.ok())
+        {
+            r.truncado = true;
+            break;
+        }
+        r.duracaoMs = hostRelogioMs - c.inicioMs;
+
+        if (decisoes && m.sirene.estaAtiva() != sireneAtiva)
+            hostDecisao(m.sirene.estaAtiva() ? "SIRENE tocando" : "SIRENE parada");
+        sireneAtiva = m.sirene.estaAtiva();
+    }
+    if (alertasAbertos) conferencia.fechar();
+
+    hostRegistrarDecisoes(nullptr);
+    return r.erro.empty();
+}
@@ -0,0 +1,34 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "host.h"
+
+// Resultado de um segmento reproduzido
+struct ResultadoSegmento
+{
+    uint32_t seq = 0;
+    uint32_t inicioMs = 0;
+    uint32_t duracaoMs = 0;   // tempo simulado até o último registro
+    uint32_t sensores = 0;
+    uint32_t zonas = 0;
+    uint32_t registros = 0;
+    uint32_t ticks = 0;
+    uint32_t alertasGravados = 0;   // pelo firmware (RASTRO_OP_ALERTA)
+    uint32_t alertasConferidos = 0; // o replay emitiu no mesmo tick
+    uint32_t divergencias = 0;      // ticks em que os alertas diferem
+    bool truncado = false;          // terminou no meio de um registro
+    std::string erro;               // formato inválido (segmento abandonado)
+    std::vector<Decisao> decisoes;  // eventos do modelo e operações aplicadas
+};
+
+// Reproduz um segmento (sem o prefixo de tamanho do download) no modelo do
+// firmware. Com 'decisoes' falso só conta (medida de velocidade).
+bool reproduzirSegmento(const uint8_t *dados, size_t tamanho, ResultadoSegmento &resultado,
+                        bool decisoes = true);
+
+#endif